@@ -129,6 +129,7 @@ option(CMAKE_BUILD_PO "Build po files (modifies git-tracked files)" OFF)
 # Select the architecture
 #-------------------------------------------------------------------------------
 option(DISABLE_ADVANCE_SIMD "Disable advance use of SIMD (SSE2+ & AVX)" OFF)
+option(MULTI_ISA "With DISABLE_ADVANCE_SIMD, also build the GS swizzle kernels for AVX, AVX2 and AVX-512 VBMI and select them at runtime" ON)
 
 # Print if we are cross compiling.
 if(CMAKE_CROSSCOMPILING)
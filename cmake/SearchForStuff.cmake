@@ -127,6 +127,8 @@ else()
 
 		if(Linux)
 			check_lib(AIO aio libaio.h)
+			# Optional, the Linux file readers fall back to libaio without it
+			check_lib(LIBURING uring liburing.h)
 			# There are two udev pkg config files - udev.pc (wrong), libudev.pc (correct)
 			# When cross compiling, pkg-config will be skipped so we have to look for
 			# udev (it'll automatically be prefixed with lib). But when not cross
@@ -141,6 +143,10 @@ else()
 
 	check_lib(SOUNDTOUCH SoundTouch SoundTouch.h PATH_SUFFIXES soundtouch)
 	check_lib(SAMPLERATE samplerate samplerate.h)
+	# Optional, ZSO images can't be read or written without it
+	check_lib(LZ4 lz4 lz4.h)
+	# Optional, zstd GS dumps can't be read or written without it
+	check_lib(ZSTD zstd zstd.h)
 
 	if(NOT QT_BUILD)
 		check_lib(SDL2 SDL2 SDL.h PATH_SUFFIXES SDL2)
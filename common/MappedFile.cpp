@@ -0,0 +1,116 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+
+#include "MappedFile.h"
+#include "FileSystem.h"
+#include "StringUtil.h"
+
+#ifdef _WIN32
+#include "RedtapeWindows.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+Common::MappedFile::MappedFile() = default;
+
+Common::MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+
+bool Common::MappedFile::Open(const char* filename)
+{
+	Close();
+
+	const HANDLE file = CreateFileW(StringUtil::UTF8StringToWideString(filename).c_str(), GENERIC_READ,
+		FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	m_file = file;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0 ||
+		!(m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr)) ||
+		!(m_data = static_cast<const u8*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0))))
+	{
+		Close();
+		return false;
+	}
+
+	m_size = static_cast<size_t>(size.QuadPart);
+	return true;
+}
+
+void Common::MappedFile::Close()
+{
+	if (m_data)
+		UnmapViewOfFile(m_data);
+	if (m_mapping)
+		CloseHandle(m_mapping);
+	if (m_file)
+		CloseHandle(m_file);
+
+	m_data = nullptr;
+	m_size = 0;
+	m_mapping = nullptr;
+	m_file = nullptr;
+}
+
+#else
+
+bool Common::MappedFile::Open(const char* filename)
+{
+	Close();
+
+	m_fd = FileSystem::OpenFDFile(filename, O_RDONLY, 0);
+	struct stat sd;
+	if (m_fd < 0 || fstat(m_fd, &sd) != 0 || sd.st_size == 0)
+	{
+		Close();
+		return false;
+	}
+
+	void* data = mmap(nullptr, static_cast<size_t>(sd.st_size), PROT_READ, MAP_SHARED, m_fd, 0);
+	if (data == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+
+	m_data = static_cast<const u8*>(data);
+	m_size = static_cast<size_t>(sd.st_size);
+	return true;
+}
+
+void Common::MappedFile::Close()
+{
+	if (m_data)
+		munmap(const_cast<u8*>(m_data), m_size);
+	if (m_fd >= 0)
+		close(m_fd);
+
+	m_data = nullptr;
+	m_size = 0;
+	m_fd = -1;
+}
+
+#endif
@@ -0,0 +1,613 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Replays a GS dump through the software or null renderer as fast as it will go, without a window,
+// and writes out how long each frame took along with the GS counters for it.  Meant for comparing
+// renderer changes against a fixed set of dumps.
+
+#include "PrecompiledHeader.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <wx/module.h>
+
+#include "common/Console.h"
+#include "common/FileSystem.h"
+#include "common/Path.h"
+#include "common/SettingsWrapper.h"
+#include "common/StringUtil.h"
+#include "common/Timer.h"
+
+#include "pcsx2/Frontend/INISettingsInterface.h"
+#include "pcsx2/Frontend/InputManager.h"
+#include "pcsx2/GS.h"
+#include "pcsx2/GS/GSPerfMon.h"
+#include "pcsx2/GSDumpReplayer.h"
+#include "pcsx2/Host.h"
+#include "pcsx2/HostDisplay.h"
+#include "pcsx2/HostSettings.h"
+#include "pcsx2/PAD/Host/PAD.h"
+#include "pcsx2/VMManager.h"
+
+#include "svnrev.h"
+
+namespace GSRunner
+{
+	struct FrameRecord
+	{
+		double ms;
+		double counters[GSPerfMon::CounterLast];
+	};
+
+	// The counters that mean something for the software and null renderers
+	static constexpr GSPerfMon::counter_t EXPORTED_COUNTERS[] = {
+		GSPerfMon::Prim,
+		GSPerfMon::Draw,
+		GSPerfMon::Swizzle,
+		GSPerfMon::Unswizzle,
+		GSPerfMon::Fillrate,
+		GSPerfMon::SyncPoint,
+		GSPerfMon::PaletteLookups,
+		GSPerfMon::PaletteHits,
+	};
+	static constexpr const char* EXPORTED_COUNTER_NAMES[] = {
+		"prim",
+		"draw",
+		"swizzle",
+		"unswizzle",
+		"fillrate",
+		"syncpoint",
+		"palettelookups",
+		"palettehits",
+	};
+	static_assert(std::size(EXPORTED_COUNTERS) == std::size(EXPORTED_COUNTER_NAMES));
+
+	static void InitializeWxRubbish();
+	static bool InitializeConfig();
+	static bool ParseCommandLineOptions(int argc, char* argv[]);
+	static bool WriteCSV(const char* path);
+	static bool WriteJSON(const char* path, double seconds, double draws);
+} // namespace GSRunner
+
+class NullHostDisplay final : public HostDisplay
+{
+public:
+	RenderAPI GetRenderAPI() const override { return RenderAPI::None; }
+	void* GetRenderDevice() const override { return nullptr; }
+	void* GetRenderContext() const override { return nullptr; }
+	void* GetRenderSurface() const override { return nullptr; }
+
+	bool HasRenderDevice() const override { return true; }
+	bool HasRenderSurface() const override { return true; }
+
+	bool CreateRenderDevice(const WindowInfo& wi, std::string_view adapter_name, VsyncMode vsync, bool threaded_presentation, bool debug_device) override
+	{
+		m_window_info = wi;
+		return true;
+	}
+	bool InitializeRenderDevice(std::string_view shader_cache_directory, bool debug_device) override { return true; }
+	bool MakeRenderContextCurrent() override { return true; }
+	bool DoneRenderContextCurrent() override { return true; }
+	void DestroyRenderDevice() override {}
+	void DestroyRenderSurface() override {}
+	bool ChangeRenderWindow(const WindowInfo& wi) override { return true; }
+	bool SupportsFullscreen() const override { return false; }
+	bool IsFullscreen() override { return false; }
+	bool SetFullscreen(bool fullscreen, u32 width, u32 height, float refresh_rate) override { return false; }
+	AdapterAndModeList GetAdapterAndModeList() override { return {}; }
+	std::string GetDriverInfo() const override { return "None"; }
+
+	void ResizeRenderWindow(s32 new_window_width, s32 new_window_height, float new_window_scale) override {}
+
+	std::unique_ptr<HostDisplayTexture> CreateTexture(u32 width, u32 height, const void* data, u32 data_stride, bool dynamic = false) override { return {}; }
+	void UpdateTexture(HostDisplayTexture* texture, u32 x, u32 y, u32 width, u32 height, const void* data, u32 data_stride) override {}
+
+	bool BeginPresent(bool frame_skip) override { return false; }
+	void EndPresent() override {}
+
+	void SetVSync(VsyncMode mode) override {}
+
+	bool CreateImGuiContext() override { return true; }
+	void DestroyImGuiContext() override {}
+	bool UpdateImGuiFontTexture() override { return true; }
+};
+
+// Never destroyed, INISettingsInterface saves itself on destruction when it's been changed
+static INISettingsInterface* s_settings_interface;
+static std::unique_ptr<NullHostDisplay> s_host_display;
+
+static std::string s_dump_path;
+static std::string s_csv_path;
+static std::string s_json_path;
+static GSRendererType s_renderer = GSRendererType::SW;
+static s32 s_loop_count = 1;
+static s32 s_extra_threads = -1;
+static bool s_verbose = false;
+static bool s_had_error = false;
+
+// Only touched on the GS thread until the VM has shut down
+static std::vector<GSRunner::FrameRecord> s_frames;
+static Common::Timer::Value s_last_present_time = 0;
+static u64 s_last_perfmon_frame = 0;
+
+static void PrintCommandLineHelp(const char* progname)
+{
+	std::fprintf(stderr, "PCSX2 GS Runner Version %s\n", GIT_REV);
+	std::fprintf(stderr, "Usage: %s [parameters] [--] <dump filename>\n", progname);
+	std::fprintf(stderr, "\n");
+	std::fprintf(stderr, "  -help: Displays this information and exits.\n");
+	std::fprintf(stderr, "  -renderer <sw|null>: Renderer to replay the dump with, defaults to sw.\n");
+	std::fprintf(stderr, "  -loop <count>: Plays the dump this many times, defaults to 1.\n");
+	std::fprintf(stderr, "  -threads <count>: Extra software renderer threads.\n");
+	std::fprintf(stderr, "  -csv <filename>: Writes the time and GS counters of each frame as CSV.\n");
+	std::fprintf(stderr, "  -json <filename>: Writes the summary and each frame as JSON.\n");
+	std::fprintf(stderr, "  -verbose: Writes the emulator log to stdout.\n");
+	std::fprintf(stderr, "  --: Signals that no more arguments will follow and the remaining\n"
+						 "    parameters make up the filename.\n");
+	std::fprintf(stderr, "\n");
+}
+
+bool GSRunner::ParseCommandLineOptions(int argc, char* argv[])
+{
+	bool no_more_args = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!no_more_args)
+		{
+#define CHECK_ARG(str) !std::strcmp(argv[i], str)
+#define CHECK_ARG_PARAM(str) (!std::strcmp(argv[i], str) && ((i + 1) < argc))
+
+			if (CHECK_ARG("-help"))
+			{
+				PrintCommandLineHelp(argv[0]);
+				return false;
+			}
+			else if (CHECK_ARG_PARAM("-renderer"))
+			{
+				const char* name = argv[++i];
+				if (!StringUtil::Strcasecmp(name, "sw"))
+					s_renderer = GSRendererType::SW;
+				else if (!StringUtil::Strcasecmp(name, "null"))
+					s_renderer = GSRendererType::Null;
+				else
+				{
+					std::fprintf(stderr, "Unknown renderer '%s'.\n", name);
+					return false;
+				}
+				continue;
+			}
+			else if (CHECK_ARG_PARAM("-loop"))
+			{
+				s_loop_count = std::max(std::atoi(argv[++i]), 1);
+				continue;
+			}
+			else if (CHECK_ARG_PARAM("-threads"))
+			{
+				s_extra_threads = std::max(std::atoi(argv[++i]), 0);
+				continue;
+			}
+			else if (CHECK_ARG_PARAM("-csv"))
+			{
+				s_csv_path = argv[++i];
+				continue;
+			}
+			else if (CHECK_ARG_PARAM("-json"))
+			{
+				s_json_path = argv[++i];
+				continue;
+			}
+			else if (CHECK_ARG("-verbose"))
+			{
+				s_verbose = true;
+				continue;
+			}
+			else if (CHECK_ARG("--"))
+			{
+				no_more_args = true;
+				continue;
+			}
+			else if (argv[i][0] == '-')
+			{
+				std::fprintf(stderr, "Unknown parameter: '%s'\n", argv[i]);
+				return false;
+			}
+
+#undef CHECK_ARG
+#undef CHECK_ARG_PARAM
+		}
+
+		if (!s_dump_path.empty())
+			s_dump_path += ' ';
+
+		s_dump_path += argv[i];
+	}
+
+	if (s_dump_path.empty())
+	{
+		PrintCommandLineHelp(argv[0]);
+		return false;
+	}
+
+	return true;
+}
+
+void GSRunner::InitializeWxRubbish()
+{
+	wxLog::DoCreateOnDemand();
+	wxLog::GetActiveTarget();
+
+	wxModule::RegisterModules();
+	wxModule::InitializeModules();
+}
+
+bool GSRunner::InitializeConfig()
+{
+	std::string program_path(FileSystem::GetProgramPath());
+	EmuFolders::AppRoot = wxDirName(wxFileName(StringUtil::UTF8StringToWxString(program_path)));
+	EmuFolders::DataRoot = EmuFolders::AppRoot;
+	EmuFolders::Settings = EmuFolders::DataRoot.Combine(wxDirName(L"inis"));
+	EmuFolders::Resources = EmuFolders::AppRoot.Combine(wxDirName(L"resources"));
+
+	// Settings come from the defaults and the command line only, so results don't depend on whoever
+	// last ran the emulator on this machine.  The file name is never loaded or saved.
+	s_settings_interface = new INISettingsInterface(std::string());
+	Host::Internal::SetBaseSettingsLayer(s_settings_interface);
+
+	EmuConfig = Pcsx2Config();
+	EmuFolders::SetDefaults();
+
+	SettingsInterface& si = *s_settings_interface;
+	{
+		SettingsSaveWrapper wrapper(si);
+		EmuConfig.LoadSave(wrapper);
+	}
+	EmuFolders::Save(si);
+	PAD::SetDefaultConfig(si);
+
+	si.SetIntValue("EmuCore/GS", "Renderer", static_cast<int>(s_renderer));
+	if (s_extra_threads >= 0)
+		si.SetIntValue("EmuCore/GS", "extrathreads", s_extra_threads);
+
+	// No pacing, the replayer runs unlimited when the frame limiter is off
+	si.SetBoolValue("EmuCore/GS", "FrameLimitEnable", false);
+	si.SetIntValue("EmuCore/GS", "VsyncEnable", static_cast<int>(VsyncMode::Off));
+	si.SetBoolValue("EmuCore/GS", "FrameSkipEnable", false);
+
+	// Nothing should be written next to the dump, or anywhere else
+	for (uint slot = 0; slot < 2; slot++)
+		si.SetBoolValue("MemoryCards", StringUtil::StdStringFromFormat("Slot%u_Enable", slot + 1).c_str(), false);
+
+	EmuFolders::LoadConfig(si);
+	return true;
+}
+
+static void RecordFrame()
+{
+	const Common::Timer::Value now = Common::Timer::GetCurrentValue();
+	const u64 frame = g_perfmon.GetFrame();
+	if (frame == s_last_perfmon_frame)
+		return;
+
+	// Loading the dump state renumbers the frames, which tells us nothing about how long the frame took
+	if (frame == s_last_perfmon_frame + 1 && s_last_present_time != 0)
+	{
+		GSRunner::FrameRecord record;
+		record.ms = Common::Timer::ConvertValueToMilliseconds(now - s_last_present_time);
+		for (int i = 0; i < GSPerfMon::CounterLast; i++)
+			record.counters[i] = g_perfmon.GetLastFrame(static_cast<GSPerfMon::counter_t>(i));
+		s_frames.push_back(record);
+	}
+
+	s_last_perfmon_frame = frame;
+	s_last_present_time = now;
+}
+
+bool GSRunner::WriteCSV(const char* path)
+{
+	auto fp = FileSystem::OpenManagedCFile(path, "wb");
+	if (!fp)
+	{
+		std::fprintf(stderr, "Failed to open '%s' for writing.\n", path);
+		return false;
+	}
+
+	std::fprintf(fp.get(), "frame,ms");
+	for (const char* name : EXPORTED_COUNTER_NAMES)
+		std::fprintf(fp.get(), ",%s", name);
+	std::fprintf(fp.get(), "\n");
+
+	for (size_t i = 0; i < s_frames.size(); i++)
+	{
+		std::fprintf(fp.get(), "%zu,%.4f", i, s_frames[i].ms);
+		for (GSPerfMon::counter_t counter : EXPORTED_COUNTERS)
+			std::fprintf(fp.get(), ",%.0f", s_frames[i].counters[counter]);
+		std::fprintf(fp.get(), "\n");
+	}
+
+	return std::ferror(fp.get()) == 0;
+}
+
+bool GSRunner::WriteJSON(const char* path, double seconds, double draws)
+{
+	auto fp = FileSystem::OpenManagedCFile(path, "wb");
+	if (!fp)
+	{
+		std::fprintf(stderr, "Failed to open '%s' for writing.\n", path);
+		return false;
+	}
+
+	std::string escaped_dump;
+	for (const char ch : s_dump_path)
+	{
+		if (ch == '"' || ch == '\\')
+			escaped_dump += '\\';
+		escaped_dump += ch;
+	}
+
+	std::FILE* f = fp.get();
+	std::fprintf(f, "{\n");
+	std::fprintf(f, "\t\"dump\": \"%s\",\n", escaped_dump.c_str());
+	std::fprintf(f, "\t\"renderer\": \"%s\",\n", (s_renderer == GSRendererType::Null) ? "null" : "sw");
+	std::fprintf(f, "\t\"loops\": %d,\n", s_loop_count);
+	std::fprintf(f, "\t\"frames\": %zu,\n", s_frames.size());
+	std::fprintf(f, "\t\"seconds\": %.6f,\n", seconds);
+	std::fprintf(f, "\t\"fps\": %.4f,\n", (seconds > 0.0) ? (s_frames.size() / seconds) : 0.0);
+	std::fprintf(f, "\t\"dps\": %.4f,\n", (seconds > 0.0) ? (draws / seconds) : 0.0);
+	std::fprintf(f, "\t\"frame_data\": [\n");
+	for (size_t i = 0; i < s_frames.size(); i++)
+	{
+		std::fprintf(f, "\t\t{\"ms\": %.4f", s_frames[i].ms);
+		for (size_t j = 0; j < std::size(EXPORTED_COUNTERS); j++)
+			std::fprintf(f, ", \"%s\": %.0f", EXPORTED_COUNTER_NAMES[j], s_frames[i].counters[EXPORTED_COUNTERS[j]]);
+		std::fprintf(f, "}%s\n", (i + 1 < s_frames.size()) ? "," : "");
+	}
+	std::fprintf(f, "\t]\n");
+	std::fprintf(f, "}\n");
+
+	return std::ferror(f) == 0;
+}
+
+int main(int argc, char* argv[])
+{
+	if (!GSRunner::ParseCommandLineOptions(argc, argv))
+		return EXIT_FAILURE;
+
+	GSRunner::InitializeWxRubbish();
+	Console_SetActiveHandler(s_verbose ? ConsoleWriter_Stdout : ConsoleWriter_Null);
+	if (!GSRunner::InitializeConfig())
+		return EXIT_FAILURE;
+
+	if (!VMManager::InitializeMemory())
+	{
+		std::fprintf(stderr, "Failed to allocate memory map.\n");
+		return EXIT_FAILURE;
+	}
+
+	// Applied when the VM resets the replayer on boot
+	GSDumpReplayer::SetLoopCount(s_loop_count);
+
+	VMBootParameters params;
+	params.filename = s_dump_path;
+	if (!VMManager::Initialize(params))
+	{
+		VMManager::ReleaseMemory();
+		return EXIT_FAILURE;
+	}
+
+	VMManager::SetState(VMState::Running);
+	while (VMManager::GetState() == VMState::Running)
+		VMManager::Execute();
+
+	// Waits for the GS to finish the frames it was sent
+	VMManager::Shutdown(false);
+	VMManager::ReleaseMemory();
+
+	if (s_had_error)
+		return EXIT_FAILURE;
+
+	double seconds = 0.0;
+	double draws = 0.0;
+	for (const GSRunner::FrameRecord& record : s_frames)
+	{
+		seconds += record.ms / 1000.0;
+		draws += record.counters[GSPerfMon::Draw];
+	}
+
+	std::fprintf(stdout, "%zu frames in %.3f seconds\n", s_frames.size(), seconds);
+	std::fprintf(stdout, "%.2f frames/s, %.2f draws/s\n",
+		(seconds > 0.0) ? (s_frames.size() / seconds) : 0.0, (seconds > 0.0) ? (draws / seconds) : 0.0);
+
+	bool result = true;
+	if (!s_csv_path.empty())
+		result &= GSRunner::WriteCSV(s_csv_path.c_str());
+	if (!s_json_path.empty())
+		result &= GSRunner::WriteJSON(s_json_path.c_str(), seconds, draws);
+
+	return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Host Interface
+//////////////////////////////////////////////////////////////////////////
+
+std::optional<std::vector<u8>> Host::ReadResourceFile(const char* filename)
+{
+	const std::string path(Path::CombineStdString(EmuFolders::Resources, filename));
+	std::optional<std::vector<u8>> ret(FileSystem::ReadBinaryFile(path.c_str()));
+	if (!ret.has_value())
+		Console.Error("Failed to read resource file '%s'", filename);
+	return ret;
+}
+
+std::optional<std::string> Host::ReadResourceFileToString(const char* filename)
+{
+	const std::string path(Path::CombineStdString(EmuFolders::Resources, filename));
+	std::optional<std::string> ret(FileSystem::ReadFileToString(path.c_str()));
+	if (!ret.has_value())
+		Console.Error("Failed to read resource file to string '%s'", filename);
+	return ret;
+}
+
+std::optional<std::time_t> Host::GetResourceFileTimestamp(const char* filename)
+{
+	const std::string path(Path::CombineStdString(EmuFolders::Resources, filename));
+	FILESYSTEM_STAT_DATA sd;
+	if (!FileSystem::StatFile(path.c_str(), &sd))
+	{
+		Console.Error("Failed to stat resource file '%s'", filename);
+		return std::nullopt;
+	}
+
+	return sd.ModificationTime;
+}
+
+void Host::ReportErrorAsync(const std::string_view& title, const std::string_view& message)
+{
+	// Errors always go to stderr, the log is usually off
+	if (!title.empty() && !message.empty())
+	{
+		std::fprintf(stderr, "%.*s: %.*s\n",
+			static_cast<int>(title.size()), title.data(),
+			static_cast<int>(message.size()), message.data());
+	}
+	else if (!message.empty())
+	{
+		std::fprintf(stderr, "%.*s\n", static_cast<int>(message.size()), message.data());
+	}
+
+	s_had_error = true;
+}
+
+void Host::OnInputDeviceConnected(const std::string_view& identifier, const std::string_view& device_name)
+{
+}
+
+void Host::OnInputDeviceDisconnected(const std::string_view& identifier)
+{
+}
+
+HostDisplay* Host::GetHostDisplay()
+{
+	return s_host_display.get();
+}
+
+HostDisplay* Host::AcquireHostDisplay(HostDisplay::RenderAPI api)
+{
+	// Whatever the renderer asked for, the GS gets the null device
+	s_host_display = std::make_unique<NullHostDisplay>();
+	s_host_display->CreateRenderDevice(WindowInfo(), std::string_view(), VsyncMode::Off, false, false);
+	return s_host_display.get();
+}
+
+void Host::ReleaseHostDisplay()
+{
+	s_host_display.reset();
+}
+
+bool Host::BeginPresentFrame(bool frame_skip)
+{
+	RecordFrame();
+	return false;
+}
+
+void Host::EndPresentFrame()
+{
+}
+
+void Host::ResizeHostDisplay(u32 new_window_width, u32 new_window_height, float new_window_scale)
+{
+}
+
+void Host::RequestResizeHostDisplay(s32 width, s32 height)
+{
+}
+
+void Host::UpdateHostDisplay()
+{
+}
+
+void Host::OnVMStarting()
+{
+}
+
+void Host::OnVMStarted()
+{
+}
+
+void Host::OnVMDestroyed()
+{
+}
+
+void Host::OnVMPaused()
+{
+}
+
+void Host::OnVMResumed()
+{
+}
+
+void Host::OnGameChanged(const std::string& disc_path, const std::string& game_serial, const std::string& game_name,
+	u32 game_crc)
+{
+}
+
+void Host::OnSaveStateLoading(const std::string_view& filename)
+{
+}
+
+void Host::OnSaveStateLoaded(const std::string_view& filename, bool was_successful)
+{
+}
+
+void Host::OnSaveStateSaved(const std::string_view& filename)
+{
+}
+
+void Host::InvalidateSaveStateCache()
+{
+}
+
+void Host::PumpMessagesOnCPUThread()
+{
+}
+
+alignas(16) static SysMtgsThread s_mtgs_thread;
+
+SysMtgsThread& GetMTGS()
+{
+	return s_mtgs_thread;
+}
+
+BEGIN_HOTKEY_LIST(g_host_hotkeys)
+END_HOTKEY_LIST()
+
+//////////////////////////////////////////////////////////////////////////
+// Interface Stuff
+//////////////////////////////////////////////////////////////////////////
+
+const IConsoleWriter* PatchesCon = &Console;
+
+void LoadAllPatchesAndStuff(const Pcsx2Config& cfg)
+{
+}
+
+void PatchesVerboseReset()
+{
+}
@@ -20,12 +20,16 @@
 #include <QtWidgets/QFileDialog>
 #include <QtWidgets/QMessageBox>
 #include <QtWidgets/QProgressBar>
+#include <QtWidgets/QProgressDialog>
 #include <QtWidgets/QStyle>
 #include <QtWidgets/QStyleFactory>
 
 #include "common/FileSystem.h"
+#include "common/ProgressCallback.h"
+#include "common/StringUtil.h"
 
 #include "pcsx2/CDVD/CDVDaccess.h"
+#include "pcsx2/CDVD/CsoWriter.h"
 #include "pcsx2/Frontend/GameList.h"
 #include "pcsx2/HostDisplay.h"
 
@@ -44,15 +48,15 @@
 #include "svnrev.h"
 
 static constexpr char DISC_IMAGE_FILTER[] =
-	QT_TRANSLATE_NOOP("MainWindow", "All File Types (*.bin *.iso *.cue *.chd *.cso *.elf *.irx *.m3u *.gs *.gs.xz);;"
+	QT_TRANSLATE_NOOP("MainWindow", "All File Types (*.bin *.iso *.cue *.chd *.cso *.zso *.elf *.irx *.m3u *.gs *.gs.xz *.gs.zst);;"
 									"Single-Track Raw Images (*.bin *.iso);;"
 									"Cue Sheets (*.cue);;"
 									"MAME CHD Images (*.chd);;"
-									"CSO Images (*.cso);;"
+									"CSO/ZSO Images (*.cso *.zso);;"
 									"ELF Executables (*.elf);;"
 									"IRX Executables (*.irx);;"
 									"Playlists (*.m3u);;"
-									"GS Dumps (*.gs *.gs.xz)");
+									"GS Dumps (*.gs *.gs.xz *.gs.zst)");
 
 const char* MainWindow::DEFAULT_THEME_NAME = "darkfusion";
 
@@ -747,6 +751,16 @@ void MainWindow::onGameListEntryContextMenuRequested(const QPoint& point)
 		action = menu.addAction(tr("Set Cover Image..."));
 		connect(action, &QAction::triggered, [this, entry]() { setGameListEntryCoverImage(entry); });
 
+		if (StringUtil::EndsWith(entry->path, ".iso"))
+		{
+			action = menu.addAction(tr("Compress Disc Image..."));
+			connect(action, &QAction::triggered, [this, entry]() {
+				// Converting takes a while, don't hold the game list lock for it
+				const QString path(QString::fromStdString(entry->path));
+				QMetaObject::invokeMethod(this, [this, path]() { compressDiscImage(path); }, Qt::QueuedConnection);
+			});
+		}
+
 		connect(menu.addAction(tr("Exclude From List")), &QAction::triggered,
 			[this, entry]() { getSettingsDialog()->getGameListSettingsWidget()->addExcludedPath(entry->path); });
 
@@ -1408,6 +1422,91 @@ void MainWindow::setGameListEntryCoverImage(const GameList::Entry* entry)
 	m_game_list_widget->refreshGridCovers();
 }
 
+namespace
+{
+	class DialogProgressCallback final : public BaseProgressCallback
+	{
+	public:
+		DialogProgressCallback(QWidget* parent, const QString& title)
+			: m_dialog(title, MainWindow::tr("Cancel"), 0, 1, parent)
+		{
+			m_dialog.setWindowTitle(title);
+			m_dialog.setWindowModality(Qt::WindowModal);
+			m_dialog.setMinimumDuration(0);
+		}
+
+		bool IsCancelled() const override { return m_dialog.wasCanceled(); }
+
+		void SetTitle(const char* title) override { m_dialog.setWindowTitle(QString::fromUtf8(title)); }
+		void SetStatusText(const char* text) override
+		{
+			BaseProgressCallback::SetStatusText(text);
+			m_dialog.setLabelText(QString::fromUtf8(text));
+			QCoreApplication::processEvents();
+		}
+		void SetProgressRange(u32 range) override
+		{
+			BaseProgressCallback::SetProgressRange(range);
+			m_dialog.setMaximum(static_cast<int>(range));
+		}
+		void SetProgressValue(u32 value) override
+		{
+			BaseProgressCallback::SetProgressValue(value);
+			m_dialog.setValue(static_cast<int>(value));
+			QCoreApplication::processEvents();
+		}
+
+		void DisplayError(const char* message) override { m_errors.append(QString::fromUtf8(message)); }
+		void DisplayWarning(const char* message) override { Console.Warning("%s", message); }
+		void DisplayInformation(const char* message) override { Console.WriteLn("%s", message); }
+		void DisplayDebugMessage(const char* message) override { DevCon.WriteLn("%s", message); }
+
+		void ModalError(const char* message) override { DisplayError(message); }
+		bool ModalConfirmation(const char* message) override { return false; }
+		void ModalInformation(const char* message) override { DisplayInformation(message); }
+
+		const QString& getErrors() const { return m_errors; }
+
+	private:
+		QProgressDialog m_dialog;
+		QString m_errors;
+	};
+} // namespace
+
+void MainWindow::compressDiscImage(const QString& path)
+{
+	const bool zso_supported = CsoWriter::IsFormatSupported(CsoWriter::Format::ZSO);
+	QString filter(tr("CSO Images (*.cso)"));
+	if (zso_supported)
+		filter.prepend(tr("ZSO Images (*.zso);;"));
+
+	const QFileInfo fi(path);
+	const QString default_path(fi.dir().filePath(fi.completeBaseName() + (zso_supported ? QStringLiteral(".zso") : QStringLiteral(".cso"))));
+	const QString filename(QFileDialog::getSaveFileName(this, tr("Compress Disc Image"), default_path, filter));
+	if (filename.isEmpty())
+		return;
+
+	const std::string dst_path(filename.toStdString());
+	const std::optional<CsoWriter::Format> format(CsoWriter::GetFormatForPath(dst_path));
+	if (!format.has_value())
+	{
+		QMessageBox::critical(this, tr("Compression Error"),
+			zso_supported ? tr("'%1' must end in .cso or .zso.").arg(filename) : tr("'%1' must end in .cso.").arg(filename));
+		return;
+	}
+
+	DialogProgressCallback progress(this, tr("Compressing Disc Image"));
+	progress.SetCancellable(true);
+	if (!CsoWriter::Convert(path.toStdString(), dst_path, format.value(), &progress))
+	{
+		if (!progress.IsCancelled())
+			QMessageBox::critical(this, tr("Compression Error"), tr("Failed to compress '%1':\n%2").arg(path).arg(progress.getErrors()));
+		return;
+	}
+
+	refreshGameList(false);
+}
+
 void MainWindow::loadSaveStateSlot(s32 slot)
 {
 	if (m_vm_valid)
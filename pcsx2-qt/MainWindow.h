@@ -147,6 +147,7 @@ private:
 	void startGameListEntry(const GameList::Entry* entry, std::optional<s32> save_slot = std::nullopt,
 		std::optional<bool> fast_boot = std::nullopt);
 	void setGameListEntryCoverImage(const GameList::Entry* entry);
+	void compressDiscImage(const QString& path);
 
 	void loadSaveStateSlot(s32 slot);
 	void loadSaveStateFile(const QString& filename, const QString& state_filename);
@@ -20,6 +20,7 @@
 #	undef Yield
 #elif defined(__linux__)
 #	include <libaio.h>
+#	include "Linux/LnxIoUring.h"
 #elif defined(__POSIX__)
 #	include <aio.h>
 #endif
@@ -35,6 +36,8 @@ protected:
 
 	int m_dataoffset;
 	uint m_blocksize;
+	// Only opened to look at the image, see SetProbe()
+	bool m_probe = false;
 
 public:
 	virtual ~AsyncFileReader() {};
@@ -54,6 +57,18 @@ public:
 	virtual void SetBlockSize(uint bytes) {}
 	virtual void SetDataOffset(int bytes) {}
 
+	// Tells the reader it's only opened for a quick look at the image (eg. by the game list), so it
+	// shouldn't start background work which only pays off over a whole session.  Call before Open().
+	void SetProbe(bool probe) { m_probe = probe; }
+
+	// Tells the reader most reads will target this buffer, so it can register it with the OS.
+	// The buffer has to outlive the reader.
+	virtual void RegisterReadBuffer(void* buffer, size_t size) {}
+
+	// Returns a pointer to `count` blocks starting at `sector` if the reader can hand them out without copying.
+	// The pointer is valid until the reader is closed.  Readers which can't do this return nullptr.
+	virtual const u8* GetBlockPointer(uint sector, uint count) { return nullptr; }
+
 	uint GetBlockSize() const { return m_blocksize; }
 
 	const std::string& GetFilename() const
@@ -77,6 +92,10 @@ class FlatFileReader : public AsyncFileReader
 #elif defined(__linux__)
 	int m_fd; // FIXME don't know if overlap as an equivalent on linux
 	io_context_t m_aio_context;
+#ifdef USE_IO_URING
+	// Used instead of m_aio_context when the kernel supports it
+	IoUringQueue m_uring;
+#endif
 #elif defined(__POSIX__)
 	int m_fd; // TODO OSX don't know if overlap as an equivalent on OSX
 	struct aiocb m_aiocb;
@@ -103,6 +122,57 @@ public:
 
 	virtual void SetBlockSize(uint bytes) override { m_blocksize = bytes; }
 	virtual void SetDataOffset(int bytes) override { m_dataoffset = bytes; }
+
+#if defined(__linux__) && defined(USE_IO_URING)
+	virtual void RegisterReadBuffer(void* buffer, size_t size) override { m_uring.RegisterBuffer(buffer, size); }
+#endif
+};
+
+// Maps the whole image into memory, so reads are served straight from the page cache without syscalls.
+// Only suitable for uncompressed images which won't be modified while they're open.
+class MappedFileReader : public AsyncFileReader
+{
+	DeclareNoncopyableObject( MappedFileReader );
+
+#ifdef _WIN32
+	HANDLE m_hFile;
+	HANDLE m_hMapping;
+#else
+	int m_fd;
+#endif
+
+	const u8* m_data;
+	u64 m_size;
+
+	int m_bytesRead;
+
+	// Sector following the previous read, used to detect sequential streaming
+	uint m_nextSector;
+	bool m_sequential;
+
+	void AdviseAccess(uint sector, uint count);
+	int CopyBlocks(void* pBuffer, uint sector, uint count);
+
+public:
+	MappedFileReader();
+	virtual ~MappedFileReader() override;
+
+	virtual bool Open(std::string fileName) override;
+
+	virtual int ReadSync(void* pBuffer, uint sector, uint count) override;
+
+	virtual void BeginRead(void* pBuffer, uint sector, uint count) override;
+	virtual int FinishRead(void) override;
+	virtual void CancelRead(void) override;
+
+	virtual void Close(void) override;
+
+	virtual uint GetBlockCount(void) const override;
+
+	virtual void SetBlockSize(uint bytes) override { m_blocksize = bytes; }
+	virtual void SetDataOffset(int bytes) override { m_dataoffset = bytes; }
+
+	virtual const u8* GetBlockPointer(uint sector, uint count) override;
 };
 
 class MultipartFileReader : public AsyncFileReader
@@ -140,6 +210,8 @@ public:
 
 	virtual void SetBlockSize(uint bytes) override;
 
+	virtual void RegisterReadBuffer(void* buffer, size_t size) override;
+
 	static AsyncFileReader* DetectMultipart(AsyncFileReader* reader);
 };
 
@@ -159,6 +231,10 @@ class BlockdumpFileReader : public AsyncFileReader
 
 	int m_lresult;
 
+#if defined(__linux__) && defined(USE_IO_URING)
+	IoUringQueue m_uring;
+#endif
+
 public:
 	BlockdumpFileReader();
 	virtual ~BlockdumpFileReader() override;
@@ -175,6 +251,10 @@ public:
 
 	virtual uint GetBlockCount(void) const override;
 
+#if defined(__linux__) && defined(USE_IO_URING)
+	virtual void RegisterReadBuffer(void* buffer, size_t size) override { m_uring.RegisterBuffer(buffer, size); }
+#endif
+
 	static bool DetectBlockdump(AsyncFileReader* reader);
 
 	int GetBlockOffset() { return m_blockofs; }
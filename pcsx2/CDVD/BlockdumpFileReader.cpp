@@ -110,6 +110,11 @@ bool BlockdumpFileReader::Open(std::string fileName)
 
 	} while (has == bs);
 
+#if defined(__linux__) && defined(USE_IO_URING)
+	// Blocks are scattered through the dump, so a request becomes one read per block
+	m_uring.Open(fileno(m_file), 16);
+#endif
+
 	return true;
 }
 
@@ -162,20 +167,65 @@ int BlockdumpFileReader::ReadSync(void* pBuffer, uint lsn, uint count)
 
 void BlockdumpFileReader::BeginRead(void* pBuffer, uint sector, uint count)
 {
+#if defined(__linux__) && defined(USE_IO_URING)
+	if (m_uring.IsOpen())
+	{
+		u8* dst = static_cast<u8*>(pBuffer);
+		m_lresult = 0;
+
+		for (; count > 0; count--, sector++, dst += m_blocksize)
+		{
+			int i = 0;
+			while (i < m_dtablesize && m_dtable[i] != sector)
+				i++;
+
+			if (i == m_dtablesize)
+			{
+				Console.WriteLn("Block %u not found in dump", sector);
+				m_lresult = -1;
+				break;
+			}
+
+			if (!m_uring.QueueRead(dst, m_blocksize, BlockDumpHeaderSize + (i * (u64)(m_blocksize + 4)) + 4))
+			{
+				m_lresult = -1;
+				break;
+			}
+		}
+
+		m_uring.Submit();
+		return;
+	}
+#endif
+
 	m_lresult = ReadSync(pBuffer, sector, count);
 }
 
 int BlockdumpFileReader::FinishRead(void)
 {
+#if defined(__linux__) && defined(USE_IO_URING)
+	// Wait even when a block was missing, some reads may already be in flight
+	if (m_uring.IsOpen() && m_uring.WaitAll() < 0)
+		m_lresult = -1;
+#endif
+
 	return m_lresult;
 }
 
 void BlockdumpFileReader::CancelRead(void)
 {
+#if defined(__linux__) && defined(USE_IO_URING)
+	if (m_uring.IsOpen())
+		m_uring.WaitAll();
+#endif
 }
 
 void BlockdumpFileReader::Close(void)
 {
+#if defined(__linux__) && defined(USE_IO_URING)
+	m_uring.Close();
+#endif
+
 	if (m_file)
 	{
 		std::fclose(m_file);
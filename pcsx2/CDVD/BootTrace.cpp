@@ -0,0 +1,175 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "BootTrace.h"
+#include "CDVDaccess.h"
+#include "CDVDisoReader.h"
+#include "Config.h"
+
+#include "common/FileSystem.h"
+#include "common/Path.h"
+#include "common/StringUtil.h"
+#include "common/Timer.h"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+// Keeps a game which streams from the start from producing a huge trace
+static constexpr size_t MAX_RUNS = 16384;
+
+static constexpr u32 TRACE_MAGIC = 0x52544250; // PBTR
+static constexpr u32 TRACE_VERSION = 1;
+
+struct TraceHeader
+{
+	u32 magic;
+	u32 version;
+	u32 runs;
+};
+
+static std::mutex s_mutex;
+static std::vector<BootTrace::Run> s_runs;
+static std::string s_serial;
+static Common::Timer s_timer;
+// Written under s_mutex, read without it so reads after the window don't take the lock
+static std::atomic<bool> s_recording{false};
+
+static std::string GetTracePath(const std::string& serial)
+{
+	return Path::CombineStdString(EmuFolders::Cache, StringUtil::StdStringFromFormat("%s.boottrace", serial.c_str()));
+}
+
+static std::vector<BootTrace::Run> LoadTrace(const std::string& serial)
+{
+	std::vector<BootTrace::Run> runs;
+	std::optional<std::vector<u8>> data = FileSystem::ReadBinaryFile(GetTracePath(serial).c_str());
+	if (!data.has_value() || data->size() < sizeof(TraceHeader))
+		return runs;
+
+	TraceHeader header;
+	std::memcpy(&header, data->data(), sizeof(header));
+	if (header.magic != TRACE_MAGIC || header.version != TRACE_VERSION || header.runs > MAX_RUNS ||
+		data->size() != sizeof(header) + header.runs * sizeof(BootTrace::Run))
+	{
+		Console.Warning("(BootTrace) Ignoring invalid trace for %s", serial.c_str());
+		return runs;
+	}
+
+	runs.resize(header.runs);
+	std::memcpy(runs.data(), data->data() + sizeof(header), header.runs * sizeof(BootTrace::Run));
+	return runs;
+}
+
+static void SaveTrace(const std::string& serial, const std::vector<BootTrace::Run>& runs)
+{
+	const TraceHeader header = {TRACE_MAGIC, TRACE_VERSION, static_cast<u32>(runs.size())};
+	std::vector<u8> data(sizeof(header) + runs.size() * sizeof(BootTrace::Run));
+	std::memcpy(data.data(), &header, sizeof(header));
+	std::memcpy(data.data() + sizeof(header), runs.data(), runs.size() * sizeof(BootTrace::Run));
+
+	if (!FileSystem::WriteBinaryFile(GetTracePath(serial).c_str(), data.data(), data.size()))
+		Console.Warning("(BootTrace) Failed to save trace for %s", serial.c_str());
+	else
+		DevCon.WriteLn("(BootTrace) Saved %zu runs for %s", runs.size(), serial.c_str());
+}
+
+// Call with s_mutex held
+static void FinishRecording()
+{
+	s_recording = false;
+	if (!s_serial.empty() && !s_runs.empty())
+		SaveTrace(s_serial, s_runs);
+	s_runs.clear();
+	s_serial.clear();
+}
+
+void BootTrace::Begin()
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+	s_runs.clear();
+	s_serial.clear();
+
+	// Only images can be prefetched
+	s_recording = EmuConfig.CdvdBootPrefetch && CDVDsys_GetSourceType() == CDVD_SourceType::Iso;
+	s_timer.Reset();
+}
+
+void BootTrace::End()
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+	// A trace cut short by closing the disc early would make the next boot prefetch less than it could
+	s_recording = false;
+	s_runs.clear();
+	s_serial.clear();
+}
+
+void BootTrace::OnRead(u32 lsn)
+{
+	if (!s_recording.load(std::memory_order_relaxed))
+		return;
+
+	std::lock_guard<std::mutex> lock(s_mutex);
+	if (!s_recording.load(std::memory_order_relaxed))
+		return;
+
+	if (s_timer.GetTimeSeconds() >= RECORD_SECONDS)
+	{
+		FinishRecording();
+		return;
+	}
+
+	if (!s_runs.empty())
+	{
+		Run& last = s_runs.back();
+		if (lsn == last.lsn + last.count)
+		{
+			last.count++;
+			return;
+		}
+		// Rereads of what we just recorded don't need prefetching again
+		if (lsn >= last.lsn && lsn < last.lsn + last.count)
+			return;
+	}
+
+	if (s_runs.size() >= MAX_RUNS)
+	{
+		FinishRecording();
+		return;
+	}
+
+	s_runs.push_back({lsn, 1});
+}
+
+void BootTrace::SetSerial(const std::string& serial)
+{
+	std::vector<Run> runs;
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		// Only the first ELF of a boot names the trace, games can load others later
+		if (!s_recording || !s_serial.empty() || serial.empty())
+			return;
+
+		s_serial = serial;
+		runs = LoadTrace(serial);
+	}
+
+	if (runs.empty())
+		return;
+
+	DevCon.WriteLn("(BootTrace) Prefetching %zu runs recorded for %s", runs.size(), serial.c_str());
+	ISOprefetch(std::move(runs));
+}
@@ -0,0 +1,44 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Games read the same sectors in the same order every time they boot.  We record which ones
+// during the first seconds after a disc is opened, save them per serial in the cache folder,
+// and on the next boot of that serial hand them to the ISO reader to prefetch.
+namespace BootTrace
+{
+	// How long after the disc is opened reads are recorded for
+	static constexpr float RECORD_SECONDS = 30.0f;
+
+	struct Run
+	{
+		u32 lsn;
+		u32 count;
+	};
+
+	// Starts recording, call when a disc is opened.
+	void Begin();
+	// Stops recording, saving the trace if the recording window was completed.
+	void End();
+	// Records a sector read by the emulated drive.
+	void OnRead(u32 lsn);
+	// Called when the serial of the booting disc becomes known.  Starts prefetching the trace
+	// saved for it, and the trace being recorded will be saved under it.
+	void SetSerial(const std::string& serial);
+} // namespace BootTrace
@@ -21,7 +21,9 @@
 #include <wx/datetime.h>
 
 #include "common/FileSystem.h"
+#include "common/StringUtil.h"
 
+#include "BootTrace.h"
 #include "CdRom.h"
 #include "CDVD.h"
 #include "CDVD_internal.h"
@@ -445,7 +447,7 @@ s32 cdvdWriteConfig(const u8* config)
 static MutexRecursive Mutex_NewDiskCB;
 
 // Sets ElfCRC to the CRC of the game bound to the CDVD source.
-static __fi ElfObject* loadElf(const wxString filename, bool isPSXElf)
+static __fi ElfObject* loadElf(SectorSource& source, const wxString filename, bool isPSXElf)
 {
 	if (filename.StartsWith(L"host"))
 		return new ElfObject(filename.After(':'), FileSystem::GetPathFileSize(filename.After(':').ToUTF8()), isPSXElf);
@@ -470,11 +472,32 @@ static __fi ElfObject* loadElf(const wxString filename, bool isPSXElf)
 	if (fixedname != filename)
 		Console.WriteLn(Color_Blue, "(LoadELF) Non-conforming version suffix detected and replaced.");
 
-	IsoFSCDVD isofs;
-	IsoFile file(isofs, fixedname);
+	IsoFile file(source, fixedname);
 	return new ElfObject(fixedname, file, isPSXElf);
 }
 
+// Serial from a boot path like cdrom0:\SLUS_123.45;1, empty if it isn't named like that
+static wxString GetElfSerial(const wxString& elfpath)
+{
+	wxString fname = elfpath.AfterLast('\\');
+	if (!fname)
+		fname = elfpath.AfterLast('/');
+	if (!fname)
+		fname = elfpath.AfterLast(':');
+	if (fname.Matches(L"????_???.??*"))
+		return fname(0, 4) + L"-" + fname(5, 3) + fname(9, 2);
+	return wxEmptyString;
+}
+
+// PS1 discs don't all name their executable after the serial, so fall back to a mangled name
+static wxString GetPSXElfSerial(const wxString& elfpath)
+{
+	wxString fname = elfpath.AfterLast('\\').BeforeFirst('_');
+	wxString fname2 = elfpath.AfterLast('_').BeforeFirst('.');
+	wxString fname3 = elfpath.AfterLast('.').BeforeFirst(';');
+	return fname + "-" + fname2 + fname3;
+}
+
 static __fi void _reloadElfInfo(wxString elfpath)
 {
 	// Now's a good time to reload the ELF info...
@@ -484,14 +507,12 @@ static __fi void _reloadElfInfo(wxString elfpath)
 		return;
 	LastELF = elfpath;
 
-	wxString fname = elfpath.AfterLast('\\');
-	if (!fname)
-		fname = elfpath.AfterLast('/');
-	if (!fname)
-		fname = elfpath.AfterLast(':');
-	if (fname.Matches(L"????_???.??*"))
-		DiscSerial = fname(0, 4) + L"-" + fname(5, 3) + fname(9, 2);
-	std::unique_ptr<ElfObject> elfptr(loadElf(elfpath, false));
+	const wxString serial(GetElfSerial(elfpath));
+	if (!serial.empty())
+		DiscSerial = serial;
+	BootTrace::SetSerial(StringUtil::wxStringToUTF8String(DiscSerial));
+	IsoFSCDVD isofs;
+	std::unique_ptr<ElfObject> elfptr(loadElf(isofs, elfpath, false));
 
 
 	elfptr->loadHeaders();
@@ -516,15 +537,13 @@ static __fi void _reloadPSXElfInfo(wxString elfpath)
 	if (elfpath == LastELF)
 		return;
 	LastELF = elfpath;
-	wxString fname = elfpath.AfterLast('\\');
-	if (!fname)
-		fname = elfpath.AfterLast('/');
-	if (!fname)
-		fname = elfpath.AfterLast(':');
-	if (fname.Matches(L"????_???.??*"))
-		DiscSerial = fname(0, 4) + L"-" + fname(5, 3) + fname(9, 2);
+	const wxString serial(GetElfSerial(elfpath));
+	if (!serial.empty())
+		DiscSerial = serial;
+	BootTrace::SetSerial(StringUtil::wxStringToUTF8String(DiscSerial));
 
-	std::unique_ptr<ElfObject> elfptr(loadElf(elfpath, true));
+	IsoFSCDVD isofs;
+	std::unique_ptr<ElfObject> elfptr(loadElf(isofs, elfpath, true));
 
 	ElfCRC = elfptr->getCRC();
 	ElfTextRange = elfptr->getTextRange();
@@ -559,10 +578,7 @@ void cdvdReloadElfInfo(wxString elfoverride)
 			// PCSX2 currently only recognizes *.elf executables in proper PS2 format.
 			// To support different PSX titles in the console title and for savestates, this code bypasses all the detection,
 			// simply using the exe name, stripped of problematic characters.
-			wxString fname = elfpath.AfterLast('\\').BeforeFirst('_');
-			wxString fname2 = elfpath.AfterLast('_').BeforeFirst('.');
-			wxString fname3 = elfpath.AfterLast('.').BeforeFirst(';');
-			DiscSerial = fname + "-" + fname2 + fname3;
+			DiscSerial = GetPSXElfSerial(elfpath);
 			_reloadPSXElfInfo(elfpath);
 			return;
 		}
@@ -591,6 +607,29 @@ void cdvdReloadElfInfo(wxString elfoverride)
 	}
 }
 
+int cdvdGetElfInfo(SectorSource& source, std::string* serial, u32* crc)
+{
+	try
+	{
+		wxString elfpath;
+		const int discType = GetPS2ElfName(source, elfpath);
+		if (discType == 0)
+			return 0;
+
+		const wxString elfserial((discType == 1) ? GetPSXElfSerial(elfpath) : GetElfSerial(elfpath));
+		*serial = StringUtil::wxStringToUTF8String(elfserial);
+
+		std::unique_ptr<ElfObject> elfptr(loadElf(source, elfpath, discType == 1));
+		*crc = elfptr->getCRC();
+		return discType;
+	}
+	catch (Exception::BaseException& e)
+	{
+		Console.Error(L"Failed to load ELF info: %s", WX_STR(e.FormatDiagnosticMessage()));
+		return 0;
+	}
+}
+
 static __fi s32 StrToS32(const wxString& str, int base = 10)
 {
 	long l;
@@ -305,6 +305,9 @@ extern u8 cdvdRead(u8 key);
 extern void cdvdWrite(u8 key, u8 rt);
 
 extern void cdvdReloadElfInfo(wxString elfoverride = wxEmptyString);
+// Reads the serial and CRC of the boot ELF from any disc without touching the emulated drive,
+// returns the same disc type as GetPS2ElfName
+extern int cdvdGetElfInfo(SectorSource& source, std::string* serial, u32* crc);
 extern s32 cdvdCtrlTrayOpen();
 extern s32 cdvdCtrlTrayClose();
 
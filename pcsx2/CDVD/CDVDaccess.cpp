@@ -31,6 +31,7 @@
 
 #include "IsoFS/IsoFS.h"
 #include "IsoFS/IsoFSCDVD.h"
+#include "BootTrace.h"
 #include "CDVDisoReader.h"
 
 #include "common/FileSystem.h"
@@ -76,12 +77,11 @@ static void CheckNullCDVD()
 //////////////////////////////////////////////////////////////////////////////////////////
 // Disk Type detection stuff (from cdvdGigaherz)
 //
-static int CheckDiskTypeFS(int baseType)
+s32 DoCDVDdetectDiskTypeFS(SectorSource& source, s32 baseType)
 {
-	IsoFSCDVD isofs;
 	try
 	{
-		IsoDirectory rootdir(isofs);
+		IsoDirectory rootdir(source);
 
 		try
 		{
@@ -241,7 +241,8 @@ static int FindDiskType(int mType)
 
 	if (dataTracks > 0)
 	{
-		iCDType = CheckDiskTypeFS(iCDType);
+		IsoFSCDVD isofs;
+		iCDType = DoCDVDdetectDiskTypeFS(isofs, iCDType);
 	}
 
 	if (audioTracks > 0)
@@ -381,6 +382,9 @@ bool DoCDVDopen()
 
 	int cdtype = DoCDVDdetectDiskType();
 
+	if (cdtype != CDVD_TYPE_NODISC)
+		BootTrace::Begin();
+
 	if (!EmuConfig.CdvdDumpBlocks || (cdtype == CDVD_TYPE_NODISC))
 	{
 		blockDumpFile.Close();
@@ -450,6 +454,8 @@ void DoCDVDclose()
 	blockDumpFile.Close();
 #endif
 
+	BootTrace::End();
+
 	if (CDVD->close != NULL)
 		CDVD->close();
 
@@ -459,6 +465,7 @@ void DoCDVDclose()
 s32 DoCDVDreadSector(u8* buffer, u32 lsn, int mode)
 {
 	CheckNullCDVD();
+	BootTrace::OnRead(lsn);
 	int ret = CDVD->readSector(buffer, lsn, mode);
 
 	if (ret == 0 && blockDumpFile.IsOpened())
@@ -502,6 +509,7 @@ s32 DoCDVDreadTrack(u32 lsn, int mode)
 
 	//DevCon.Warning("CDVD readTrack(lsn=%d,mode=%d)",params lsn, lastReadSize);
 	lastLSN = lsn;
+	BootTrace::OnRead(lsn);
 	return CDVD->readTrack(lsn, mode);
 }
 
@@ -544,6 +552,7 @@ s32 DoCDVDdetectDiskType()
 void DoCDVDresetDiskTypeCache()
 {
 	diskTypeCached = -1;
+	IsoFSCDVD::ClearDirectoryCache();
 }
 
 ////////////////////////////////////////////////////////
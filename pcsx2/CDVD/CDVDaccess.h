@@ -16,6 +16,8 @@
 #pragma once
 #include <string>
 
+class SectorSource;
+
 typedef struct _cdvdSubQ
 {
 	u8 ctrl : 4;   // control and mode bits
@@ -167,4 +169,6 @@ extern s32 DoCDVDreadSector(u8* buffer, u32 lsn, int mode);
 extern s32 DoCDVDreadTrack(u32 lsn, int mode);
 extern s32 DoCDVDgetBuffer(u8* buffer);
 extern s32 DoCDVDdetectDiskType();
+// Works out the disc type from the filesystem of any disc, doesn't touch the current one
+extern s32 DoCDVDdetectDiskTypeFS(SectorSource& source, s32 baseType);
 extern void DoCDVDresetDiskTypeCache();
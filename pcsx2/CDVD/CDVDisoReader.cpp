@@ -40,6 +40,11 @@ void CALLBACK ISOclose()
 	iso.Close();
 }
 
+void ISOprefetch(std::vector<BootTrace::Run> runs)
+{
+	iso.StartPrefetch(std::move(runs));
+}
+
 s32 CALLBACK ISOopen(const char* pTitle)
 {
 	ISOclose(); // just in case
@@ -21,4 +21,7 @@
 #include "IopCommon.h"
 #include "IsoFileFormats.h"
 
+// Reads the given sectors of the open image in the background, ahead of the emulated drive
+extern void ISOprefetch(std::vector<BootTrace::Run> runs);
+
 #endif
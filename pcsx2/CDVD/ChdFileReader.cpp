@@ -15,6 +15,7 @@
 
 #include "PrecompiledHeader.h"
 #include "ChdFileReader.h"
+#include "ChunksCache.h"
 
 #include "common/FileSystem.h"
 #include "common/StringUtil.h"
@@ -141,13 +142,22 @@ bool ChdFileReader::Open2(std::string fileName)
 	}
 	ChdFile = child;
 
+	m_chain.clear();
+	for (int d = chd_depth; d >= 0; d--)
+		m_chain.push_back(std::move(chds[d]));
+
 	const chd_header* chd_header = chd_get_header(ChdFile);
 	file_size = static_cast<u64>(chd_header->unitbytes) * chd_header->unitcount;
 	hunk_size = chd_header->hunkbytes;
+	hunk_count = chd_header->totalhunks;
 	// CHD likes to use full 2448 byte blocks, but keeps the +24 offset of source ISOs
 	// The rest of PCSX2 likes to use 2448 byte buffers, which can't fit that so trim blocks instead
 	m_internalBlockSize = chd_header->unitbytes;
 
+	std::lock_guard<std::mutex> lock(m_cacheMutex);
+	if (m_cacheSizeMb)
+		m_cache = std::make_unique<ChunksCache>(m_cacheSizeMb, hunk_size);
+
 	return true;
 }
 
@@ -172,18 +182,218 @@ int ChdFileReader::ReadChunk(void* dst, s64 chunkID)
 	if (chunkID < 0)
 		return -1;
 
-	chd_error error = chd_read(ChdFile, chunkID, dst);
+	return ReadHunk(ChdFile, dst, chunkID);
+}
+
+int ChdFileReader::ReadHunk(chd_file* chd, void* dst, s64 hunk)
+{
+	const s64 offset = hunk * hunk_size;
+	{
+		std::unique_lock<std::mutex> lock(m_cacheMutex);
+		if (m_cache)
+		{
+			// No point decoding it twice if the prefetch thread is already on it
+			while (m_prefetching == hunk)
+				m_prefetchDone.wait(lock);
+
+			if (m_cache->Read(dst, offset, hunk_size) == static_cast<int>(hunk_size))
+				return hunk_size;
+
+			if (m_prefetchHunks)
+			{
+				m_prefetchNext = hunk + 1;
+				m_prefetchEnd = std::min<s64>(hunk + 1 + m_prefetchHunks, hunk_count);
+				if (!m_prefetchThread.joinable())
+					StartPrefetch();
+				m_prefetchWork.notify_one();
+			}
+		}
+	}
+
+	chd_error error = chd_read(chd, hunk, dst);
 	if (error != CHDERR_NONE)
 	{
-		Console.Error(L"CDVD: chd_read returned error: %s", chd_error_string(error));
+		Console.Error("CDVD: chd_read returned error: %s", chd_error_string(error));
 		return 0;
 	}
 
+	std::lock_guard<std::mutex> lock(m_cacheMutex);
+	if (m_cache)
+		m_cache->Store(dst, offset, hunk_size, hunk_size);
+
 	return hunk_size;
 }
 
+void ChdFileReader::SetHunkCache(uint megabytes, u32 prefetchHunks)
+{
+	std::lock_guard<std::mutex> lock(m_cacheMutex);
+	m_prefetchHunks = prefetchHunks;
+	if (!prefetchHunks)
+		m_prefetchEnd = m_prefetchNext;
+
+	if (megabytes == m_cacheSizeMb && (m_cache || !ChdFile))
+		return;
+
+	m_cacheSizeMb = megabytes;
+	if (ChdFile && megabytes)
+		m_cache = std::make_unique<ChunksCache>(megabytes, hunk_size);
+	else
+		m_cache.reset();
+}
+
+// Call with m_cacheMutex held
+void ChdFileReader::StartPrefetch()
+{
+	// Opening the chain can take a while, so let the thread do it
+	m_prefetchQuit = false;
+	m_prefetchThread = std::thread([this]() {
+		std::vector<std::FILE*> files;
+		chd_file* chd = OpenChain(files);
+		PrefetchThread(chd, std::move(files));
+	});
+}
+
+void ChdFileReader::StopPrefetch()
+{
+	if (!m_prefetchThread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_cacheMutex);
+		m_prefetchQuit = true;
+		m_prefetchWork.notify_one();
+	}
+	m_prefetchThread.join();
+	m_prefetchNext = 0;
+	m_prefetchEnd = 0;
+}
+
+void ChdFileReader::PrefetchThread(chd_file* chd, std::vector<std::FILE*> files)
+{
+	Threading::SetNameOfCurrentThread("CHD Prefetch");
+
+	std::unique_ptr<u8[]> buffer = std::make_unique<u8[]>(hunk_size);
+	std::unique_lock<std::mutex> lock(m_cacheMutex);
+	for (;;)
+	{
+		m_prefetchWork.wait(lock, [this]() { return m_prefetchQuit || m_prefetchNext < m_prefetchEnd; });
+		if (m_prefetchQuit)
+			break;
+
+		// The queue is still drained without a handle, so the reads don't keep waking us
+		const s64 hunk = m_prefetchNext++;
+		if (!chd || !m_cache || m_cache->Contains(hunk * hunk_size))
+			continue;
+
+		m_prefetching = hunk;
+		lock.unlock();
+		const chd_error error = chd_read(chd, hunk, buffer.get());
+		lock.lock();
+		m_prefetching = -1;
+		m_prefetchDone.notify_all();
+
+		if (error != CHDERR_NONE)
+		{
+			// The read thread will report it if the hunk is actually needed
+			m_prefetchEnd = m_prefetchNext;
+			continue;
+		}
+
+		if (m_cache)
+		{
+			m_cache->Store(buffer.get(), hunk * hunk_size, hunk_size, hunk_size);
+			m_prefetched++;
+		}
+	}
+	lock.unlock();
+
+	if (chd)
+		chd_close(chd);
+	for (std::FILE* fp : files)
+		std::fclose(fp);
+}
+
+chd_file* ChdFileReader::OpenChain(std::vector<std::FILE*>& files)
+{
+	chd_file* parent = nullptr;
+	for (const std::string& filename : m_chain)
+	{
+		std::FILE* fp = nullptr;
+		chd_file* child = nullptr;
+		const chd_error error = chd_open_wrapper(filename.c_str(), &fp, CHD_OPEN_READ, parent, &child);
+		if (error != CHDERR_NONE)
+		{
+			Console.Error("CDVD: chd_open return error: %s", chd_error_string(error));
+			if (parent)
+				chd_close(parent);
+			return nullptr;
+		}
+
+		files.push_back(fp);
+		parent = child;
+	}
+	return parent;
+}
+
+u32 ChdFileReader::CreateWorkerContexts(u32 count)
+{
+	if (!ChdFile)
+		return 0;
+
+	for (u32 i = 0; i < count; i++)
+	{
+		WorkerContext ctx;
+		ctx.chd = OpenChain(ctx.files);
+		if (!ctx.chd)
+		{
+			for (std::FILE* fp : ctx.files)
+				std::fclose(fp);
+			break;
+		}
+		m_contexts.push_back(std::move(ctx));
+	}
+
+	return static_cast<u32>(m_contexts.size());
+}
+
+void ChdFileReader::DestroyWorkerContexts()
+{
+	for (WorkerContext& ctx : m_contexts)
+	{
+		chd_close(ctx.chd);
+		for (std::FILE* fp : ctx.files)
+			std::fclose(fp);
+	}
+	m_contexts.clear();
+}
+
+int ChdFileReader::ReadChunkWorker(void* dst, s64 chunkID, u32 worker)
+{
+	if (chunkID < 0 || worker >= m_contexts.size())
+		return -1;
+
+	return ReadHunk(m_contexts[worker].chd, dst, chunkID);
+}
+
 void ChdFileReader::Close2()
 {
+	StopPrefetch();
+
+	{
+		std::lock_guard<std::mutex> lock(m_cacheMutex);
+		if (m_cache)
+		{
+			const ChunksCache::Stats& stats = m_cache->GetStats();
+			if (stats.hits || stats.misses)
+			{
+				DevCon.WriteLn("CDVD: CHD hunk cache %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64 " evictions, %" PRIu64 " hunks prefetched",
+					stats.hits, stats.misses, stats.evictions, m_prefetched);
+			}
+			m_cache.reset();
+		}
+		m_prefetched = 0;
+	}
+
 	if (ChdFile != NULL)
 	{
 		chd_close(ChdFile);
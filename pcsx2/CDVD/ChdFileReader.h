@@ -16,8 +16,14 @@
 #pragma once
 #include "ThreadedFileReader.h"
 #include "libchdr/chd.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
+class ChunksCache;
+
 class ChdFileReader : public ThreadedFileReader
 {
 	DeclareNoncopyableObject(ChdFileReader);
@@ -35,9 +41,55 @@ public:
 	uint GetBlockCount(void) const override;
 	ChdFileReader(void);
 
+	u32 CreateWorkerContexts(u32 count) override;
+	void DestroyWorkerContexts() override;
+	int ReadChunkWorker(void* dst, s64 chunkID, u32 worker) override;
+
+	/// Keep up to `megabytes` of decoded hunks, so going back and forth between areas of the disc doesn't decode them again
+	/// After a miss, `prefetchHunks` following hunks are decoded into the cache in the background
+	void SetHunkCache(uint megabytes, u32 prefetchHunks);
+
 private:
+	/// Read a hunk through the cache, decoding it with `chd` on a miss
+	int ReadHunk(chd_file* chd, void* dst, s64 hunk);
+	void StartPrefetch();
+	void StopPrefetch();
+	void PrefetchThread(chd_file* chd, std::vector<std::FILE*> files);
+
+	/// Open another instance of the parent chain found by Open2
+	chd_file* OpenChain(std::vector<std::FILE*>& files);
+
+	/// libchdr handles aren't thread safe, so each pool worker gets its own
+	struct WorkerContext
+	{
+		chd_file* chd;
+		std::vector<std::FILE*> files;
+	};
+
 	chd_file* ChdFile;
 	u64 file_size;
 	u32 hunk_size;
+	u32 hunk_count;
 	std::vector<std::FILE*> m_files;
+	/// CHD files making up the image, outermost parent first
+	std::vector<std::string> m_chain;
+	std::vector<WorkerContext> m_contexts;
+
+	uint m_cacheSizeMb = 0;
+	u32 m_prefetchHunks = 0;
+	/// Protects everything below
+	std::mutex m_cacheMutex;
+	std::unique_ptr<ChunksCache> m_cache;
+	/// Hunks [m_prefetchNext, m_prefetchEnd) are waiting to be prefetched
+	s64 m_prefetchNext = 0;
+	s64 m_prefetchEnd = 0;
+	/// Hunk the prefetch thread is decoding, -1 if none
+	s64 m_prefetching = -1;
+	u64 m_prefetched = 0;
+	bool m_prefetchQuit = false;
+	/// Signalled when hunks are queued for prefetch
+	std::condition_variable m_prefetchWork;
+	/// Signalled when the prefetch thread finishes a hunk
+	std::condition_variable m_prefetchDone;
+	std::thread m_prefetchThread;
 };
@@ -16,43 +16,146 @@
 #include "PrecompiledHeader.h"
 #include "ChunksCache.h"
 
+ChunksCache::ChunksCache(uint initialLimitMb, uint chunkSize)
+	: m_slab(nullptr)
+	, m_head(INVALID_NODE)
+	, m_tail(INVALID_NODE)
+	, m_chunkSize(chunkSize)
+	, m_capacity(0)
+	, m_stats{}
+{
+	SetLimit(initialLimitMb);
+}
+
+ChunksCache::~ChunksCache()
+{
+	Clear();
+}
+
 void ChunksCache::SetLimit(uint megabytes)
 {
-	m_limit = (s64)megabytes * 1024 * 1024;
-	MatchLimit();
+	Clear();
+	m_capacity = static_cast<u32>(((s64)megabytes * 1024 * 1024) / m_chunkSize);
 }
 
-void ChunksCache::MatchLimit(bool removeAll)
+void ChunksCache::Clear()
 {
-	std::list<CacheEntry*>::reverse_iterator rit;
-	while (!m_entries.empty() && (removeAll || m_size > m_limit))
+	if (m_slab)
 	{
-		rit = m_entries.rbegin();
-		m_size -= (*rit)->size;
-		delete (*rit);
-		m_entries.pop_back();
+		free(m_slab);
+		m_slab = nullptr;
 	}
+	m_entries.clear();
+	m_freeNodes.clear();
+	m_index.clear();
+	m_head = INVALID_NODE;
+	m_tail = INVALID_NODE;
+}
+
+void ChunksCache::Unlink(u32 node)
+{
+	CacheEntry& e = m_entries[node];
+	if (e.prev != INVALID_NODE)
+		m_entries[e.prev].next = e.next;
+	else
+		m_head = e.next;
+	if (e.next != INVALID_NODE)
+		m_entries[e.next].prev = e.prev;
+	else
+		m_tail = e.prev;
 }
 
-void ChunksCache::Take(void* pMallocedSrc, s64 offset, int length, int coverage)
+void ChunksCache::PushFront(u32 node)
 {
-	m_entries.push_front(new CacheEntry(pMallocedSrc, offset, length, coverage));
-	m_size += length;
-	MatchLimit();
+	CacheEntry& e = m_entries[node];
+	e.prev = INVALID_NODE;
+	e.next = m_head;
+	if (m_head != INVALID_NODE)
+		m_entries[m_head].prev = node;
+	m_head = node;
+	if (m_tail == INVALID_NODE)
+		m_tail = node;
+}
+
+u32 ChunksCache::AllocateNode()
+{
+	if (!m_slab)
+	{
+		// Pages only get committed as chunks are stored, so a large limit costs nothing up front
+		m_slab = static_cast<u8*>(malloc(static_cast<size_t>(m_capacity) * m_chunkSize));
+		if (!m_slab)
+			return INVALID_NODE;
+		m_entries.resize(m_capacity);
+		m_freeNodes.reserve(m_capacity);
+		for (u32 i = m_capacity; i > 0; i--)
+			m_freeNodes.push_back(i - 1);
+		m_index.reserve(m_capacity);
+	}
+
+	if (!m_freeNodes.empty())
+	{
+		u32 node = m_freeNodes.back();
+		m_freeNodes.pop_back();
+		return node;
+	}
+
+	// Full, recycle the least recently used entry
+	u32 node = m_tail;
+	Unlink(node);
+	m_index.erase(m_entries[node].offset);
+	m_stats.evictions++;
+	return node;
+}
+
+void ChunksCache::Store(const void* pSrc, s64 offset, int length, int coverage)
+{
+	if (!m_capacity || offset % m_chunkSize != 0 || length > static_cast<int>(m_chunkSize))
+		return;
+
+	u32 node;
+	auto it = m_index.find(offset);
+	if (it != m_index.end())
+	{
+		node = it->second;
+		Unlink(node);
+	}
+	else
+	{
+		node = AllocateNode();
+		if (node == INVALID_NODE)
+			return;
+		m_index.emplace(offset, node);
+	}
+
+	CacheEntry& e = m_entries[node];
+	e.offset = offset;
+	e.size = length;
+	e.coverage = coverage;
+	if (length > 0)
+		memcpy(EntryData(node), pSrc, length);
+	PushFront(node);
 }
 
 // By design, succeed only if the entire request is in a single cached chunk
 int ChunksCache::Read(void* pDest, s64 offset, int length)
 {
-	for (auto it = m_entries.begin(); it != m_entries.end(); it++)
+	auto it = m_index.find(offset - offset % m_chunkSize);
+	if (it != m_index.end())
 	{
-		CacheEntry* e = *it;
-		if (e && offset >= e->offset && (offset + length) <= (e->offset + e->coverage))
+		u32 node = it->second;
+		CacheEntry& e = m_entries[node];
+		if ((offset + length) <= (e.offset + e.coverage))
 		{
-			if (it != m_entries.begin())
-				m_entries.splice(m_entries.begin(), m_entries, it); // Move to top (MRU)
-			return CopyAvailable(e->data, e->offset, e->size, pDest, offset, length);
+			if (node != m_head)
+			{
+				// Move to top (MRU)
+				Unlink(node);
+				PushFront(node);
+			}
+			m_stats.hits++;
+			return CopyAvailable(EntryData(node), e.offset, e.size, pDest, offset, length);
 		}
 	}
+	m_stats.misses++;
 	return -1;
 }
@@ -17,21 +17,35 @@
 
 #include "zlib_indexed.h"
 
+#include <unordered_map>
+#include <vector>
+
 #define CLAMP(val, minval, maxval) (std::min(maxval, std::max(minval, val)))
 
+// LRU cache of fixed size chunks, indexed by their offset.
+// Chunk data lives in a single slab allocated on first use, so storing a chunk never hits malloc.
 class ChunksCache
 {
 public:
-	ChunksCache(uint initialLimitMb)
-		: m_entries(0)
-		, m_size(0)
-		, m_limit(initialLimitMb * 1024 * 1024){};
-	~ChunksCache() { Clear(); };
+	struct Stats
+	{
+		u64 hits;
+		u64 misses;
+		u64 evictions;
+	};
+
+	ChunksCache(uint initialLimitMb, uint chunkSize);
+	~ChunksCache();
 	void SetLimit(uint megabytes);
-	void Clear() { MatchLimit(true); };
+	void Clear();
 
-	void Take(void* pMallocedSrc, s64 offset, int length, int coverage);
+	// Copies the chunk at offset (a multiple of the chunk size) into the cache
+	void Store(const void* pSrc, s64 offset, int length, int coverage);
 	int Read(void* pDest, s64 offset, int length);
+	// Doesn't count as a use of the chunk
+	bool Contains(s64 offset) const { return m_index.find(offset - offset % m_chunkSize) != m_index.end(); }
+
+	const Stats& GetStats() const { return m_stats; }
 
 	static int CopyAvailable(void* pSrc, s64 srcOffset, int srcSize,
 							 void* pDst, s64 dstOffset, int maxCopySize)
@@ -42,31 +56,34 @@ public:
 	};
 
 private:
-	class CacheEntry
-	{
-	public:
-		CacheEntry(void* pMallocedSrc, s64 offset, int length, int coverage)
-			: data(pMallocedSrc)
-			, offset(offset)
-			, coverage(coverage)
-			, size(length){};
-
-		~CacheEntry()
-		{
-			if (data)
-				free(data);
-		};
+	static constexpr u32 INVALID_NODE = 0xFFFFFFFFu;
 
-		void* data;
+	struct CacheEntry
+	{
 		s64 offset;
 		int coverage;
 		int size;
+		// Neighbours in the LRU list, most recently used first
+		u32 prev;
+		u32 next;
 	};
 
-	std::list<CacheEntry*> m_entries;
-	void MatchLimit(bool removeAll = false);
-	s64 m_size;
-	s64 m_limit;
+	void* EntryData(u32 node) const { return m_slab + static_cast<size_t>(node) * m_chunkSize; }
+	void Unlink(u32 node);
+	void PushFront(u32 node);
+	// Takes a free node, evicting the least recently used entry if there isn't one
+	u32 AllocateNode();
+
+	u8* m_slab;
+	std::vector<CacheEntry> m_entries;
+	std::vector<u32> m_freeNodes;
+	std::unordered_map<s64, u32> m_index;
+	u32 m_head;
+	u32 m_tail;
+
+	uint m_chunkSize;
+	u32 m_capacity;
+	Stats m_stats;
 };
 
 #undef CLAMP
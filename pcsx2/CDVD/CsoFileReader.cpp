@@ -24,26 +24,16 @@
 #else
 #include <zlib/zlib.h>
 #endif
-
-// Implementation of CSO compressed ISO reading, based on:
-// https://github.com/unknownbrackets/maxcso/blob/master/README_CSO.md
-struct CsoHeader
-{
-	u8 magic[4];
-	u32 header_size;
-	u64 total_bytes;
-	u32 frame_size;
-	u8 ver;
-	u8 align;
-	u8 reserved[2];
-};
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
 
 static const u32 CSO_READ_BUFFER_SIZE = 256 * 1024;
 
 bool CsoFileReader::CanHandle(const std::string& fileName, const std::string& displayName)
 {
 	bool supported = false;
-	if (StringUtil::EndsWith(displayName, ".cso"))
+	if (StringUtil::EndsWith(displayName, ".cso") || StringUtil::EndsWith(displayName, ".zso"))
 	{
 		FILE* fp = FileSystem::OpenCFile(fileName.c_str(), "rb");
 		CsoHeader hdr;
@@ -61,11 +51,19 @@ bool CsoFileReader::CanHandle(const std::string& fileName, const std::string& di
 
 bool CsoFileReader::ValidateHeader(const CsoHeader& hdr)
 {
-	if (hdr.magic[0] != 'C' || hdr.magic[1] != 'I' || hdr.magic[2] != 'S' || hdr.magic[3] != 'O')
+	const bool zso = IsZsoHeader(hdr);
+	if (!zso && (hdr.magic[0] != 'C' || hdr.magic[1] != 'I' || hdr.magic[2] != 'S' || hdr.magic[3] != 'O'))
 	{
 		// Invalid magic, definitely a bad file.
 		return false;
 	}
+#ifndef USE_LZ4
+	if (zso)
+	{
+		Console.Error("This build of PCSX2 was compiled without ZSO support.");
+		return false;
+	}
+#endif
 	if (hdr.ver > 1)
 	{
 		Console.Error("Only CSOv1 files are supported.");
@@ -86,6 +84,11 @@ bool CsoFileReader::ValidateHeader(const CsoHeader& hdr)
 	return true;
 }
 
+bool CsoFileReader::IsZsoHeader(const CsoHeader& hdr)
+{
+	return hdr.magic[0] == 'Z' && hdr.magic[1] == 'I' && hdr.magic[2] == 'S' && hdr.magic[3] == 'O';
+}
+
 bool CsoFileReader::Open2(std::string fileName)
 {
 	Close2();
@@ -133,6 +136,7 @@ bool CsoFileReader::ReadFileHeader()
 	// This is the index alignment (index values need shifting by this amount.)
 	m_indexShift = hdr.align;
 	m_totalSize = hdr.total_bytes;
+	m_lz4 = IsZsoHeader(hdr);
 
 	return true;
 }
@@ -142,15 +146,7 @@ bool CsoFileReader::InitializeBuffers()
 	// Round up, since part of a frame requires a full frame.
 	u32 numFrames = (u32)((m_totalSize + m_frameSize - 1) / m_frameSize);
 
-	// We might read a bit of alignment too, so be prepared.
-	if (m_frameSize + (1 << m_indexShift) < CSO_READ_BUFFER_SIZE)
-	{
-		m_readBuffer = new u8[CSO_READ_BUFFER_SIZE];
-	}
-	else
-	{
-		m_readBuffer = new u8[m_frameSize + (1 << m_indexShift)];
-	}
+	m_readBuffer = new u8[GetReadBufferSize()];
 
 	const u32 indexSize = numFrames + 1;
 	m_index = new u32[indexSize];
@@ -160,6 +156,10 @@ bool CsoFileReader::InitializeBuffers()
 		return false;
 	}
 
+	// LZ4 decompression is stateless, only CSO needs a stream.
+	if (m_lz4)
+		return true;
+
 	m_z_stream = new z_stream;
 	m_z_stream->zalloc = Z_NULL;
 	m_z_stream->zfree = Z_NULL;
@@ -173,6 +173,60 @@ bool CsoFileReader::InitializeBuffers()
 	return true;
 }
 
+u32 CsoFileReader::GetReadBufferSize() const
+{
+	// We might read a bit of alignment too, so be prepared.
+	return std::max<u32>(m_frameSize + (1 << m_indexShift), CSO_READ_BUFFER_SIZE);
+}
+
+u32 CsoFileReader::CreateWorkerContexts(u32 count)
+{
+	if (!m_src)
+		return 0;
+
+	for (u32 i = 0; i < count; i++)
+	{
+		// Each worker seeks independently, so it needs its own handle
+		FILE* src = FileSystem::OpenCFile(m_filename.c_str(), "rb");
+		if (!src)
+			break;
+
+		z_stream* z = nullptr;
+		if (!m_lz4)
+		{
+			z = new z_stream;
+			z->zalloc = Z_NULL;
+			z->zfree = Z_NULL;
+			z->opaque = Z_NULL;
+			if (inflateInit2(z, -15) != Z_OK)
+			{
+				delete z;
+				fclose(src);
+				break;
+			}
+		}
+
+		m_contexts.push_back({src, z, new u8[GetReadBufferSize()]});
+	}
+
+	return static_cast<u32>(m_contexts.size());
+}
+
+void CsoFileReader::DestroyWorkerContexts()
+{
+	for (WorkerContext& ctx : m_contexts)
+	{
+		fclose(ctx.src);
+		if (ctx.z)
+		{
+			inflateEnd(ctx.z);
+			delete ctx.z;
+		}
+		delete[] ctx.readBuffer;
+	}
+	m_contexts.clear();
+}
+
 void CsoFileReader::Close2()
 {
 	m_filename.clear();
@@ -185,6 +239,7 @@ void CsoFileReader::Close2()
 	if (m_z_stream)
 	{
 		inflateEnd(m_z_stream);
+		delete m_z_stream;
 		m_z_stream = NULL;
 	}
 
@@ -198,6 +253,7 @@ void CsoFileReader::Close2()
 		delete[] m_index;
 		m_index = NULL;
 	}
+	m_lz4 = false;
 }
 
 ThreadedFileReader::Chunk CsoFileReader::ChunkForOffset(u64 offset)
@@ -221,10 +277,22 @@ int CsoFileReader::ReadChunk(void *dst, s64 chunkID)
 	if (chunkID < 0)
 		return -1;
 
-	const u32 frame = chunkID;
+	return ReadFrame(dst, chunkID, m_src, m_z_stream, m_readBuffer);
+}
+
+int CsoFileReader::ReadChunkWorker(void* dst, s64 chunkID, u32 worker)
+{
+	if (chunkID < 0 || worker >= m_contexts.size())
+		return -1;
 
+	WorkerContext& ctx = m_contexts[worker];
+	return ReadFrame(dst, chunkID, ctx.src, ctx.z, ctx.readBuffer);
+}
+
+int CsoFileReader::ReadFrame(void* dst, u32 frame, FILE* src, z_stream* z, u8* readBuffer)
+{
 	// Grab the index data for the frame we're about to read.
-	const bool compressed = (m_index[frame + 0] & 0x80000000) == 0;
+	const bool compressed = (m_index[frame + 0] & CSO_INDEX_UNCOMPRESSED) == 0;
 	const u32 index0 = m_index[frame + 0] & 0x7FFFFFFF;
 	const u32 index1 = m_index[frame + 1] & 0x7FFFFFFF;
 
@@ -235,35 +303,50 @@ int CsoFileReader::ReadChunk(void *dst, s64 chunkID)
 	if (!compressed)
 	{
 		// Just read directly, easy.
-		if (FileSystem::FSeek64(m_src, frameRawPos, SEEK_SET) != 0)
+		if (FileSystem::FSeek64(src, frameRawPos, SEEK_SET) != 0)
 		{
 			Console.Error("Unable to seek to uncompressed CSO data.");
 			return 0;
 		}
-		return fread(dst, 1, m_frameSize, m_src);
+		return fread(dst, 1, m_frameSize, src);
 	}
 	else
 	{
-		if (FileSystem::FSeek64(m_src, frameRawPos, SEEK_SET) != 0)
+		if (FileSystem::FSeek64(src, frameRawPos, SEEK_SET) != 0)
 		{
 			Console.Error("Unable to seek to compressed CSO data.");
 			return 0;
 		}
 		// This might be less bytes than frameRawSize in case of padding on the last frame.
 		// This is because the index positions must be aligned.
-		const u32 readRawBytes = fread(m_readBuffer, 1, frameRawSize, m_src);
+		const u32 readRawBytes = fread(readBuffer, 1, frameRawSize, src);
+
+#ifdef USE_LZ4
+		if (m_lz4)
+		{
+			// The padding isn't part of the block, so stop once the frame is complete.
+			const int size = LZ4_decompress_safe_partial(reinterpret_cast<const char*>(readBuffer),
+				static_cast<char*>(dst), readRawBytes, m_frameSize, m_frameSize);
+			if (size != static_cast<int>(m_frameSize))
+			{
+				Console.Error("Unable to decompress ZSO frame using LZ4.");
+				return 0;
+			}
+			return m_frameSize;
+		}
+#endif
 
-		m_z_stream->next_in = m_readBuffer;
-		m_z_stream->avail_in = readRawBytes;
-		m_z_stream->next_out = static_cast<Bytef*>(dst);
-		m_z_stream->avail_out = m_frameSize;
+		z->next_in = readBuffer;
+		z->avail_in = readRawBytes;
+		z->next_out = static_cast<Bytef*>(dst);
+		z->avail_out = m_frameSize;
 
-		int status = inflate(m_z_stream, Z_FINISH);
-		bool success = status == Z_STREAM_END && m_z_stream->total_out == m_frameSize;
+		int status = inflate(z, Z_FINISH);
+		bool success = status == Z_STREAM_END && z->total_out == m_frameSize;
 
 		if (!success)
 			Console.Error("Unable to decompress CSO frame using zlib.");
-		inflateReset(m_z_stream);
+		inflateReset(z);
 
 		return success ? m_frameSize : 0;
 	}
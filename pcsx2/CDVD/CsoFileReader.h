@@ -26,10 +26,27 @@
 
 #include "ThreadedFileReader.h"
 #include "ChunksCache.h"
+#include <vector>
 
-struct CsoHeader;
 typedef struct z_stream_s z_stream;
 
+// Implementation of CSO compressed ISO reading, based on:
+// https://github.com/unknownbrackets/maxcso/blob/master/README_CSO.md
+// ZSO images share the layout, but have LZ4 compressed frames.
+struct CsoHeader
+{
+	u8 magic[4];
+	u32 header_size;
+	u64 total_bytes;
+	u32 frame_size;
+	u8 ver;
+	u8 align;
+	u8 reserved[2];
+};
+
+// Set in an index entry when the frame is stored uncompressed.
+static const u32 CSO_INDEX_UNCOMPRESSED = 0x80000000;
+
 static const uint CSO_CHUNKCACHE_SIZE_MB = 200;
 
 class CsoFileReader : public ThreadedFileReader
@@ -46,6 +63,7 @@ public:
 		, m_totalSize(0)
 		, m_src(0)
 		, m_z_stream(0)
+		, m_lz4(false)
 	{
 		m_blocksize = 2048;
 	};
@@ -60,6 +78,10 @@ public:
 
 	void Close2(void) override;
 
+	u32 CreateWorkerContexts(u32 count) override;
+	void DestroyWorkerContexts() override;
+	int ReadChunkWorker(void* dst, s64 chunkID, u32 worker) override;
+
 	uint GetBlockCount(void) const override
 	{
 		return (m_totalSize - m_dataoffset) / m_blocksize;
@@ -67,12 +89,23 @@ public:
 
 private:
 	static bool ValidateHeader(const CsoHeader& hdr);
+	static bool IsZsoHeader(const CsoHeader& hdr);
 	bool ReadFileHeader();
 	bool InitializeBuffers();
+	u32 GetReadBufferSize() const;
+	int ReadFrame(void* dst, u32 frame, FILE* src, z_stream* z, u8* readBuffer);
 	int ReadFromFrame(u8* dest, u64 pos, int maxBytes);
 	bool DecompressFrame(Bytef* dst, u32 frame, u32 readBufferSize);
 	bool DecompressFrame(u32 frame, u32 readBufferSize);
 
+	/// File handle and inflate state for one decompression pool worker
+	struct WorkerContext
+	{
+		FILE* src;
+		z_stream* z;
+		u8* readBuffer;
+	};
+
 	u32 m_frameSize;
 	u8 m_frameShift;
 	u8 m_indexShift;
@@ -82,4 +115,7 @@ private:
 	// The actual source cso file handle.
 	FILE* m_src;
 	z_stream* m_z_stream;
+	// ZSO, frames are LZ4 blocks instead of raw deflate.
+	bool m_lz4;
+	std::vector<WorkerContext> m_contexts;
 };
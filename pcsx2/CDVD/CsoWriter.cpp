@@ -0,0 +1,309 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "CsoWriter.h"
+#include "CsoFileReader.h"
+
+#include "common/FileSystem.h"
+#include "common/StringUtil.h"
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#ifdef __POSIX__
+#include <zlib.h>
+#else
+#include <zlib/zlib.h>
+#endif
+#ifdef USE_LZ4
+#include <lz4hc.h>
+#endif
+
+// Frames handed to the workers at once.  Starting the workers costs nothing next to
+// compressing this many, and it keeps the memory used small.
+static constexpr u32 BATCH_FRAMES = 4096;
+
+namespace
+{
+	class FrameCompressor
+	{
+		DeclareNoncopyableObject(FrameCompressor);
+
+	public:
+		FrameCompressor() = default;
+
+		~FrameCompressor()
+		{
+			if (m_zInitialized)
+				deflateEnd(&m_z);
+		}
+
+		bool Init(CsoWriter::Format format)
+		{
+			m_format = format;
+			if (format == CsoWriter::Format::ZSO)
+			{
+#ifdef USE_LZ4
+				// Kept in u64s, the state has to be pointer aligned
+				m_lz4State.resize((LZ4_sizeofStateHC() + sizeof(u64) - 1) / sizeof(u64));
+				return true;
+#else
+				return false;
+#endif
+			}
+
+			std::memset(&m_z, 0, sizeof(m_z));
+			m_zInitialized = deflateInit2(&m_z, Z_BEST_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+			return m_zInitialized;
+		}
+
+		// Returns the compressed size, or 0 if the frame doesn't fit in capacity.
+		u32 Compress(const u8* src, u32 size, u8* dst, u32 capacity)
+		{
+#ifdef USE_LZ4
+			if (m_format == CsoWriter::Format::ZSO)
+			{
+				const int res = LZ4_compress_HC_extStateHC(m_lz4State.data(), reinterpret_cast<const char*>(src),
+					reinterpret_cast<char*>(dst), size, capacity, LZ4HC_CLEVEL_DEFAULT);
+				return res > 0 ? static_cast<u32>(res) : 0;
+			}
+#endif
+
+			deflateReset(&m_z);
+			m_z.next_in = const_cast<Bytef*>(src);
+			m_z.avail_in = size;
+			m_z.next_out = dst;
+			m_z.avail_out = capacity;
+			if (deflate(&m_z, Z_FINISH) != Z_STREAM_END)
+				return 0;
+
+			return capacity - m_z.avail_out;
+		}
+
+	private:
+		CsoWriter::Format m_format = CsoWriter::Format::CSO;
+		z_stream m_z;
+		bool m_zInitialized = false;
+		std::vector<u64> m_lz4State;
+	};
+} // namespace
+
+bool CsoWriter::IsFormatSupported(Format format)
+{
+#ifdef USE_LZ4
+	return true;
+#else
+	return format != Format::ZSO;
+#endif
+}
+
+std::optional<CsoWriter::Format> CsoWriter::GetFormatForPath(const std::string& path)
+{
+	if (StringUtil::EndsWithNoCase(path, ".cso"))
+		return Format::CSO;
+	if (StringUtil::EndsWithNoCase(path, ".zso"))
+		return Format::ZSO;
+	return std::nullopt;
+}
+
+static bool WritePadding(std::FILE* fp, u64& pos, u32 alignment)
+{
+	static constexpr u8 zeros[64] = {};
+	u32 padding = static_cast<u32>((alignment - (pos & (alignment - 1))) & (alignment - 1));
+	pos += padding;
+	while (padding > 0)
+	{
+		const u32 count = std::min<u32>(padding, sizeof(zeros));
+		if (std::fwrite(zeros, 1, count, fp) != count)
+			return false;
+		padding -= count;
+	}
+	return true;
+}
+
+static bool CompressImage(std::FILE* src, std::FILE* dst, u64 totalBytes, CsoWriter::Format format, ProgressCallback* progress)
+{
+	const u32 frameSize = CsoWriter::DEFAULT_FRAME_SIZE;
+	const u32 numFrames = static_cast<u32>((totalBytes + frameSize - 1) / frameSize);
+	const u64 dataStart = sizeof(CsoHeader) + (numFrames + 1) * sizeof(u32);
+
+	// Index entries are 31 bits, so large images need their frames aligned to fit.
+	u8 align = 0;
+	while (((dataStart + static_cast<u64>(numFrames) * (frameSize + (1u << align))) >> align) >= CSO_INDEX_UNCOMPRESSED)
+		align++;
+
+	CsoHeader header = {};
+	std::memcpy(header.magic, (format == CsoWriter::Format::ZSO) ? "ZISO" : "CISO", sizeof(header.magic));
+	header.header_size = sizeof(CsoHeader);
+	header.total_bytes = totalBytes;
+	header.frame_size = frameSize;
+	header.ver = 1;
+	header.align = align;
+
+	// The index is written again once the frame positions are known.
+	std::vector<u32> index(numFrames + 1);
+	if (std::fwrite(&header, sizeof(header), 1, dst) != 1 ||
+		std::fwrite(index.data(), sizeof(u32), index.size(), dst) != index.size())
+	{
+		progress->DisplayFormattedError("Failed to write header.");
+		return false;
+	}
+
+	const u32 numWorkers = std::max(std::thread::hardware_concurrency(), 1u);
+	std::vector<std::unique_ptr<FrameCompressor>> compressors;
+	for (u32 i = 0; i < numWorkers; i++)
+	{
+		compressors.push_back(std::make_unique<FrameCompressor>());
+		if (!compressors.back()->Init(format))
+		{
+			progress->DisplayFormattedError("Failed to initialize compressor.");
+			return false;
+		}
+	}
+
+	std::vector<u8> input(static_cast<size_t>(BATCH_FRAMES) * frameSize);
+	std::vector<u8> output(static_cast<size_t>(BATCH_FRAMES) * frameSize);
+	std::vector<u32> outputSizes(BATCH_FRAMES);
+
+	const u32 numBatches = (numFrames + BATCH_FRAMES - 1) / BATCH_FRAMES;
+	progress->SetProgressRange(numBatches);
+	progress->SetProgressValue(0);
+
+	u64 pos = dataStart;
+	for (u32 batch = 0; batch < numBatches; batch++)
+	{
+		if (progress->IsCancelled())
+			return false;
+
+		const u32 firstFrame = batch * BATCH_FRAMES;
+		const u32 batchFrames = std::min(BATCH_FRAMES, numFrames - firstFrame);
+		const size_t batchBytes = static_cast<size_t>(batchFrames) * frameSize;
+
+		// The last frame is zero filled up to the frame size, readers always decompress whole frames.
+		const size_t bytesRead = std::fread(input.data(), 1, batchBytes, src);
+		if (bytesRead != std::min<u64>(batchBytes, totalBytes - static_cast<u64>(firstFrame) * frameSize))
+		{
+			progress->DisplayFormattedError("Failed to read source image.");
+			return false;
+		}
+		std::memset(input.data() + bytesRead, 0, batchBytes - bytesRead);
+
+		std::atomic<u32> nextFrame{0};
+		auto worker = [&](FrameCompressor* compressor) {
+			for (u32 i = nextFrame++; i < batchFrames; i = nextFrame++)
+			{
+				const size_t offset = static_cast<size_t>(i) * frameSize;
+				// Frames which don't get smaller are stored as they are
+				outputSizes[i] = compressor->Compress(&input[offset], frameSize, &output[offset], frameSize - 1);
+			}
+		};
+
+		const u32 batchWorkers = std::min(numWorkers, batchFrames);
+		std::vector<std::thread> threads;
+		for (u32 i = 1; i < batchWorkers; i++)
+			threads.emplace_back(worker, compressors[i].get());
+		worker(compressors[0].get());
+		for (std::thread& thread : threads)
+			thread.join();
+
+		for (u32 i = 0; i < batchFrames; i++)
+		{
+			if (!WritePadding(dst, pos, 1u << align))
+			{
+				progress->DisplayFormattedError("Failed to write frame data.");
+				return false;
+			}
+
+			const size_t offset = static_cast<size_t>(i) * frameSize;
+			const bool compressed = outputSizes[i] != 0;
+			const u8* data = compressed ? &output[offset] : &input[offset];
+			const u32 size = compressed ? outputSizes[i] : frameSize;
+
+			index[firstFrame + i] = static_cast<u32>(pos >> align) | (compressed ? 0 : CSO_INDEX_UNCOMPRESSED);
+			if (std::fwrite(data, 1, size, dst) != size)
+			{
+				progress->DisplayFormattedError("Failed to write frame data.");
+				return false;
+			}
+			pos += size;
+		}
+
+		progress->SetProgressValue(batch + 1);
+	}
+
+	// The final entry marks the end of the last frame.
+	if (!WritePadding(dst, pos, 1u << align))
+	{
+		progress->DisplayFormattedError("Failed to write frame data.");
+		return false;
+	}
+	index[numFrames] = static_cast<u32>(pos >> align);
+
+	if (FileSystem::FSeek64(dst, sizeof(CsoHeader), SEEK_SET) != 0 ||
+		std::fwrite(index.data(), sizeof(u32), index.size(), dst) != index.size())
+	{
+		progress->DisplayFormattedError("Failed to write index.");
+		return false;
+	}
+
+	return true;
+}
+
+bool CsoWriter::Convert(const std::string& srcPath, const std::string& dstPath, Format format, ProgressCallback* progress)
+{
+	if (!IsFormatSupported(format))
+	{
+		progress->DisplayFormattedError("This build of PCSX2 was compiled without ZSO support.");
+		return false;
+	}
+
+	auto src = FileSystem::OpenManagedCFile(srcPath.c_str(), "rb");
+	if (!src)
+	{
+		progress->DisplayFormattedError("Failed to open '%s'.", srcPath.c_str());
+		return false;
+	}
+
+	const s64 totalBytes = FileSystem::FSize64(src.get());
+	if (totalBytes <= 0)
+	{
+		progress->DisplayFormattedError("'%s' is empty.", srcPath.c_str());
+		return false;
+	}
+
+	auto dst = FileSystem::OpenManagedCFile(dstPath.c_str(), "wb");
+	if (!dst)
+	{
+		progress->DisplayFormattedError("Failed to create '%s'.", dstPath.c_str());
+		return false;
+	}
+
+	progress->SetFormattedStatusText("Compressing '%s'...", srcPath.c_str());
+	const bool result = CompressImage(src.get(), dst.get(), static_cast<u64>(totalBytes), format, progress);
+
+	// Flush before reporting success, a full disk may only show up here
+	if (!result || std::fflush(dst.get()) != 0)
+	{
+		dst.reset();
+		FileSystem::DeleteFilePath(dstPath.c_str());
+		return false;
+	}
+
+	return true;
+}
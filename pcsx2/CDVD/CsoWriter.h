@@ -0,0 +1,43 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/ProgressCallback.h"
+#include <optional>
+#include <string>
+
+// Compresses uncompressed ISO images into the formats CsoFileReader reads.  Frames are
+// compressed in parallel, one worker per hardware thread, and written out in order.
+namespace CsoWriter
+{
+	enum class Format
+	{
+		CSO, // Raw deflate frames, readable by everything which reads CSO.
+		ZSO, // LZ4 frames, several times cheaper to decompress than CSO.
+	};
+
+	static constexpr u32 DEFAULT_FRAME_SIZE = 2048;
+
+	// ZSO needs PCSX2 to be built with LZ4.
+	bool IsFormatSupported(Format format);
+
+	// Picks the format from the extension of the path, .cso or .zso in any case.
+	// Returns nothing for any other extension.
+	std::optional<Format> GetFormatForPath(const std::string& path);
+
+	bool Convert(const std::string& srcPath, const std::string& dstPath, Format format,
+		ProgressCallback* progress = ProgressCallback::NullProgressCallback);
+} // namespace CsoWriter
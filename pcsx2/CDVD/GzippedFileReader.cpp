@@ -16,6 +16,7 @@
 #include "PrecompiledHeader.h"
 #include <wx/stdpaths.h>
 #include <fstream>
+#include <map>
 #include "common/FileSystem.h"
 #include "common/StringUtil.h"
 #include "Config.h"
@@ -23,8 +24,6 @@
 #include "GzippedFileReader.h"
 #include "zlib_indexed.h"
 
-#define CLAMP(val, minval, maxval) (std::min(maxval, std::max(minval, val)))
-
 #define GZIP_ID "PCSX2.index.gzip.v1|"
 #define GZIP_ID_LEN (sizeof(GZIP_ID) - 1) /* sizeof includes the \0 terminator */
 
@@ -72,7 +71,7 @@ static Access* ReadIndexFromFile(const char* filename)
 	return index;
 }
 
-static void WriteIndexToFile(Access* index, const char* filename)
+static void WriteIndexToFile(const Access* index, const char* filename)
 {
 	if (FileSystem::FileExists(filename))
 	{
@@ -86,10 +85,10 @@ static void WriteIndexToFile(Access* index, const char* filename)
 
 	bool success = (std::fwrite(GZIP_ID, GZIP_ID_LEN, 1, fp.get()) == 1);
 
-	Point* tmp = index->list;
-	index->list = 0; // current pointer is useless on disk, normalize it as 0.
-	std::fwrite((char*)index, sizeof(Access), 1, fp.get());
-	index->list = tmp;
+	// Other readers may be using the index, so normalize the pointer in a copy
+	Access header = *index;
+	header.list = 0; // current pointer is useless on disk, normalize it as 0.
+	std::fwrite((char*)&header, sizeof(Access), 1, fp.get());
 
 	success = success && (std::fwrite((char*)index->list, sizeof(Point) * index->have, 1, fp.get()) == 1);
 
@@ -184,334 +183,457 @@ static std::string iso2indexname(const std::string& isoname)
 	return StringUtil::wxStringToUTF8String(ApplyTemplate(L"gzip index", appRoot, EmuConfig.GzipIsoIndexTemplate, isoname, false));
 }
 
-GzippedFileReader::GzippedFileReader(void)
-	: mBytesRead(0)
-	, m_pIndex(0)
-	, m_zstates(0)
-	, m_src(0)
-	, m_cache(GZFILE_CACHE_SIZE_MB)
+// Building an index means decompressing the whole file, but the block count is needed as soon as
+// the file is opened.  The gzip trailer has the size modulo 4GB, and the ISO volume descriptor has
+// it in sectors, so if the two agree we know the size without waiting for the index.
+// Returns -1 if the size can't be worked out that way.
+static s64 GuessUncompressedSize(const std::string& filename)
 {
-	m_blocksize = 2048;
-	AsyncPrefetchReset();
-};
+	auto fp = FileSystem::OpenManagedCFile(filename.c_str(), "rb");
+	if (!fp)
+		return -1;
 
-void GzippedFileReader::InitZstates()
-{
-	if (m_zstates)
+	u8 magic[2];
+	u8 trailer[4];
+	if (std::fread(magic, sizeof(magic), 1, fp.get()) != 1 || magic[0] != 0x1f || magic[1] != 0x8b ||
+		FileSystem::FSeek64(fp.get(), -static_cast<s64>(sizeof(trailer)), SEEK_END) != 0 ||
+		std::fread(trailer, sizeof(trailer), 1, fp.get()) != 1 || FileSystem::FSeek64(fp.get(), 0, SEEK_SET) != 0)
 	{
-		delete[] m_zstates;
-		m_zstates = 0;
+		return -1;
 	}
-	if (!m_pIndex)
-		return;
+	const u32 isize = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | (static_cast<u32>(trailer[3]) << 24);
 
-	// having another extra element helps avoiding logic for last (so 2+ instead of 1+)
-	int size = 2 + m_pIndex->uncompressed_size / m_pIndex->span;
-	m_zstates = new Czstate[size]();
-}
+	// The same layouts InputIsoFile::Detect() tries, the volume descriptor is in sector 16
+	struct Layout
+	{
+		u32 blocksize;
+		s32 offset;
+		s32 blockofs;
+	};
+	static constexpr Layout layouts[] = {
+		{2048, 0, 24}, {2336, 0, 16}, {2352, 0, 0}, {2448, 0, 0},
+		{2048, 150 * 2048, 24}, {2352, 150 * 2048, 0}, {2448, 150 * 2048, 0},
+		{2048, -8, 24}, {2352, -8, 0}, {2448, -8, 0}};
+	static constexpr u32 HEAD_SIZE = 150 * 2048 + 17 * 2448;
+
+	std::vector<u8> head(HEAD_SIZE);
+	std::vector<u8> input(CHUNK);
+	z_stream strm = {};
+	if (inflateInit2(&strm, 47) != Z_OK)
+		return -1;
+	strm.next_out = head.data();
+	strm.avail_out = HEAD_SIZE;
+	int ret = Z_OK;
+	while (ret == Z_OK && strm.avail_out > 0)
+	{
+		if (strm.avail_in == 0)
+		{
+			strm.avail_in = static_cast<uInt>(std::fread(input.data(), 1, input.size(), fp.get()));
+			strm.next_in = input.data();
+			if (strm.avail_in == 0)
+				break;
+		}
+		ret = inflate(&strm, Z_NO_FLUSH);
+	}
+	const u32 headSize = HEAD_SIZE - strm.avail_out;
+	inflateEnd(&strm);
 
-#ifndef _WIN32
-void GzippedFileReader::AsyncPrefetchReset(){};
-void GzippedFileReader::AsyncPrefetchOpen(){};
-void GzippedFileReader::AsyncPrefetchClose(){};
-void GzippedFileReader::AsyncPrefetchChunk(s64 dummy){};
-void GzippedFileReader::AsyncPrefetchCancel(){};
-#else
-// AsyncPrefetch works as follows:
-// ater extracting a chunk from the compressed file, ask the OS to asynchronously
-// read the next chunk from the file, and then completely ignore the result and
-// cancel the async read before the next extract. the next extract then reads the
-// data from the disk buf if it's overlapping/contained within the chunk we've
-// asked the OS to prefetch, then the OS is likely to already have it cached.
-// This procedure is frequently able to overcome seek time due to fragmentation of the
-// compressed file on disk without any meaningful penalty.
-// This system is only enabled for win32 where we have this async read request.
-void GzippedFileReader::AsyncPrefetchReset()
-{
-	hOverlappedFile = INVALID_HANDLE_VALUE;
-	asyncInProgress = false;
+	for (const Layout& layout : layouts)
+	{
+		const s64 pvd = 16 * static_cast<s64>(layout.blocksize) + layout.offset + 24 - layout.blockofs;
+		if (pvd < 0 || pvd + 88 > headSize || std::memcmp(&head[pvd + 1], "CD001", 5) != 0)
+			continue;
+
+		u32 volumeBlocks;
+		std::memcpy(&volumeBlocks, &head[pvd + 80], sizeof(volumeBlocks));
+		const s64 size = static_cast<s64>(volumeBlocks) * layout.blocksize + layout.offset;
+		if (size > 0 && static_cast<u32>(size) == isize)
+			return size;
+	}
+
+	return -1;
 }
 
-void GzippedFileReader::AsyncPrefetchOpen()
+struct GzippedFileReader::SharedIndex
 {
-	hOverlappedFile = CreateFile(
-		StringUtil::UTF8StringToWideString(m_filename).c_str(),
-		GENERIC_READ,
-		FILE_SHARE_READ,
-		NULL,
-		OPEN_EXISTING,
-		FILE_FLAG_SEQUENTIAL_SCAN | FILE_FLAG_OVERLAPPED,
-		NULL);
+	shared_access access;
+	// Set once the index is complete (or failed), protected by access.lock
+	bool done = false;
+	// Set once LoadIndex() has filled this in, protected by access.lock
+	bool ready = false;
+	// Set if LoadIndex() failed, or only indexed the start of the file for a probe
+	bool failed = false;
+	bool headOnly = false;
+	s64 uncompressedSize = 0;
+	std::thread thread;
+
+	~SharedIndex()
+	{
+		if (thread.joinable())
+		{
+			{
+				std::lock_guard<std::mutex> lock(access.lock);
+				access.cancel = true;
+			}
+			thread.join();
+		}
+		free_index(access.index);
+	}
 };
 
-void GzippedFileReader::AsyncPrefetchClose()
+void GzippedFileReader::BuildIndexThread(SharedIndex* shared, std::string fileName, std::string indexFile)
 {
-	AsyncPrefetchCancel();
+	Threading::SetNameOfCurrentThread("Gzip Indexer");
 
-	if (hOverlappedFile != INVALID_HANDLE_VALUE)
-		CloseHandle(hOverlappedFile);
+	Access* index = nullptr;
+	int len = Z_ERRNO;
+	if (FILE* infile = FileSystem::OpenCFile(fileName.c_str(), "rb"))
+	{
+		len = build_index(infile, GZFILE_SPAN_DEFAULT, &index, &shared->access);
+		fclose(infile);
+	}
 
-	AsyncPrefetchReset();
-};
+	bool cancelled;
+	{
+		std::lock_guard<std::mutex> lock(shared->access.lock);
+		shared->done = true;
+		cancelled = shared->access.cancel;
+	}
+	shared->access.cond.notify_all();
 
-void GzippedFileReader::AsyncPrefetchChunk(s64 start)
-{
-	if (hOverlappedFile == INVALID_HANDLE_VALUE || asyncInProgress)
+	if (len < 0)
 	{
-		Console.Warning(L"Unexpected file handle or progress state. Aborting prefetch.");
+		// Closing the file before we finished isn't an error, the next open carries on from scratch
+		if (!cancelled)
+			Console.Error("ERROR (%d): index could not be generated for file '%s'", len, fileName.c_str());
 		return;
 	}
 
-	LARGE_INTEGER offset;
-	offset.QuadPart = start;
-
-	DWORD bytesToRead = GZFILE_READ_CHUNK_SIZE;
-
-	ZeroMemory(&asyncOperationContext, sizeof(asyncOperationContext));
-	asyncOperationContext.hEvent = 0;
-	asyncOperationContext.Offset = offset.LowPart;
-	asyncOperationContext.OffsetHigh = offset.HighPart;
-
-	ReadFile(hOverlappedFile, mDummyAsyncPrefetchTarget, bytesToRead, NULL, &asyncOperationContext);
-	asyncInProgress = true;
-};
+	if (index->uncompressed_size != shared->uncompressedSize)
+		Console.Error("gunzip: '%s' is %" PRId64 " bytes, not the %" PRId64 " bytes its header promised",
+			fileName.c_str(), index->uncompressed_size, shared->uncompressedSize);
+	else
+		WriteIndexToFile(index, indexFile.c_str());
+}
 
-void GzippedFileReader::AsyncPrefetchCancel()
+std::shared_ptr<GzippedFileReader::SharedIndex> GzippedFileReader::AcquireIndex(const std::string& fileName, bool probe)
 {
-	if (!asyncInProgress)
-		return;
+	static std::mutex s_indexesMutex;
+	static std::map<std::string, std::weak_ptr<SharedIndex>> s_indexes;
 
-	if (!CancelIo(hOverlappedFile))
+	while (true)
 	{
-		Console.Warning("canceling gz prefetch failed. following prefetching will not work.");
-		return;
-	}
+		// Only the map is protected, the index is loaded outside the lock so opening one file never waits on another
+		std::shared_ptr<SharedIndex> shared;
+		bool owner = false;
+		{
+			std::lock_guard<std::mutex> lock(s_indexesMutex);
+			for (auto it = s_indexes.begin(); it != s_indexes.end();)
+				it = it->second.expired() ? s_indexes.erase(it) : std::next(it);
+
+			// Other readers of the file (eg. the boot prefetch) share the index, and any build in progress
+			if (auto it = s_indexes.find(fileName); it != s_indexes.end())
+				shared = it->second.lock();
+			if (!shared)
+			{
+				shared = std::make_shared<SharedIndex>();
+				s_indexes[fileName] = shared;
+				owner = true;
+			}
+		}
 
-	asyncInProgress = false;
-};
-#endif /* _WIN32 */
+		if (owner)
+		{
+			LoadIndex(shared.get(), fileName, probe);
+
+			// Failures get another go on the next open, and a probe's partial index is no use to anyone else
+			if (shared->failed || shared->headOnly)
+			{
+				std::lock_guard<std::mutex> lock(s_indexesMutex);
+				if (auto it = s_indexes.find(fileName); it != s_indexes.end() && it->second.lock() == shared)
+					s_indexes.erase(it);
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(shared->access.lock);
+				shared->ready = true;
+			}
+			shared->access.cond.notify_all();
+		}
+		else
+		{
+			std::unique_lock<std::mutex> lock(shared->access.lock);
+			shared->access.cond.wait(lock, [&shared]() { return shared->ready; });
+		}
 
-// TODO: do better than just checking existance and extension
-bool GzippedFileReader::CanHandle(const std::string& fileName, const std::string& displayName)
-{
-	return StringUtil::EndsWith(fileName, ".gz");
+		if (shared->failed)
+			return nullptr;
+
+		// A probe got there first with a partial index, build a proper one
+		if (shared->headOnly && !probe)
+			continue;
+
+		return shared;
+	}
 }
 
-bool GzippedFileReader::OkIndex()
+void GzippedFileReader::LoadIndex(SharedIndex* shared, const std::string& fileName, bool probe)
 {
-	if (m_pIndex)
-		return true;
+	shared->failed = true;
 
-	// Try to read index from disk
-	const std::string indexfile(iso2indexname(m_filename));
+	const std::string indexfile(iso2indexname(fileName));
 	if (indexfile.empty())
-		return false; // iso2indexname(...) will print errors if it can't apply the template
+		return; // iso2indexname(...) will print errors if it can't apply the template
 
-	if (FileSystem::FileExists(indexfile.c_str()) && (m_pIndex = ReadIndexFromFile(indexfile.c_str())))
+	// Try to read index from disk
+	Access* index;
+	if (FileSystem::FileExists(indexfile.c_str()) && (index = ReadIndexFromFile(indexfile.c_str())))
 	{
 		Console.WriteLn(Color_Green, "OK: Gzip quick access index read from disk: '%s'", indexfile.c_str());
-		if (m_pIndex->span != GZFILE_SPAN_DEFAULT)
+		if (index->span != GZFILE_SPAN_DEFAULT)
 		{
 			Console.Warning("Note: This index has %1.1f MB intervals, while the current default for new indexes is %1.1f MB.",
-							(float)m_pIndex->span / 1024 / 1024, (float)GZFILE_SPAN_DEFAULT / 1024 / 1024);
+							(float)index->span / 1024 / 1024, (float)GZFILE_SPAN_DEFAULT / 1024 / 1024);
 			Console.Warning("It will work fine, but if you want to generate a new index with default intervals, delete this index file.");
 			Console.Warning("(smaller intervals mean bigger index file and quicker but more frequent decompressions)");
 		}
-		InitZstates();
-		return true;
+		shared->access.index = index;
+		shared->access.scanned = index->uncompressed_size;
+		shared->uncompressedSize = index->uncompressed_size;
+		shared->done = true;
 	}
-
-	// No valid index file. Generate an index
-	Console.Warning("This may take a while (but only once). Scanning compressed file to generate a quick access index...");
-
-	Access* index;
-	FILE* infile = FileSystem::OpenCFile(m_filename.c_str(), "rb");
-	int len = build_index(infile, GZFILE_SPAN_DEFAULT, &index);
-	printf("\n"); // build_index prints progress without \n's
-	fclose(infile);
-
-	if (len >= 0)
+	else if ((shared->uncompressedSize = GuessUncompressedSize(fileName)) > 0)
 	{
-		m_pIndex = index;
-		WriteIndexToFile((Access*)m_pIndex, indexfile.c_str());
+		if (probe)
+		{
+			// A probe only reads a few sectors, so rather than indexing the whole file, reads inflate from the start
+			FILE* infile = FileSystem::OpenCFile(fileName.c_str(), "rb");
+			if (!infile)
+				return;
+			const int len = build_index(infile, GZFILE_SPAN_DEFAULT, &index, nullptr, 0);
+			fclose(infile);
+			if (len <= 0)
+				return;
+
+			shared->access.index = index;
+			shared->done = true;
+			shared->headOnly = true;
+		}
+		else
+		{
+			// Reads can use the access points as they're found, so the game doesn't have to wait for the whole file
+			Console.WriteLn("gunzip: Building a quick access index in the background for '%s'", fileName.c_str());
+			shared->thread = std::thread(&GzippedFileReader::BuildIndexThread, shared, fileName, indexfile);
+		}
 	}
 	else
 	{
-		Console.Error("ERROR (%d): index could not be generated for file '%s'", len, m_filename.c_str());
-		free_index(index);
-		InitZstates();
-		return false;
+		// No valid index file, and we need the size up front. Generate an index
+		Console.Warning("This may take a while (but only once). Scanning compressed file to generate a quick access index...");
+
+		FILE* infile = FileSystem::OpenCFile(fileName.c_str(), "rb");
+		if (!infile)
+			return;
+		const int len = build_index(infile, GZFILE_SPAN_DEFAULT, &index);
+		printf("\n"); // build_index prints progress without \n's
+		fclose(infile);
+
+		if (len < 0)
+		{
+			Console.Error("ERROR (%d): index could not be generated for file '%s'", len, fileName.c_str());
+			return;
+		}
+
+		WriteIndexToFile(index, indexfile.c_str());
+		shared->access.index = index;
+		shared->access.scanned = index->uncompressed_size;
+		shared->uncompressedSize = index->uncompressed_size;
+		shared->done = true;
 	}
 
-	InitZstates();
-	return true;
+	shared->failed = false;
+}
+
+GzippedFileReader::GzippedFileReader(void)
+	: m_uncompressedSize(0)
+	, m_cache(GZFILE_CACHE_SIZE_MB, GZFILE_READ_CHUNK_SIZE)
+{
+	m_blocksize = 2048;
+};
+
+// TODO: do better than just checking existance and extension
+bool GzippedFileReader::CanHandle(const std::string& fileName, const std::string& displayName)
+{
+	return StringUtil::EndsWith(fileName, ".gz");
 }
 
-bool GzippedFileReader::Open(std::string fileName)
+bool GzippedFileReader::Open2(std::string fileName)
 {
-	Close();
+	Close2();
 	m_filename = std::move(fileName);
-	if (!(m_src = FileSystem::OpenCFile(m_filename.c_str(), "rb")) || !OkIndex())
+	m_index = AcquireIndex(m_filename, m_probe);
+	if (!m_index || !(m_context = CreateContext()))
 	{
-		Close();
+		Close2();
 		return false;
-	};
+	}
 
-	AsyncPrefetchOpen();
+	m_uncompressedSize = m_index->uncompressedSize;
 	return true;
 };
 
-void GzippedFileReader::BeginRead(void* pBuffer, uint sector, uint count)
+std::unique_ptr<GzippedFileReader::Context> GzippedFileReader::CreateContext() const
 {
-	// No a-sync support yet, implement as sync
-	mBytesRead = ReadSync(pBuffer, sector, count);
-	return;
-};
+	// Each context seeks independently, so it needs its own handle
+	FILE* src = FileSystem::OpenCFile(m_filename.c_str(), "rb");
+	if (!src)
+		return nullptr;
+
+	std::unique_ptr<Context> ctx = std::make_unique<Context>();
+	ctx->src = src;
+	return ctx;
+}
 
-int GzippedFileReader::FinishRead(void)
+u32 GzippedFileReader::CreateWorkerContexts(u32 count)
 {
-	int res = mBytesRead;
-	mBytesRead = -1;
-	return res;
-};
+	if (!m_context)
+		return 0;
 
-#define PTT clock_t
-#define NOW() (clock() / (CLOCKS_PER_SEC / 1000))
+	for (u32 i = 0; i < count; i++)
+	{
+		std::unique_ptr<Context> ctx = CreateContext();
+		if (!ctx)
+			break;
+		m_contexts.push_back(std::move(ctx));
+	}
+
+	return static_cast<u32>(m_contexts.size());
+}
 
-int GzippedFileReader::ReadSync(void* pBuffer, uint sector, uint count)
+void GzippedFileReader::DestroyWorkerContexts()
 {
-	s64 offset = (s64)sector * m_blocksize + m_dataoffset;
-	int bytesToRead = count * m_blocksize;
-	int res = _ReadSync(pBuffer, offset, bytesToRead);
-	if (res < 0)
-		Console.Error(L"Error: iso-gzip read unsuccessful.");
-	return res;
+	for (std::unique_ptr<Context>& ctx : m_contexts)
+		fclose(ctx->src);
+	m_contexts.clear();
 }
 
-// If we have a valid and adequate zstate for this span, use it, else, use the index
-s64 GzippedFileReader::GetOptimalExtractionStart(s64 offset)
+ThreadedFileReader::Chunk GzippedFileReader::ChunkForOffset(u64 offset)
 {
-	int span = m_pIndex->span;
-	Czstate& cstate = m_zstates[offset / span];
-	s64 stateOffset = cstate.state.isValid ? cstate.state.out_offset : 0;
-	if (stateOffset && stateOffset <= offset)
-		return stateOffset; // state is faster than indexed
-
-	// If span is not exact multiples of GZFILE_READ_CHUNK_SIZE (because it was configured badly),
-	// we fallback to always GZFILE_READ_CHUNK_SIZE boundaries
-	if (span % GZFILE_READ_CHUNK_SIZE)
-		return offset / GZFILE_READ_CHUNK_SIZE * GZFILE_READ_CHUNK_SIZE;
-
-	return span * (offset / span); // index direct access boundaries
+	Chunk chunk = {0};
+	if (offset >= static_cast<u64>(m_uncompressedSize))
+	{
+		chunk.chunkID = -1;
+	}
+	else
+	{
+		chunk.chunkID = offset / GZFILE_READ_CHUNK_SIZE;
+		chunk.offset = chunk.chunkID * GZFILE_READ_CHUNK_SIZE;
+		chunk.length = static_cast<u32>(std::min<u64>(GZFILE_READ_CHUNK_SIZE, m_uncompressedSize - chunk.offset));
+	}
+	return chunk;
 }
 
-int GzippedFileReader::_ReadSync(void* pBuffer, s64 offset, uint bytesToRead)
+int GzippedFileReader::ReadChunk(void* dst, s64 chunkID)
 {
-	if (!OkIndex())
+	if (chunkID < 0)
 		return -1;
 
-	// Without all the caching, chunking and states, this would be enough:
-	// return extract(m_src, m_pIndex, offset, (unsigned char*)pBuffer, bytesToRead);
+	return ReadChunkWithContext(dst, chunkID, *m_context);
+}
 
-	// Split request to GZFILE_READ_CHUNK_SIZE chunks at GZFILE_READ_CHUNK_SIZE boundaries
-	uint maxInChunk = GZFILE_READ_CHUNK_SIZE - offset % GZFILE_READ_CHUNK_SIZE;
-	if (bytesToRead > maxInChunk)
-	{
-		int first = _ReadSync(pBuffer, offset, maxInChunk);
-		if (first != (int)maxInChunk)
-			return first; // EOF or failure
+int GzippedFileReader::ReadChunkWorker(void* dst, s64 chunkID, u32 worker)
+{
+	if (chunkID < 0 || worker >= m_contexts.size())
+		return -1;
 
-		int rest = _ReadSync((char*)pBuffer + maxInChunk, offset + maxInChunk, bytesToRead - maxInChunk);
-		if (rest < 0)
-			return rest;
+	return ReadChunkWithContext(dst, chunkID, *m_contexts[worker]);
+}
 
-		return first + rest;
-	}
+bool GzippedFileReader::GetAccessPoint(s64 offset, Point* point)
+{
+	shared_access& access = m_index->access;
+	std::unique_lock<std::mutex> lock(access.lock);
+	// Access points before what's been scanned won't change any more
+	access.cond.wait(lock, [this, &access, offset]() { return m_index->done || access.scanned > offset; });
+	if (!access.index || access.index->have == 0)
+		return false;
 
-	// From here onwards it's guarenteed that the request is inside a single GZFILE_READ_CHUNK_SIZE boundaries
+	const Point* first = access.index->list;
+	const Point* last = first + access.index->have;
+	const Point* here = std::upper_bound(first, last, offset, [](s64 value, const Point& pt) { return value < pt.out; });
+	std::memcpy(point, (here == first) ? first : here - 1, sizeof(Point));
+	return true;
+}
 
-	int res = m_cache.Read(pBuffer, offset, bytesToRead);
-	if (res >= 0)
-		return res;
+#define PTT clock_t
+#define NOW() (clock() / (CLOCKS_PER_SEC / 1000))
+
+int GzippedFileReader::ReadChunkWithContext(void* dst, s64 chunkID, Context& ctx)
+{
+	const s64 offset = chunkID * GZFILE_READ_CHUNK_SIZE;
+	const int size = static_cast<int>(std::min<s64>(GZFILE_READ_CHUNK_SIZE, m_uncompressedSize - offset));
+	if (size <= 0)
+		return -1;
 
-	// Not available from cache. Decompress from optimal starting
-	// point in GZFILE_READ_CHUNK_SIZE chunks and cache each chunk.
-	PTT s = NOW();
-	s64 extractOffset = GetOptimalExtractionStart(offset); // guaranteed in GZFILE_READ_CHUNK_SIZE boundaries
-	int size = offset + maxInChunk - extractOffset;
-	unsigned char* extracted = (unsigned char*)malloc(size);
-
-	int span = m_pIndex->span;
-	int spanix = extractOffset / span;
-	AsyncPrefetchCancel();
-	res = extract(m_src, m_pIndex, extractOffset, extracted, size, &(m_zstates[spanix].state));
-	if (res < 0)
 	{
-		free(extracted);
-		return res;
+		std::lock_guard<std::mutex> lock(m_cacheMutex);
+		const int res = m_cache.Read(dst, offset, size);
+		if (res >= 0)
+			return res;
 	}
-	AsyncPrefetchChunk(getInOffset(&(m_zstates[spanix].state)));
 
-	int copied = ChunksCache::CopyAvailable(extracted, extractOffset, res, pBuffer, offset, bytesToRead);
+	// Carry on from the end of the last chunk if that's where we are, else start at the nearest access point
+	PTT s = NOW();
+	Zstate& state = ctx.zstate.state;
+	if (!state.isValid || state.out_offset != offset)
+	{
+		if (!GetAccessPoint(offset, &ctx.point))
+			return -1;
+	}
 
-	if (m_zstates[spanix].state.isValid && (extractOffset + res) / span != offset / span)
+	Access index = {};
+	index.have = 1;
+	index.size = 1;
+	index.list = &ctx.point;
+	index.span = GZFILE_READ_CHUNK_SIZE;
+	index.uncompressed_size = m_uncompressedSize;
+	const int res = extract(ctx.src, &index, offset, static_cast<unsigned char*>(dst), size, &state);
+	if (res < 0)
 	{
-		// The state no longer matches this span.
-		// move the state to the appropriate span because it will be faster than using the index
-		int targetix = (extractOffset + res) / span;
-		m_zstates[targetix].Kill();
-		// We have elements for the entire file, and another one.
-		m_zstates[targetix].state.in_offset = m_zstates[spanix].state.in_offset;
-		m_zstates[targetix].state.isValid = m_zstates[spanix].state.isValid;
-		m_zstates[targetix].state.out_offset = m_zstates[spanix].state.out_offset;
-		inflateCopy(&m_zstates[targetix].state.strm, &m_zstates[spanix].state.strm);
-
-		m_zstates[spanix].Kill();
+		Console.Error("Error: iso-gzip read unsuccessful.");
+		return res;
 	}
 
-	if (size <= GZFILE_READ_CHUNK_SIZE)
-		m_cache.Take(extracted, extractOffset, res, size);
-	else
-	{ // split into cacheable chunks
-		for (int i = 0; i < size; i += GZFILE_READ_CHUNK_SIZE)
-		{
-			int available = CLAMP(res - i, 0, GZFILE_READ_CHUNK_SIZE);
-			void* chunk = available ? malloc(available) : 0;
-			if (available)
-				memcpy(chunk, extracted + i, available);
-			m_cache.Take(chunk, extractOffset + i, available, std::min(size - i, GZFILE_READ_CHUNK_SIZE));
-		}
-		free(extracted);
+	{
+		std::lock_guard<std::mutex> lock(m_cacheMutex);
+		m_cache.Store(dst, offset, res, size);
 	}
 
 	int duration = NOW() - s;
 	if (duration > 10)
-		Console.WriteLn(Color_Gray, L"gunzip: chunk #%5d-%2d : %1.2f MB - %d ms",
-						(int)(offset / 4 / 1024 / 1024),
-						(int)(offset % (4 * 1024 * 1024) / GZFILE_READ_CHUNK_SIZE),
-						(float)size / 1024 / 1024,
-						duration);
+		Console.WriteLn(Color_Gray, "gunzip: chunk #%5d : %1.2f MB - %d ms",
+						(int)chunkID, (float)size / 1024 / 1024, duration);
 
-	return copied;
+	return res;
 }
 
-void GzippedFileReader::Close()
+void GzippedFileReader::Close2()
 {
 	m_filename.clear();
-	if (m_pIndex)
-	{
-		free_index((Access*)m_pIndex);
-		m_pIndex = 0;
-	}
+	m_uncompressedSize = 0;
 
-	InitZstates(); // results in delete because no index
-	m_cache.Clear();
-
-	if (m_src)
+	if (m_context)
 	{
-		fclose(m_src);
-		m_src = 0;
+		fclose(m_context->src);
+		m_context.reset();
 	}
 
-	AsyncPrefetchClose();
+	// Last one out cancels the index build if it's still going
+	m_index.reset();
+
+	const ChunksCache::Stats& stats = m_cache.GetStats();
+	if (stats.hits || stats.misses)
+		DevCon.WriteLn("gunzip: chunk cache %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64 " evictions",
+			stats.hits, stats.misses, stats.evictions);
+	m_cache.Clear();
 }
@@ -17,44 +17,43 @@
 
 typedef struct zstate Zstate;
 
-#include "AsyncFileReader.h"
+#include "ThreadedFileReader.h"
 #include "ChunksCache.h"
 #include "zlib_indexed.h"
 
-#define GZFILE_SPAN_DEFAULT (1048576L * 4)  /* distance between direct access points when creating a new index */
-#define GZFILE_READ_CHUNK_SIZE (256 * 1024) /* zlib extraction chunks size (at 0-based boundaries) */
-#define GZFILE_CACHE_SIZE_MB 200            /* cache size for extracted data. must be at least GZFILE_READ_CHUNK_SIZE (in MB)*/
+#include <memory>
+#include <vector>
 
-class GzippedFileReader : public AsyncFileReader
+#define GZFILE_SPAN_DEFAULT (1048576L * 4)    /* distance between direct access points when creating a new index */
+#define GZFILE_READ_CHUNK_SIZE (1048576L * 4) /* zlib extraction chunks size (at 0-based boundaries). a span, so chunks decompressed in parallel start at different access points */
+#define GZFILE_CACHE_SIZE_MB 200              /* cache size for extracted data. must be at least GZFILE_READ_CHUNK_SIZE (in MB)*/
+
+class GzippedFileReader : public ThreadedFileReader
 {
 	DeclareNoncopyableObject(GzippedFileReader);
 
 public:
 	GzippedFileReader(void);
 
-	virtual ~GzippedFileReader(void) { Close(); };
+	~GzippedFileReader(void) { Close(); };
 
 	static bool CanHandle(const std::string& fileName, const std::string& displayName);
-	virtual bool Open(std::string fileName);
+	bool Open2(std::string fileName) override;
 
-	virtual int ReadSync(void* pBuffer, uint sector, uint count);
+	Chunk ChunkForOffset(u64 offset) override;
+	int ReadChunk(void* dst, s64 chunkID) override;
 
-	virtual void BeginRead(void* pBuffer, uint sector, uint count);
-	virtual int FinishRead(void);
-	virtual void CancelRead(void){};
+	void Close2(void) override;
 
-	virtual void Close(void);
+	u32 CreateWorkerContexts(u32 count) override;
+	void DestroyWorkerContexts() override;
+	int ReadChunkWorker(void* dst, s64 chunkID, u32 worker) override;
 
-	virtual uint GetBlockCount(void) const
+	uint GetBlockCount(void) const override
 	{
-		// type and formula copied from FlatFileReader
-		// FIXME? : Shouldn't it be uint and (size - m_dataoffset) / m_blocksize ?
-		return (int)((m_pIndex ? m_pIndex->uncompressed_size : 0) / m_blocksize);
+		return (m_uncompressedSize - m_dataoffset) / m_blocksize;
 	};
 
-	virtual void SetBlockSize(uint bytes) { m_blocksize = bytes; }
-	virtual void SetDataOffset(int bytes) { m_dataoffset = bytes; }
-
 private:
 	class Czstate
 	{
@@ -70,29 +69,36 @@ private:
 		Zstate state;
 	};
 
-	bool OkIndex(); // Verifies that we have an index, or try to create one
-	s64 GetOptimalExtractionStart(s64 offset);
-	int _ReadSync(void* pBuffer, s64 offset, uint bytesToRead);
-	void InitZstates();
+	/// File handle and inflate state for one decompression context
+	/// The state is kept at the end of the last chunk, so sequential chunks don't go back to the index
+	struct Context
+	{
+		FILE* src = nullptr;
+		Czstate zstate;
+		/// Copy of the access point extraction starts from, the index may grow while we use it
+		Point point;
+	};
+
+	/// Index of one file, shared by all of its readers
+	struct SharedIndex;
 
-	int mBytesRead;   // Temp sync read result when simulating async read
-	Access* m_pIndex; // Quick access index
-	Czstate* m_zstates;
-	FILE* m_src;
+	/// Find or load the index of a file, probes don't start a background build
+	static std::shared_ptr<SharedIndex> AcquireIndex(const std::string& fileName, bool probe);
+	/// Read the index from disk, or start building it, for the first reader of a file
+	static void LoadIndex(SharedIndex* shared, const std::string& fileName, bool probe);
+	static void BuildIndexThread(SharedIndex* shared, std::string fileName, std::string indexFile);
 
-	ChunksCache m_cache;
+	std::unique_ptr<Context> CreateContext() const;
+	/// Copy the last access point at or before `offset`, waiting for the index to get there if it's still being built
+	bool GetAccessPoint(s64 offset, Point* point);
+	int ReadChunkWithContext(void* dst, s64 chunkID, Context& ctx);
 
-#ifdef _WIN32
-	// Used by async prefetch
-	HANDLE hOverlappedFile;
-	OVERLAPPED asyncOperationContext;
-	bool asyncInProgress;
-	char mDummyAsyncPrefetchTarget[GZFILE_READ_CHUNK_SIZE];
-#endif
-
-	void AsyncPrefetchReset();
-	void AsyncPrefetchOpen();
-	void AsyncPrefetchClose();
-	void AsyncPrefetchChunk(s64 dummy);
-	void AsyncPrefetchCancel();
+	std::shared_ptr<SharedIndex> m_index;
+	s64 m_uncompressedSize;
+	std::unique_ptr<Context> m_context;
+	std::vector<std::unique_ptr<Context>> m_contexts;
+
+	/// Shared between the read thread and the decompression pool
+	std::mutex m_cacheMutex;
+	ChunksCache m_cache;
 };
@@ -17,9 +17,16 @@
 #include "PrecompiledHeader.h"
 #include "IopCommon.h"
 #include "IsoFileFormats.h"
+#include "ChdFileReader.h"
+#include "ThreadedFileReader.h"
+
+#include "common/ScopedGuard.h"
 
 #include <errno.h>
 
+// Memory for blocks prefetched from a boot trace, more than most games read while booting
+static constexpr size_t PREFETCH_CACHE_SIZE = 64 * 1024 * 1024;
+
 static const char* nameFromType(int type)
 {
 	switch (type)
@@ -82,6 +89,23 @@ void InputIsoFile::BeginRead2(uint lsn)
 		m_read_count = std::min(ReadUnit, m_blocks - m_read_lsn);
 	}
 
+	// Take what the boot prefetch already decompressed, and read the rest next time
+	if (m_prefetch_data && KeepPrefetched())
+	{
+		const uint prefetched = ReadPrefetched(m_readbuffer, m_read_lsn, m_read_count);
+		if (prefetched > 0)
+		{
+			m_read_count = prefetched;
+			m_read_ptr = NULL;
+			return;
+		}
+	}
+
+	// Readers backed by memory can skip the copy into m_readbuffer
+	m_read_ptr = m_reader->GetBlockPointer(m_read_lsn, m_read_count);
+	if (m_read_ptr)
+		return;
+
 	m_reader->BeginRead(m_readbuffer, m_read_lsn, m_read_count);
 	m_read_inprogress = true;
 }
@@ -148,7 +172,8 @@ int InputIsoFile::FinishRead3(u8* dst, uint mode)
 	length = end - _offset;
 
 	uint read_offset = (m_current_lsn - m_read_lsn) * m_blocksize;
-	memcpy(dst + diff, m_readbuffer + ndiff + read_offset, length);
+	const u8* src = m_read_ptr ? m_read_ptr : m_readbuffer;
+	memcpy(dst + diff, src + ndiff + read_offset, length);
 
 	if (m_type == ISOTYPE_CD && diff >= 12)
 	{
@@ -181,10 +206,13 @@ void InputIsoFile::_init()
 
 	m_read_inprogress = false;
 	m_read_count = 0;
+	m_read_ptr = NULL;
 	ReadUnit = 0;
 	m_current_lsn = -1;
 	m_read_lsn = -1;
 	m_reader = NULL;
+	m_compressed = false;
+	m_prefetch_capacity = 0;
 }
 
 // Tests the specified filename to see if it is a supported ISO type.  This function typically
@@ -200,7 +228,7 @@ bool InputIsoFile::Test(std::string srcfile)
 	return Open(std::move(srcfile), true);
 }
 
-bool InputIsoFile::Open(std::string srcfile, bool testOnly)
+bool InputIsoFile::Open(std::string srcfile, bool testOnly, bool probe)
 {
 	Close();
 	m_filename = std::move(srcfile);
@@ -212,17 +240,40 @@ bool InputIsoFile::Open(std::string srcfile, bool testOnly)
 	m_reader = CompressedFileReader::GetNewReader(m_filename);
 	isCompressed = m_reader != NULL;
 
-	// If it wasn't compressed, let's open it has a FlatFileReader.
-	if (!isCompressed)
+	if (isCompressed)
 	{
-		// Allow write sharing of the iso based on the ini settings.
-		// Mostly useful for romhacking, where the disc is frequently
-		// changed and the emulator would block modifications
-		m_reader = new FlatFileReader(EmuConfig.CdvdShareWrite);
+		m_reader->SetProbe(testOnly || probe);
+		if (!m_reader->Open(m_filename))
+			return false;
+	}
+	else
+	{
+		// Try mapping it first, reads then come straight out of the page cache.
+		// Not when write sharing is on, the image could be truncated under us.
+		// CdvdMapImages can turn it off for images on slow or network storage: a mapped read that
+		// misses the page cache stalls the emu thread in a page fault, while FlatFileReader's reads
+		// (io_uring, else libaio on Linux) stay asynchronous.
+		if (EmuConfig.CdvdMapImages && !EmuConfig.CdvdShareWrite)
+		{
+			m_reader = new MappedFileReader();
+			if (!m_reader->Open(m_filename))
+			{
+				delete m_reader;
+				m_reader = NULL;
+			}
+		}
+
+		// If it can't be mapped, let's open it has a FlatFileReader.
+		if (!m_reader)
+		{
+			// Allow write sharing of the iso based on the ini settings.
+			// Mostly useful for romhacking, where the disc is frequently
+			// changed and the emulator would block modifications
+			m_reader = new FlatFileReader(EmuConfig.CdvdShareWrite);
+			if (!m_reader->Open(m_filename))
+				return false;
+		}
 	}
-
-	if (!m_reader->Open(m_filename))
-		return false;
 
 	// It might actually be a blockdump file.
 	// Check that before continuing with the FlatFileReader.
@@ -252,6 +303,17 @@ bool InputIsoFile::Open(std::string srcfile, bool testOnly)
 			.SetUserMsg(_("Unrecognized ISO image file format"))
 			.SetDiagMsg(L"ISO mounting failed: PCSX2 is unable to identify the ISO image type.");
 
+	m_compressed = isCompressed;
+
+	// Only worth spinning up the decompression pool for images we're actually going to run
+	if (isCompressed)
+	{
+		if (ThreadedFileReader* threaded = dynamic_cast<ThreadedFileReader*>(m_reader))
+			threaded->SetDecompressThreads(EmuConfig.CdvdDecompressThreads);
+		if (ChdFileReader* chd = dynamic_cast<ChdFileReader*>(m_reader))
+			chd->SetHunkCache(EmuConfig.CdvdChdCacheSize, EmuConfig.CdvdChdPrefetchHunks);
+	}
+
 	if (!isBlockdump && !isCompressed)
 	{
 		ReadUnit = MaxReadUnit;
@@ -268,6 +330,9 @@ bool InputIsoFile::Open(std::string srcfile, bool testOnly)
 
 	m_blocks = m_reader->GetBlockCount();
 
+	// Nearly every read lands in m_readbuffer, let the reader pin it if it wants to
+	m_reader->RegisterReadBuffer(m_readbuffer, sizeof(m_readbuffer));
+
 	Console.WriteLn(Color_StrongBlue, "isoFile open ok: %s", m_filename.c_str());
 
 	ConsoleIndentScope indent;
@@ -284,6 +349,8 @@ bool InputIsoFile::Open(std::string srcfile, bool testOnly)
 
 void InputIsoFile::Close()
 {
+	StopPrefetch();
+
 	delete m_reader;
 	m_reader = NULL;
 
@@ -295,6 +362,121 @@ bool InputIsoFile::IsOpened() const
 	return m_reader != NULL;
 }
 
+void InputIsoFile::StartPrefetch(std::vector<BootTrace::Run> runs)
+{
+	StopPrefetch();
+	if (!IsOpened() || runs.empty())
+		return;
+
+	if (m_compressed)
+	{
+		m_prefetch_capacity = static_cast<u32>(PREFETCH_CACHE_SIZE / m_blocksize);
+		m_prefetch_data = std::make_unique<u8[]>(static_cast<size_t>(m_prefetch_capacity) * m_blocksize);
+	}
+
+	m_prefetch_done.store(false, std::memory_order_relaxed);
+	m_prefetch_timer.Reset();
+	m_prefetch_thread = std::thread(&InputIsoFile::PrefetchThread, this, std::move(runs));
+}
+
+void InputIsoFile::StopPrefetch()
+{
+	if (m_prefetch_thread.joinable())
+	{
+		m_prefetch_stop.store(true, std::memory_order_relaxed);
+		m_prefetch_thread.join();
+		m_prefetch_stop.store(false, std::memory_order_relaxed);
+	}
+
+	m_prefetch_index.clear();
+	m_prefetch_data.reset();
+	m_prefetch_capacity = 0;
+}
+
+void InputIsoFile::PrefetchThread(std::vector<BootTrace::Run> runs)
+{
+	Threading::SetNameOfCurrentThread("ISO Prefetch");
+	ScopedGuard done([this]() { m_prefetch_done.store(true, std::memory_order_release); });
+
+	// Readers aren't thread safe, so use our own.  It won't have the main reader's
+	// decompression threads, but it doesn't need to beat anything but the emulated drive.
+	// It's too big for a thread's stack, m_readbuffer alone is over 300KB.
+	const std::unique_ptr<InputIsoFile> source = std::make_unique<InputIsoFile>();
+	if (!source->Open(m_filename, true))
+		return;
+
+	const std::unique_ptr<u8[]> buffer = std::make_unique<u8[]>(MaxReadUnit * m_blocksize);
+	u32 blocks = 0;
+
+	for (const BootTrace::Run& run : runs)
+	{
+		for (u32 lsn = run.lsn; lsn < run.lsn + run.count && lsn < m_blocks;)
+		{
+			if (m_prefetch_stop.load(std::memory_order_relaxed))
+				return;
+
+			const u32 count = std::min({run.lsn + run.count - lsn, m_blocks - lsn, static_cast<u32>(MaxReadUnit)});
+			if (source->m_reader->ReadSync(buffer.get(), lsn, count) < 0)
+				return;
+
+			if (m_prefetch_data)
+			{
+				std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+				for (u32 i = 0; i < count; i++)
+				{
+					if (m_prefetch_index.size() >= m_prefetch_capacity)
+					{
+						DevCon.WriteLn("(BootTrace) Prefetch cache full after %u blocks", blocks);
+						return;
+					}
+
+					const u32 slot = static_cast<u32>(m_prefetch_index.size());
+					if (m_prefetch_index.emplace(lsn + i, slot).second)
+						std::memcpy(&m_prefetch_data[static_cast<size_t>(slot) * m_blocksize], buffer.get() + static_cast<size_t>(i) * m_blocksize, m_blocksize);
+				}
+			}
+
+			lsn += count;
+			blocks += count;
+		}
+	}
+
+	DevCon.WriteLn("(BootTrace) Prefetched %u blocks", blocks);
+}
+
+bool InputIsoFile::KeepPrefetched()
+{
+	if (m_prefetch_timer.GetTimeSeconds() < BootTrace::RECORD_SECONDS)
+		return true;
+
+	// The game has read everything the trace covers by now.  Anything the thread hasn't got to
+	// isn't worth reading anymore, and the cache and index aren't worth keeping, so stop the
+	// thread and free them.  Reads keep using them until the thread has noticed.
+	m_prefetch_stop.store(true, std::memory_order_relaxed);
+	if (!m_prefetch_done.load(std::memory_order_acquire))
+		return true;
+
+	StopPrefetch();
+	DevCon.WriteLn("(BootTrace) Boot window over, prefetch cache freed");
+	return false;
+}
+
+uint InputIsoFile::ReadPrefetched(u8* dst, uint lsn, uint count)
+{
+	std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+
+	uint read = 0;
+	for (; read < count; read++)
+	{
+		const auto it = m_prefetch_index.find(lsn + read);
+		if (it == m_prefetch_index.end())
+			break;
+		std::memcpy(dst + static_cast<size_t>(read) * m_blocksize, &m_prefetch_data[static_cast<size_t>(it->second) * m_blocksize], m_blocksize);
+	}
+
+	return read;
+}
+
 bool InputIsoFile::tryIsoType(u32 _size, s32 _offset, s32 _blockofs)
 {
 	static u8 buf[2456];
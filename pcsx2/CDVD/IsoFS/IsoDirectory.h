@@ -25,7 +25,7 @@ class IsoDirectory
 {
 public:
 	SectorSource& internalReader;
-	std::vector<IsoFileDescriptor> files;
+	std::shared_ptr<const IsoDirectoryEntries> m_dir;
 	IsoFS_Type m_fstype;
 
 public:
@@ -0,0 +1,54 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2010  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A parsed directory record
+struct IsoDirectoryEntries
+{
+	std::vector<IsoFileDescriptor> files;
+	// Names, exactly as recorded on the disc, to their index in files
+	std::unordered_map<std::string, int> index;
+};
+
+// Keeps the directories of a disc once they've been read, so resolving paths on it again doesn't
+// go back to the disc.  Whoever owns the cache has to Clear() it when the disc changes.
+class IsoDirectoryCache
+{
+public:
+	static std::string NameKey(const wxString& name);
+
+	bool GetRoot(IsoFileDescriptor* root, IsoFS_Type* fstype);
+	void SetRoot(const IsoFileDescriptor& root, IsoFS_Type fstype);
+
+	std::shared_ptr<const IsoDirectoryEntries> Find(u32 lba);
+	// Returns the directory which ends up cached, another thread may have added one first
+	std::shared_ptr<const IsoDirectoryEntries> Insert(u32 lba, std::shared_ptr<const IsoDirectoryEntries> dir);
+
+	void Clear();
+
+private:
+	std::mutex m_mutex;
+	bool m_hasRoot = false;
+	IsoFileDescriptor m_root;
+	IsoFS_Type m_fstype = FStype_ISO9660;
+	std::unordered_map<u32, std::shared_ptr<const IsoDirectoryEntries>> m_directories;
+};
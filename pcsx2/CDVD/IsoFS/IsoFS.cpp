@@ -48,6 +48,13 @@ IsoDirectory::IsoDirectory(SectorSource& r)
 	: internalReader(r)
 {
 	IsoFileDescriptor rootDirEntry;
+	IsoDirectoryCache* cache = internalReader.getDirectoryCache();
+	if (cache && cache->GetRoot(&rootDirEntry, &m_fstype))
+	{
+		Init(rootDirEntry);
+		return;
+	}
+
 	bool isValid = false;
 	bool done = false;
 	uint i = 16;
@@ -103,6 +110,8 @@ IsoDirectory::IsoDirectory(SectorSource& r)
 			.SetDiagMsg(L"IsoFS could not find the root directory on the ISO image.");
 
 	DevCon.WriteLn(L"(IsoFS) Filesystem is " + FStype_ToString());
+	if (cache)
+		cache->SetRoot(rootDirEntry, m_fstype);
 	Init(rootDirEntry);
 }
 
@@ -116,10 +125,15 @@ IsoDirectory::IsoDirectory(SectorSource& r, IsoFileDescriptor directoryEntry)
 
 void IsoDirectory::Init(const IsoFileDescriptor& directoryEntry)
 {
+	IsoDirectoryCache* cache = internalReader.getDirectoryCache();
+	if (cache && (m_dir = cache->Find(directoryEntry.lba)))
+		return;
+
 	// parse directory sector
 	IsoFile dataStream(internalReader, directoryEntry);
 
-	files.clear();
+	auto dir = std::make_shared<IsoDirectoryEntries>();
+	std::vector<IsoFileDescriptor>& files = dir->files;
 
 	uint remainingSize = directoryEntry.size;
 
@@ -142,22 +156,29 @@ void IsoDirectory::Init(const IsoFileDescriptor& directoryEntry)
 	}
 
 	b[0] = 0;
+
+	// Names match exactly, and the first of any duplicates wins, like the old linear search did
+	for (unsigned int i = 0; i < files.size(); i++)
+		dir->index.emplace(IsoDirectoryCache::NameKey(files[i].name), i);
+
+	if (cache)
+		m_dir = cache->Insert(directoryEntry.lba, std::move(dir));
+	else
+		m_dir = std::move(dir);
 }
 
 const IsoFileDescriptor& IsoDirectory::GetEntry(int index) const
 {
-	return files[index];
+	return m_dir->files[index];
 }
 
 int IsoDirectory::GetIndexOf(const wxString& fileName) const
 {
-	for (unsigned int i = 0; i < files.size(); i++)
-	{
-		if (files[i].name == fileName)
-			return i;
-	}
+	const auto it = m_dir->index.find(IsoDirectoryCache::NameKey(fileName));
+	if (it == m_dir->index.end())
+		throw Exception::FileNotFound(fileName);
 
-	throw Exception::FileNotFound(fileName);
+	return it->second;
 }
 
 const IsoFileDescriptor& IsoDirectory::GetEntry(const wxString& fileName) const
@@ -214,6 +235,54 @@ u32 IsoDirectory::GetFileSize(const wxString& filePath) const
 	return FindFile(filePath).size;
 }
 
+//////////////////////////////////////////////////////////////////////////
+// IsoDirectoryCache
+//////////////////////////////////////////////////////////////////////////
+
+std::string IsoDirectoryCache::NameKey(const wxString& name)
+{
+	return std::string(name.ToUTF8());
+}
+
+bool IsoDirectoryCache::GetRoot(IsoFileDescriptor* root, IsoFS_Type* fstype)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_hasRoot)
+		return false;
+
+	*root = m_root;
+	*fstype = m_fstype;
+	return true;
+}
+
+void IsoDirectoryCache::SetRoot(const IsoFileDescriptor& root, IsoFS_Type fstype)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_hasRoot = true;
+	m_root = root;
+	m_fstype = fstype;
+}
+
+std::shared_ptr<const IsoDirectoryEntries> IsoDirectoryCache::Find(u32 lba)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto it = m_directories.find(lba);
+	return (it != m_directories.end()) ? it->second : nullptr;
+}
+
+std::shared_ptr<const IsoDirectoryEntries> IsoDirectoryCache::Insert(u32 lba, std::shared_ptr<const IsoDirectoryEntries> dir)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_directories.emplace(lba, std::move(dir)).first->second;
+}
+
+void IsoDirectoryCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_hasRoot = false;
+	m_directories.clear();
+}
+
 IsoFileDescriptor::IsoFileDescriptor()
 {
 	lba = 0;
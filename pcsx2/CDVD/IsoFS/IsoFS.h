@@ -17,9 +17,12 @@
 
 class IsoFile;
 class IsoDirectory;
+class IsoDirectoryCache;
+struct IsoDirectoryEntries;
 struct ISoFileDescriptor;
 
 #include "SectorSource.h"
 #include "IsoFileDescriptor.h"
 #include "IsoDirectory.h"
+#include "IsoDirectoryCache.h"
 #include "IsoFile.h"
@@ -16,9 +16,12 @@
 
 #include "PrecompiledHeader.h"
 
+#include "IsoFS.h"
 #include "IsoFSCDVD.h"
 #include "CDVD/CDVDaccess.h"
 
+static IsoDirectoryCache s_directoryCache;
+
 IsoFSCDVD::IsoFSCDVD()
 {
 }
@@ -35,3 +38,13 @@ int IsoFSCDVD::getNumSectors()
 
 	return td.lsn;
 }
+
+IsoDirectoryCache* IsoFSCDVD::getDirectoryCache()
+{
+	return &s_directoryCache;
+}
+
+void IsoFSCDVD::ClearDirectoryCache()
+{
+	s_directoryCache.Clear();
+}
@@ -28,4 +28,9 @@ public:
 	virtual bool readSector(unsigned char* buffer, int lba);
 
 	virtual int getNumSectors();
+
+	// Shared by every IsoFSCDVD, since they all read the current disc
+	virtual IsoDirectoryCache* getDirectoryCache();
+	// Call when the current disc changes
+	static void ClearDirectoryCache();
 };
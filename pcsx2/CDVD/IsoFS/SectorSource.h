@@ -15,10 +15,14 @@
 
 #pragma once
 
+class IsoDirectoryCache;
+
 class SectorSource
 {
 public:
 	virtual int getNumSectors() = 0;
 	virtual bool readSector(unsigned char* buffer, int lba) = 0;
+	// Sources which are read through more than once can keep the directories they've parsed here
+	virtual IsoDirectoryCache* getDirectoryCache() { return nullptr; }
 	virtual ~SectorSource() = default;
 };
@@ -17,9 +17,16 @@
 
 #include "CDVD.h"
 #include "AsyncFileReader.h"
+#include "BootTrace.h"
 #include "CompressedFileReader.h"
+#include "common/Timer.h"
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 enum isoType
 {
@@ -63,8 +70,24 @@ protected:
 	bool m_read_inprogress;
 	uint m_read_lsn;
 	uint m_read_count;
+	// Points into the reader's own memory when it can provide blocks without a copy, m_readbuffer otherwise
+	const u8* m_read_ptr;
 	u8 m_readbuffer[MaxReadUnit * CD_FRAMESIZE_RAW];
 
+	bool m_compressed;
+
+	// Blocks read ahead of the emulator from a recorded boot trace
+	std::thread m_prefetch_thread;
+	std::atomic<bool> m_prefetch_stop{false};
+	std::atomic<bool> m_prefetch_done{false};
+	// Started with the prefetch, the cache is freed once the boot trace window has passed
+	Common::Timer m_prefetch_timer;
+	std::mutex m_prefetch_mutex;
+	// Maps an lsn to its block in m_prefetch_data, only compressed images keep the data
+	std::unordered_map<u32, u32> m_prefetch_index;
+	std::unique_ptr<u8[]> m_prefetch_data;
+	u32 m_prefetch_capacity;
+
 public:
 	InputIsoFile();
 	virtual ~InputIsoFile();
@@ -81,7 +104,8 @@ public:
 	}
 
 	bool Test(std::string srcfile);
-	bool Open(std::string srcfile, bool testOnly = false);
+	// probe: only opened to look at the image, see AsyncFileReader::SetProbe()
+	bool Open(std::string srcfile, bool testOnly = false, bool probe = false);
 	void Close();
 	bool Detect(bool readType = true);
 
@@ -90,8 +114,18 @@ public:
 	void BeginRead2(uint lsn);
 	int FinishRead3(u8* dest, uint mode);
 
+	// Reads the given sectors on another thread so they're ready before the emulator asks for them.
+	// Compressed images keep the blocks in memory, others only warm the OS cache.
+	void StartPrefetch(std::vector<BootTrace::Run> runs);
+	void StopPrefetch();
+
 protected:
 	void _init();
+	void PrefetchThread(std::vector<BootTrace::Run> runs);
+	// Copies the blocks from lsn on which were prefetched, returns how many
+	uint ReadPrefetched(u8* dst, uint lsn, uint count);
+	// Frees the prefetch cache once the boot is over, returns false if it's gone
+	bool KeepPrefetched();
 
 	bool tryIsoType(u32 _size, s32 _offset, s32 _blockofs);
 	void FindParts();
@@ -0,0 +1,234 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "AsyncFileReader.h"
+#include "common/FileSystem.h"
+#include "common/StringUtil.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// How far ahead of a sequential read we ask the OS to start paging in
+static constexpr u64 SEQUENTIAL_PREFETCH_SIZE = 4 * 1024 * 1024;
+
+MappedFileReader::MappedFileReader()
+	: m_data(nullptr)
+	, m_size(0)
+	, m_bytesRead(0)
+	, m_nextSector(0)
+	, m_sequential(false)
+{
+	m_blocksize = 2048;
+#ifdef _WIN32
+	m_hFile = INVALID_HANDLE_VALUE;
+	m_hMapping = nullptr;
+#else
+	m_fd = -1;
+#endif
+}
+
+MappedFileReader::~MappedFileReader(void)
+{
+	Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFileReader::Open(std::string fileName)
+{
+	Close();
+	m_filename = std::move(fileName);
+
+	m_hFile = CreateFile(
+		StringUtil::UTF8StringToWideString(m_filename).c_str(),
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		NULL,
+		OPEN_EXISTING,
+		FILE_FLAG_RANDOM_ACCESS,
+		NULL);
+	if (m_hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(m_hFile, &fileSize) || fileSize.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+	m_size = fileSize.QuadPart;
+
+	m_hMapping = CreateFileMapping(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!m_hMapping)
+	{
+		Close();
+		return false;
+	}
+
+	m_data = static_cast<const u8*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+	if (!m_data)
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFileReader::Close(void)
+{
+	if (m_data)
+		UnmapViewOfFile(m_data);
+	if (m_hMapping)
+		CloseHandle(m_hMapping);
+	if (m_hFile != INVALID_HANDLE_VALUE)
+		CloseHandle(m_hFile);
+
+	m_data = nullptr;
+	m_size = 0;
+	m_hMapping = nullptr;
+	m_hFile = INVALID_HANDLE_VALUE;
+}
+
+void MappedFileReader::AdviseAccess(uint sector, uint count)
+{
+	// FILE_FLAG_RANDOM_ACCESS already stops the cache manager from reading far ahead on seeks,
+	// and the memory manager clusters faults on sequential access by itself.
+	m_nextSector = sector + count;
+}
+
+#else
+
+bool MappedFileReader::Open(std::string fileName)
+{
+	Close();
+	m_filename = std::move(fileName);
+
+	m_fd = FileSystem::OpenFDFile(m_filename.c_str(), O_RDONLY, 0);
+	if (m_fd == -1)
+		return false;
+
+	struct stat sysStatData;
+	if (fstat(m_fd, &sysStatData) < 0 || sysStatData.st_size == 0)
+	{
+		Close();
+		return false;
+	}
+	m_size = sysStatData.st_size;
+
+	void* data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+	if (data == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+	m_data = static_cast<const u8*>(data);
+
+	// Start out assuming seeks, the kernel's default readaround wastes I/O on them
+	madvise(data, m_size, MADV_RANDOM);
+	m_sequential = false;
+
+	return true;
+}
+
+void MappedFileReader::Close(void)
+{
+	if (m_data)
+		munmap(const_cast<u8*>(m_data), m_size);
+	if (m_fd != -1)
+		close(m_fd);
+
+	m_data = nullptr;
+	m_size = 0;
+	m_fd = -1;
+}
+
+void MappedFileReader::AdviseAccess(uint sector, uint count)
+{
+	const bool sequential = (sector == m_nextSector);
+	m_nextSector = sector + count;
+
+	if (sequential != m_sequential)
+	{
+		m_sequential = sequential;
+		madvise(const_cast<u8*>(m_data), m_size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+	}
+
+	if (sequential)
+	{
+		// Get the pages after this read in flight before the game asks for them
+		static const uintptr_t pageMask = ~static_cast<uintptr_t>(sysconf(_SC_PAGESIZE) - 1);
+		const u64 begin = static_cast<u64>(m_nextSector) * m_blocksize + m_dataoffset;
+		if (begin < m_size)
+		{
+			const u64 end = std::min(begin + SEQUENTIAL_PREFETCH_SIZE, m_size);
+			const uintptr_t alignedBegin = reinterpret_cast<uintptr_t>(m_data + begin) & pageMask;
+			madvise(reinterpret_cast<void*>(alignedBegin), reinterpret_cast<uintptr_t>(m_data + end) - alignedBegin, MADV_WILLNEED);
+		}
+	}
+}
+
+#endif
+
+int MappedFileReader::CopyBlocks(void* pBuffer, uint sector, uint count)
+{
+	const u64 offset = sector * (u64)m_blocksize + m_dataoffset;
+	if (!m_data || offset >= m_size)
+		return -1;
+
+	const u64 bytes = std::min<u64>(count * (u64)m_blocksize, m_size - offset);
+	AdviseAccess(sector, count);
+	std::memcpy(pBuffer, m_data + offset, bytes);
+	return static_cast<int>(bytes);
+}
+
+int MappedFileReader::ReadSync(void* pBuffer, uint sector, uint count)
+{
+	return CopyBlocks(pBuffer, sector, count);
+}
+
+void MappedFileReader::BeginRead(void* pBuffer, uint sector, uint count)
+{
+	// Nothing to wait for, the page cache is the buffer
+	m_bytesRead = CopyBlocks(pBuffer, sector, count);
+}
+
+int MappedFileReader::FinishRead(void)
+{
+	return m_bytesRead;
+}
+
+void MappedFileReader::CancelRead(void)
+{
+}
+
+const u8* MappedFileReader::GetBlockPointer(uint sector, uint count)
+{
+	const u64 offset = sector * (u64)m_blocksize + m_dataoffset;
+	if (!m_data || offset + count * (u64)m_blocksize > m_size)
+		return nullptr;
+
+	AdviseAccess(sector, count);
+	return m_data + offset;
+}
+
+uint MappedFileReader::GetBlockCount(void) const
+{
+	return (int)(m_size / m_blocksize);
+}
@@ -15,10 +15,25 @@
 
 #include "PrecompiledHeader.h"
 #include "ThreadedFileReader.h"
+#include "common/Timer.h"
 
 // Make sure buffer size is bigger than the cutoff where PCSX2 emulates a seek
 // If buffers are smaller than that, we can't keep up with linear reads
 static constexpr u32 MINIMUM_SIZE = 128 * 1024;
+// Buffer size while the game is streaming, both buffers together keep a couple MB read ahead
+// Chunks are appended to a buffer as they decode, so a bigger buffer doesn't delay the first hit
+static constexpr u32 STREAMING_SIZE = 1024 * 1024;
+
+// Decompression pool limits
+// Each worker gets a few slots so that it always has the next chunk queued while the previous one is consumed
+static constexpr u32 MAXIMUM_WORKERS = 16;
+static constexpr u32 SLOTS_PER_WORKER = 4;
+
+// Access pattern classification
+// Requests starting at most this far past the end of the previous one still count as sequential (streams skip headers and padding)
+static constexpr u64 SEQUENTIAL_GAP = MINIMUM_SIZE;
+// Requests needed before we trust the classification, until then readahead behaves as it always did
+static constexpr u32 MINIMUM_HISTORY = 4;
 
 ThreadedFileReader::ThreadedFileReader()
 {
@@ -31,6 +46,7 @@ ThreadedFileReader::~ThreadedFileReader()
 	(void)std::lock_guard<std::mutex>{m_mtx};
 	m_condition.notify_one();
 	m_readThread.join();
+	pxAssertMsg(m_workers.empty(), "Subclasses must Close() before destruction");
 	for (auto& buffer : m_buffer)
 		if (buffer.ptr)
 			free(buffer.ptr);
@@ -74,44 +90,88 @@ void ThreadedFileReader::Loop()
 		u32 requestSize = m_requestSize;
 		void* ptr = m_requestPtr.load(std::memory_order_relaxed);
 
+		for (u32 i = 0; i < m_cachedReadCount; i++)
+			AddAccess(m_cachedReads[i].begin, m_cachedReads[i].end);
+		m_cachedReadCount = 0;
+
 		m_running = true;
 		lock.unlock();
 
 		bool ok = true;
 
+		// Readahead-only requests were already recorded by whoever hit the buffers
 		if (ptr)
+			AddAccess(requestOffset, requestOffset + requestSize);
+		const AccessPattern pattern = ClassifyAccess();
+		PerformanceMetrics::OnCDVDReadahead(pattern);
+
+		// Scale the readahead to what the game has been doing lately
+		// Streaming gets everything we've got, strided reads get the next stride, random seeks get nothing
+		u64 readaheadOffset = requestOffset + requestSize;
+		u64 readaheadEnd = UINT64_MAX;
+		u64 poolLimit = UINT64_MAX;
+		int readaheadBuffers = static_cast<int>(std::size(m_buffer));
+		u32 readaheadSize = MINIMUM_SIZE;
+		if (pattern == AccessPattern::Sequential)
 		{
-			ok = Decompress(ptr, requestOffset, requestSize);
+			// Two buffers of MINIMUM_SIZE is what the reader has always kept, go deeper by filling bigger buffers
+			readaheadSize = STREAMING_SIZE;
+		}
+		else if (pattern == AccessPattern::Strided)
+		{
+			// Just enough for one more read the size of the last one
+			readaheadOffset = m_strideNext;
+			readaheadEnd = readaheadOffset + m_strideSize;
+			readaheadBuffers = 1;
+			poolLimit = requestOffset + requestSize;
+		}
+		else if (pattern == AccessPattern::Random)
+		{
+			readaheadBuffers = 0;
+			// The workers can still help with the request itself
+			poolLimit = requestOffset + requestSize;
 		}
 
-		m_requestPtr.store(nullptr, std::memory_order_release);
-		m_condition.notify_one();
+		if (!m_workers.empty())
+		{
+			std::unique_lock<std::mutex> poolLock(m_poolMtx);
+			m_poolLimit = poolLimit;
+			QueuePoolReadahead(requestOffset, poolLock);
+		}
+
+		if (ptr)
+		{
+			ok = Decompress(ptr, requestOffset, requestSize);
+			// Only clear the pointer we serviced, a readahead-only pass mustn't clobber a request that arrived meanwhile
+			m_requestPtr.store(nullptr, std::memory_order_release);
+			m_condition.notify_one();
+		}
 
-		if (ok)
+		if (ok && readaheadBuffers > 0)
 		{
 			// Readahead
-			Chunk chunk = ChunkForOffset(requestOffset + requestSize);
+			Chunk chunk = ChunkForOffset(readaheadOffset);
 			if (chunk.chunkID >= 0)
 			{
 				int buffersFilled = 0;
-				Buffer* buf = GetBlockPtr(chunk);
+				Buffer* buf = GetBlockPtr(chunk, readaheadSize);
 				// Cancel readahead if a new request comes in
 				while (buf && !m_requestPtr.load(std::memory_order_acquire))
 				{
 					u32 bufsize = buf->size.load(std::memory_order_relaxed);
 					chunk = ChunkForOffset(buf->offset + bufsize);
-					if (chunk.chunkID < 0)
+					if (chunk.chunkID < 0 || chunk.offset >= readaheadEnd)
 						break;
-					if (buf->offset + bufsize != chunk.offset || chunk.length + bufsize > buf->cap)
+					if (buf->offset + bufsize != chunk.offset || chunk.length + bufsize > std::min(buf->cap, readaheadSize))
 					{
 						buffersFilled++;
-						if (buffersFilled >= 2)
+						if (buffersFilled >= readaheadBuffers)
 							break;
-						buf = GetBlockPtr(chunk);
+						buf = GetBlockPtr(chunk, readaheadSize);
 					}
 					else
 					{
-						int amt = ReadChunk(static_cast<char*>(buf->ptr) + bufsize, chunk.chunkID);
+						int amt = ReadChunkPooled(static_cast<char*>(buf->ptr) + bufsize, chunk);
 						if (amt <= 0)
 							break;
 						buf->size.store(bufsize + amt, std::memory_order_release);
@@ -132,7 +192,62 @@ void ThreadedFileReader::Loop()
 	}
 }
 
-ThreadedFileReader::Buffer* ThreadedFileReader::GetBlockPtr(const Chunk& block)
+void ThreadedFileReader::AddAccess(u64 begin, u64 end)
+{
+	m_history[m_historyPos] = {begin, end};
+	m_historyPos = (m_historyPos + 1) % ACCESS_HISTORY;
+	if (m_historyCount < ACCESS_HISTORY)
+		m_historyCount++;
+}
+
+ThreadedFileReader::AccessPattern ThreadedFileReader::ClassifyAccess()
+{
+	if (m_historyCount < MINIMUM_HISTORY)
+		return AccessPattern::Unknown;
+
+	auto record = [this](u32 age) -> const AccessRecord& {
+		return m_history[(m_historyPos + ACCESS_HISTORY - 1 - age) % ACCESS_HISTORY];
+	};
+
+	u32 sequential = 0;
+	for (u32 age = 0; age + 1 < m_historyCount; age++)
+	{
+		const AccessRecord& cur = record(age);
+		const AccessRecord& prev = record(age + 1);
+		if (cur.end > prev.end && cur.begin <= prev.end + SEQUENTIAL_GAP)
+			sequential++;
+	}
+	if (sequential * 4 >= (m_historyCount - 1) * 3)
+		return AccessPattern::Sequential;
+
+	// Same distance between the last few read starts, eg. reading every Nth record of a table
+	const s64 stride = static_cast<s64>(record(0).begin - record(1).begin);
+	bool strided = stride != 0;
+	for (u32 age = 1; strided && age + 1 < MINIMUM_HISTORY; age++)
+		strided = static_cast<s64>(record(age).begin - record(age + 1).begin) == stride;
+	if (strided && (stride > 0 || static_cast<u64>(-stride) <= record(0).begin))
+	{
+		m_strideNext = record(0).begin + stride;
+		m_strideSize = record(0).end - record(0).begin;
+		return AccessPattern::Strided;
+	}
+
+	return AccessPattern::Random;
+}
+
+void ThreadedFileReader::RecordRequest(u64 begin, u64 end, bool prefetched, const std::lock_guard<std::mutex>&)
+{
+	m_requests.fetch_add(1, std::memory_order_relaxed);
+	if (prefetched)
+	{
+		m_prefetchHits.fetch_add(1, std::memory_order_relaxed);
+		if (m_cachedReadCount < ACCESS_HISTORY)
+			m_cachedReads[m_cachedReadCount++] = {begin, end};
+	}
+	PerformanceMetrics::OnCDVDRead(prefetched);
+}
+
+ThreadedFileReader::Buffer* ThreadedFileReader::GetBlockPtr(const Chunk& block, u32 minSize)
 {
 	for (int i = 0; i < static_cast<int>(std::size(m_buffer)); i++)
 	{
@@ -153,7 +268,7 @@ ThreadedFileReader::Buffer* ThreadedFileReader::GetBlockPtr(const Chunk& block)
 		std::unique_lock<std::mutex> lock(m_mtx, std::defer_lock);
 		if (std::this_thread::get_id() == m_readThread.get_id())
 			lock.lock();
-		u32 size = std::max(block.length, MINIMUM_SIZE);
+		u32 size = std::max(block.length, std::max(minSize, MINIMUM_SIZE));
 		if (buf.cap < size)
 		{
 			buf.ptr = realloc(buf.ptr, size);
@@ -161,7 +276,7 @@ ThreadedFileReader::Buffer* ThreadedFileReader::GetBlockPtr(const Chunk& block)
 		}
 		buf.size.store(0, std::memory_order_relaxed);
 	}
-	int size = ReadChunk(buf.ptr, block.chunkID);
+	int size = ReadChunkPooled(buf.ptr, block);
 	if (size > 0)
 	{
 		buf.offset = block.offset;
@@ -172,6 +287,197 @@ ThreadedFileReader::Buffer* ThreadedFileReader::GetBlockPtr(const Chunk& block)
 	return nullptr;
 }
 
+void ThreadedFileReader::WorkerLoop(u32 worker)
+{
+	Threading::SetNameOfCurrentThread("ISO Decompress Worker");
+
+	std::unique_lock<std::mutex> lock(m_poolMtx);
+
+	while (true)
+	{
+		PoolSlot* slot = nullptr;
+		while (!m_poolQuit)
+		{
+			// Lowest chunk first, that's the one the read thread will want next
+			for (PoolSlot& candidate : m_slots)
+			{
+				if (candidate.state == SlotState::Queued && (!slot || candidate.chunkID < slot->chunkID))
+					slot = &candidate;
+			}
+			if (slot)
+				break;
+			m_poolWork.wait(lock);
+		}
+
+		if (m_poolQuit)
+			return;
+
+		// Nobody else touches a slot's buffer while it's decoding
+		slot->state = SlotState::Decoding;
+		const s64 chunkID = slot->chunkID;
+		const u32 length = slot->length;
+		lock.unlock();
+
+		if (slot->cap < length)
+		{
+			slot->ptr = realloc(slot->ptr, length);
+			slot->cap = length;
+		}
+		int amt = ReadChunkWorker(slot->ptr, chunkID, worker);
+
+		lock.lock();
+		if (amt > 0)
+		{
+			slot->size = amt;
+			slot->state = SlotState::Ready;
+			m_chunksDecoded.fetch_add(1, std::memory_order_relaxed);
+		}
+		else
+		{
+			slot->state = SlotState::Empty;
+		}
+		m_poolDone.notify_all();
+	}
+}
+
+void ThreadedFileReader::StartWorkers()
+{
+	if (!m_requestedWorkers || !m_workers.empty())
+		return;
+
+	u32 count = CreateWorkerContexts(std::min(m_requestedWorkers, MAXIMUM_WORKERS));
+	if (!count)
+		return;
+
+	m_slots.resize(count * SLOTS_PER_WORKER);
+	m_poolQuit = false;
+	for (u32 i = 0; i < count; i++)
+		m_workers.emplace_back([](ThreadedFileReader* r, u32 worker){ r->WorkerLoop(worker); }, this, i);
+
+	DevCon.WriteLn("ThreadedFileReader: Decompressing with %u worker threads", count);
+}
+
+void ThreadedFileReader::StopWorkers()
+{
+	if (m_workers.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_poolMtx);
+		m_poolQuit = true;
+	}
+	m_poolWork.notify_all();
+	for (std::thread& worker : m_workers)
+		worker.join();
+	m_workers.clear();
+
+	for (PoolSlot& slot : m_slots)
+		free(slot.ptr);
+	m_slots.clear();
+
+	DestroyWorkerContexts();
+}
+
+ThreadedFileReader::PoolSlot* ThreadedFileReader::FindSlot(s64 chunkID)
+{
+	for (PoolSlot& slot : m_slots)
+	{
+		if (slot.state != SlotState::Empty && slot.chunkID == chunkID)
+			return &slot;
+	}
+	return nullptr;
+}
+
+bool ThreadedFileReader::IsBuffered(const Chunk& chunk) const
+{
+	for (const Buffer& buf : m_buffer)
+	{
+		u32 size = buf.size.load(std::memory_order_relaxed);
+		if (size && buf.offset <= chunk.offset && buf.offset + size >= chunk.offset + chunk.length)
+			return true;
+	}
+	return false;
+}
+
+void ThreadedFileReader::QueuePoolReadahead(u64 offset, const std::unique_lock<std::mutex>&)
+{
+	Chunk chunk = ChunkForOffset(offset);
+	if (chunk.chunkID < 0)
+		return;
+
+	const s64 first = chunk.chunkID;
+	const s64 last = first + static_cast<s64>(m_slots.size());
+	auto outsideWindow = [first, last](const PoolSlot& slot) { return slot.chunkID < first || slot.chunkID >= last; };
+
+	// Drop queued work we no longer need so the workers go straight to the new window
+	for (PoolSlot& slot : m_slots)
+	{
+		if (slot.state == SlotState::Queued && outsideWindow(slot))
+			slot.state = SlotState::Empty;
+	}
+
+	bool queued = false;
+	for (; chunk.chunkID >= 0 && chunk.chunkID < last && chunk.offset < m_poolLimit; chunk = ChunkForOffset(chunk.offset + chunk.length))
+	{
+		if (FindSlot(chunk.chunkID) || IsBuffered(chunk))
+			continue;
+
+		PoolSlot* target = nullptr;
+		for (PoolSlot& slot : m_slots)
+		{
+			if (slot.state == SlotState::Empty || (slot.state == SlotState::Ready && outsideWindow(slot)))
+			{
+				target = &slot;
+				break;
+			}
+		}
+		if (!target)
+			break;
+
+		target->chunkID = chunk.chunkID;
+		target->length = chunk.length;
+		target->size = 0;
+		target->state = SlotState::Queued;
+		queued = true;
+	}
+
+	if (queued)
+		m_poolWork.notify_all();
+}
+
+int ThreadedFileReader::ReadChunkPooled(void* dst, const Chunk& chunk)
+{
+	if (!m_workers.empty())
+	{
+		std::unique_lock<std::mutex> lock(m_poolMtx);
+		PoolSlot* slot = FindSlot(chunk.chunkID);
+		if (slot && slot->state == SlotState::Decoding)
+		{
+			Common::Timer timer;
+			while (slot->state == SlotState::Decoding)
+				m_poolDone.wait(lock);
+			m_waitTime.fetch_add(static_cast<u64>(timer.GetTimeNanoseconds()), std::memory_order_relaxed);
+		}
+
+		if (slot && slot->state == SlotState::Ready && slot->chunkID == chunk.chunkID)
+		{
+			const u32 size = slot->size;
+			memcpy(dst, slot->ptr, size);
+			slot->state = SlotState::Empty;
+			m_readaheadHits.fetch_add(1, std::memory_order_relaxed);
+			// Slide the window along behind the consumer
+			QueuePoolReadahead(chunk.offset + chunk.length, lock);
+			return size;
+		}
+
+		// Not started yet, faster to decode it ourselves than to wait for a worker
+		if (slot && slot->state == SlotState::Queued)
+			slot->state = SlotState::Empty;
+	}
+
+	return ReadChunk(dst, chunk.chunkID);
+}
+
 bool ThreadedFileReader::Decompress(void* target, u64 begin, u32 size)
 {
 	char* write = static_cast<char*>(target);
@@ -196,7 +502,7 @@ bool ThreadedFileReader::Decompress(void* target, u64 begin, u32 size)
 		}
 		else
 		{
-			int amt = ReadChunk(write, chunk.chunkID);
+			int amt = ReadChunkPooled(write, chunk);
 			if (amt < static_cast<int>(chunk.length))
 				return false;
 			write += chunk.length;
@@ -242,7 +548,31 @@ bool ThreadedFileReader::TryCachedRead(void*& buffer, u64& offset, u32& size, co
 bool ThreadedFileReader::Open(std::string fileName)
 {
 	CancelAndWaitUntilStopped();
-	return Open2(std::move(fileName));
+	StopWorkers();
+	if (!Open2(std::move(fileName)))
+		return false;
+	StartWorkers();
+	return true;
+}
+
+void ThreadedFileReader::SetDecompressThreads(u32 count)
+{
+	CancelAndWaitUntilStopped();
+	StopWorkers();
+	m_requestedWorkers = count;
+	// Subclasses return no contexts if nothing is open
+	StartWorkers();
+}
+
+ThreadedFileReader::DecompressStats ThreadedFileReader::GetDecompressStats() const
+{
+	DecompressStats stats;
+	stats.chunksDecoded = m_chunksDecoded.load(std::memory_order_relaxed);
+	stats.readaheadHits = m_readaheadHits.load(std::memory_order_relaxed);
+	stats.waitTime = m_waitTime.load(std::memory_order_relaxed);
+	stats.requests = m_requests.load(std::memory_order_relaxed);
+	stats.prefetchHits = m_prefetchHits.load(std::memory_order_relaxed);
+	return stats;
 }
 
 int ThreadedFileReader::ReadSync(void* pBuffer, uint sector, uint count)
@@ -252,7 +582,11 @@ int ThreadedFileReader::ReadSync(void* pBuffer, uint sector, uint count)
 	u32 size = count * blocksize;
 	{
 		std::lock_guard<std::mutex> l(m_mtx);
-		if (TryCachedRead(pBuffer, offset, size, l))
+		const u64 begin = offset;
+		const u64 end = offset + size;
+		const bool allDone = TryCachedRead(pBuffer, offset, size, l);
+		RecordRequest(begin, end, size == 0, l);
+		if (allDone)
 			return m_amtRead;
 
 		if (size > 0 && !m_running)
@@ -292,6 +626,8 @@ void ThreadedFileReader::CancelAndWaitUntilStopped(void)
 	std::unique_lock<std::mutex> lock(m_mtx);
 	while (m_running)
 		m_condition.wait(lock);
+	// Drop any readahead still queued, else the thread would start on it as soon as we let go of the lock
+	m_requestSize = 0;
 }
 
 void ThreadedFileReader::BeginRead(void* pBuffer, uint sector, uint count)
@@ -301,7 +637,11 @@ void ThreadedFileReader::BeginRead(void* pBuffer, uint sector, uint count)
 	u32 size = count * blocksize;
 	{
 		std::lock_guard<std::mutex> l(m_mtx);
-		if (TryCachedRead(pBuffer, offset, size, l))
+		const u64 begin = offset;
+		const u64 end = offset + size;
+		const bool allDone = TryCachedRead(pBuffer, offset, size, l);
+		RecordRequest(begin, end, size == 0, l);
+		if (allDone)
 			return;
 		if (size == 0)
 		{
@@ -344,6 +684,21 @@ void ThreadedFileReader::CancelRead(void)
 void ThreadedFileReader::Close(void)
 {
 	CancelAndWaitUntilStopped();
+	const DecompressStats stats = GetDecompressStats();
+	if (stats.requests)
+	{
+		DevCon.WriteLn("ThreadedFileReader: %" PRIu64 " of %" PRIu64 " reads served from readahead",
+			stats.prefetchHits, stats.requests);
+	}
+	if (!m_workers.empty())
+	{
+		DevCon.WriteLn("ThreadedFileReader: %" PRIu64 " chunks decoded by workers, %" PRIu64 " readahead hits, %.2f ms waiting",
+			stats.chunksDecoded, stats.readaheadHits, stats.waitTime / 1000000.0);
+	}
+	StopWorkers();
+	m_historyCount = 0;
+	m_historyPos = 0;
+	m_cachedReadCount = 0;
 	for (auto& buf : m_buffer)
 		buf.size.store(0, std::memory_order_relaxed);
 	Close2();
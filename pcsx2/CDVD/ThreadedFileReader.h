@@ -16,12 +16,14 @@
 #pragma once
 
 #include "AsyncFileReader.h"
+#include "PerformanceMetrics.h"
 #include "common/PersistentThread.h"
 
 #include <thread>
 #include <mutex>
 #include <atomic>
 #include <condition_variable>
+#include <vector>
 
 /// A file reader for use with compressed formats
 /// Calls decompression code on a separate thread to make a synchronous decompression API async
@@ -51,6 +53,15 @@ protected:
 	/// AsyncFileReader close but ThreadedFileReader needs prep work first
 	virtual void Close2(void) = 0;
 
+	/// Create up to `count` independent decompression contexts for the worker pool
+	/// Returns the number created, 0 if the format can't be decompressed in parallel
+	virtual u32 CreateWorkerContexts(u32 count) { return 0; }
+	/// Destroy the contexts created by CreateWorkerContexts
+	virtual void DestroyWorkerContexts() {}
+	/// Synchronously read the given block into `dst` using the given worker context
+	/// May be called concurrently with ReadChunk and with other worker contexts
+	virtual int ReadChunkWorker(void* dst, s64 chunkID, u32 worker) { return -1; }
+
 	ThreadedFileReader();
 	~ThreadedFileReader();
 
@@ -78,6 +89,67 @@ private:
 	Buffer m_buffer[2];
 	u32 m_nextBuffer = 0;
 
+	enum class SlotState : u8
+	{
+		Empty,
+		Queued,
+		Decoding,
+		Ready,
+	};
+	/// A chunk decoded (or waiting to be decoded) by the worker pool
+	struct PoolSlot
+	{
+		void* ptr = nullptr;
+		u32 cap = 0;
+		u32 size = 0;
+		u32 length = 0;
+		s64 chunkID = -1;
+		SlotState state = SlotState::Empty;
+	};
+	/// Ring of chunks after the current request, decoded out of order by the workers
+	std::vector<PoolSlot> m_slots;
+	std::vector<std::thread> m_workers;
+	/// Number of workers to start when a file is opened
+	u32 m_requestedWorkers = 0;
+	/// Protects `m_slots`, separate from `m_mtx` so the workers never hold up requests
+	std::mutex m_poolMtx;
+	/// Signalled when a slot is queued
+	std::condition_variable m_poolWork;
+	/// Signalled when a slot finishes decoding
+	std::condition_variable m_poolDone;
+	bool m_poolQuit = false;
+
+	/// Pool readahead stops at this offset, so requests we don't expect to continue don't queue extra chunks
+	/// Protected by `m_poolMtx`
+	u64 m_poolLimit = UINT64_MAX;
+
+	std::atomic<u64> m_chunksDecoded{0};
+	std::atomic<u64> m_readaheadHits{0};
+	std::atomic<u64> m_waitTime{0};
+
+	using AccessPattern = PerformanceMetrics::CDVDAccessPattern;
+	struct AccessRecord
+	{
+		u64 begin;
+		u64 end;
+	};
+	/// Most recent reads, oldest first from `m_historyPos`
+	/// Only touched by the read thread
+	static constexpr u32 ACCESS_HISTORY = 8;
+	AccessRecord m_history[ACCESS_HISTORY];
+	u32 m_historyCount = 0;
+	u32 m_historyPos = 0;
+	/// Where the next read should start and how big it'll be if the current pattern is strided
+	u64 m_strideNext = 0;
+	u64 m_strideSize = 0;
+	/// Reads served from the readahead buffers since the read thread last looked, so it still sees them
+	/// Protected by `m_mtx`
+	AccessRecord m_cachedReads[ACCESS_HISTORY];
+	u32 m_cachedReadCount = 0;
+
+	std::atomic<u64> m_requests{0};
+	std::atomic<u64> m_prefetchHits{0};
+
 	std::thread m_readThread;
 	std::mutex m_mtx;
 	std::condition_variable m_condition;
@@ -96,9 +168,32 @@ private:
 
 	/// Main loop of read thread
 	void Loop();
+	/// Main loop of decompression pool workers
+	void WorkerLoop(u32 worker);
+
+	/// Start the decompression pool if requested and supported by the subclass
+	void StartWorkers();
+	/// Stop the decompression pool and release its contexts
+	void StopWorkers();
+	/// Find the pool slot holding or decoding the given chunk
+	PoolSlot* FindSlot(s64 chunkID);
+	/// Check whether a readahead buffer already holds the given chunk
+	bool IsBuffered(const Chunk& chunk) const;
+	/// Queue the chunks starting at `offset` and before `m_poolLimit` for decoding by the pool, recycling slots outside of that window
+	void QueuePoolReadahead(u64 offset, const std::unique_lock<std::mutex>& lock);
+	/// Read the given chunk, taking it from the pool if a worker already decoded it
+	int ReadChunkPooled(void* dst, const Chunk& chunk);
+
+	/// Add a read to the access history
+	void AddAccess(u64 begin, u64 end);
+	/// Classify the reads in the access history
+	AccessPattern ClassifyAccess();
+	/// Count a read for the prefetch hit rate, and remember it for the read thread if it didn't reach it
+	void RecordRequest(u64 begin, u64 end, bool prefetched, const std::lock_guard<std::mutex>&);
 
 	/// Load the given block into one of the `m_buffer` buffers if necessary and return a pointer to its contents if successful
-	Buffer* GetBlockPtr(const Chunk& block);
+	/// A newly loaded buffer has room for at least `minSize` bytes so readahead can append to it
+	Buffer* GetBlockPtr(const Chunk& block, u32 minSize = 0);
 	/// Decompress from offset to size into
 	bool Decompress(void* ptr, u64 offset, u32 size);
 	/// Cancel any inflight read and wait until the thread is no longer doing anything
@@ -109,6 +204,24 @@ private:
 	bool TryCachedRead(void*& buffer, u64& offset, u32& size, const std::lock_guard<std::mutex>&);
 
 public:
+	struct DecompressStats
+	{
+		/// Chunks decoded by pool workers
+		u64 chunksDecoded;
+		/// Reads satisfied by a chunk the pool had already decoded
+		u64 readaheadHits;
+		/// Time spent waiting for a worker to finish a chunk that was needed, in nanoseconds
+		u64 waitTime;
+		/// Reads requested by the emulator
+		u64 requests;
+		/// Reads served entirely from the readahead buffers
+		u64 prefetchHits;
+	};
+
+	/// Set the number of decompression pool workers, 0 to decompress on the read thread only
+	void SetDecompressThreads(u32 count);
+	DecompressStats GetDecompressStats() const;
+
 	bool Open(std::string fileName) final override;
 	int ReadSync(void* pBuffer, uint sector, uint count) final override;
 	void BeginRead(void* pBuffer, uint sector, uint count) final override;
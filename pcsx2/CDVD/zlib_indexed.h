@@ -48,6 +48,9 @@ Comments) 1950 to 1952 in the files http://tools.ietf.org/html/rfc1950
   - extract: added state import/export for instant sequential access regardless of index
       (Thanks to Mark Adler for suggesting the approach)
   - build_index(...) - added progress prints
+  - build_index(...) - optionally shares the access points as they are found (struct shared_access),
+      so the index can be used by other threads before it's complete
+  - build_index(...) - optionally stops once a given amount of uncompressed data has been scanned
   - CHUNK changed from 16k to 512k
  */
 
@@ -109,6 +112,9 @@ Comments) 1950 to 1952 in the files http://tools.ietf.org/html/rfc1950
 
 #include "common/FileSystem.h"
 
+#include <condition_variable>
+#include <mutex>
+
 #define local static
 
 //#define SPAN (1048576L)  /* desired distance between access points */
@@ -155,6 +161,17 @@ typedef struct access Access;
 #pragma pack(pop, indexData)
 #endif
 
+/* Lets other threads use the access points while build_index() is still finding them.
+   Fields are protected by lock, and cond is signalled whenever build_index() updates them. */
+struct shared_access
+{
+	std::mutex lock;
+	std::condition_variable cond;
+	struct access* index = nullptr; /* access points found so far, NULL if the build failed */
+	s64 scanned = 0;                /* uncompressed bytes scanned, access points after this are final */
+	bool cancel = false;            /* set to make build_index() give up with Z_ERRNO */
+};
+
 /* Deallocate an index built by build_index() */
 local void free_index(struct access* index)
 {
@@ -223,8 +240,11 @@ local struct access* addpoint(struct access* index, int bits,
    of the first zlib or gzip stream in the file is ignored.  build_index()
    returns the number of access points on success (>= 1), Z_MEM_ERROR for out
    of memory, Z_DATA_ERROR for an error in the input file, or Z_ERRNO for a
-   file read error.  On success, *built points to the resulting index. */
-local int build_index(FILE* in, s64 span, struct access** built)
+   file read error.  On success, *built points to the resulting index.  If shared
+   is given, the index is also published there as it grows.  If limit is not
+   negative, the build stops at the first access point at or after limit, and
+   uncompressed_size is only how far it got. */
+local int build_index(FILE* in, s64 span, struct access** built, struct shared_access* shared = nullptr, s64 limit = -1)
 {
 	int ret;
 	s64 totin, totout, totPrinted; /* our own total counters to avoid 4GB limit */
@@ -302,14 +322,29 @@ local int build_index(FILE* in, s64 span, struct access** built)
 			if ((strm.data_type & 128) && !(strm.data_type & 64) &&
 				(totout == 0 || totout - last > span))
 			{
+				if (shared)
+					shared->lock.lock();
 				index = addpoint(index, strm.data_type & 7, totin,
 								 totout, strm.avail_out, window);
+				if (shared)
+				{
+					/* the list may have moved, nobody can be using the old one while we hold the lock */
+					shared->index = index;
+					shared->scanned = totout;
+					shared->lock.unlock();
+					shared->cond.notify_all();
+				}
 				if (index == NULL)
 				{
 					ret = Z_MEM_ERROR;
 					goto build_index_error;
 				}
 				last = totout;
+				if (limit >= 0 && totout >= limit)
+				{
+					ret = Z_STREAM_END;
+					break;
+				}
 			}
 		} while (strm.avail_in != 0);
 		if (totin / (50 * 1024 * 1024) != totPrinted / (50 * 1024 * 1024))
@@ -317,6 +352,21 @@ local int build_index(FILE* in, s64 span, struct access** built)
 			printf("%dMB ", (int)(totin / (1024 * 1024)));
 			totPrinted = totin;
 		}
+		if (shared)
+		{
+			bool cancel;
+			{
+				std::lock_guard<std::mutex> lock(shared->lock);
+				shared->scanned = totout;
+				cancel = shared->cancel;
+			}
+			shared->cond.notify_all();
+			if (cancel)
+			{
+				ret = Z_ERRNO;
+				goto build_index_error;
+			}
+		}
 	} while (ret != Z_STREAM_END);
 
 	if (index == NULL)
@@ -327,16 +377,30 @@ local int build_index(FILE* in, s64 span, struct access** built)
 
 	/* clean up and return index (release unused entries in list) */
 	(void)inflateEnd(&strm);
+	if (shared)
+		shared->lock.lock();
 	index->list = (Point*)realloc(index->list, sizeof(struct point) * index->have);
 	index->size = index->have;
 	index->span = span;
 	index->uncompressed_size = totout;
 	*built = index;
+	if (shared)
+	{
+		shared->index = index;
+		shared->scanned = totout;
+		shared->lock.unlock();
+		shared->cond.notify_all();
+	}
 	return index->have;
 
 	/* return error */
 build_index_error:
 	(void)inflateEnd(&strm);
+	if (shared)
+	{
+		std::lock_guard<std::mutex> lock(shared->lock);
+		shared->index = NULL;
+	}
 	if (index != NULL)
 		free_index(index);
 	return ret;
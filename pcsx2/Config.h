@@ -187,6 +187,12 @@ enum class TexturePreloadingLevel : u8
 	Full,
 };
 
+enum class GSDumpCompressionMethod : u8
+{
+	LZMA,
+	Zstandard,
+};
+
 // Template function for casting enumerations to their underlying type
 template <typename Enumeration>
 typename std::underlying_type<Enumeration>::type enum_cast(Enumeration E)
@@ -439,6 +445,7 @@ struct Pcsx2Config
 					GPUPaletteConversion : 1,
 					ConservativeFramebuffer : 1,
 					AutoFlushSW : 1,
+					SWTileBinning : 1,
 					PreloadFrameWithGSData : 1,
 					WrapGSMem : 1,
 					Mipmap : 1,
@@ -507,6 +514,7 @@ struct Pcsx2Config
 		CRCHackLevel CRCHack{CRCHackLevel::Automatic};
 		BiFiltering TextureFiltering{BiFiltering::PS2};
 		TexturePreloadingLevel TexturePreloading{TexturePreloadingLevel::Off};
+		GSDumpCompressionMethod GSDumpCompression{GSDumpCompressionMethod::LZMA};
 		int Dithering{2};
 		int MaxAnisotropy{0};
 		int SWExtraThreads{2};
@@ -880,6 +888,8 @@ struct Pcsx2Config
 		CdvdVerboseReads : 1, // enables cdvd read activity verbosely dumped to the console
 		CdvdDumpBlocks : 1, // enables cdvd block dumping
 		CdvdShareWrite : 1, // allows the iso to be modified while it's loaded
+		CdvdMapImages : 1, // memory maps uncompressed images, off uses FlatFileReader (io_uring on Linux) instead
+		CdvdBootPrefetch : 1, // records the sectors read while booting, and prefetches them next time
 		EnablePatches : 1, // enables patch detection and application
 		EnableCheats : 1, // enables cheat detection and application
 		EnablePINE : 1, // enables inter-process communication
@@ -924,6 +934,9 @@ struct Pcsx2Config
 	// slots (3 each)
 	McdOptions Mcd[8];
 	std::string GzipIsoIndexTemplate; // for quick-access index with gzipped ISO
+	uint CdvdDecompressThreads; // extra threads decompressing CSO/CHD chunks ahead of reads, 0 to disable
+	uint CdvdChdCacheSize; // megabytes of decoded CHD hunks to keep, 0 to disable
+	uint CdvdChdPrefetchHunks; // CHD hunks decoded into the cache in the background after a miss, 0 to disable
 
 	// Set at runtime, not loaded from config.
 	std::string CurrentBlockdump;
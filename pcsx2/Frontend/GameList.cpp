@@ -20,31 +20,41 @@
 #include "common/Assertions.h"
 #include "common/Console.h"
 #include "common/FileSystem.h"
+#include "common/MappedFile.h"
 #include "common/ProgressCallback.h"
 #include "common/StringUtil.h"
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cctype>
+#include <condition_variable>
 #include <cstdio>
+#include <cstring>
 #include <ctime>
 #include <fstream>
+#include <mutex>
 #include <string_view>
+#include <thread>
+#include <unordered_set>
 #include <utility>
 
 #include "CDVD/CDVD.h"
+#include "CDVD/IsoFileFormats.h"
+#include "CDVD/IsoFS/IsoFS.h"
 #include "Elfheader.h"
 #include "VMManager.h"
 
 enum : u32
 {
 	GAME_LIST_CACHE_SIGNATURE = 0x45434C47,
-	GAME_LIST_CACHE_VERSION = 31
+	GAME_LIST_CACHE_VERSION = 32
 };
 
+// Every image being scanned has its own reader threads, so don't open too many at once
+static constexpr u32 MAX_SCAN_THREADS = 8;
+
 namespace GameList
 {
-	using CacheMap = std::unordered_map<std::string, GameList::Entry>;
-
 	static Entry* GetMutableEntryForPath(const char* path);
 
 	static bool GetElfListEntry(const std::string& path, GameList::Entry* entry);
@@ -55,12 +65,10 @@ namespace GameList
 		ProgressCallback* progress);
 	static bool AddFileFromCache(const std::string& path, std::time_t timestamp);
 	static bool ScanFile(std::string path, std::time_t timestamp);
+	static void ScanFiles(std::vector<FILESYSTEM_FIND_DATA*>& files, ProgressCallback* progress);
 
 	static void LoadCache();
-	static bool LoadEntriesFromCache(std::FILE* stream);
-	static bool OpenCacheForWriting();
-	static bool WriteEntryToCache(const GameList::Entry* entry);
-	static void CloseCacheFileStream();
+	static void SaveCache(bool keep_unused);
 	static void DeleteCacheFile();
 
 	static void LoadDatabase();
@@ -68,8 +76,8 @@ namespace GameList
 
 static std::vector<GameList::Entry> m_entries;
 static std::recursive_mutex s_mutex;
-static GameList::CacheMap m_cache_map;
-static std::FILE* m_cache_write_stream = nullptr;
+// Set when files were scanned and the cache needs writing out again, protected by s_mutex
+static bool s_cache_dirty = false;
 
 static bool m_game_list_loaded = false;
 
@@ -104,7 +112,7 @@ const char* GameList::EntryCompatibilityRatingToString(CompatibilityRating ratin
 
 bool GameList::IsScannableFilename(const std::string& path)
 {
-	static const char* extensions[] = {".iso", ".mdf", ".nrg", ".bin", ".img", ".gz", ".cso", ".chd", ".elf", ".irx"};
+	static const char* extensions[] = {".iso", ".mdf", ".nrg", ".bin", ".img", ".gz", ".cso", ".zso", ".chd", ".elf", ".irx"};
 
 	const std::string::size_type pos = path.rfind('.');
 	if (pos == std::string::npos)
@@ -169,6 +177,46 @@ bool GameList::GetElfListEntry(const std::string& path, GameList::Entry* entry)
 	return true;
 }
 
+namespace
+{
+	// Reads the filesystem of an image directly, so images can be scanned on any thread
+	class IsoFileSectorSource final : public SectorSource
+	{
+	public:
+		explicit IsoFileSectorSource(InputIsoFile& iso)
+			: m_iso(iso)
+		{
+		}
+
+		int getNumSectors() override
+		{
+			return static_cast<int>(m_iso.GetBlockCount());
+		}
+
+		bool readSector(unsigned char* buffer, int lba) override
+		{
+			if (lba < 0 || static_cast<uint>(lba) >= m_iso.GetBlockCount())
+				return false;
+
+			u8 raw[CD_FRAMESIZE_RAW];
+			if (m_iso.ReadSync(raw, static_cast<uint>(lba)) < 0)
+				return false;
+
+			std::memcpy(buffer, raw + 24, 2048);
+			return true;
+		}
+
+		IsoDirectoryCache* getDirectoryCache() override
+		{
+			return &m_directoryCache;
+		}
+
+	private:
+		InputIsoFile& m_iso;
+		IsoDirectoryCache m_directoryCache;
+	};
+} // namespace
+
 bool GameList::GetGameListEntry(const std::string& path, GameList::Entry* entry)
 {
 	if (VMManager::IsElfFileName(path.c_str()))
@@ -178,12 +226,26 @@ bool GameList::GetGameListEntry(const std::string& path, GameList::Entry* entry)
 	if (!FileSystem::StatFile(path.c_str(), &sd))
 		return false;
 
-	// This isn't great, we really want to make it all thread-local...
-	CDVD = &CDVDapi_Iso;
-	if (CDVD->open(path.c_str()) != 0)
+	// Scanner threads have small stacks, and InputIsoFile's read buffer alone is over 300KB
+	const std::unique_ptr<InputIsoFile> iso = std::make_unique<InputIsoFile>();
+	try
+	{
+		if (!iso->Open(path, false, true))
+			return false;
+	}
+	catch (Exception::BaseException& e)
+	{
+		Console.Error("Failed to open '%s': %s", path.c_str(),
+			StringUtil::wxStringToUTF8String(e.FormatDiagnosticMessage()).c_str());
 		return false;
+	}
 
-	const s32 type = DoCDVDdetectDiskType();
+	// Audio discs don't have a filesystem to look at
+	if (iso->GetType() == ISOTYPE_AUDIO || iso->GetType() == ISOTYPE_ILLEGAL)
+		return false;
+
+	IsoFileSectorSource source(*iso);
+	const s32 type = DoCDVDdetectDiskTypeFS(source, (iso->GetType() == ISOTYPE_CD) ? CDVD_TYPE_DETCTCD : CDVD_TYPE_DETCTDVDS);
 	switch (type)
 	{
 		case CDVD_TYPE_PSCD:
@@ -199,26 +261,16 @@ bool GameList::GetGameListEntry(const std::string& path, GameList::Entry* entry)
 
 		case CDVD_TYPE_ILLEGAL:
 		default:
-			DoCDVDclose();
 			return false;
 	}
 
-	cdvdReloadElfInfo(wxEmptyString);
-
 	entry->path = path;
-	entry->serial = StringUtil::wxStringToUTF8String(DiscSerial);
-	entry->crc = ElfCRC;
+	entry->serial.clear();
+	entry->crc = 0;
+	cdvdGetElfInfo(source, &entry->serial, &entry->crc);
 	entry->total_size = sd.Size;
 	entry->compatibility_rating = CompatibilityRating::Unknown;
 
-	DoCDVDclose();
-
-	// TODO(Stenzek): These globals are **awful**. Clean it up.
-	DiscSerial.clear();
-	ElfCRC = 0;
-	ElfEntry = -1;
-	LastELF.clear();
-
 	if (const GameDatabaseSchema::GameEntry* db_entry = GameDatabase::findGame(entry->serial))
 	{
 		entry->title = std::move(db_entry->name);
@@ -241,114 +293,161 @@ bool GameList::GetGameListEntry(const std::string& path, GameList::Entry* entry)
 	return true;
 }
 
-bool GameList::GetGameListEntryFromCache(const std::string& path, GameList::Entry* entry)
+namespace
 {
-	auto iter = m_cache_map.find(path);
-	if (iter == m_cache_map.end())
-		return false;
-
-	*entry = std::move(iter->second);
-	m_cache_map.erase(iter);
-	return true;
-}
-
-static bool ReadString(std::FILE* stream, std::string* dest)
-{
-	u32 size;
-	if (std::fread(&size, sizeof(size), 1, stream) != 1)
-		return false;
+	// The cache is mapped and entries are looked up in place, so it's laid out as a header, a fixed
+	// size record per entry, an open addressed hash table of record indices keyed on the path,
+	// and the strings of all the records.
+	struct CacheHeader
+	{
+		u32 signature;
+		u32 version;
+		u32 num_records;
+		u32 num_buckets;
+		u64 records_offset;
+		u64 buckets_offset;
+		u64 strings_offset;
+		u64 strings_size;
+	};
+	static_assert(sizeof(CacheHeader) == 48);
+
+	struct CacheRecord
+	{
+		u64 path_hash;
+		u64 total_size;
+		u64 last_modified_time;
+		u32 path_offset;
+		u32 path_length;
+		u32 serial_offset;
+		u32 serial_length;
+		u32 title_offset;
+		u32 title_length;
+		u32 crc;
+		u8 type;
+		u8 region;
+		u8 compatibility_rating;
+		u8 pad;
+	};
+	static_assert(sizeof(CacheRecord) == 56);
 
-	dest->resize(size);
-	if (size > 0 && std::fread(dest->data(), size, 1, stream) != 1)
-		return false;
+	static constexpr u32 CACHE_EMPTY_BUCKET = 0xFFFFFFFFu;
+} // namespace
 
-	return true;
-}
+static Common::MappedFile s_cache_file;
 
-static bool ReadU8(std::FILE* stream, u8* dest)
+// FNV-1a, the hashes are stored in the file so they have to be the same in every build
+static u64 HashCachePath(const std::string_view& path)
 {
-	return std::fread(dest, sizeof(u8), 1, stream) > 0;
+	u64 hash = 0xCBF29CE484222325ULL;
+	for (const char ch : path)
+	{
+		hash ^= static_cast<u8>(ch);
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
 }
 
-static bool ReadU32(std::FILE* stream, u32* dest)
+static const CacheHeader* GetCacheHeader()
 {
-	return std::fread(dest, sizeof(u32), 1, stream) > 0;
+	return s_cache_file.IsOpen() ? reinterpret_cast<const CacheHeader*>(s_cache_file.GetData()) : nullptr;
 }
 
-static bool ReadU64(std::FILE* stream, u64* dest)
+static const CacheRecord* GetCacheRecords(const CacheHeader* header)
 {
-	return std::fread(dest, sizeof(u64), 1, stream) > 0;
+	return reinterpret_cast<const CacheRecord*>(s_cache_file.GetData() + header->records_offset);
 }
 
-static bool WriteString(std::FILE* stream, const std::string& str)
+static const u32* GetCacheBuckets(const CacheHeader* header)
 {
-	const u32 size = static_cast<u32>(str.size());
-	return (std::fwrite(&size, sizeof(size), 1, stream) > 0 &&
-			(size == 0 || std::fwrite(str.data(), size, 1, stream) > 0));
+	return reinterpret_cast<const u32*>(s_cache_file.GetData() + header->buckets_offset);
 }
 
-static bool WriteU8(std::FILE* stream, u8 dest)
+static bool GetCacheString(const CacheHeader* header, u32 offset, u32 length, std::string_view* dest)
 {
-	return std::fwrite(&dest, sizeof(u8), 1, stream) > 0;
-}
+	if (static_cast<u64>(offset) + length > header->strings_size)
+		return false;
 
-static bool WriteU32(std::FILE* stream, u32 dest)
-{
-	return std::fwrite(&dest, sizeof(u32), 1, stream) > 0;
+	*dest = std::string_view(reinterpret_cast<const char*>(s_cache_file.GetData() + header->strings_offset + offset), length);
+	return true;
 }
 
-static bool WriteU64(std::FILE* stream, u64 dest)
+static bool ValidateCache()
 {
-	return std::fwrite(&dest, sizeof(u64), 1, stream) > 0;
+	const size_t size = s_cache_file.GetSize();
+	if (size < sizeof(CacheHeader))
+		return false;
+
+	const CacheHeader* header = GetCacheHeader();
+	if (header->signature != GAME_LIST_CACHE_SIGNATURE || header->version != GAME_LIST_CACHE_VERSION)
+		return false;
+
+	// Lookups stop at an empty bucket, so there has to be at least one
+	if (header->num_buckets == 0 || (header->num_buckets & (header->num_buckets - 1)) != 0 ||
+		header->num_buckets <= header->num_records)
+	{
+		return false;
+	}
+
+	const u64 records_size = static_cast<u64>(header->num_records) * sizeof(CacheRecord);
+	const u64 buckets_size = static_cast<u64>(header->num_buckets) * sizeof(u32);
+	return ((header->records_offset % alignof(CacheRecord)) == 0 && (header->buckets_offset % alignof(u32)) == 0 &&
+			header->records_offset >= sizeof(CacheHeader) && header->records_offset + records_size <= size &&
+			header->buckets_offset >= sizeof(CacheHeader) && header->buckets_offset + buckets_size <= size &&
+			header->strings_offset >= sizeof(CacheHeader) && header->strings_size <= size &&
+			header->strings_offset <= size - header->strings_size);
 }
 
-bool GameList::LoadEntriesFromCache(std::FILE* stream)
+static bool ReadCacheRecord(const CacheHeader* header, const CacheRecord& record, GameList::Entry* entry)
 {
-	u32 file_signature, file_version;
-	s64 start_pos, file_size;
-	if (!ReadU32(stream, &file_signature) || !ReadU32(stream, &file_version) ||
-		file_signature != GAME_LIST_CACHE_SIGNATURE || file_version != GAME_LIST_CACHE_VERSION ||
-		(start_pos = FileSystem::FTell64(stream)) < 0 || FileSystem::FSeek64(stream, 0, SEEK_END) != 0 ||
-		(file_size = FileSystem::FTell64(stream)) < 0 || FileSystem::FSeek64(stream, start_pos, SEEK_SET) != 0)
+	std::string_view path, serial, title;
+	if (!GetCacheString(header, record.path_offset, record.path_length, &path) ||
+		!GetCacheString(header, record.serial_offset, record.serial_length, &serial) ||
+		!GetCacheString(header, record.title_offset, record.title_length, &title) ||
+		record.region >= static_cast<u8>(GameList::Region::Count) || record.type >= static_cast<u8>(GameList::EntryType::Count) ||
+		record.compatibility_rating > static_cast<u8>(GameList::CompatibilityRating::Perfect))
 	{
-		Console.Warning("Game list cache is corrupted");
+		Console.Warning("Game list cache entry is corrupted");
 		return false;
 	}
 
-	while (FileSystem::FTell64(stream) != file_size)
-	{
-		std::string path;
-		GameList::Entry ge;
+	entry->path = path;
+	entry->serial = serial;
+	entry->title = title;
+	entry->type = static_cast<GameList::EntryType>(record.type);
+	entry->region = static_cast<GameList::Region>(record.region);
+	entry->total_size = record.total_size;
+	entry->last_modified_time = static_cast<std::time_t>(record.last_modified_time);
+	entry->crc = record.crc;
+	entry->compatibility_rating = static_cast<GameList::CompatibilityRating>(record.compatibility_rating);
+	return true;
+}
 
-		u8 type;
-		u8 region;
-		u8 compatibility_rating;
-		u64 last_modified_time;
+bool GameList::GetGameListEntryFromCache(const std::string& path, GameList::Entry* entry)
+{
+	const CacheHeader* header = GetCacheHeader();
+	if (!header)
+		return false;
 
-		if (!ReadString(stream, &path) || !ReadString(stream, &ge.serial) || !ReadString(stream, &ge.title) ||
-			!ReadU8(stream, &type) || !ReadU8(stream, &region) || !ReadU64(stream, &ge.total_size) ||
-			!ReadU64(stream, &last_modified_time) || !ReadU32(stream, &ge.crc) || !ReadU8(stream, &compatibility_rating) ||
-			region >= static_cast<u8>(Region::Count) || type >= static_cast<u8>(EntryType::Count) ||
-			compatibility_rating > static_cast<u8>(CompatibilityRating::Perfect))
-		{
-			Console.Warning("Game list cache entry is corrupted");
+	const CacheRecord* records = GetCacheRecords(header);
+	const u32* buckets = GetCacheBuckets(header);
+	const u64 hash = HashCachePath(path);
+	const u32 mask = header->num_buckets - 1;
+	for (u32 i = 0, bucket = static_cast<u32>(hash) & mask; i < header->num_buckets; i++, bucket = (bucket + 1) & mask)
+	{
+		const u32 index = buckets[bucket];
+		if (index == CACHE_EMPTY_BUCKET || index >= header->num_records)
 			return false;
-		}
-
-		ge.path = path;
-		ge.region = static_cast<Region>(region);
-		ge.type = static_cast<EntryType>(type);
-		ge.compatibility_rating = static_cast<CompatibilityRating>(compatibility_rating);
-		ge.last_modified_time = static_cast<std::time_t>(last_modified_time);
 
-		auto iter = m_cache_map.find(ge.path);
-		if (iter != m_cache_map.end())
-			iter->second = std::move(ge);
-		else
-			m_cache_map.emplace(std::move(path), std::move(ge));
+		const CacheRecord& record = records[index];
+		std::string_view record_path;
+		if (record.path_hash == hash && GetCacheString(header, record.path_offset, record.path_length, &record_path) &&
+			record_path == path)
+		{
+			return ReadCacheRecord(header, record, entry);
+		}
 	}
 
-	return true;
+	return false;
 }
 
 static std::string GetCacheFilename()
@@ -359,95 +458,126 @@ static std::string GetCacheFilename()
 void GameList::LoadCache()
 {
 	const std::string cache_filename(GetCacheFilename());
-	auto stream = FileSystem::OpenManagedCFile(cache_filename.c_str(), "rb");
-	if (!stream)
+	if (!FileSystem::FileExists(cache_filename.c_str()))
 		return;
 
-	if (!LoadEntriesFromCache(stream.get()))
+	if (!s_cache_file.Open(cache_filename.c_str()))
+	{
+		Console.Warning("Failed to map game list cache '%s'", cache_filename.c_str());
+		return;
+	}
+
+	if (!ValidateCache())
 	{
 		Console.Warning("Deleting corrupted cache file '%s'", cache_filename.c_str());
-		stream.reset();
-		m_cache_map.clear();
+		s_cache_file.Close();
 		DeleteCacheFile();
-		return;
 	}
 }
 
-bool GameList::OpenCacheForWriting()
+void GameList::SaveCache(bool keep_unused)
 {
-	const std::string cache_filename(GetCacheFilename());
-	if (cache_filename.empty())
-		return false;
+	std::vector<const Entry*> entries;
+	entries.reserve(m_entries.size());
+	for (const Entry& entry : m_entries)
+		entries.push_back(&entry);
 
-	pxAssert(!m_cache_write_stream);
-	m_cache_write_stream = FileSystem::OpenCFile(cache_filename.c_str(), "r+b");
-	if (m_cache_write_stream)
+	// A cancelled scan didn't get to look at everything, so keep what it didn't get to
+	std::vector<Entry> unused_entries;
+	if (const CacheHeader* header = GetCacheHeader(); header && keep_unused)
 	{
-		// check the header
-		u32 signature, version;
-		if (ReadU32(m_cache_write_stream, &signature) && signature == GAME_LIST_CACHE_SIGNATURE &&
-			ReadU32(m_cache_write_stream, &version) && version == GAME_LIST_CACHE_VERSION &&
-			FileSystem::FSeek64(m_cache_write_stream, 0, SEEK_END) == 0)
+		std::unordered_set<std::string_view> paths;
+		for (const Entry& entry : m_entries)
+			paths.insert(entry.path);
+
+		const CacheRecord* records = GetCacheRecords(header);
+		unused_entries.reserve(header->num_records);
+		for (u32 i = 0; i < header->num_records; i++)
 		{
-			return true;
+			Entry entry;
+			if (ReadCacheRecord(header, records[i], &entry) && paths.find(entry.path) == paths.end())
+				unused_entries.push_back(std::move(entry));
 		}
-
-		std::fclose(m_cache_write_stream);
+		for (const Entry& entry : unused_entries)
+			entries.push_back(&entry);
 	}
 
-	Console.WriteLn("Creating new game list cache file: '%s'", cache_filename.c_str());
+	// Nothing to do if no files were scanned and none went away
+	if (!s_cache_dirty && GetCacheHeader() && GetCacheHeader()->num_records == entries.size())
+		return;
 
-	m_cache_write_stream = FileSystem::OpenCFile(cache_filename.c_str(), "w+b");
-	if (!m_cache_write_stream)
-		return false;
+	u32 num_buckets = 16;
+	while (num_buckets < entries.size() * 2)
+		num_buckets <<= 1;
 
+	std::vector<CacheRecord> records(entries.size());
+	std::vector<u32> buckets(num_buckets, CACHE_EMPTY_BUCKET);
+	std::string strings;
+	auto add_string = [&strings](const std::string& str, u32* offset, u32* length) {
+		*offset = static_cast<u32>(strings.size());
+		*length = static_cast<u32>(str.size());
+		strings.append(str);
+	};
 
-	// new cache file, write header
-	if (!WriteU32(m_cache_write_stream, GAME_LIST_CACHE_SIGNATURE) ||
-		!WriteU32(m_cache_write_stream, GAME_LIST_CACHE_VERSION))
+	for (size_t i = 0; i < entries.size(); i++)
 	{
-		Console.Error("Failed to write game list cache header");
-		std::fclose(m_cache_write_stream);
-		m_cache_write_stream = nullptr;
-		FileSystem::DeleteFilePath(cache_filename.c_str());
-		return false;
+		const Entry* entry = entries[i];
+		CacheRecord& record = records[i];
+		record = {};
+		record.path_hash = HashCachePath(entry->path);
+		record.total_size = entry->total_size;
+		record.last_modified_time = static_cast<u64>(entry->last_modified_time);
+		add_string(entry->path, &record.path_offset, &record.path_length);
+		add_string(entry->serial, &record.serial_offset, &record.serial_length);
+		add_string(entry->title, &record.title_offset, &record.title_length);
+		record.crc = entry->crc;
+		record.type = static_cast<u8>(entry->type);
+		record.region = static_cast<u8>(entry->region);
+		record.compatibility_rating = static_cast<u8>(entry->compatibility_rating);
+
+		u32 bucket = static_cast<u32>(record.path_hash) & (num_buckets - 1);
+		while (buckets[bucket] != CACHE_EMPTY_BUCKET)
+			bucket = (bucket + 1) & (num_buckets - 1);
+		buckets[bucket] = static_cast<u32>(i);
 	}
 
-	return true;
-}
-
-bool GameList::WriteEntryToCache(const Entry* entry)
-{
-	bool result = true;
-	result &= WriteString(m_cache_write_stream, entry->path);
-	result &= WriteString(m_cache_write_stream, entry->serial);
-	result &= WriteString(m_cache_write_stream, entry->title);
-	result &= WriteU8(m_cache_write_stream, static_cast<u8>(entry->type));
-	result &= WriteU8(m_cache_write_stream, static_cast<u8>(entry->region));
-	result &= WriteU64(m_cache_write_stream, entry->total_size);
-	result &= WriteU64(m_cache_write_stream, static_cast<u64>(entry->last_modified_time));
-	result &= WriteU32(m_cache_write_stream, entry->crc);
-	result &= WriteU8(m_cache_write_stream, static_cast<u8>(entry->compatibility_rating));
-
-	// flush after each entry, that way we don't end up with a corrupted file if we crash scanning.
-	if (result)
-		result = (std::fflush(m_cache_write_stream) == 0);
-
-	return result;
-}
-
-void GameList::CloseCacheFileStream()
-{
-	if (!m_cache_write_stream)
+	CacheHeader header = {};
+	header.signature = GAME_LIST_CACHE_SIGNATURE;
+	header.version = GAME_LIST_CACHE_VERSION;
+	header.num_records = static_cast<u32>(records.size());
+	header.num_buckets = num_buckets;
+	header.records_offset = sizeof(CacheHeader);
+	header.buckets_offset = header.records_offset + records.size() * sizeof(CacheRecord);
+	header.strings_offset = header.buckets_offset + buckets.size() * sizeof(u32);
+	header.strings_size = strings.size();
+
+	std::vector<u8> data(static_cast<size_t>(header.strings_offset + header.strings_size));
+	std::memcpy(data.data(), &header, sizeof(header));
+	std::memcpy(data.data() + header.records_offset, records.data(), records.size() * sizeof(CacheRecord));
+	std::memcpy(data.data() + header.buckets_offset, buckets.data(), buckets.size() * sizeof(u32));
+	std::memcpy(data.data() + header.strings_offset, strings.data(), strings.size());
+
+	// The old file can't be replaced while it's mapped on Windows
+	unused_entries.clear();
+	s_cache_file.Close();
+
+	// Write to a temporary file and move it over the old one, so a crash can't leave a half written cache
+	const std::string cache_filename(GetCacheFilename());
+	const std::string temp_filename(cache_filename + ".tmp");
+	if (!FileSystem::WriteBinaryFile(temp_filename.c_str(), data.data(), data.size()) ||
+		!FileSystem::RenamePath(temp_filename.c_str(), cache_filename.c_str()))
+	{
+		Console.Error("Failed to write game list cache '%s'", cache_filename.c_str());
+		FileSystem::DeleteFilePath(temp_filename.c_str());
 		return;
+	}
 
-	std::fclose(m_cache_write_stream);
-	m_cache_write_stream = nullptr;
+	DevCon.WriteLn("Wrote %u entries to game list cache", header.num_records);
 }
 
 void GameList::DeleteCacheFile()
 {
-	pxAssert(!m_cache_write_stream);
+	pxAssert(!s_cache_file.IsOpen());
 
 	const std::string cache_filename(GetCacheFilename());
 	if (cache_filename.empty() || !FileSystem::FileExists(cache_filename.c_str()))
@@ -481,6 +611,8 @@ void GameList::ScanDirectory(const char* path, bool recursive, const std::vector
 	progress->SetProgressRange(static_cast<u32>(files.size()));
 	progress->SetProgressValue(0);
 
+	// Cached files are added straight away, the rest are opened on the scan threads
+	std::vector<FILESYSTEM_FIND_DATA*> to_scan;
 	for (FILESYSTEM_FIND_DATA& ffd : files)
 	{
 		if (progress->IsCancelled() || !GameList::IsScannableFilename(ffd.FileName) ||
@@ -498,16 +630,80 @@ void GameList::ScanDirectory(const char* path, bool recursive, const std::vector
 				continue;
 		}
 
-		// ownership of fp is transferred
-		progress->SetFormattedStatusText("Scanning '%s'...", FileSystem::GetDisplayNameFromPath(ffd.FileName).c_str());
-		ScanFile(std::move(ffd.FileName), ffd.ModificationTime);
-		progress->IncrementProgressValue();
+		to_scan.push_back(&ffd);
 	}
 
+	progress->SetProgressValue(static_cast<u32>(files.size() - to_scan.size()));
+	if (!to_scan.empty() && !progress->IsCancelled())
+		ScanFiles(to_scan, progress);
+
 	progress->SetProgressValue(static_cast<u32>(files.size()));
 	progress->PopState();
 }
 
+void GameList::ScanFiles(std::vector<FILESYSTEM_FIND_DATA*>& files, ProgressCallback* progress)
+{
+	const u32 num_threads = std::clamp<u32>(std::thread::hardware_concurrency(), 1u,
+		std::min<u32>(MAX_SCAN_THREADS, static_cast<u32>(files.size())));
+	DevCon.WriteLn("Scanning %zu files on %u threads", files.size(), num_threads);
+
+	std::atomic<size_t> next_file{0};
+	std::atomic<bool> cancelled{false};
+
+	// Progress can only be reported from this thread, so the scan threads just count what they finish
+	std::mutex done_mutex;
+	std::condition_variable done_cv;
+	u32 files_done = 0;
+	u32 threads_running = num_threads;
+	std::string last_file;
+
+	auto worker = [&]() {
+		for (size_t i = next_file++; i < files.size() && !cancelled.load(std::memory_order_relaxed); i = next_file++)
+		{
+			FILESYSTEM_FIND_DATA* ffd = files[i];
+			std::string display_name(FileSystem::GetDisplayNameFromPath(ffd->FileName));
+			ScanFile(std::move(ffd->FileName), ffd->ModificationTime);
+
+			std::unique_lock lock(done_mutex);
+			files_done++;
+			last_file = std::move(display_name);
+			done_cv.notify_one();
+		}
+
+		std::unique_lock lock(done_mutex);
+		threads_running--;
+		done_cv.notify_one();
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(num_threads);
+	for (u32 i = 0; i < num_threads; i++)
+		threads.emplace_back(worker);
+
+	{
+		u32 files_reported = 0;
+		std::unique_lock lock(done_mutex);
+		while (threads_running > 0)
+		{
+			// Wake up now and then even if nothing finished, so cancelling doesn't wait for a slow image
+			done_cv.wait_for(lock, std::chrono::milliseconds(100));
+
+			if (files_reported != files_done)
+			{
+				progress->SetFormattedStatusText("Scanning '%s'...", last_file.c_str());
+				for (; files_reported < files_done; files_reported++)
+					progress->IncrementProgressValue();
+			}
+
+			if (progress->IsCancelled())
+				cancelled.store(true, std::memory_order_relaxed);
+		}
+	}
+
+	for (std::thread& thread : threads)
+		thread.join();
+}
+
 bool GameList::AddFileFromCache(const std::string& path, std::time_t timestamp)
 {
 	if (std::any_of(m_entries.begin(), m_entries.end(), [&path](const Entry& other) { return other.path == path; }))
@@ -535,14 +731,9 @@ bool GameList::ScanFile(std::string path, std::time_t timestamp)
 	entry.path = std::move(path);
 	entry.last_modified_time = timestamp;
 
-	if (m_cache_write_stream || OpenCacheForWriting())
-	{
-		if (!WriteEntryToCache(&entry))
-			Console.Warning("Failed to write entry '%s' to cache", entry.path.c_str());
-	}
-
 	std::unique_lock lock(s_mutex);
 	m_entries.push_back(std::move(entry));
+	s_cache_dirty = true;
 	return true;
 }
 
@@ -614,6 +805,7 @@ void GameList::Refresh(bool invalidate_cache, ProgressCallback* progress /* = nu
 	if (!progress)
 		progress = ProgressCallback::NullProgressCallback;
 
+	s_cache_dirty = false;
 	if (invalidate_cache)
 		DeleteCacheFile();
 	else
@@ -655,9 +847,10 @@ void GameList::Refresh(bool invalidate_cache, ProgressCallback* progress /* = nu
 		}
 	}
 
-	// don't need unused cache entries
-	CloseCacheFileStream();
-	m_cache_map.clear();
+	// unused cache entries are dropped, unless we didn't get to look for them
+	std::unique_lock lock(s_mutex);
+	SaveCache(progress->IsCancelled());
+	s_cache_file.Close();
 }
 
 std::string GameList::GetCoverImagePathForEntry(const Entry* entry)
@@ -613,6 +613,15 @@ static void DrawPerformanceOverlay()
 				FormatProcessorStat(text, PerformanceMetrics::GetVUThreadUsage(), PerformanceMetrics::GetVUThreadAverageTime());
 				DRAW_LINE(s_fixed_font, text.c_str(), IM_COL32(255, 255, 255, 255));
 			}
+
+			if (PerformanceMetrics::GetCDVDReadCount() > 0)
+			{
+				text.Clear();
+				text.Write("CDVD: %s, %.0f%% prefetched",
+					PerformanceMetrics::GetCDVDAccessPatternName(PerformanceMetrics::GetCDVDAccessPattern()),
+					PerformanceMetrics::GetCDVDPrefetchHitRate());
+				DRAW_LINE(s_fixed_font, text.c_str(), IM_COL32(255, 255, 255, 255));
+			}
 		}
 
 		if (GSConfig.OsdShowGPU)
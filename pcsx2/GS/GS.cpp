@@ -175,6 +175,16 @@ static HostDisplay::RenderAPI GetAPIForRenderer(GSRendererType renderer)
 	}
 }
 
+/// Points the swizzle and CLUT kernel tables at the best copies for the running CPU
+static void SelectGSKernels()
+{
+#ifdef MULTI_ISA_SHARED_COMPILATION
+	Console.WriteLn("GS: Using %s kernels", GSGetISAName(GSGetBestISA()));
+#endif
+	MULTI_ISA_SELECT(GSLocalMemoryPopulateFunctions)(GSLocalMemory::m_psm);
+	MULTI_ISA_SELECT(GSClutPopulateFunctions)(GSClut::m_fn);
+}
+
 static bool DoGSOpen(GSRendererType renderer, u8* basemem)
 {
 	HostDisplay* display = Host::GetHostDisplay();
@@ -201,6 +211,11 @@ static bool DoGSOpen(GSRendererType renderer, u8* basemem)
 			break;
 #endif
 
+		// Headless hosts, nothing is ever presented
+		case HostDisplay::RenderAPI::None:
+			g_gs_device = std::make_unique<GSDeviceNull>();
+			break;
+
 		default:
 			Console.Error("Unknown render API %u", static_cast<unsigned>(display->GetRenderAPI()));
 			return false;
@@ -321,6 +336,8 @@ bool GSopen(const Pcsx2Config::GSOptions& config, GSRendererType renderer, u8* b
 		return false;
 	}
 
+	SelectGSKernels();
+
 	if (!DoGSOpen(renderer, basemem))
 	{
 		Host::ReleaseHostDisplay();
@@ -659,18 +676,24 @@ void GSgetStats(std::string& info)
 
 	const char* api_name = HostDisplay::RenderAPIToString(s_render_api);
 
+	const double palette_lookups = pm.Get(GSPerfMon::PaletteLookups);
+	const int palette_hits = (palette_lookups > 0) ? (int)(100 * pm.Get(GSPerfMon::PaletteHits) / palette_lookups) : 0;
+
 	if (GSConfig.Renderer == GSRendererType::SW)
 	{
 		const double fps = GetVerticalFrequency();
 		const double fillrate = pm.Get(GSPerfMon::Fillrate);
-		info = format("%s SW | %d S | %d P | %d D | %.2f U | %.2f D | %.2f mpps",
+		info = format("%s SW | %d S | %d P | %d D | %.2f U | %.2f D | %.2f mpps | %d JIT %.2f ms | %d%% PH",
 			api_name,
 			(int)pm.Get(GSPerfMon::SyncPoint),
 			(int)pm.Get(GSPerfMon::Prim),
 			(int)pm.Get(GSPerfMon::Draw),
 			pm.Get(GSPerfMon::Swizzle) / 1024,
 			pm.Get(GSPerfMon::Unswizzle) / 1024,
-			fps * fillrate / (1024 * 1024));
+			fps * fillrate / (1024 * 1024),
+			(int)std::ceil(pm.Get(GSPerfMon::JitCompiles)),
+			pm.Get(GSPerfMon::JitCompileTime),
+			palette_hits);
 	}
 	else if (GSConfig.Renderer == GSRendererType::Null)
 	{
@@ -680,7 +703,7 @@ void GSgetStats(std::string& info)
 	{
 		if (GSConfig.TexturePreloading == TexturePreloadingLevel::Full)
 		{
-			info = format("%s HW | HC: %d MB | %d P | %d D | %d DC | %d RB | %d TC | %d TU",
+			info = format("%s HW | HC: %d MB | %d P | %d D | %d DC | %d RB | %d TC | %d TU | %d%% PH",
 				api_name,
 				(int)std::ceil(static_cast<GSRendererHW*>(s_gs.get())->GetTextureCache()->GetHashCacheMemoryUsage() / 1048576.0f),
 				(int)pm.Get(GSPerfMon::Prim),
@@ -688,18 +711,20 @@ void GSgetStats(std::string& info)
 				(int)std::ceil(pm.Get(GSPerfMon::DrawCalls)),
 				(int)std::ceil(pm.Get(GSPerfMon::Readbacks)),
 				(int)std::ceil(pm.Get(GSPerfMon::TextureCopies)),
-				(int)std::ceil(pm.Get(GSPerfMon::TextureUploads)));
+				(int)std::ceil(pm.Get(GSPerfMon::TextureUploads)),
+				palette_hits);
 		}
 		else
 		{
-			info = format("%s HW | %d P | %d D | %d DC | %d RB | %d TC | %d TU",
+			info = format("%s HW | %d P | %d D | %d DC | %d RB | %d TC | %d TU | %d%% PH",
 				api_name,
 				(int)pm.Get(GSPerfMon::Prim),
 				(int)pm.Get(GSPerfMon::Draw),
 				(int)std::ceil(pm.Get(GSPerfMon::DrawCalls)),
 				(int)std::ceil(pm.Get(GSPerfMon::Readbacks)),
 				(int)std::ceil(pm.Get(GSPerfMon::TextureCopies)),
-				(int)std::ceil(pm.Get(GSPerfMon::TextureUploads)));
+				(int)std::ceil(pm.Get(GSPerfMon::TextureUploads)),
+				palette_hits);
 		}
 	}
 }
@@ -765,6 +790,7 @@ void GSUpdateConfig(const Pcsx2Config::GSOptions& new_config)
 		GSConfig.CRCHack != old_config.CRCHack ||
 		GSConfig.SWExtraThreads != old_config.SWExtraThreads ||
 		GSConfig.SWExtraThreadsHeight != old_config.SWExtraThreadsHeight ||
+		GSConfig.SWTileBinning != old_config.SWTileBinning ||
 
 		GSConfig.ShadeBoost_Brightness != old_config.ShadeBoost_Brightness ||
 		GSConfig.ShadeBoost_Contrast != old_config.ShadeBoost_Contrast ||
@@ -1234,6 +1260,11 @@ void GSApp::Init()
 	m_gs_texture_preloading.push_back(GSSetting(static_cast<u32>(TexturePreloadingLevel::Partial), "Partial", ""));
 	m_gs_texture_preloading.push_back(GSSetting(static_cast<u32>(TexturePreloadingLevel::Full), "Full", "Hash Cache"));
 
+	m_gs_dump_compression.push_back(GSSetting(static_cast<u32>(GSDumpCompressionMethod::LZMA), "LZMA (xz)", "Default"));
+#ifdef USE_ZSTD
+	m_gs_dump_compression.push_back(GSSetting(static_cast<u32>(GSDumpCompressionMethod::Zstandard), "Zstandard (zst)", ""));
+#endif
+
 	m_gs_generic_list.push_back(GSSetting(-1, "Automatic", "Default"));
 	m_gs_generic_list.push_back(GSSetting(0, "Force-Disabled", ""));
 	m_gs_generic_list.push_back(GSSetting(1, "Force-Enabled", ""));
@@ -1314,10 +1345,12 @@ void GSApp::Init()
 	m_default_configuration["DumpReplaceableMipmaps"]                     = "0";
 	m_default_configuration["DumpTexturesWithFMVActive"]                  = "0";
 	m_default_configuration["extrathreads"]                               = "2";
+	m_default_configuration["extrathreads_binning"]                       = "0";
 	m_default_configuration["extrathreads_height"]                        = "4";
 	m_default_configuration["filter"]                                     = std::to_string(static_cast<s8>(BiFiltering::PS2));
 	m_default_configuration["FMVSoftwareRendererSwitch"]                  = "0";
 	m_default_configuration["fxaa"]                                       = "0";
+	m_default_configuration["GSDumpCompression"]                          = std::to_string(static_cast<int>(GSDumpCompressionMethod::LZMA));
 	m_default_configuration["HWDisableReadbacks"]                         = "0";
 	m_default_configuration["IntegerScaling"]                             = "0";
 	m_default_configuration["interlace"]                                  = "7";
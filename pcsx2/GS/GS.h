@@ -134,6 +134,7 @@ public:
 	std::vector<GSSetting> m_gs_bifilter;
 	std::vector<GSSetting> m_gs_trifilter;
 	std::vector<GSSetting> m_gs_texture_preloading;
+	std::vector<GSSetting> m_gs_dump_compression;
 	std::vector<GSSetting> m_gs_hack;
 	std::vector<GSSetting> m_gs_generic_list;
 	std::vector<GSSetting> m_gs_offset_hack;
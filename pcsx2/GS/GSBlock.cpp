@@ -16,6 +16,8 @@
 #include "PrecompiledHeader.h"
 #include "GSBlock.h"
 
+MULTI_ISA_UNSHARED_START
+
 CONSTINIT const GSVector4i GSBlock::m_r16mask(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
 CONSTINIT const GSVector4i GSBlock::m_r8mask(0, 4, 2, 6, 8, 12, 10, 14, 1, 5, 3, 7, 9, 13, 11, 15);
 CONSTINIT const GSVector4i GSBlock::m_r4mask(0, 8, 4, 12, 1, 9, 5, 13, 2, 10, 6, 14, 3, 11, 7, 15);
@@ -33,3 +35,129 @@ CONSTINIT const GSVector4i GSBlock::m_uw8hmask0(0, 0, 0, 0, 1, 1, 1, 1, 8, 8, 8,
 CONSTINIT const GSVector4i GSBlock::m_uw8hmask1(2, 2, 2, 2, 3, 3, 3, 3, 10, 10, 10, 10, 11, 11, 11, 11);
 CONSTINIT const GSVector4i GSBlock::m_uw8hmask2(4, 4, 4, 4, 5, 5, 5, 5, 12, 12, 12, 12, 13, 13, 13, 13);
 CONSTINIT const GSVector4i GSBlock::m_uw8hmask3(6, 6, 6, 6, 7, 7, 7, 7, 14, 14, 14, 14, 15, 15, 15, 15);
+
+#if GS_BLOCK_VBMI
+
+alignas(64) CONSTINIT const u8 GSBlock::m_vbmi_r8idx[2][64] =
+{
+	{
+		0, 4, 16, 20, 32, 36, 48, 52, 2, 6, 18, 22, 34, 38, 50, 54,
+		8, 12, 24, 28, 40, 44, 56, 60, 10, 14, 26, 30, 42, 46, 58, 62,
+		33, 37, 49, 53, 1, 5, 17, 21, 35, 39, 51, 55, 3, 7, 19, 23,
+		41, 45, 57, 61, 9, 13, 25, 29, 43, 47, 59, 63, 11, 15, 27, 31,
+	},
+	{
+		32, 36, 48, 52, 0, 4, 16, 20, 34, 38, 50, 54, 2, 6, 18, 22,
+		40, 44, 56, 60, 8, 12, 24, 28, 42, 46, 58, 62, 10, 14, 26, 30,
+		1, 5, 17, 21, 33, 37, 49, 53, 3, 7, 19, 23, 35, 39, 51, 55,
+		9, 13, 25, 29, 41, 45, 57, 61, 11, 15, 27, 31, 43, 47, 59, 63,
+	},
+};
+
+alignas(64) CONSTINIT const u8 GSBlock::m_vbmi_w8idx[2][64] =
+{
+	{
+		0, 36, 8, 44, 1, 37, 9, 45, 16, 52, 24, 60, 17, 53, 25, 61,
+		2, 38, 10, 46, 3, 39, 11, 47, 18, 54, 26, 62, 19, 55, 27, 63,
+		4, 32, 12, 40, 5, 33, 13, 41, 20, 48, 28, 56, 21, 49, 29, 57,
+		6, 34, 14, 42, 7, 35, 15, 43, 22, 50, 30, 58, 23, 51, 31, 59,
+	},
+	{
+		4, 32, 12, 40, 5, 33, 13, 41, 20, 48, 28, 56, 21, 49, 29, 57,
+		6, 34, 14, 42, 7, 35, 15, 43, 22, 50, 30, 58, 23, 51, 31, 59,
+		0, 36, 8, 44, 1, 37, 9, 45, 16, 52, 24, 60, 17, 53, 25, 61,
+		2, 38, 10, 46, 3, 39, 11, 47, 18, 54, 26, 62, 19, 55, 27, 63,
+	},
+};
+
+alignas(64) CONSTINIT const u8 GSBlock::m_vbmi_r4idx_lo[2][64] =
+{
+	{
+		0, 16, 32, 48, 1, 17, 33, 49, 2, 18, 34, 50, 3, 19, 35, 51,
+		8, 24, 40, 56, 9, 25, 41, 57, 10, 26, 42, 58, 11, 27, 43, 59,
+		32, 48, 0, 16, 33, 49, 1, 17, 34, 50, 2, 18, 35, 51, 3, 19,
+		40, 56, 8, 24, 41, 57, 9, 25, 42, 58, 10, 26, 43, 59, 11, 27,
+	},
+	{
+		32, 48, 0, 16, 33, 49, 1, 17, 34, 50, 2, 18, 35, 51, 3, 19,
+		40, 56, 8, 24, 41, 57, 9, 25, 42, 58, 10, 26, 43, 59, 11, 27,
+		0, 16, 32, 48, 1, 17, 33, 49, 2, 18, 34, 50, 3, 19, 35, 51,
+		8, 24, 40, 56, 9, 25, 41, 57, 10, 26, 42, 58, 11, 27, 43, 59,
+	},
+};
+
+alignas(64) CONSTINIT const u8 GSBlock::m_vbmi_r4idx_hi[2][64] =
+{
+	{
+		4, 20, 36, 52, 5, 21, 37, 53, 6, 22, 38, 54, 7, 23, 39, 55,
+		12, 28, 44, 60, 13, 29, 45, 61, 14, 30, 46, 62, 15, 31, 47, 63,
+		36, 52, 4, 20, 37, 53, 5, 21, 38, 54, 6, 22, 39, 55, 7, 23,
+		44, 60, 12, 28, 45, 61, 13, 29, 46, 62, 14, 30, 47, 63, 15, 31,
+	},
+	{
+		36, 52, 4, 20, 37, 53, 5, 21, 38, 54, 6, 22, 39, 55, 7, 23,
+		44, 60, 12, 28, 45, 61, 13, 29, 46, 62, 14, 30, 47, 63, 15, 31,
+		4, 20, 36, 52, 5, 21, 37, 53, 6, 22, 38, 54, 7, 23, 39, 55,
+		12, 28, 44, 60, 13, 29, 45, 61, 14, 30, 46, 62, 15, 31, 47, 63,
+	},
+};
+
+alignas(64) CONSTINIT const u8 GSBlock::m_vbmi_w4idx_lo[2][64] =
+{
+	{
+		0, 4, 8, 12, 0, 4, 8, 12, 16, 20, 24, 28, 16, 20, 24, 28,
+		1, 5, 9, 13, 1, 5, 9, 13, 17, 21, 25, 29, 17, 21, 25, 29,
+		2, 6, 10, 14, 2, 6, 10, 14, 18, 22, 26, 30, 18, 22, 26, 30,
+		3, 7, 11, 15, 3, 7, 11, 15, 19, 23, 27, 31, 19, 23, 27, 31,
+	},
+	{
+		2, 6, 10, 14, 2, 6, 10, 14, 18, 22, 26, 30, 18, 22, 26, 30,
+		3, 7, 11, 15, 3, 7, 11, 15, 19, 23, 27, 31, 19, 23, 27, 31,
+		0, 4, 8, 12, 0, 4, 8, 12, 16, 20, 24, 28, 16, 20, 24, 28,
+		1, 5, 9, 13, 1, 5, 9, 13, 17, 21, 25, 29, 17, 21, 25, 29,
+	},
+};
+
+alignas(64) CONSTINIT const u8 GSBlock::m_vbmi_w4idx_hi[2][64] =
+{
+	{
+		34, 38, 42, 46, 34, 38, 42, 46, 50, 54, 58, 62, 50, 54, 58, 62,
+		35, 39, 43, 47, 35, 39, 43, 47, 51, 55, 59, 63, 51, 55, 59, 63,
+		32, 36, 40, 44, 32, 36, 40, 44, 48, 52, 56, 60, 48, 52, 56, 60,
+		33, 37, 41, 45, 33, 37, 41, 45, 49, 53, 57, 61, 49, 53, 57, 61,
+	},
+	{
+		32, 36, 40, 44, 32, 36, 40, 44, 48, 52, 56, 60, 48, 52, 56, 60,
+		33, 37, 41, 45, 33, 37, 41, 45, 49, 53, 57, 61, 49, 53, 57, 61,
+		34, 38, 42, 46, 34, 38, 42, 46, 50, 54, 58, 62, 50, 54, 58, 62,
+		35, 39, 43, 47, 35, 39, 43, 47, 51, 55, 59, 63, 51, 55, 59, 63,
+	},
+};
+
+alignas(64) CONSTINIT const u8 GSBlock::m_vbmi_r4pidx[2][128] =
+{
+	{
+		0, 4, 16, 20, 32, 36, 48, 52, 1, 5, 17, 21, 33, 37, 49, 53,
+		2, 6, 18, 22, 34, 38, 50, 54, 3, 7, 19, 23, 35, 39, 51, 55,
+		8, 12, 24, 28, 40, 44, 56, 60, 9, 13, 25, 29, 41, 45, 57, 61,
+		10, 14, 26, 30, 42, 46, 58, 62, 11, 15, 27, 31, 43, 47, 59, 63,
+		32, 36, 48, 52, 0, 4, 16, 20, 33, 37, 49, 53, 1, 5, 17, 21,
+		34, 38, 50, 54, 2, 6, 18, 22, 35, 39, 51, 55, 3, 7, 19, 23,
+		40, 44, 56, 60, 8, 12, 24, 28, 41, 45, 57, 61, 9, 13, 25, 29,
+		42, 46, 58, 62, 10, 14, 26, 30, 43, 47, 59, 63, 11, 15, 27, 31,
+	},
+	{
+		32, 36, 48, 52, 0, 4, 16, 20, 33, 37, 49, 53, 1, 5, 17, 21,
+		34, 38, 50, 54, 2, 6, 18, 22, 35, 39, 51, 55, 3, 7, 19, 23,
+		40, 44, 56, 60, 8, 12, 24, 28, 41, 45, 57, 61, 9, 13, 25, 29,
+		42, 46, 58, 62, 10, 14, 26, 30, 43, 47, 59, 63, 11, 15, 27, 31,
+		0, 4, 16, 20, 32, 36, 48, 52, 1, 5, 17, 21, 33, 37, 49, 53,
+		2, 6, 18, 22, 34, 38, 50, 54, 3, 7, 19, 23, 35, 39, 51, 55,
+		8, 12, 24, 28, 40, 44, 56, 60, 9, 13, 25, 29, 41, 45, 57, 61,
+		10, 14, 26, 30, 42, 46, 58, 62, 11, 15, 27, 31, 43, 47, 59, 63,
+	},
+};
+
+#endif
+
+MULTI_ISA_UNSHARED_END
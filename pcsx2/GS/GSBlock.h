@@ -18,6 +18,17 @@
 #include "GSRegs.h"
 #include "GSTables.h"
 #include "GSVector.h"
+#include "MultiISA.h"
+
+// With AVX-512 VBMI a whole 64 byte column of 8 or 4 bit pixels is a single byte permute.
+// Multi-ISA builds compile it as the isa_avx2_vbmi copy and pick it at runtime, see MultiISA.h.
+#if defined(__AVX512VBMI__) && defined(__AVX512BW__) && defined(__AVX512VL__)
+	#define GS_BLOCK_VBMI 1
+#else
+	#define GS_BLOCK_VBMI 0
+#endif
+
+MULTI_ISA_UNSHARED_START
 
 class GSBlock
 {
@@ -39,6 +50,49 @@ class GSBlock
 	static const GSVector4i m_uw8hmask2;
 	static const GSVector4i m_uw8hmask3;
 
+#if GS_BLOCK_VBMI
+	// Byte permutes between a column and its 4 rows, indexed by column parity.
+	// For 4 bit pixels the two pixels of an output byte always come from the same half of their source bytes,
+	// so the 4 bit tables pick the source bytes for the low and high pixels and the caller says which words want the upper half.
+	alignas(64) static const u8 m_vbmi_r8idx[2][64];
+	alignas(64) static const u8 m_vbmi_w8idx[2][64];
+	alignas(64) static const u8 m_vbmi_r4idx_lo[2][64];
+	alignas(64) static const u8 m_vbmi_r4idx_hi[2][64];
+	alignas(64) static const u8 m_vbmi_w4idx_lo[2][64];
+	alignas(64) static const u8 m_vbmi_w4idx_hi[2][64];
+	alignas(64) static const u8 m_vbmi_r4pidx[2][128];
+
+	__forceinline static __m512i LoadRowsVBMI(const u8* RESTRICT src, int srcpitch)
+	{
+		__m512i v = _mm512_castsi128_si512(_mm_loadu_si128((const __m128i*)&src[srcpitch * 0]));
+		v = _mm512_inserti32x4(v, _mm_loadu_si128((const __m128i*)&src[srcpitch * 1]), 1);
+		v = _mm512_inserti32x4(v, _mm_loadu_si128((const __m128i*)&src[srcpitch * 2]), 2);
+		v = _mm512_inserti32x4(v, _mm_loadu_si128((const __m128i*)&src[srcpitch * 3]), 3);
+		return v;
+	}
+
+	__forceinline static void StoreRowsVBMI(u8* RESTRICT dst, int dstpitch, __m512i v)
+	{
+		_mm_store_si128((__m128i*)&dst[dstpitch * 0], _mm512_castsi512_si128(v));
+		_mm_store_si128((__m128i*)&dst[dstpitch * 1], _mm512_extracti32x4_epi32(v, 1));
+		_mm_store_si128((__m128i*)&dst[dstpitch * 2], _mm512_extracti32x4_epi32(v, 2));
+		_mm_store_si128((__m128i*)&dst[dstpitch * 3], _mm512_extracti32x4_epi32(v, 3));
+	}
+
+	/// Moves the 4 bit pixels of v around, words set in `high` take both pixels from the upper halves of their source bytes
+	__forceinline static __m512i PermuteNibblesVBMI(__m512i v, const u8* idx_lo, const u8* idx_hi, __mmask32 high)
+	{
+		__m512i lo = _mm512_permutexvar_epi8(_mm512_load_si512(idx_lo), v);
+		__m512i hi = _mm512_permutexvar_epi8(_mm512_load_si512(idx_hi), v);
+
+		lo = _mm512_mask_srli_epi16(lo, high, lo, 4);
+		hi = _mm512_mask_slli_epi16(hi, ~high, hi, 4);
+
+		// (0x0f & lo) | (0xf0 & hi)
+		return _mm512_ternarylogic_epi32(_mm512_set1_epi8(0x0f), lo, hi, 0xca);
+	}
+#endif
+
 #if _M_SSE >= 0x501
 	// Equvialent of `a = *s0; b = *s1; sw128(a, b);`
 	// Loads in two halves instead to reduce shuffle instructions
@@ -188,7 +242,13 @@ public:
 	{
 		// TODO: read unaligned as WriteColumn32 does and try saving a few shuffles
 
-#if _M_SSE >= 0x501
+#if GS_BLOCK_VBMI
+
+		__m512i v = LoadRowsVBMI(src, srcpitch);
+
+		_mm512_store_si512(&dst[i * 64], _mm512_permutexvar_epi8(_mm512_load_si512(m_vbmi_w8idx[i & 1]), v));
+
+#elif _M_SSE >= 0x501
 
 		GSVector4i v4 = GSVector4i::load<false>(&src[srcpitch * 0]);
 		GSVector4i v5 = GSVector4i::load<false>(&src[srcpitch * 1]);
@@ -251,7 +311,16 @@ public:
 
 		// TODO: pshufb
 
-#if _M_SSE >= 0x501
+#if GS_BLOCK_VBMI
+
+		__m512i v = LoadRowsVBMI(src, srcpitch);
+
+		// Every other pair of words comes from the upper halves
+		v = PermuteNibblesVBMI(v, m_vbmi_w4idx_lo[i & 1], m_vbmi_w4idx_hi[i & 1], 0xcccccccc);
+
+		_mm512_store_si512(&dst[i * 64], v);
+
+#elif _M_SSE >= 0x501
 
 		GSVector8i v0 = GSVector8i(GSVector4i::load<false>(&src[srcpitch * 0]), GSVector4i::load<false>(&src[srcpitch * 1]));
 		GSVector8i v1 = GSVector8i(GSVector4i::load<false>(&src[srcpitch * 2]), GSVector4i::load<false>(&src[srcpitch * 3]));
@@ -489,7 +558,13 @@ public:
 
 		//for(int j = 0; j < 64; j++) ((u8*)src)[j] = (u8)j;
 
-#if _M_SSE >= 0x501
+#if GS_BLOCK_VBMI
+
+		__m512i v = _mm512_load_si512(&src[i * 64]);
+
+		StoreRowsVBMI(dst, dstpitch, _mm512_permutexvar_epi8(_mm512_load_si512(m_vbmi_r8idx[i & 1]), v));
+
+#elif _M_SSE >= 0x501
 
 		const GSVector8i* s = (const GSVector8i*)src;
 
@@ -559,7 +634,16 @@ public:
 	{
 		//printf("ReadColumn4\n");
 
-#if _M_SSE >= 0x501
+#if GS_BLOCK_VBMI
+
+		__m512i v = _mm512_load_si512(&src[i * 64]);
+
+		// Rows 0 and 1 come from the lower halves of the source bytes, rows 2 and 3 from the upper halves
+		v = PermuteNibblesVBMI(v, m_vbmi_r4idx_lo[i & 1], m_vbmi_r4idx_hi[i & 1], 0xffff0000);
+
+		StoreRowsVBMI(dst, dstpitch, v);
+
+#elif _M_SSE >= 0x501
 
 		const GSVector8i* s = (const GSVector8i*)src;
 
@@ -725,7 +809,30 @@ public:
 	{
 		//printf("ReadBlock4P\n");
 
-#if _M_SSE >= 0x501
+#if GS_BLOCK_VBMI
+
+		const __m512i mask = _mm512_set1_epi8(0x0f);
+
+		for (int i = 0; i < 4; i++)
+		{
+			__m512i v = _mm512_load_si512(&src[i * 64]);
+
+			// Rows 0 and 1 are the lower halves of the source bytes, rows 2 and 3 the upper halves
+			__m512i v0 = _mm512_permutexvar_epi8(_mm512_load_si512(&m_vbmi_r4pidx[i & 1][0]), v);
+			__m512i v1 = _mm512_permutexvar_epi8(_mm512_load_si512(&m_vbmi_r4pidx[i & 1][64]), v);
+
+			v0 = _mm512_and_si512(v0, mask);
+			v1 = _mm512_and_si512(_mm512_srli_epi16(v1, 4), mask);
+
+			_mm256_store_si256((__m256i*)&dst[dstpitch * 0], _mm512_castsi512_si256(v0));
+			_mm256_store_si256((__m256i*)&dst[dstpitch * 1], _mm512_extracti64x4_epi64(v0, 1));
+			_mm256_store_si256((__m256i*)&dst[dstpitch * 2], _mm512_castsi512_si256(v1));
+			_mm256_store_si256((__m256i*)&dst[dstpitch * 3], _mm512_extracti64x4_epi64(v1, 1));
+
+			dst += dstpitch * 4;
+		}
+
+#elif _M_SSE >= 0x501
 
 		const GSVector8i* s = (const GSVector8i*)src;
 
@@ -1940,3 +2047,5 @@ public:
 
 	// TODO: ReadAndExpandBlock4HH_16
 };
+
+MULTI_ISA_UNSHARED_END
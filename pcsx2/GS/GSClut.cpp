@@ -15,19 +15,39 @@
 
 #include "PrecompiledHeader.h"
 #include "GSClut.h"
+#include "GSBlock.h"
 #include "GSLocalMemory.h"
 #include "GSGL.h"
+#include "GSPerfMon.h"
 
-#define CLUT_ALLOC_SIZE (2 * 4096)
+#define XXH_STATIC_LINKING_ONLY 1
+#define XXH_INLINE_ALL 1
+#include "xxhash.h"
+
+#ifdef MULTI_ISA_COMPILE_ONCE
+
+#define CLUT_ALLOC_SIZE (2048 + sizeof(PaletteCacheEntry) * PALETTE_CACHE_SIZE)
+
+GSClutFunctions GSClut::m_fn;
 
 GSClut::GSClut(GSLocalMemory* mem)
 	: m_mem(mem)
 {
 	u8* p = (u8*)vmalloc(CLUT_ALLOC_SIZE, false);
 
-	m_clut = (u16*)&p[0];      // 1k + 1k for mirrored area simulating wrapping memory
-	m_buff32 = (u32*)&p[2048]; // 1k
-	m_buff64 = (u64*)&p[4096]; // 2k
+	m_clut = (u16*)&p[0]; // 1k + 1k for mirrored area simulating wrapping memory
+	m_palette_cache = (PaletteCacheEntry*)&p[2048];
+	m_palette_clock = 0;
+
+	for (int i = 0; i < PALETTE_CACHE_SIZE; i++)
+	{
+		m_palette_cache[i].valid = false;
+		m_palette_cache[i].last_use = 0;
+	}
+
+	m_palette = &m_palette_cache[0];
+	m_buff32 = m_palette->buff32;
+	m_buff64 = m_palette->buff64;
 	m_write.dirty = true;
 	m_read.dirty = true;
 
@@ -170,34 +190,34 @@ void GSClut::Write(const GIFRegTEX0& TEX0, const GIFRegTEXCLUT& TEXCLUT)
 void GSClut::WriteCLUT32_I8_CSM1(const GIFRegTEX0& TEX0, const GIFRegTEXCLUT& TEXCLUT)
 {
 	ALIGN_STACK(32);
-	WriteCLUT_T32_I8_CSM1((u32*)m_mem->BlockPtr32(0, 0, TEX0.CBP, 1), m_clut, (TEX0.CSA & 15));
+	m_fn.WriteCLUT_T32_I8_CSM1((u32*)m_mem->BlockPtr32(0, 0, TEX0.CBP, 1), m_clut, (TEX0.CSA & 15));
 }
 
 void GSClut::WriteCLUT32_I4_CSM1(const GIFRegTEX0& TEX0, const GIFRegTEXCLUT& TEXCLUT)
 {
 	ALIGN_STACK(32);
 
-	WriteCLUT_T32_I4_CSM1((u32*)m_mem->BlockPtr32(0, 0, TEX0.CBP, 1), m_clut + ((TEX0.CSA & 15) << 4));
+	m_fn.WriteCLUT_T32_I4_CSM1((u32*)m_mem->BlockPtr32(0, 0, TEX0.CBP, 1), m_clut + ((TEX0.CSA & 15) << 4));
 }
 
 void GSClut::WriteCLUT16_I8_CSM1(const GIFRegTEX0& TEX0, const GIFRegTEXCLUT& TEXCLUT)
 {
-	WriteCLUT_T16_I8_CSM1((u16*)m_mem->BlockPtr16(0, 0, TEX0.CBP, 1), m_clut + (TEX0.CSA << 4));
+	m_fn.WriteCLUT_T16_I8_CSM1((u16*)m_mem->BlockPtr16(0, 0, TEX0.CBP, 1), m_clut + (TEX0.CSA << 4));
 }
 
 void GSClut::WriteCLUT16_I4_CSM1(const GIFRegTEX0& TEX0, const GIFRegTEXCLUT& TEXCLUT)
 {
-	WriteCLUT_T16_I4_CSM1((u16*)m_mem->BlockPtr16(0, 0, TEX0.CBP, 1), m_clut + (TEX0.CSA << 4));
+	m_fn.WriteCLUT_T16_I4_CSM1((u16*)m_mem->BlockPtr16(0, 0, TEX0.CBP, 1), m_clut + (TEX0.CSA << 4));
 }
 
 void GSClut::WriteCLUT16S_I8_CSM1(const GIFRegTEX0& TEX0, const GIFRegTEXCLUT& TEXCLUT)
 {
-	WriteCLUT_T16_I8_CSM1((u16*)m_mem->BlockPtr16S(0, 0, TEX0.CBP, 1), m_clut + (TEX0.CSA << 4));
+	m_fn.WriteCLUT_T16_I8_CSM1((u16*)m_mem->BlockPtr16S(0, 0, TEX0.CBP, 1), m_clut + (TEX0.CSA << 4));
 }
 
 void GSClut::WriteCLUT16S_I4_CSM1(const GIFRegTEX0& TEX0, const GIFRegTEXCLUT& TEXCLUT)
 {
-	WriteCLUT_T16_I4_CSM1((u16*)m_mem->BlockPtr16S(0, 0, TEX0.CBP, 1), m_clut + (TEX0.CSA << 4));
+	m_fn.WriteCLUT_T16_I4_CSM1((u16*)m_mem->BlockPtr16S(0, 0, TEX0.CBP, 1), m_clut + (TEX0.CSA << 4));
 }
 
 template <int n>
@@ -299,6 +319,43 @@ void GSClut::Read(const GIFRegTEX0& TEX0)
 }
 #endif
 
+bool GSClut::FindPalette(u64 key, u64 hash)
+{
+	PaletteCacheEntry* lru = &m_palette_cache[0];
+
+	for (int i = 0; i < PALETTE_CACHE_SIZE; i++)
+	{
+		PaletteCacheEntry* e = &m_palette_cache[i];
+
+		if (e->valid && e->key == key && e->hash == hash)
+		{
+			lru = e;
+			break;
+		}
+
+		if (e->last_use < lru->last_use)
+			lru = e;
+	}
+
+	const bool hit = lru->valid && lru->key == key && lru->hash == hash;
+
+	if (!hit)
+	{
+		lru->key = key;
+		lru->hash = hash;
+		lru->valid = true;
+		lru->alpha_valid = false;
+	}
+
+	lru->last_use = ++m_palette_clock;
+
+	m_palette = lru;
+	m_buff32 = lru->buff32;
+	m_buff64 = lru->buff64;
+
+	return hit;
+}
+
 void GSClut::Read32(const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA)
 {
 	if (m_read.IsDirty(TEX0, TEXA))
@@ -308,43 +365,73 @@ void GSClut::Read32(const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA)
 		m_read.dirty = false;
 		m_read.adirty = true;
 
+		const bool t32 = TEX0.CPSM == PSM_PSMCT32 || TEX0.CPSM == PSM_PSMCT24;
+		const bool t16 = TEX0.CPSM == PSM_PSMCT16 || TEX0.CPSM == PSM_PSMCT16S;
+		const bool i8 = TEX0.PSM == PSM_PSMT8 || TEX0.PSM == PSM_PSMT8H;
+		const bool i4 = TEX0.PSM == PSM_PSMT4 || TEX0.PSM == PSM_PSMT4HL || TEX0.PSM == PSM_PSMT4HH;
+
+		if (!(t32 || t16) || !(i8 || i4))
+			return;
+
+		// Only hash the part of the CLUT the conversion reads
+
 		u16* clut = m_clut;
+		u64 key, hash;
 
-		if (TEX0.CPSM == PSM_PSMCT32 || TEX0.CPSM == PSM_PSMCT24)
+		if (t32)
 		{
-			switch (TEX0.PSM)
+			if (i8)
 			{
-				case PSM_PSMT8:
-				case PSM_PSMT8H:
-					ReadCLUT_T32_I8(clut, m_buff32, (TEX0.CSA & 15) << 4);
-					break;
-				case PSM_PSMT4:
-				case PSM_PSMT4HL:
-				case PSM_PSMT4HH:
-					clut += (TEX0.CSA & 15) << 4;
-					// TODO: merge these functions
-					ReadCLUT_T32_I4(clut, m_buff32);
-					ExpandCLUT64_T32_I8(m_buff32, (u64*)m_buff64); // sw renderer does not need m_buff64 anymore
-					break;
+				// CSA is an offset into the whole CLUT here, see ReadCLUT_T32_I8
+				key = 0 | ((TEX0.CSA & 15) << 2);
+				hash = XXH3_64bits(clut, 512 * sizeof(u16));
 			}
+			else
+			{
+				clut += (TEX0.CSA & 15) << 4;
+				key = 1;
+				hash = XXH3_64bits_withSeed(clut + 256, 16 * sizeof(u16), XXH3_64bits(clut, 16 * sizeof(u16)));
+			}
+		}
+		else
+		{
+			clut += TEX0.CSA << 4;
+			key = (i8 ? 2 : 3) | ((u64)TEXA.TA0 << 8) | ((u64)TEXA.TA1 << 16) | ((u64)TEXA.AEM << 24);
+			hash = XXH3_64bits(clut, (i8 ? 256 : 16) * sizeof(u16));
 		}
-		else if (TEX0.CPSM == PSM_PSMCT16 || TEX0.CPSM == PSM_PSMCT16S)
+
+		g_perfmon.Put(GSPerfMon::PaletteLookups, 1);
+
+		if (FindPalette(key, hash))
 		{
-			switch (TEX0.PSM)
+			g_perfmon.Put(GSPerfMon::PaletteHits, 1);
+			return;
+		}
+
+		if (t32)
+		{
+			if (i8)
 			{
-				case PSM_PSMT8:
-				case PSM_PSMT8H:
-					clut += TEX0.CSA << 4;
-					Expand16(clut, m_buff32, 256, TEXA);
-					break;
-				case PSM_PSMT4:
-				case PSM_PSMT4HL:
-				case PSM_PSMT4HH:
-					clut += TEX0.CSA << 4;
-					// TODO: merge these functions
-					Expand16(clut, m_buff32, 16, TEXA);
-					ExpandCLUT64_T32_I8(m_buff32, (u64*)m_buff64); // sw renderer does not need m_buff64 anymore
-					break;
+				m_fn.ReadCLUT_T32_I8(clut, m_buff32, (TEX0.CSA & 15) << 4);
+			}
+			else
+			{
+				// TODO: merge these functions
+				m_fn.ReadCLUT_T32_I4(clut, m_buff32);
+				m_fn.ExpandCLUT64_T32_I8(m_buff32, (u64*)m_buff64); // sw renderer does not need m_buff64 anymore
+			}
+		}
+		else
+		{
+			if (i8)
+			{
+				m_fn.Expand16(clut, m_buff32, 256, TEXA);
+			}
+			else
+			{
+				// TODO: merge these functions
+				m_fn.Expand16(clut, m_buff32, 16, TEXA);
+				m_fn.ExpandCLUT64_T32_I8(m_buff32, (u64*)m_buff64); // sw renderer does not need m_buff64 anymore
 			}
 		}
 	}
@@ -365,6 +452,11 @@ void GSClut::GetAlphaMinMax32(int& amin_out, int& amax_out)
 			m_read.amin = m_read.TEXA.TA0;
 			m_read.amax = m_read.TEXA.TA0;
 		}
+		else if (m_palette->alpha_valid)
+		{
+			m_read.amin = m_palette->amin;
+			m_read.amax = m_palette->amax;
+		}
 		else
 		{
 			const GSVector4i* p = (const GSVector4i*)m_buff32;
@@ -410,6 +502,10 @@ void GSClut::GetAlphaMinMax32(int& amin_out, int& amax_out)
 
 			m_read.amin = v0.min_i16(v1).extract16<0>();
 			m_read.amax = v0.max_i16(v1).extract16<1>();
+
+			m_palette->amin = m_read.amin;
+			m_palette->amax = m_read.amax;
+			m_palette->alpha_valid = true;
 		}
 	}
 
@@ -417,22 +513,29 @@ void GSClut::GetAlphaMinMax32(int& amin_out, int& amax_out)
 	amax_out = m_read.amax;
 }
 
-//
+bool GSClut::WriteState::IsDirty(const GIFRegTEX0& TEX0, const GIFRegTEXCLUT& TEXCLUT)
+{
+	return dirty || !GSVector4i::load<true>(this).eq(GSVector4i::load(&TEX0, &TEXCLUT));
+}
 
-void GSClut::WriteCLUT_T32_I8_CSM1(const u32* RESTRICT src, u16* RESTRICT clut, u16 offset)
+bool GSClut::ReadState::IsDirty(const GIFRegTEX0& TEX0)
 {
-	// This is required when CSA is offset from the base of the CLUT so we point to the right data
-	for (int i = offset; i < 16; i ++)
-	{
-		const int off = i << 4; // WriteCLUT_T32_I4_CSM1 loads 16 at a time
-		// Source column
-		const int s = clutTableT32I8[off & 0x70] | (off & 0x80);
+	return dirty || !GSVector4i::load<true>(this).eq(GSVector4i::load(&TEX0, &this->TEXA));
+}
 
-		WriteCLUT_T32_I4_CSM1(&src[s], &clut[off]);
-	}
+bool GSClut::ReadState::IsDirty(const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA)
+{
+	return dirty || !GSVector4i::load<true>(this).eq(GSVector4i::load(&TEX0, &TEXA));
 }
 
-__forceinline void GSClut::WriteCLUT_T32_I4_CSM1(const u32* RESTRICT src, u16* RESTRICT clut)
+#endif
+
+// Palette conversion kernels, reached through GSClut::m_fn.
+// This part is compiled once per ISA in multi-ISA builds, see MultiISA.h.
+
+MULTI_ISA_UNSHARED_START
+
+static __forceinline void WriteCLUT_T32_I4_CSM1(const u32* RESTRICT src, u16* RESTRICT clut)
 {
 	// 1 block
 
@@ -473,7 +576,20 @@ __forceinline void GSClut::WriteCLUT_T32_I4_CSM1(const u32* RESTRICT src, u16* R
 #endif
 }
 
-void GSClut::WriteCLUT_T16_I8_CSM1(const u16* RESTRICT src, u16* RESTRICT clut)
+static void WriteCLUT_T32_I8_CSM1(const u32* RESTRICT src, u16* RESTRICT clut, u16 offset)
+{
+	// This is required when CSA is offset from the base of the CLUT so we point to the right data
+	for (int i = offset; i < 16; i ++)
+	{
+		const int off = i << 4; // WriteCLUT_T32_I4_CSM1 loads 16 at a time
+		// Source column
+		const int s = clutTableT32I8[off & 0x70] | (off & 0x80);
+
+		WriteCLUT_T32_I4_CSM1(&src[s], &clut[off]);
+	}
+}
+
+static void WriteCLUT_T16_I8_CSM1(const u16* RESTRICT src, u16* RESTRICT clut)
 {
 	// 2 blocks
 
@@ -498,7 +614,7 @@ void GSClut::WriteCLUT_T16_I8_CSM1(const u16* RESTRICT src, u16* RESTRICT clut)
 	}
 }
 
-__forceinline void GSClut::WriteCLUT_T16_I4_CSM1(const u16* RESTRICT src, u16* RESTRICT clut)
+static void WriteCLUT_T16_I4_CSM1(const u16* RESTRICT src, u16* RESTRICT clut)
 {
 	// 1 block (half)
 
@@ -508,23 +624,25 @@ __forceinline void GSClut::WriteCLUT_T16_I4_CSM1(const u16* RESTRICT src, u16* R
 	}
 }
 
-void GSClut::ReadCLUT_T32_I8(const u16* RESTRICT clut, u32* RESTRICT dst, int offset)
+static __forceinline void ReadCLUT_T32_I4(const u16* RESTRICT clut, u32* RESTRICT dst)
 {
-	// Okay this deserves a small explanation
-	// T32 I8 can address up to 256 colors however the offset can be "more than zero" when reading
-	// Previously I assumed that it would wrap around the end of the buffer to the beginning
-	// but it turns out this is incorrect, the address doesn't mirror, it clamps to to the last offset,
-	// probably though some sort of addressing mechanism then picks the color from the lower 0xF of the requested CLUT entry.
-	// if we don't do this, the dirt on GTA SA goes transparent and actually cleans the car driving through dirt.
-	for (int i = 0; i < 256; i += 16)
-	{
-		// Min value + offet or Last CSA * 16 (240)
-		ReadCLUT_T32_I4(&clut[std::min((i + offset), 240)], &dst[i]);
-	}
-}
+#if _M_SSE >= 0x501
+
+	// Low halves of the 16 colors are in v0, high halves in v1
+	GSVector8i* s = (GSVector8i*)clut;
+	GSVector8i* d = (GSVector8i*)dst;
+
+	GSVector8i v0 = s[0];
+	GSVector8i v1 = s[16];
+
+	GSVector8i::sw16(v0, v1);
+
+	// v0 has colors 0-3 and 8-11, v1 has colors 4-7 and 12-15
+	d[0] = v0.ac(v1);
+	d[1] = v0.bd(v1);
+
+#else
 
-__forceinline void GSClut::ReadCLUT_T32_I4(const u16* RESTRICT clut, u32* RESTRICT dst)
-{
 	GSVector4i* s = (GSVector4i*)clut;
 	GSVector4i* d = (GSVector4i*)dst;
 
@@ -539,232 +657,137 @@ __forceinline void GSClut::ReadCLUT_T32_I4(const u16* RESTRICT clut, u32* RESTRI
 	d[1] = v1;
 	d[2] = v2;
 	d[3] = v3;
-}
 
-#if 0
-__forceinline void GSClut::ReadCLUT_T32_I4(const u16* RESTRICT clut, u32* RESTRICT dst32, u64* RESTRICT dst64)
-{
-	GSVector4i* s = (GSVector4i*)clut;
-	GSVector4i* d32 = (GSVector4i*)dst32;
-	GSVector4i* d64 = (GSVector4i*)dst64;
-
-	GSVector4i s0 = s[0];
-	GSVector4i s1 = s[1];
-	GSVector4i s2 = s[32];
-	GSVector4i s3 = s[33];
-
-	GSVector4i::sw16(s0, s2, s1, s3);
-
-	d32[0] = s0;
-	d32[1] = s1;
-	d32[2] = s2;
-	d32[3] = s3;
-
-	ExpandCLUT64_T32(s0, s0, s1, s2, s3, &d64[0]);
-	ExpandCLUT64_T32(s1, s0, s1, s2, s3, &d64[32]);
-	ExpandCLUT64_T32(s2, s0, s1, s2, s3, &d64[64]);
-	ExpandCLUT64_T32(s3, s0, s1, s2, s3, &d64[96]);
-}
 #endif
+}
 
-#if 0
-void GSClut::ReadCLUT_T16_I8(const u16* RESTRICT clut, u32* RESTRICT dst)
+static void ReadCLUT_T32_I8(const u16* RESTRICT clut, u32* RESTRICT dst, int offset)
 {
-	for(int i = 0; i < 256; i += 16)
+	// Okay this deserves a small explanation
+	// T32 I8 can address up to 256 colors however the offset can be "more than zero" when reading
+	// Previously I assumed that it would wrap around the end of the buffer to the beginning
+	// but it turns out this is incorrect, the address doesn't mirror, it clamps to to the last offset,
+	// probably though some sort of addressing mechanism then picks the color from the lower 0xF of the requested CLUT entry.
+	// if we don't do this, the dirt on GTA SA goes transparent and actually cleans the car driving through dirt.
+	for (int i = 0; i < 256; i += 16)
 	{
-		ReadCLUT_T16_I4(&clut[i], &dst[i]);
+		// Min value + offet or Last CSA * 16 (240)
+		ReadCLUT_T32_I4(&clut[std::min((i + offset), 240)], &dst[i]);
 	}
 }
-#endif
 
-#if 0
-__forceinline void GSClut::ReadCLUT_T16_I4(const u16* RESTRICT clut, u32* RESTRICT dst)
+static void ExpandCLUT64_T32_I8(const u32* RESTRICT src, u64* RESTRICT dst)
 {
-	GSVector4i* s = (GSVector4i*)clut;
-	GSVector4i* d = (GSVector4i*)dst;
+	// dst[i * 16 + j] = src[i] << 32 | src[j]
 
-	GSVector4i v0 = s[0];
-	GSVector4i v1 = s[1];
-
-	d[0] = v0.upl16();
-	d[1] = v0.uph16();
-	d[2] = v1.upl16();
-	d[3] = v1.uph16();
-}
-#endif
+#if _M_SSE >= 0x501
 
-#if 0
-__forceinline void GSClut::ReadCLUT_T16_I4(const u16* RESTRICT clut, u32* RESTRICT dst32, u64* RESTRICT dst64)
-{
-	GSVector4i* s = (GSVector4i*)clut;
-	GSVector4i* d32 = (GSVector4i*)dst32;
-	GSVector4i* d64 = (GSVector4i*)dst64;
+	const GSVector8i* s = (const GSVector8i*)src;
+	GSVector8i* d = (GSVector8i*)dst;
 
-	GSVector4i v0 = s[0];
-	GSVector4i v1 = s[1];
+	// Swap the middle qwords so the in-lane unpacks come out in order
+	const GSVector8i lo0 = s[0].acbd();
+	const GSVector8i lo1 = s[1].acbd();
 
-	GSVector4i s0 = v0.upl16();
-	GSVector4i s1 = v0.uph16();
-	GSVector4i s2 = v1.upl16();
-	GSVector4i s3 = v1.uph16();
+	for (int i = 0; i < 16; i++, d += 4)
+	{
+		const GSVector8i hi = GSVector8i::broadcast32(&src[i]);
 
-	d32[0] = s0;
-	d32[1] = s1;
-	d32[2] = s2;
-	d32[3] = s3;
+		d[0] = lo0.upl32(hi);
+		d[1] = lo0.uph32(hi);
+		d[2] = lo1.upl32(hi);
+		d[3] = lo1.uph32(hi);
+	}
 
-	ExpandCLUT64_T16(s0, s0, s1, s2, s3, &d64[0]);
-	ExpandCLUT64_T16(s1, s0, s1, s2, s3, &d64[32]);
-	ExpandCLUT64_T16(s2, s0, s1, s2, s3, &d64[64]);
-	ExpandCLUT64_T16(s3, s0, s1, s2, s3, &d64[96]);
-}
-#endif
+#else
 
-void GSClut::ExpandCLUT64_T32_I8(const u32* RESTRICT src, u64* RESTRICT dst)
-{
-	GSVector4i* s = (GSVector4i*)src;
+	const GSVector4i* s = (const GSVector4i*)src;
 	GSVector4i* d = (GSVector4i*)dst;
 
-	GSVector4i s0 = s[0];
-	GSVector4i s1 = s[1];
-	GSVector4i s2 = s[2];
-	GSVector4i s3 = s[3];
+	const GSVector4i lo0 = s[0];
+	const GSVector4i lo1 = s[1];
+	const GSVector4i lo2 = s[2];
+	const GSVector4i lo3 = s[3];
 
-	ExpandCLUT64_T32(s0, s0, s1, s2, s3, &d[0]);
-	ExpandCLUT64_T32(s1, s0, s1, s2, s3, &d[32]);
-	ExpandCLUT64_T32(s2, s0, s1, s2, s3, &d[64]);
-	ExpandCLUT64_T32(s3, s0, s1, s2, s3, &d[96]);
-}
+	for (int i = 0; i < 16; i++, d += 8)
+	{
+		const GSVector4i hi = GSVector4i::load((int)src[i]).xxxx();
+
+		d[0] = lo0.upl32(hi);
+		d[1] = lo0.uph32(hi);
+		d[2] = lo1.upl32(hi);
+		d[3] = lo1.uph32(hi);
+		d[4] = lo2.upl32(hi);
+		d[5] = lo2.uph32(hi);
+		d[6] = lo3.upl32(hi);
+		d[7] = lo3.uph32(hi);
+	}
 
-__forceinline void GSClut::ExpandCLUT64_T32(const GSVector4i& hi, const GSVector4i& lo0, const GSVector4i& lo1, const GSVector4i& lo2, const GSVector4i& lo3, GSVector4i* dst)
-{
-	ExpandCLUT64_T32(hi.xxxx(), lo0, &dst[0]);
-	ExpandCLUT64_T32(hi.xxxx(), lo1, &dst[2]);
-	ExpandCLUT64_T32(hi.xxxx(), lo2, &dst[4]);
-	ExpandCLUT64_T32(hi.xxxx(), lo3, &dst[6]);
-	ExpandCLUT64_T32(hi.yyyy(), lo0, &dst[8]);
-	ExpandCLUT64_T32(hi.yyyy(), lo1, &dst[10]);
-	ExpandCLUT64_T32(hi.yyyy(), lo2, &dst[12]);
-	ExpandCLUT64_T32(hi.yyyy(), lo3, &dst[14]);
-	ExpandCLUT64_T32(hi.zzzz(), lo0, &dst[16]);
-	ExpandCLUT64_T32(hi.zzzz(), lo1, &dst[18]);
-	ExpandCLUT64_T32(hi.zzzz(), lo2, &dst[20]);
-	ExpandCLUT64_T32(hi.zzzz(), lo3, &dst[22]);
-	ExpandCLUT64_T32(hi.wwww(), lo0, &dst[24]);
-	ExpandCLUT64_T32(hi.wwww(), lo1, &dst[26]);
-	ExpandCLUT64_T32(hi.wwww(), lo2, &dst[28]);
-	ExpandCLUT64_T32(hi.wwww(), lo3, &dst[30]);
+#endif
 }
 
-__forceinline void GSClut::ExpandCLUT64_T32(const GSVector4i& hi, const GSVector4i& lo, GSVector4i* dst)
+template <bool AEM>
+static void Expand16(const u16* RESTRICT src, u32* RESTRICT dst, int w, const GIFRegTEXA& TEXA)
 {
-	dst[0] = lo.upl32(hi);
-	dst[1] = lo.uph32(hi);
-}
+	// w is 16 or 256
 
-#if 0
-void GSClut::ExpandCLUT64_T16_I8(const u32* RESTRICT src, u64* RESTRICT dst)
-{
-	GSVector4i* s = (GSVector4i*)src;
-	GSVector4i* d = (GSVector4i*)dst;
+#if _M_SSE >= 0x501
 
-	GSVector4i s0 = s[0];
-	GSVector4i s1 = s[1];
-	GSVector4i s2 = s[2];
-	GSVector4i s3 = s[3];
+	ASSERT((w & 15) == 0);
 
-	ExpandCLUT64_T16(s0, s0, s1, s2, s3, &d[0]);
-	ExpandCLUT64_T16(s1, s0, s1, s2, s3, &d[32]);
-	ExpandCLUT64_T16(s2, s0, s1, s2, s3, &d[64]);
-	ExpandCLUT64_T16(s3, s0, s1, s2, s3, &d[96]);
-}
-#endif
+	const GSVector8i* s = (const GSVector8i*)src;
+	GSVector8i* d = (GSVector8i*)dst;
 
-__forceinline void GSClut::ExpandCLUT64_T16(const GSVector4i& hi, const GSVector4i& lo0, const GSVector4i& lo1, const GSVector4i& lo2, const GSVector4i& lo3, GSVector4i* dst)
-{
-	ExpandCLUT64_T16(hi.xxxx(), lo0, &dst[0]);
-	ExpandCLUT64_T16(hi.xxxx(), lo1, &dst[2]);
-	ExpandCLUT64_T16(hi.xxxx(), lo2, &dst[4]);
-	ExpandCLUT64_T16(hi.xxxx(), lo3, &dst[6]);
-	ExpandCLUT64_T16(hi.yyyy(), lo0, &dst[8]);
-	ExpandCLUT64_T16(hi.yyyy(), lo1, &dst[10]);
-	ExpandCLUT64_T16(hi.yyyy(), lo2, &dst[12]);
-	ExpandCLUT64_T16(hi.yyyy(), lo3, &dst[14]);
-	ExpandCLUT64_T16(hi.zzzz(), lo0, &dst[16]);
-	ExpandCLUT64_T16(hi.zzzz(), lo1, &dst[18]);
-	ExpandCLUT64_T16(hi.zzzz(), lo2, &dst[20]);
-	ExpandCLUT64_T16(hi.zzzz(), lo3, &dst[22]);
-	ExpandCLUT64_T16(hi.wwww(), lo0, &dst[24]);
-	ExpandCLUT64_T16(hi.wwww(), lo1, &dst[26]);
-	ExpandCLUT64_T16(hi.wwww(), lo2, &dst[28]);
-	ExpandCLUT64_T16(hi.wwww(), lo3, &dst[30]);
-}
+	const GSVector8i TA0(TEXA.TA0 << 24);
+	const GSVector8i TA1(TEXA.TA1 << 24);
 
-__forceinline void GSClut::ExpandCLUT64_T16(const GSVector4i& hi, const GSVector4i& lo, GSVector4i* dst)
-{
-	dst[0] = lo.upl16(hi);
-	dst[1] = lo.uph16(hi);
-}
+	for (int i = 0, j = w >> 4; i < j; i++)
+	{
+		GSVector8i c = s[i].acbd();
 
-// TODO
+		d[i * 2 + 0] = GSBlock::Expand16to32<AEM>(c.upl16(c), TA0, TA1);
+		d[i * 2 + 1] = GSBlock::Expand16to32<AEM>(c.uph16(c), TA0, TA1);
+	}
 
-CONSTINIT const GSVector4i GSClut::m_bm = GSVector4i::cxpr(0x00007c00);
-CONSTINIT const GSVector4i GSClut::m_gm = GSVector4i::cxpr(0x000003e0);
-CONSTINIT const GSVector4i GSClut::m_rm = GSVector4i::cxpr(0x0000001f);
+#else
 
-void GSClut::Expand16(const u16* RESTRICT src, u32* RESTRICT dst, int w, const GIFRegTEXA& TEXA)
-{
 	ASSERT((w & 7) == 0);
 
-	const GSVector4i rm = m_rm;
-	const GSVector4i gm = m_gm;
-	const GSVector4i bm = m_bm;
-
-	GSVector4i TA0(TEXA.TA0 << 24);
-	GSVector4i TA1(TEXA.TA1 << 24);
-
-	GSVector4i c, cl, ch;
-
 	const GSVector4i* s = (const GSVector4i*)src;
 	GSVector4i* d = (GSVector4i*)dst;
 
-	if (!TEXA.AEM)
-	{
-		for (int i = 0, j = w >> 3; i < j; i++)
-		{
-			c = s[i];
-			cl = c.upl16(c);
-			ch = c.uph16(c);
-			d[i * 2 + 0] = ((cl & rm) << 3) | ((cl & gm) << 6) | ((cl & bm) << 9) | TA0.blend8(TA1, cl.sra16(15));
-			d[i * 2 + 1] = ((ch & rm) << 3) | ((ch & gm) << 6) | ((ch & bm) << 9) | TA0.blend8(TA1, ch.sra16(15));
-		}
-	}
-	else
+	const GSVector4i TA0(TEXA.TA0 << 24);
+	const GSVector4i TA1(TEXA.TA1 << 24);
+
+	for (int i = 0, j = w >> 3; i < j; i++)
 	{
-		for (int i = 0, j = w >> 3; i < j; i++)
-		{
-			c = s[i];
-			cl = c.upl16(c);
-			ch = c.uph16(c);
-			d[i * 2 + 0] = ((cl & rm) << 3) | ((cl & gm) << 6) | ((cl & bm) << 9) | TA0.blend8(TA1, cl.sra16(15)).andnot(cl == GSVector4i::zero());
-			d[i * 2 + 1] = ((ch & rm) << 3) | ((ch & gm) << 6) | ((ch & bm) << 9) | TA0.blend8(TA1, ch.sra16(15)).andnot(ch == GSVector4i::zero());
-		}
-	}
-}
+		GSVector4i c = s[i];
 
-//
+		d[i * 2 + 0] = GSBlock::Expand16to32<AEM>(c.upl16(c), TA0, TA1);
+		d[i * 2 + 1] = GSBlock::Expand16to32<AEM>(c.uph16(c), TA0, TA1);
+	}
 
-bool GSClut::WriteState::IsDirty(const GIFRegTEX0& TEX0, const GIFRegTEXCLUT& TEXCLUT)
-{
-	return dirty || !GSVector4i::load<true>(this).eq(GSVector4i::load(&TEX0, &TEXCLUT));
+#endif
 }
 
-bool GSClut::ReadState::IsDirty(const GIFRegTEX0& TEX0)
+static void Expand16(const u16* RESTRICT src, u32* RESTRICT dst, int w, const GIFRegTEXA& TEXA)
 {
-	return dirty || !GSVector4i::load<true>(this).eq(GSVector4i::load(&TEX0, &this->TEXA));
+	if (TEXA.AEM)
+		Expand16<true>(src, dst, w, TEXA);
+	else
+		Expand16<false>(src, dst, w, TEXA);
 }
 
-bool GSClut::ReadState::IsDirty(const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA)
+void GSClutPopulateFunctions(GSClutFunctions& fn)
 {
-	return dirty || !GSVector4i::load<true>(this).eq(GSVector4i::load(&TEX0, &TEXA));
+	fn.WriteCLUT_T32_I8_CSM1 = WriteCLUT_T32_I8_CSM1;
+	fn.WriteCLUT_T32_I4_CSM1 = WriteCLUT_T32_I4_CSM1;
+	fn.WriteCLUT_T16_I8_CSM1 = WriteCLUT_T16_I8_CSM1;
+	fn.WriteCLUT_T16_I4_CSM1 = WriteCLUT_T16_I4_CSM1;
+	fn.ReadCLUT_T32_I8 = ReadCLUT_T32_I8;
+	fn.ReadCLUT_T32_I4 = ReadCLUT_T32_I4;
+	fn.ExpandCLUT64_T32_I8 = ExpandCLUT64_T32_I8;
+	fn.Expand16 = Expand16;
 }
+
+MULTI_ISA_UNSHARED_END
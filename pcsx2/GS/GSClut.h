@@ -19,15 +19,27 @@
 #include "GSVector.h"
 #include "GSTables.h"
 #include "GSAlignedClass.h"
+#include "MultiISA.h"
 
 class GSLocalMemory;
 
-class alignas(32) GSClut : public GSAlignedClass<32>
+/// Palette conversion kernels, compiled once per ISA in multi-ISA builds
+struct GSClutFunctions
 {
-	static const GSVector4i m_bm;
-	static const GSVector4i m_gm;
-	static const GSVector4i m_rm;
+	void (*WriteCLUT_T32_I8_CSM1)(const u32* src, u16* clut, u16 offset);
+	void (*WriteCLUT_T32_I4_CSM1)(const u32* src, u16* clut);
+	void (*WriteCLUT_T16_I8_CSM1)(const u16* src, u16* clut);
+	void (*WriteCLUT_T16_I4_CSM1)(const u16* src, u16* clut);
+	void (*ReadCLUT_T32_I8)(const u16* clut, u32* dst, int offset);
+	void (*ReadCLUT_T32_I4)(const u16* clut, u32* dst);
+	void (*ExpandCLUT64_T32_I8)(const u32* src, u64* dst);
+	void (*Expand16)(const u16* src, u32* dst, int w, const GIFRegTEXA& TEXA);
+};
 
+MULTI_ISA_DEF(void GSClutPopulateFunctions(GSClutFunctions& fn);)
+
+class alignas(32) GSClut : public GSAlignedClass<32>
+{
 	GSLocalMemory* m_mem;
 
 	u32 m_CBP[2];
@@ -35,6 +47,26 @@ class alignas(32) GSClut : public GSAlignedClass<32>
 	u32* m_buff32;
 	u64* m_buff64;
 
+	/// Expanded palettes found by the content of the CLUT they came from.
+	/// Games often switch between a few palettes every draw, this skips converting them again.
+	struct alignas(64) PaletteCacheEntry
+	{
+		u32 buff32[256];
+		u64 buff64[256];
+		u64 hash;
+		u64 key; ///< How the CLUT was read: format, CSA where it changes the result and TEXA for 16 bit
+		u64 last_use;
+		int amin, amax;
+		bool alpha_valid;
+		bool valid;
+	};
+
+	static constexpr int PALETTE_CACHE_SIZE = 8;
+
+	PaletteCacheEntry* m_palette_cache;
+	PaletteCacheEntry* m_palette; ///< Entry m_buff32 and m_buff64 point into
+	u64 m_palette_clock;
+
 	struct alignas(32) WriteState
 	{
 		GIFRegTEX0 TEX0;
@@ -74,29 +106,14 @@ class alignas(32) GSClut : public GSAlignedClass<32>
 
 	void WriteCLUT_NULL(const GIFRegTEX0& TEX0, const GIFRegTEXCLUT& TEXCLUT);
 
-	static void WriteCLUT_T32_I8_CSM1(const u32* RESTRICT src, u16* RESTRICT clut, u16 offset);
-	static void WriteCLUT_T32_I4_CSM1(const u32* RESTRICT src, u16* RESTRICT clut);
-	static void WriteCLUT_T16_I8_CSM1(const u16* RESTRICT src, u16* RESTRICT clut);
-	static void WriteCLUT_T16_I4_CSM1(const u16* RESTRICT src, u16* RESTRICT clut);
-	static void ReadCLUT_T32_I8(const u16* RESTRICT clut, u32* RESTRICT dst, int offset);
-	static void ReadCLUT_T32_I4(const u16* RESTRICT clut, u32* RESTRICT dst);
-	//static void ReadCLUT_T32_I4(const u16* RESTRICT clut, u32* RESTRICT dst32, u64* RESTRICT dst64);
-	//static void ReadCLUT_T16_I8(const u16* RESTRICT clut, u32* RESTRICT dst);
-	//static void ReadCLUT_T16_I4(const u16* RESTRICT clut, u32* RESTRICT dst);
-	//static void ReadCLUT_T16_I4(const u16* RESTRICT clut, u32* RESTRICT dst32, u64* RESTRICT dst64);
-public:
-	static void ExpandCLUT64_T32_I8(const u32* RESTRICT src, u64* RESTRICT dst);
-
-private:
-	static void ExpandCLUT64_T32(const GSVector4i& hi, const GSVector4i& lo0, const GSVector4i& lo1, const GSVector4i& lo2, const GSVector4i& lo3, GSVector4i* dst);
-	static void ExpandCLUT64_T32(const GSVector4i& hi, const GSVector4i& lo, GSVector4i* dst);
-	//static void ExpandCLUT64_T16_I8(const u32* RESTRICT src, u64* RESTRICT dst);
-	static void ExpandCLUT64_T16(const GSVector4i& hi, const GSVector4i& lo0, const GSVector4i& lo1, const GSVector4i& lo2, const GSVector4i& lo3, GSVector4i* dst);
-	static void ExpandCLUT64_T16(const GSVector4i& hi, const GSVector4i& lo, GSVector4i* dst);
-
-	static void Expand16(const u16* RESTRICT src, u32* RESTRICT dst, int w, const GIFRegTEXA& TEXA);
+	/// Points m_buff32/m_buff64 at the cached palette for key and hash, or at the least recently used entry to convert into.
+	/// Returns true if the palette was already there.
+	bool FindPalette(u64 key, u64 hash);
 
 public:
+	/// Kernels for the running CPU, filled in at GSopen
+	static GSClutFunctions m_fn;
+
 	GSClut(GSLocalMemory* mem);
 	virtual ~GSClut();
 
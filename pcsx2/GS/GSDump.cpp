@@ -223,3 +223,109 @@ void GSDumpXz::Compress(lzma_action action, lzma_ret expected_status)
 
 	} while (m_strm.avail_out == 0);
 }
+
+#ifdef USE_ZSTD
+
+//////////////////////////////////////////////////////////////////////
+// GSDumpZst implementation
+//////////////////////////////////////////////////////////////////////
+
+GSDumpZst::GSDumpZst(const std::string& fn, const std::string& serial, u32 crc,
+	u32 screenshot_width, u32 screenshot_height, const u32* screenshot_pixels,
+	const freezeData& fd, const GSPrivRegSet* regs)
+	: GSDumpBase(fn + ".gs.zst")
+{
+	m_cctx = ZSTD_createCCtx();
+	if (!m_cctx)
+	{
+		fprintf(stderr, "GSDumpZst: Error creating zstd context\n");
+		return;
+	}
+
+	ZSTD_CCtx_setParameter(m_cctx, ZSTD_c_compressionLevel, 3);
+	ZSTD_CCtx_setParameter(m_cctx, ZSTD_c_checksumFlag, 1);
+
+	m_in_buff.reserve(CHUNK_SIZE);
+	m_compress_buff.reserve(CHUNK_SIZE);
+	m_thread = std::thread(&GSDumpZst::CompressThread, this);
+
+	AddHeader(serial, crc, screenshot_width, screenshot_height, screenshot_pixels, fd, regs);
+}
+
+GSDumpZst::~GSDumpZst()
+{
+	if (m_thread.joinable())
+	{
+		SubmitChunk();
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_shutdown = true;
+		}
+		m_cv.notify_all();
+		m_thread.join();
+	}
+
+	ZSTD_freeCCtx(m_cctx);
+}
+
+void GSDumpZst::AppendRawData(const void* data, size_t size)
+{
+	size_t old_size = m_in_buff.size();
+	m_in_buff.resize(old_size + size);
+	memcpy(&m_in_buff[old_size], data, size);
+
+	if (m_in_buff.size() >= CHUNK_SIZE)
+		SubmitChunk();
+}
+
+void GSDumpZst::AppendRawData(u8 c)
+{
+	m_in_buff.push_back(c);
+
+	if (m_in_buff.size() >= CHUNK_SIZE)
+		SubmitChunk();
+}
+
+void GSDumpZst::SubmitChunk()
+{
+	if (m_in_buff.empty() || !m_cctx)
+		return;
+
+	// If the last chunk is still being compressed we have to wait for it, so we don't buffer without limit
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_cv.wait(lock, [this]() { return !m_compress_pending; });
+
+	std::swap(m_in_buff, m_compress_buff);
+	m_in_buff.clear();
+	m_compress_pending = true;
+	lock.unlock();
+	m_cv.notify_all();
+}
+
+void GSDumpZst::CompressThread()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;)
+	{
+		m_cv.wait(lock, [this]() { return m_compress_pending || m_shutdown; });
+		if (!m_compress_pending)
+			break;
+
+		lock.unlock();
+
+		m_out_buff.resize(ZSTD_compressBound(m_compress_buff.size()));
+		const size_t ret = ZSTD_compress2(m_cctx, m_out_buff.data(), m_out_buff.size(),
+			m_compress_buff.data(), m_compress_buff.size());
+		if (ZSTD_isError(ret))
+			fprintf(stderr, "GSDumpZst: Error %s\n", ZSTD_getErrorName(ret));
+		else
+			Write(m_out_buff.data(), ret);
+
+		lock.lock();
+		m_compress_pending = false;
+		m_cv.notify_all();
+	}
+}
+
+#endif
@@ -19,6 +19,12 @@
 #include "GSRegs.h"
 #include "Renderers/SW/GSVertexSW.h"
 #include <lzma.h>
+#ifdef USE_ZSTD
+#include <zstd.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
 
 /*
 
@@ -107,3 +113,35 @@ public:
 		const freezeData& fd, const GSPrivRegSet* regs);
 	virtual ~GSDumpXz();
 };
+
+#ifdef USE_ZSTD
+class GSDumpZst final : public GSDumpBase
+{
+	// Data is compressed in chunks of this size, each its own zstd frame so they can be decompressed in parallel
+	static constexpr size_t CHUNK_SIZE = 4 * 1024 * 1024;
+
+	ZSTD_CCtx* m_cctx = nullptr;
+
+	// One chunk is filled while the other is compressed
+	std::vector<u8> m_in_buff;
+	std::vector<u8> m_compress_buff;
+	std::vector<u8> m_out_buff;
+
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	bool m_compress_pending = false;
+	bool m_shutdown = false;
+
+	void SubmitChunk();
+	void CompressThread();
+	void AppendRawData(const void* data, size_t size) final;
+	void AppendRawData(u8 c) final;
+
+public:
+	GSDumpZst(const std::string& fn, const std::string& serial, u32 crc,
+		u32 screenshot_width, u32 screenshot_height, const u32* screenshot_pixels,
+		const freezeData& fd, const GSPrivRegSet* regs);
+	virtual ~GSDumpZst();
+};
+#endif
@@ -0,0 +1,1005 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021 PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "GSLocalMemory.h"
+#include "GSBlock.h"
+#include "GSExtra.h"
+#include "GSUtil.h"
+
+// Swizzle, unswizzle and CLUT expansion kernels for GSLocalMemory.
+// This file is compiled once per ISA in multi-ISA builds, see MultiISA.h.
+
+MULTI_ISA_UNSHARED_START
+
+template <typename Fn>
+static void foreachBlock(const GSOffset& off, const GSLocalMemory& mem, const GSVector4i& r, u8* dst, int dstpitch, int bpp, Fn&& fn)
+{
+	ASSERT(off.isBlockAligned(r));
+	GSOffset::BNHelper bn = off.bnMulti(r.left, r.top);
+	int right = r.right >> off.blockShiftX();
+	int bottom = r.bottom >> off.blockShiftY();
+
+	int offset = dstpitch << off.blockShiftY();
+	int xAdd = (1 << off.blockShiftX()) * (bpp / 8);
+
+	for (; bn.blkY() < bottom; bn.nextBlockY(), dst += offset)
+	{
+		for (int x = 0; bn.blkX() < right; bn.nextBlockX(), x += xAdd)
+		{
+			const u8* src = mem.BlockPtr(bn.value());
+			u8* read_dst = dst + x;
+			fn(read_dst, src);
+		}
+	}
+}
+
+////////////////////
+
+template <int psm, int bsx, int bsy, int alignment>
+static void WriteImageColumn(GSLocalMemory& mem, int l, int r, int y, int h, const u8* src, int srcpitch, const GIFRegBITBLTBUF& BITBLTBUF)
+{
+	u32 bp = BITBLTBUF.DBP;
+	u32 bw = BITBLTBUF.DBW;
+
+	const int csy = bsy / 4;
+
+	for (int offset = srcpitch * csy; h >= csy; h -= csy, y += csy, src += offset)
+	{
+		for (int x = l; x < r; x += bsx)
+		{
+			switch (psm)
+			{
+				case PSM_PSMCT32: GSBlock::WriteColumn32<alignment, 0xffffffff>(y, mem.BlockPtr32(x, y, bp, bw), &src[x * 4], srcpitch); break;
+				case PSM_PSMCT16: GSBlock::WriteColumn16<alignment>(y, mem.BlockPtr16(x, y, bp, bw), &src[x * 2], srcpitch); break;
+				case PSM_PSMCT16S: GSBlock::WriteColumn16<alignment>(y, mem.BlockPtr16S(x, y, bp, bw), &src[x * 2], srcpitch); break;
+				case PSM_PSMT8: GSBlock::WriteColumn8<alignment>(y, mem.BlockPtr8(x, y, bp, bw), &src[x], srcpitch); break;
+				case PSM_PSMT4: GSBlock::WriteColumn4<alignment>(y, mem.BlockPtr4(x, y, bp, bw), &src[x >> 1], srcpitch); break;
+				case PSM_PSMZ32: GSBlock::WriteColumn32<alignment, 0xffffffff>(y, mem.BlockPtr32Z(x, y, bp, bw), &src[x * 4], srcpitch); break;
+				case PSM_PSMZ16: GSBlock::WriteColumn16<alignment>(y, mem.BlockPtr16Z(x, y, bp, bw), &src[x * 2], srcpitch); break;
+				case PSM_PSMZ16S: GSBlock::WriteColumn16<alignment>(y, mem.BlockPtr16SZ(x, y, bp, bw), &src[x * 2], srcpitch); break;
+				// TODO
+				default: __assume(0);
+			}
+		}
+	}
+}
+
+template <int psm, int bsx, int bsy, int alignment>
+static void WriteImageBlock(GSLocalMemory& mem, int l, int r, int y, int h, const u8* src, int srcpitch, const GIFRegBITBLTBUF& BITBLTBUF)
+{
+	u32 bp = BITBLTBUF.DBP;
+	u32 bw = BITBLTBUF.DBW;
+
+	for (int offset = srcpitch * bsy; h >= bsy; h -= bsy, y += bsy, src += offset)
+	{
+		for (int x = l; x < r; x += bsx)
+		{
+			switch (psm)
+			{
+				case PSM_PSMCT32: GSBlock::WriteBlock32<alignment, 0xffffffff>(mem.BlockPtr32(x, y, bp, bw), &src[x * 4], srcpitch); break;
+				case PSM_PSMCT16: GSBlock::WriteBlock16<alignment>(mem.BlockPtr16(x, y, bp, bw), &src[x * 2], srcpitch); break;
+				case PSM_PSMCT16S: GSBlock::WriteBlock16<alignment>(mem.BlockPtr16S(x, y, bp, bw), &src[x * 2], srcpitch); break;
+				case PSM_PSMT8: GSBlock::WriteBlock8<alignment>(mem.BlockPtr8(x, y, bp, bw), &src[x], srcpitch); break;
+				case PSM_PSMT4: GSBlock::WriteBlock4<alignment>(mem.BlockPtr4(x, y, bp, bw), &src[x >> 1], srcpitch); break;
+				case PSM_PSMZ32: GSBlock::WriteBlock32<alignment, 0xffffffff>(mem.BlockPtr32Z(x, y, bp, bw), &src[x * 4], srcpitch); break;
+				case PSM_PSMZ16: GSBlock::WriteBlock16<alignment>(mem.BlockPtr16Z(x, y, bp, bw), &src[x * 2], srcpitch); break;
+				case PSM_PSMZ16S: GSBlock::WriteBlock16<alignment>(mem.BlockPtr16SZ(x, y, bp, bw), &src[x * 2], srcpitch); break;
+				// TODO
+				default: __assume(0);
+			}
+		}
+	}
+}
+
+template <int psm, int bsx, int bsy>
+static void WriteImageLeftRight(GSLocalMemory& mem, int l, int r, int y, int h, const u8* src, int srcpitch, const GIFRegBITBLTBUF& BITBLTBUF)
+{
+	u32 bp = BITBLTBUF.DBP;
+	u32 bw = BITBLTBUF.DBW;
+
+	for (; h > 0; y++, h--, src += srcpitch)
+	{
+		for (int x = l; x < r; x++)
+		{
+			switch (psm)
+			{
+				case PSM_PSMCT32: mem.WritePixel32(x, y, *(u32*)&src[x * 4], bp, bw); break;
+				case PSM_PSMCT16: mem.WritePixel16(x, y, *(u16*)&src[x * 2], bp, bw); break;
+				case PSM_PSMCT16S: mem.WritePixel16S(x, y, *(u16*)&src[x * 2], bp, bw); break;
+				case PSM_PSMT8: mem.WritePixel8(x, y, src[x], bp, bw); break;
+				case PSM_PSMT4: mem.WritePixel4(x, y, src[x >> 1] >> ((x & 1) << 2), bp, bw); break;
+				case PSM_PSMZ32: mem.WritePixel32Z(x, y, *(u32*)&src[x * 4], bp, bw); break;
+				case PSM_PSMZ16: mem.WritePixel16Z(x, y, *(u16*)&src[x * 2], bp, bw); break;
+				case PSM_PSMZ16S: mem.WritePixel16SZ(x, y, *(u16*)&src[x * 2], bp, bw); break;
+				// TODO
+				default: __assume(0);
+			}
+		}
+	}
+}
+
+template <int psm, int bsx, int bsy, int trbpp>
+static void WriteImageTopBottom(GSLocalMemory& mem, int l, int r, int y, int h, const u8* src, int srcpitch, const GIFRegBITBLTBUF& BITBLTBUF)
+{
+	alignas(32) u8 buff[64]; // merge buffer for one column
+
+	u32 bp = BITBLTBUF.DBP;
+	u32 bw = BITBLTBUF.DBW;
+
+	const int csy = bsy / 4;
+
+	// merge incomplete column
+
+	int y2 = y & (csy - 1);
+
+	if (y2 > 0)
+	{
+		int h2 = std::min(h, csy - y2);
+
+		for (int x = l; x < r; x += bsx)
+		{
+			u8* dst = NULL;
+
+			switch (psm)
+			{
+				case PSM_PSMCT32: dst = mem.BlockPtr32(x, y, bp, bw); break;
+				case PSM_PSMCT16: dst = mem.BlockPtr16(x, y, bp, bw); break;
+				case PSM_PSMCT16S: dst = mem.BlockPtr16S(x, y, bp, bw); break;
+				case PSM_PSMT8: dst = mem.BlockPtr8(x, y, bp, bw); break;
+				case PSM_PSMT4: dst = mem.BlockPtr4(x, y, bp, bw); break;
+				case PSM_PSMZ32: dst = mem.BlockPtr32Z(x, y, bp, bw); break;
+				case PSM_PSMZ16: dst = mem.BlockPtr16Z(x, y, bp, bw); break;
+				case PSM_PSMZ16S: dst = mem.BlockPtr16SZ(x, y, bp, bw); break;
+				// TODO
+				default: __assume(0);
+			}
+
+			switch (psm)
+			{
+				case PSM_PSMCT32:
+				case PSM_PSMZ32:
+					GSBlock::ReadColumn32(y, dst, buff, 32);
+					memcpy(&buff[32], &src[x * 4], 32);
+					GSBlock::WriteColumn32<32, 0xffffffff>(y, dst, buff, 32);
+					break;
+				case PSM_PSMCT16:
+				case PSM_PSMCT16S:
+				case PSM_PSMZ16:
+				case PSM_PSMZ16S:
+					GSBlock::ReadColumn16(y, dst, buff, 32);
+					memcpy(&buff[32], &src[x * 2], 32);
+					GSBlock::WriteColumn16<32>(y, dst, buff, 32);
+					break;
+				case PSM_PSMT8:
+					GSBlock::ReadColumn8(y, dst, buff, 16);
+					for (int i = 0, j = y2; i < h2; i++, j++)
+						memcpy(&buff[j * 16], &src[i * srcpitch + x], 16);
+					GSBlock::WriteColumn8<32>(y, dst, buff, 16);
+					break;
+				case PSM_PSMT4:
+					GSBlock::ReadColumn4(y, dst, buff, 16);
+					for (int i = 0, j = y2; i < h2; i++, j++)
+						memcpy(&buff[j * 16], &src[i * srcpitch + (x >> 1)], 16);
+					GSBlock::WriteColumn4<32>(y, dst, buff, 16);
+					break;
+				// TODO
+				default:
+					__assume(0);
+			}
+		}
+
+		src += srcpitch * h2;
+		y += h2;
+		h -= h2;
+	}
+
+	// write whole columns
+
+	{
+		int h2 = h & ~(csy - 1);
+
+		if (h2 > 0)
+		{
+#if FAST_UNALIGNED
+			WriteImageColumn<psm, bsx, bsy, 0>(mem, l, r, y, h2, src, srcpitch, BITBLTBUF);
+#else
+			size_t addr = (size_t)&src[l * trbpp >> 3];
+
+			if ((addr & 31) == 0 && (srcpitch & 31) == 0)
+			{
+				WriteImageColumn<psm, bsx, bsy, 32>(mem, l, r, y, h2, src, srcpitch, BITBLTBUF);
+			}
+			else if ((addr & 15) == 0 && (srcpitch & 15) == 0)
+			{
+				WriteImageColumn<psm, bsx, bsy, 16>(mem, l, r, y, h2, src, srcpitch, BITBLTBUF);
+			}
+			else
+			{
+				WriteImageColumn<psm, bsx, bsy, 0>(mem, l, r, y, h2, src, srcpitch, BITBLTBUF);
+			}
+#endif
+
+			src += srcpitch * h2;
+			y += h2;
+			h -= h2;
+		}
+	}
+
+	// merge incomplete column
+
+	if (h >= 1)
+	{
+		for (int x = l; x < r; x += bsx)
+		{
+			u8* dst = NULL;
+
+			switch (psm)
+			{
+			case PSM_PSMCT32: dst = mem.BlockPtr32(x, y, bp, bw); break;
+			case PSM_PSMCT16: dst = mem.BlockPtr16(x, y, bp, bw); break;
+			case PSM_PSMCT16S: dst = mem.BlockPtr16S(x, y, bp, bw); break;
+			case PSM_PSMT8: dst = mem.BlockPtr8(x, y, bp, bw); break;
+			case PSM_PSMT4: dst = mem.BlockPtr4(x, y, bp, bw); break;
+			case PSM_PSMZ32: dst = mem.BlockPtr32Z(x, y, bp, bw); break;
+			case PSM_PSMZ16: dst = mem.BlockPtr16Z(x, y, bp, bw); break;
+			case PSM_PSMZ16S: dst = mem.BlockPtr16SZ(x, y, bp, bw); break;
+			// TODO
+			default: __assume(0);
+			}
+
+			switch (psm)
+			{
+				case PSM_PSMCT32:
+				case PSM_PSMZ32:
+					GSBlock::ReadColumn32(y, dst, buff, 32);
+					memcpy(&buff[0], &src[x * 4], 32);
+					GSBlock::WriteColumn32<32, 0xffffffff>(y, dst, buff, 32);
+					break;
+				case PSM_PSMCT16:
+				case PSM_PSMCT16S:
+				case PSM_PSMZ16:
+				case PSM_PSMZ16S:
+					GSBlock::ReadColumn16(y, dst, buff, 32);
+					memcpy(&buff[0], &src[x * 2], 32);
+					GSBlock::WriteColumn16<32>(y, dst, buff, 32);
+					break;
+				case PSM_PSMT8:
+					GSBlock::ReadColumn8(y, dst, buff, 16);
+					for (int i = 0; i < h; i++)
+						memcpy(&buff[i * 16], &src[i * srcpitch + x], 16);
+					GSBlock::WriteColumn8<32>(y, dst, buff, 16);
+					break;
+				case PSM_PSMT4:
+					GSBlock::ReadColumn4(y, dst, buff, 16);
+					for (int i = 0; i < h; i++)
+						memcpy(&buff[i * 16], &src[i * srcpitch + (x >> 1)], 16);
+					GSBlock::WriteColumn4<32>(y, dst, buff, 16);
+					break;
+				// TODO
+				default:
+					__assume(0);
+			}
+		}
+	}
+}
+
+template <int psm, int bsx, int bsy, int trbpp>
+static void WriteImage(GSLocalMemory& mem, int& tx, int& ty, const u8* src, int len, GIFRegBITBLTBUF& BITBLTBUF, GIFRegTRXPOS& TRXPOS, GIFRegTRXREG& TRXREG)
+{
+	if (TRXREG.RRW == 0)
+		return;
+
+	int l = (int)TRXPOS.DSAX;
+	int r = l + (int)TRXREG.RRW;
+
+	// finish the incomplete row first
+
+	if (tx != l)
+	{
+		int n = std::min(len, (r - tx) * trbpp >> 3);
+		mem.WriteImageX(tx, ty, src, n, BITBLTBUF, TRXPOS, TRXREG);
+		src += n;
+		len -= n;
+	}
+
+	int la = (l + (bsx - 1)) & ~(bsx - 1);
+	int ra = r & ~(bsx - 1);
+	int srcpitch = (r - l) * trbpp >> 3;
+	int h = len / srcpitch;
+
+	if (ra - la >= bsx && h > 0) // "transfer width" >= "block width" && there is at least one full row
+	{
+		const u8* s = &src[-l * trbpp >> 3];
+
+		src += srcpitch * h;
+		len -= srcpitch * h;
+
+		// left part
+
+		if (l < la)
+		{
+			WriteImageLeftRight<psm, bsx, bsy>(mem, l, la, ty, h, s, srcpitch, BITBLTBUF);
+		}
+
+		// right part
+
+		if (ra < r)
+		{
+			WriteImageLeftRight<psm, bsx, bsy>(mem, ra, r, ty, h, s, srcpitch, BITBLTBUF);
+		}
+
+		// horizontally aligned part
+
+		if (la < ra)
+		{
+			// top part
+
+			{
+				int h2 = std::min(h, bsy - (ty & (bsy - 1)));
+
+				if (h2 < bsy)
+				{
+					WriteImageTopBottom<psm, bsx, bsy, trbpp>(mem, la, ra, ty, h2, s, srcpitch, BITBLTBUF);
+
+					s += srcpitch * h2;
+					ty += h2;
+					h -= h2;
+				}
+			}
+
+			// horizontally and vertically aligned part
+
+			{
+				int h2 = h & ~(bsy - 1);
+
+				if (h2 > 0)
+				{
+#if FAST_UNALIGNED
+					WriteImageBlock<psm, bsx, bsy, 0>(mem, la, ra, ty, h2, s, srcpitch, BITBLTBUF);
+#else
+					size_t addr = (size_t)&s[la * trbpp >> 3];
+
+					if ((addr & 31) == 0 && (srcpitch & 31) == 0)
+					{
+						WriteImageBlock<psm, bsx, bsy, 32>(mem, la, ra, ty, h2, s, srcpitch, BITBLTBUF);
+					}
+					else if ((addr & 15) == 0 && (srcpitch & 15) == 0)
+					{
+						WriteImageBlock<psm, bsx, bsy, 16>(mem, la, ra, ty, h2, s, srcpitch, BITBLTBUF);
+					}
+					else
+					{
+						WriteImageBlock<psm, bsx, bsy, 0>(mem, la, ra, ty, h2, s, srcpitch, BITBLTBUF);
+					}
+#endif
+
+					s += srcpitch * h2;
+					ty += h2;
+					h -= h2;
+				}
+			}
+
+			// bottom part
+
+			if (h > 0)
+			{
+				WriteImageTopBottom<psm, bsx, bsy, trbpp>(mem, la, ra, ty, h, s, srcpitch, BITBLTBUF);
+
+				// s += srcpitch * h;
+				ty += h;
+				// h -= h;
+			}
+		}
+	}
+
+	// the rest
+
+	if (len > 0)
+	{
+		mem.WriteImageX(tx, ty, src, len, BITBLTBUF, TRXPOS, TRXREG);
+	}
+}
+
+
+static bool IsTopLeftAligned(int dsax, int tx, int ty, int bw, int bh)
+{
+	return ((dsax & (bw - 1)) == 0 && (tx & (bw - 1)) == 0 && dsax == tx && (ty & (bh - 1)) == 0);
+}
+
+static void WriteImage24(GSLocalMemory& mem, int& tx, int& ty, const u8* src, int len, GIFRegBITBLTBUF& BITBLTBUF, GIFRegTRXPOS& TRXPOS, GIFRegTRXREG& TRXREG)
+{
+	if (TRXREG.RRW == 0)
+		return;
+
+	u32 bp = BITBLTBUF.DBP;
+	u32 bw = BITBLTBUF.DBW;
+
+	int tw = TRXPOS.DSAX + TRXREG.RRW, srcpitch = TRXREG.RRW * 3;
+	int th = len / srcpitch;
+
+	bool aligned = IsTopLeftAligned(TRXPOS.DSAX, tx, ty, 8, 8);
+
+	if (!aligned || (tw & 7) || (th & 7) || (len % srcpitch))
+	{
+		// TODO
+
+		mem.WriteImageX(tx, ty, src, len, BITBLTBUF, TRXPOS, TRXREG);
+	}
+	else
+	{
+		th += ty;
+
+		for (int y = ty; y < th; y += 8, src += srcpitch * 8)
+		{
+			for (int x = tx; x < tw; x += 8)
+			{
+				GSBlock::UnpackAndWriteBlock24(src + (x - tx) * 3, srcpitch, mem.BlockPtr32(x, y, bp, bw));
+			}
+		}
+
+		ty = th;
+	}
+}
+
+static void WriteImage8H(GSLocalMemory& mem, int& tx, int& ty, const u8* src, int len, GIFRegBITBLTBUF& BITBLTBUF, GIFRegTRXPOS& TRXPOS, GIFRegTRXREG& TRXREG)
+{
+	if (TRXREG.RRW == 0)
+		return;
+
+	u32 bp = BITBLTBUF.DBP;
+	u32 bw = BITBLTBUF.DBW;
+
+	int tw = TRXPOS.DSAX + TRXREG.RRW, srcpitch = TRXREG.RRW;
+	int th = len / srcpitch;
+
+	bool aligned = IsTopLeftAligned(TRXPOS.DSAX, tx, ty, 8, 8);
+
+	if (!aligned || (tw & 7) || (th & 7) || (len % srcpitch))
+	{
+		// TODO
+
+		mem.WriteImageX(tx, ty, src, len, BITBLTBUF, TRXPOS, TRXREG);
+	}
+	else
+	{
+		th += ty;
+
+		for (int y = ty; y < th; y += 8, src += srcpitch * 8)
+		{
+			for (int x = tx; x < tw; x += 8)
+			{
+				GSBlock::UnpackAndWriteBlock8H(src + (x - tx), srcpitch, mem.BlockPtr32(x, y, bp, bw));
+			}
+		}
+
+		ty = th;
+	}
+}
+
+static void WriteImage4HL(GSLocalMemory& mem, int& tx, int& ty, const u8* src, int len, GIFRegBITBLTBUF& BITBLTBUF, GIFRegTRXPOS& TRXPOS, GIFRegTRXREG& TRXREG)
+{
+	if (TRXREG.RRW == 0)
+		return;
+
+	u32 bp = BITBLTBUF.DBP;
+	u32 bw = BITBLTBUF.DBW;
+
+	int tw = TRXPOS.DSAX + TRXREG.RRW, srcpitch = TRXREG.RRW / 2;
+	int th = len / srcpitch;
+
+	bool aligned = IsTopLeftAligned(TRXPOS.DSAX, tx, ty, 8, 8);
+
+	if (!aligned || (tw & 7) || (th & 7) || (len % srcpitch))
+	{
+		// TODO
+
+		mem.WriteImageX(tx, ty, src, len, BITBLTBUF, TRXPOS, TRXREG);
+	}
+	else
+	{
+		th += ty;
+
+		for (int y = ty; y < th; y += 8, src += srcpitch * 8)
+		{
+			for (int x = tx; x < tw; x += 8)
+			{
+				GSBlock::UnpackAndWriteBlock4HL(src + (x - tx) / 2, srcpitch, mem.BlockPtr32(x, y, bp, bw));
+			}
+		}
+
+		ty = th;
+	}
+}
+
+static void WriteImage4HH(GSLocalMemory& mem, int& tx, int& ty, const u8* src, int len, GIFRegBITBLTBUF& BITBLTBUF, GIFRegTRXPOS& TRXPOS, GIFRegTRXREG& TRXREG)
+{
+	if (TRXREG.RRW == 0)
+		return;
+
+	u32 bp = BITBLTBUF.DBP;
+	u32 bw = BITBLTBUF.DBW;
+
+	int tw = TRXPOS.DSAX + TRXREG.RRW, srcpitch = TRXREG.RRW / 2;
+	int th = len / srcpitch;
+
+	bool aligned = IsTopLeftAligned(TRXPOS.DSAX, tx, ty, 8, 8);
+
+	if (!aligned || (tw & 7) || (th & 7) || (len % srcpitch))
+	{
+		// TODO
+
+		mem.WriteImageX(tx, ty, src, len, BITBLTBUF, TRXPOS, TRXREG);
+	}
+	else
+	{
+		th += ty;
+
+		for (int y = ty; y < th; y += 8, src += srcpitch * 8)
+		{
+			for (int x = tx; x < tw; x += 8)
+			{
+				GSBlock::UnpackAndWriteBlock4HH(src + (x - tx) / 2, srcpitch, mem.BlockPtr32(x, y, bp, bw));
+			}
+		}
+
+		ty = th;
+	}
+}
+
+static void WriteImage24Z(GSLocalMemory& mem, int& tx, int& ty, const u8* src, int len, GIFRegBITBLTBUF& BITBLTBUF, GIFRegTRXPOS& TRXPOS, GIFRegTRXREG& TRXREG)
+{
+	if (TRXREG.RRW == 0)
+		return;
+
+	u32 bp = BITBLTBUF.DBP;
+	u32 bw = BITBLTBUF.DBW;
+
+	int tw = TRXPOS.DSAX + TRXREG.RRW, srcpitch = TRXREG.RRW * 3;
+	int th = len / srcpitch;
+
+	bool aligned = IsTopLeftAligned(TRXPOS.DSAX, tx, ty, 8, 8);
+
+	if (!aligned || (tw & 7) || (th & 7) || (len % srcpitch))
+	{
+		// TODO
+
+		mem.WriteImageX(tx, ty, src, len, BITBLTBUF, TRXPOS, TRXREG);
+	}
+	else
+	{
+		th += ty;
+
+		for (int y = ty; y < th; y += 8, src += srcpitch * 8)
+		{
+			for (int x = tx; x < tw; x += 8)
+			{
+				GSBlock::UnpackAndWriteBlock24(src + (x - tx) * 3, srcpitch, mem.BlockPtr32Z(x, y, bp, bw));
+			}
+		}
+
+		ty = th;
+	}
+}
+///////////////////
+
+static void ReadTexture32(GSLocalMemory& mem, const GSOffset& off, const GSVector4i& r, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	foreachBlock(off.assertSizesMatch(GSLocalMemory::swizzle32), mem, r, dst, dstpitch, 32, [&](u8* read_dst, const u8* src)
+	{
+		GSBlock::ReadBlock32(src, read_dst, dstpitch);
+	});
+}
+
+static void ReadTexture24(GSLocalMemory& mem, const GSOffset& off, const GSVector4i& r, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	if (TEXA.AEM)
+	{
+		foreachBlock(off.assertSizesMatch(GSLocalMemory::swizzle32), mem, r, dst, dstpitch, 32, [&](u8* read_dst, const u8* src)
+		{
+			GSBlock::ReadAndExpandBlock24<true>(src, read_dst, dstpitch, TEXA);
+		});
+	}
+	else
+	{
+		foreachBlock(off.assertSizesMatch(GSLocalMemory::swizzle32), mem, r, dst, dstpitch, 32, [&](u8* read_dst, const u8* src)
+		{
+			GSBlock::ReadAndExpandBlock24<false>(src, read_dst, dstpitch, TEXA);
+		});
+	}
+}
+
+static void ReadTextureGPU24(GSLocalMemory& mem, const GSOffset& off, const GSVector4i& r, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	foreachBlock(off.assertSizesMatch(GSLocalMemory::swizzle16), mem, r, dst, dstpitch, 16, [&](u8* read_dst, const u8* src)
+	{
+		GSBlock::ReadBlock16(src, read_dst, dstpitch);
+	});
+
+	// Convert packed RGB scanline to 32 bits RGBA
+	ASSERT(dstpitch >= r.width() * 4);
+	for (int y = r.top; y < r.bottom; y++)
+	{
+		u8* line = dst + y * dstpitch;
+
+		for (int x = r.right; x >= r.left; x--)
+		{
+			*(u32*)&line[x * 4] = *(u32*)&line[x * 3] & 0xFFFFFF;
+		}
+	}
+}
+
+static void ReadTexture16(GSLocalMemory& mem, const GSOffset& off, const GSVector4i& r, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	if (TEXA.AEM)
+	{
+		foreachBlock(off.assertSizesMatch(GSLocalMemory::swizzle16), mem, r, dst, dstpitch, 32, [&](u8* read_dst, const u8* src)
+		{
+			GSBlock::ReadAndExpandBlock16<true>(src, read_dst, dstpitch, TEXA);
+		});
+	}
+	else
+	{
+		foreachBlock(off.assertSizesMatch(GSLocalMemory::swizzle16), mem, r, dst, dstpitch, 32, [&](u8* read_dst, const u8* src)
+		{
+			GSBlock::ReadAndExpandBlock16<false>(src, read_dst, dstpitch, TEXA);
+		});
+	}
+}
+
+static void ReadTexture8(GSLocalMemory& mem, const GSOffset& off, const GSVector4i& r, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	const u32* pal = mem.m_clut;
+
+	foreachBlock(off.assertSizesMatch(GSLocalMemory::swizzle8), mem, r, dst, dstpitch, 32, [&](u8* read_dst, const u8* src)
+	{
+		GSBlock::ReadAndExpandBlock8_32(src, read_dst, dstpitch, pal);
+	});
+}
+
+static void ReadTexture4(GSLocalMemory& mem, const GSOffset& off, const GSVector4i& r, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	const u32* pal = mem.m_clut;
+
+	foreachBlock(off.assertSizesMatch(GSLocalMemory::swizzle4), mem, r, dst, dstpitch, 32, [&](u8* read_dst, const u8* src)
+	{
+		GSBlock::ReadAndExpandBlock4_32(src, read_dst, dstpitch, pal);
+	});
+}
+
+static void ReadTexture8H(GSLocalMemory& mem, const GSOffset& off, const GSVector4i& r, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	const u32* pal = mem.m_clut;
+
+	foreachBlock(off.assertSizesMatch(GSLocalMemory::swizzle32), mem, r, dst, dstpitch, 32, [&](u8* read_dst, const u8* src)
+	{
+		GSBlock::ReadAndExpandBlock8H_32(src, read_dst, dstpitch, pal);
+	});
+}
+
+#if _M_SSE == 0x501
+static void ReadTexture8HSW(GSLocalMemory& mem, const GSOffset& off, const GSVector4i& r, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	const u32* pal = mem.m_clut;
+
+	foreachBlock(off.assertSizesMatch(GSLocalMemory::swizzle8), mem, r, dst, dstpitch, 32, [&](u8* read_dst, const u8* src)
+	{
+		GSBlock::ReadAndExpandBlock8_32HSW(src, read_dst, dstpitch, pal);
+	});
+}
+
+static void ReadTexture8HHSW(GSLocalMemory& mem, const GSOffset& off, const GSVector4i& r, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	const u32* pal = mem.m_clut;
+
+	foreachBlock(off.assertSizesMatch(GSLocalMemory::swizzle32), mem, r, dst, dstpitch, 32, [&](u8* read_dst, const u8* src)
+	{
+		GSBlock::ReadAndExpandBlock8H_32HSW(src, read_dst, dstpitch, pal);
+	});
+}
+#endif
+
+static void ReadTexture4HL(GSLocalMemory& mem, const GSOffset& off, const GSVector4i& r, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	const u32* pal = mem.m_clut;
+
+	foreachBlock(off.assertSizesMatch(GSLocalMemory::swizzle32), mem, r, dst, dstpitch, 32, [&](u8* read_dst, const u8* src)
+	{
+		GSBlock::ReadAndExpandBlock4HL_32(src, read_dst, dstpitch, pal);
+	});
+}
+
+static void ReadTexture4HH(GSLocalMemory& mem, const GSOffset& off, const GSVector4i& r, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	const u32* pal = mem.m_clut;
+
+	foreachBlock(off.assertSizesMatch(GSLocalMemory::swizzle32), mem, r, dst, dstpitch, 32, [&](u8* read_dst, const u8* src)
+	{
+		GSBlock::ReadAndExpandBlock4HH_32(src, read_dst, dstpitch, pal);
+	});
+}
+
+///////////////////
+
+static void ReadTextureBlock32(const GSLocalMemory& mem, u32 bp, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	ALIGN_STACK(32);
+
+	GSBlock::ReadBlock32(mem.BlockPtr(bp), dst, dstpitch);
+}
+
+static void ReadTextureBlock24(const GSLocalMemory& mem, u32 bp, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	ALIGN_STACK(32);
+
+	if (TEXA.AEM)
+	{
+		GSBlock::ReadAndExpandBlock24<true>(mem.BlockPtr(bp), dst, dstpitch, TEXA);
+	}
+	else
+	{
+		GSBlock::ReadAndExpandBlock24<false>(mem.BlockPtr(bp), dst, dstpitch, TEXA);
+	}
+}
+
+static void ReadTextureBlock16(const GSLocalMemory& mem, u32 bp, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	ALIGN_STACK(32);
+
+	if (TEXA.AEM)
+	{
+		GSBlock::ReadAndExpandBlock16<true>(mem.BlockPtr(bp), dst, dstpitch, TEXA);
+	}
+	else
+	{
+		GSBlock::ReadAndExpandBlock16<false>(mem.BlockPtr(bp), dst, dstpitch, TEXA);
+	}
+}
+
+static void ReadTextureBlock8(const GSLocalMemory& mem, u32 bp, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	ALIGN_STACK(32);
+
+	GSBlock::ReadAndExpandBlock8_32(mem.BlockPtr(bp), dst, dstpitch, mem.m_clut);
+}
+
+static void ReadTextureBlock4(const GSLocalMemory& mem, u32 bp, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	ALIGN_STACK(32);
+
+	GSBlock::ReadAndExpandBlock4_32(mem.BlockPtr(bp), dst, dstpitch, mem.m_clut);
+}
+
+static void ReadTextureBlock8H(const GSLocalMemory& mem, u32 bp, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	ALIGN_STACK(32);
+
+	GSBlock::ReadAndExpandBlock8H_32(mem.BlockPtr(bp), dst, dstpitch, mem.m_clut);
+}
+
+#if _M_SSE == 0x501
+static void ReadTextureBlock8HSW(const GSLocalMemory& mem, u32 bp, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	ALIGN_STACK(32);
+
+	GSBlock::ReadAndExpandBlock8_32HSW(mem.BlockPtr(bp), dst, dstpitch, mem.m_clut);
+}
+
+static void ReadTextureBlock8HHSW(const GSLocalMemory& mem, u32 bp, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	ALIGN_STACK(32);
+
+	GSBlock::ReadAndExpandBlock8H_32HSW(mem.BlockPtr(bp), dst, dstpitch, mem.m_clut);
+}
+#endif
+
+static void ReadTextureBlock4HL(const GSLocalMemory& mem, u32 bp, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	ALIGN_STACK(32);
+
+	GSBlock::ReadAndExpandBlock4HL_32(mem.BlockPtr(bp), dst, dstpitch, mem.m_clut);
+}
+
+static void ReadTextureBlock4HH(const GSLocalMemory& mem, u32 bp, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	ALIGN_STACK(32);
+
+	GSBlock::ReadAndExpandBlock4HH_32(mem.BlockPtr(bp), dst, dstpitch, mem.m_clut);
+}
+// 32/8
+
+static void ReadTexture8P(GSLocalMemory& mem, const GSOffset& off, const GSVector4i& r, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	foreachBlock(off.assertSizesMatch(GSLocalMemory::swizzle8), mem, r, dst, dstpitch, 8, [&](u8* read_dst, const u8* src)
+	{
+		GSBlock::ReadBlock8(src, read_dst, dstpitch);
+	});
+}
+
+static void ReadTexture4P(GSLocalMemory& mem, const GSOffset& off, const GSVector4i& r, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	foreachBlock(off.assertSizesMatch(GSLocalMemory::swizzle4), mem, r, dst, dstpitch, 8, [&](u8* read_dst, const u8* src)
+	{
+		GSBlock::ReadBlock4P(src, read_dst, dstpitch);
+	});
+}
+
+static void ReadTexture8HP(GSLocalMemory& mem, const GSOffset& off, const GSVector4i& r, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	foreachBlock(off.assertSizesMatch(GSLocalMemory::swizzle32), mem, r, dst, dstpitch, 8, [&](u8* read_dst, const u8* src)
+	{
+		GSBlock::ReadBlock8HP(src, read_dst, dstpitch);
+	});
+}
+
+static void ReadTexture4HLP(GSLocalMemory& mem, const GSOffset& off, const GSVector4i& r, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	foreachBlock(off.assertSizesMatch(GSLocalMemory::swizzle32), mem, r, dst, dstpitch, 8, [&](u8* read_dst, const u8* src)
+	{
+		GSBlock::ReadBlock4HLP(src, read_dst, dstpitch);
+	});
+}
+
+static void ReadTexture4HHP(GSLocalMemory& mem, const GSOffset& off, const GSVector4i& r, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	foreachBlock(off.assertSizesMatch(GSLocalMemory::swizzle32), mem, r, dst, dstpitch, 8, [&](u8* read_dst, const u8* src)
+	{
+		GSBlock::ReadBlock4HHP(src, read_dst, dstpitch);
+	});
+}
+
+//
+
+static void ReadTextureBlock8P(const GSLocalMemory& mem, u32 bp, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	GSBlock::ReadBlock8(mem.BlockPtr(bp), dst, dstpitch);
+}
+
+static void ReadTextureBlock4P(const GSLocalMemory& mem, u32 bp, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	ALIGN_STACK(32);
+
+	GSBlock::ReadBlock4P(mem.BlockPtr(bp), dst, dstpitch);
+}
+
+static void ReadTextureBlock8HP(const GSLocalMemory& mem, u32 bp, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	ALIGN_STACK(32);
+
+	GSBlock::ReadBlock8HP(mem.BlockPtr(bp), dst, dstpitch);
+}
+
+static void ReadTextureBlock4HLP(const GSLocalMemory& mem, u32 bp, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	ALIGN_STACK(32);
+
+	GSBlock::ReadBlock4HLP(mem.BlockPtr(bp), dst, dstpitch);
+}
+
+static void ReadTextureBlock4HHP(const GSLocalMemory& mem, u32 bp, u8* dst, int dstpitch, const GIFRegTEXA& TEXA)
+{
+	ALIGN_STACK(32);
+
+	GSBlock::ReadBlock4HHP(mem.BlockPtr(bp), dst, dstpitch);
+}
+///////////////////
+
+void GSLocalMemoryPopulateFunctions(GSLocalMemory::psm_t (&psm)[64])
+{
+	for (GSLocalMemory::psm_t& p : psm)
+	{
+		p.wi = WriteImage<PSM_PSMCT32, 8, 8, 32>;
+		p.rtx = ReadTexture32;
+		p.rtxP = ReadTexture32;
+		p.rtxb = ReadTextureBlock32;
+		p.rtxbP = ReadTextureBlock32;
+	}
+
+	psm[PSM_PSMCT24].wi = WriteImage24; // TODO
+	psm[PSM_PSMCT16].wi = WriteImage<PSM_PSMCT16, 16, 8, 16>;
+	psm[PSM_PSMCT16S].wi = WriteImage<PSM_PSMCT16S, 16, 8, 16>;
+	psm[PSM_PSMT8].wi = WriteImage<PSM_PSMT8, 16, 16, 8>;
+	psm[PSM_PSMT4].wi = WriteImage<PSM_PSMT4, 32, 16, 4>;
+	psm[PSM_PSMT8H].wi = WriteImage8H; // TODO
+	psm[PSM_PSMT4HL].wi = WriteImage4HL; // TODO
+	psm[PSM_PSMT4HH].wi = WriteImage4HH; // TODO
+	psm[PSM_PSMZ32].wi = WriteImage<PSM_PSMZ32, 8, 8, 32>;
+	psm[PSM_PSMZ24].wi = WriteImage24Z; // TODO
+	psm[PSM_PSMZ16].wi = WriteImage<PSM_PSMZ16, 16, 8, 16>;
+	psm[PSM_PSMZ16S].wi = WriteImage<PSM_PSMZ16S, 16, 8, 16>;
+
+	psm[PSM_PSMCT24].rtx = ReadTexture24;
+	psm[PSM_PSGPU24].rtx = ReadTextureGPU24;
+	psm[PSM_PSMCT16].rtx = ReadTexture16;
+	psm[PSM_PSMCT16S].rtx = ReadTexture16;
+	psm[PSM_PSMT8].rtx = ReadTexture8;
+	psm[PSM_PSMT4].rtx = ReadTexture4;
+	psm[PSM_PSMT8H].rtx = ReadTexture8H;
+	psm[PSM_PSMT4HL].rtx = ReadTexture4HL;
+	psm[PSM_PSMT4HH].rtx = ReadTexture4HH;
+	psm[PSM_PSMZ32].rtx = ReadTexture32;
+	psm[PSM_PSMZ24].rtx = ReadTexture24;
+	psm[PSM_PSMZ16].rtx = ReadTexture16;
+	psm[PSM_PSMZ16S].rtx = ReadTexture16;
+
+	psm[PSM_PSMCT24].rtxP = ReadTexture24;
+	psm[PSM_PSMCT16].rtxP = ReadTexture16;
+	psm[PSM_PSMCT16S].rtxP = ReadTexture16;
+	psm[PSM_PSMT8].rtxP = ReadTexture8P;
+	psm[PSM_PSMT4].rtxP = ReadTexture4P;
+	psm[PSM_PSMT8H].rtxP = ReadTexture8HP;
+	psm[PSM_PSMT4HL].rtxP = ReadTexture4HLP;
+	psm[PSM_PSMT4HH].rtxP = ReadTexture4HHP;
+	psm[PSM_PSMZ32].rtxP = ReadTexture32;
+	psm[PSM_PSMZ24].rtxP = ReadTexture24;
+	psm[PSM_PSMZ16].rtxP = ReadTexture16;
+	psm[PSM_PSMZ16S].rtxP = ReadTexture16;
+
+	psm[PSM_PSMCT24].rtxb = ReadTextureBlock24;
+	psm[PSM_PSMCT16].rtxb = ReadTextureBlock16;
+	psm[PSM_PSMCT16S].rtxb = ReadTextureBlock16;
+	psm[PSM_PSMT8].rtxb = ReadTextureBlock8;
+	psm[PSM_PSMT4].rtxb = ReadTextureBlock4;
+	psm[PSM_PSMT8H].rtxb = ReadTextureBlock8H;
+	psm[PSM_PSMT4HL].rtxb = ReadTextureBlock4HL;
+	psm[PSM_PSMT4HH].rtxb = ReadTextureBlock4HH;
+	psm[PSM_PSMZ32].rtxb = ReadTextureBlock32;
+	psm[PSM_PSMZ24].rtxb = ReadTextureBlock24;
+	psm[PSM_PSMZ16].rtxb = ReadTextureBlock16;
+	psm[PSM_PSMZ16S].rtxb = ReadTextureBlock16;
+
+	psm[PSM_PSMCT24].rtxbP = ReadTextureBlock24;
+	psm[PSM_PSMCT16].rtxbP = ReadTextureBlock16;
+	psm[PSM_PSMCT16S].rtxbP = ReadTextureBlock16;
+	psm[PSM_PSMT8].rtxbP = ReadTextureBlock8P;
+	psm[PSM_PSMT4].rtxbP = ReadTextureBlock4P;
+	psm[PSM_PSMT8H].rtxbP = ReadTextureBlock8HP;
+	psm[PSM_PSMT4HL].rtxbP = ReadTextureBlock4HLP;
+	psm[PSM_PSMT4HH].rtxbP = ReadTextureBlock4HHP;
+	psm[PSM_PSMZ32].rtxbP = ReadTextureBlock32;
+	psm[PSM_PSMZ24].rtxbP = ReadTextureBlock24;
+	psm[PSM_PSMZ16].rtxbP = ReadTextureBlock16;
+	psm[PSM_PSMZ16S].rtxbP = ReadTextureBlock16;
+
+#if _M_SSE == 0x501
+	bool slowVPGATHERDD;
+	if (g_cpu.has(Xbyak::util::Cpu::tINTEL))
+	{
+		// Slow on Haswell
+		// CPUID data from https://en.wikichip.org/wiki/intel/cpuid
+		slowVPGATHERDD = g_cpu.displayModel == 0x46 || g_cpu.displayModel == 0x45 || g_cpu.displayModel == 0x3c;
+	}
+	else
+	{
+		// Currently no Zen CPUs with fast VPGATHERDD
+		// Check https://uops.info/table.html as new CPUs come out for one that doesn't split it into like 40 µops
+		// Doing it manually is about 28 µops (8x xmm -> gpr, 6x extr, 8x load, 6x insr)
+		slowVPGATHERDD = true;
+	}
+	if (const char* over = getenv("SLOW_VPGATHERDD_OVERRIDE")) // Easy override for comparing on vs off
+	{
+		slowVPGATHERDD = over[0] == 'Y' || over[0] == 'y' || over[0] == '1';
+	}
+	if (slowVPGATHERDD)
+	{
+		psm[PSM_PSMT8].rtx = ReadTexture8HSW;
+		psm[PSM_PSMT8H].rtx = ReadTexture8HHSW;
+		psm[PSM_PSMT8].rtxb = ReadTextureBlock8HSW;
+		psm[PSM_PSMT8H].rtxb = ReadTextureBlock8HHSW;
+	}
+#endif
+}
+
+MULTI_ISA_UNSHARED_END
@@ -21,6 +21,8 @@
 #include "GSDump.h"
 #include "GSLzma.h"
 
+#include <algorithm>
+
 using namespace GSDumpTypes;
 
 GSDumpFile::GSDumpFile(FILE* file, FILE* repack_file)
@@ -65,9 +67,21 @@ std::unique_ptr<GSDumpFile> GSDumpFile::OpenGSDump(const char* filename, const c
 	}
 
 	if (StringUtil::EndsWithNoCase(filename, ".xz"))
-		return std::make_unique<GSDumpLzma>(fp, nullptr);
+		return std::make_unique<GSDumpLzma>(fp, repack_fp);
+	else if (StringUtil::EndsWithNoCase(filename, ".zst"))
+	{
+#ifdef USE_ZSTD
+		return std::make_unique<GSDumpZstd>(fp, repack_fp);
+#else
+		Console.Error("This build of PCSX2 was compiled without zstd GS dump support.");
+		std::fclose(fp);
+		if (repack_fp)
+			std::fclose(repack_fp);
+		return nullptr;
+#endif
+	}
 	else
-		return std::make_unique<GSDumpRaw>(fp, nullptr);
+		return std::make_unique<GSDumpRaw>(fp, repack_fp);
 }
 
 bool GSDumpFile::GetPreviewImageFromDump(const char* filename, u32* width, u32* height, std::vector<u32>* pixels)
@@ -111,7 +125,7 @@ bool GSDumpFile::GetPreviewImageFromDump(const char* filename, u32* width, u32*
 	return true;
 }
 
-bool GSDumpFile::ReadFile()
+bool GSDumpFile::ReadHeader()
 {
 	u32 ss;
 	if (Read(&m_crc, sizeof(m_crc)) != sizeof(m_crc) || Read(&ss, sizeof(ss)) != sizeof(ss))
@@ -157,6 +171,15 @@ bool GSDumpFile::ReadFile()
 	if (Read(m_regs_data.data(), m_regs_data.size()) != m_regs_data.size())
 		return false;
 
+	m_packets_offset = m_read_offset;
+	return true;
+}
+
+bool GSDumpFile::ReadFile()
+{
+	if (!ReadHeader())
+		return false;
+
 	// read all the packet data in
 	// TODO: make this suck less by getting the full/extracted size and preallocating
 	for (;;)
@@ -243,6 +266,244 @@ bool GSDumpFile::ReadFile()
 	return true;
 }
 
+bool GSDumpFile::BeginStreaming(size_t max_buffered_bytes /*= DEFAULT_STREAM_BUFFER_SIZE*/)
+{
+	if (!ReadHeader())
+		return false;
+
+	m_stream_max_buffered = max_buffered_bytes;
+	m_seek_index.push_back({0, m_packets_offset});
+	m_stream_thread = std::thread(&GSDumpFile::StreamThread, this);
+	return true;
+}
+
+void GSDumpFile::EndStreaming()
+{
+	if (!m_stream_thread.joinable())
+		return;
+
+	{
+		std::unique_lock<std::mutex> lock(m_stream_mutex);
+		m_stream_shutdown = true;
+	}
+	m_stream_cv.notify_all();
+	m_stream_thread.join();
+}
+
+GSDumpFile::StreamReadResult GSDumpFile::ReadStreamPacket(StreamPacket* packet)
+{
+	GSData& info = packet->info;
+	info = {};
+	info.path = GSTransferPath::Dummy;
+	if (Read(&info.id, sizeof(info.id)) != sizeof(info.id))
+		return IsEof() ? StreamReadResult::End : StreamReadResult::Error;
+
+	switch (info.id)
+	{
+		case GSType::Transfer:
+			if (Read(&info.path, sizeof(info.path)) != sizeof(info.path) ||
+				Read(&info.length, sizeof(info.length)) != sizeof(info.length))
+			{
+				return StreamReadResult::Error;
+			}
+			break;
+		case GSType::VSync:
+			info.length = 1;
+			break;
+		case GSType::ReadFIFO2:
+			info.length = 4;
+			break;
+		case GSType::Registers:
+			info.length = 8192;
+			break;
+		default:
+			return StreamReadResult::Error;
+	}
+
+	if (info.length < 0)
+		return StreamReadResult::Error;
+
+	// Old path 1 transfers are replayed from the end of a 16KB buffer, so the payload goes at its end
+	const bool old_path1 = (info.id == GSType::Transfer && info.path == GSTransferPath::Path1Old);
+	const size_t size = old_path1 ? std::max<size_t>(info.length, 16384) : info.length;
+	packet->data.resize(size);
+	if (Read(packet->data.data() + (size - info.length), info.length) != static_cast<size_t>(info.length))
+		return StreamReadResult::Error;
+
+	info.data = packet->data.data();
+	return StreamReadResult::OK;
+}
+
+void GSDumpFile::ReleaseStreamPacket(StreamPacket& packet)
+{
+	if (packet.data.capacity() > 0 && m_stream_free_buffers.size() < MAX_FREE_STREAM_BUFFERS)
+		m_stream_free_buffers.push_back(std::move(packet.data));
+
+	packet.data = {};
+	packet.info = {};
+}
+
+void GSDumpFile::StreamThread()
+{
+	u32 generation = m_stream_generation;
+	u32 frame = 0;
+	bool wrapped = false;
+
+	std::unique_lock<std::mutex> lock(m_stream_mutex);
+	while (!m_stream_shutdown)
+	{
+		if (m_stream_seek_pending)
+		{
+			const SeekPoint point = m_stream_seek_point;
+			m_stream_seek_pending = false;
+			generation = m_stream_generation;
+
+			lock.unlock();
+			const bool seeked = Seek(point.offset);
+			lock.lock();
+			if (!seeked)
+			{
+				Console.Error("(GSDumpFile) Failed to seek to frame %u.", point.frame);
+				m_stream_error = true;
+				break;
+			}
+
+			frame = point.frame;
+			wrapped = false;
+			continue;
+		}
+
+		// Always let one packet through, so ones bigger than the whole buffer still get played
+		if (!m_stream_queue.empty() && m_stream_buffered >= m_stream_max_buffered)
+		{
+			m_stream_cv.wait(lock);
+			continue;
+		}
+
+		StreamPacket packet = {};
+		if (!m_stream_free_buffers.empty())
+		{
+			packet.data = std::move(m_stream_free_buffers.back());
+			m_stream_free_buffers.pop_back();
+		}
+
+		lock.unlock();
+
+		StreamReadResult result;
+		try
+		{
+			result = ReadStreamPacket(&packet);
+		}
+		catch (...)
+		{
+			// the lzma decoder throws on corrupted data
+			result = StreamReadResult::Error;
+		}
+
+		lock.lock();
+
+		// A seek came in while we were reading, this packet is from before it
+		if (generation != m_stream_generation)
+		{
+			ReleaseStreamPacket(packet);
+			continue;
+		}
+
+		if (result == StreamReadResult::End)
+		{
+			ReleaseStreamPacket(packet);
+
+			// Loop back around to the first packet, unless there aren't any
+			const bool empty = (m_read_offset == m_packets_offset);
+			lock.unlock();
+			const bool seeked = !empty && Seek(m_packets_offset);
+			lock.lock();
+			if (!seeked)
+			{
+				Console.Error("(GSDumpFile) Failed to restart dump.");
+				m_stream_error = true;
+				break;
+			}
+
+			frame = 0;
+			wrapped = true;
+			continue;
+		}
+		else if (result == StreamReadResult::Error)
+		{
+			Console.Error("(GSDumpFile) Failed to read packet at offset %llu.", static_cast<unsigned long long>(m_read_offset));
+			m_stream_error = true;
+			break;
+		}
+
+		if (packet.info.id == GSType::VSync)
+		{
+			frame++;
+			if ((frame % SEEK_INDEX_INTERVAL) == 0 && frame > m_seek_index.back().frame)
+				m_seek_index.push_back({frame, m_read_offset});
+		}
+
+		packet.wrapped = wrapped;
+		wrapped = false;
+		m_stream_buffered += packet.data.size();
+		m_stream_queue.push_back(std::move(packet));
+		m_stream_cv.notify_all();
+	}
+
+	m_stream_cv.notify_all();
+}
+
+bool GSDumpFile::GetNextStreamPacket(GSData* packet, bool* wrapped)
+{
+	std::unique_lock<std::mutex> lock(m_stream_mutex);
+	ReleaseStreamPacket(m_stream_current);
+
+	m_stream_cv.wait(lock, [this]() { return !m_stream_queue.empty() || m_stream_error; });
+	if (m_stream_queue.empty())
+		return false;
+
+	m_stream_current = std::move(m_stream_queue.front());
+	m_stream_queue.pop_front();
+	m_stream_buffered -= m_stream_current.data.size();
+	m_stream_consumed = true;
+	lock.unlock();
+	m_stream_cv.notify_all();
+
+	*packet = m_stream_current.info;
+	*wrapped = m_stream_current.wrapped;
+	return true;
+}
+
+u32 GSDumpFile::SeekToFrame(u32 frame)
+{
+	std::unique_lock<std::mutex> lock(m_stream_mutex);
+
+	// The first point is always frame 0
+	auto it = std::upper_bound(m_seek_index.begin(), m_seek_index.end(), frame,
+		[](u32 value, const SeekPoint& point) { return value < point.frame; });
+	const SeekPoint point = *(it - 1);
+
+	// Nothing has been played since the stream started there, what's buffered is still good
+	if (!m_stream_consumed && point.frame == m_stream_start_frame)
+		return point.frame;
+
+	for (StreamPacket& packet : m_stream_queue)
+		ReleaseStreamPacket(packet);
+	m_stream_queue.clear();
+	m_stream_buffered = 0;
+	ReleaseStreamPacket(m_stream_current);
+
+	m_stream_seek_point = point;
+	m_stream_seek_pending = true;
+	m_stream_start_frame = point.frame;
+	m_stream_consumed = false;
+	m_stream_generation++;
+	lock.unlock();
+	m_stream_cv.notify_all();
+
+	return point.frame;
+}
+
 /******************************************************************/
 GSDumpLzma::GSDumpLzma(FILE* file, FILE* repack_file)
 	: GSDumpFile(file, repack_file)
@@ -275,6 +536,29 @@ void GSDumpLzma::Initialize()
 	m_strm.next_out  = m_area;
 }
 
+bool GSDumpLzma::ResetDecoder()
+{
+	lzma_end(&m_strm);
+	memset(&m_strm, 0, sizeof(lzma_stream));
+
+	lzma_ret ret = lzma_stream_decoder(&m_strm, UINT32_MAX, 0);
+	if (ret != LZMA_OK)
+	{
+		fprintf(stderr, "Error initializing the decoder! (error code %u)\n", ret);
+		return false;
+	}
+
+	m_avail = 0;
+	m_start = 0;
+	m_read_offset = 0;
+
+	m_strm.avail_in  = 0;
+	m_strm.next_in   = m_inbuf;
+
+	std::rewind(m_fp);
+	return true;
+}
+
 void GSDumpLzma::Decompress()
 {
 	lzma_action action = LZMA_RUN;
@@ -339,11 +623,37 @@ size_t GSDumpLzma::Read(void* ptr, size_t size)
 	if (off > 0)
 		Repack(ptr, off);
 
+	m_read_offset += off;
 	return off;
 }
 
+bool GSDumpLzma::Seek(u64 offset)
+{
+	// xz can only be decoded forwards, so going back means starting over
+	if (offset < m_read_offset && !ResetDecoder())
+		return false;
+
+	while (m_read_offset < offset)
+	{
+		if (IsEof())
+			return false;
+
+		if (m_avail == 0)
+			Decompress();
+
+		const size_t l = static_cast<size_t>(std::min<u64>(offset - m_read_offset, m_avail));
+		m_avail       -= l;
+		m_start       += l;
+		m_read_offset += l;
+	}
+
+	return true;
+}
+
 GSDumpLzma::~GSDumpLzma()
 {
+	EndStreaming();
+
 	lzma_end(&m_strm);
 
 	if (m_inbuf)
@@ -359,6 +669,11 @@ GSDumpRaw::GSDumpRaw(FILE* file, FILE* repack_file)
 {
 }
 
+GSDumpRaw::~GSDumpRaw()
+{
+	EndStreaming();
+}
+
 bool GSDumpRaw::IsEof()
 {
 	return !!feof(m_fp);
@@ -367,6 +682,7 @@ bool GSDumpRaw::IsEof()
 size_t GSDumpRaw::Read(void* ptr, size_t size)
 {
 	size_t ret = fread(ptr, 1, size, m_fp);
+	m_read_offset += ret;
 	if (ret != size && ferror(m_fp))
 	{
 		fprintf(stderr, "GSDumpRaw:: Read error (%zu/%zu)\n", ret, size);
@@ -378,3 +694,277 @@ size_t GSDumpRaw::Read(void* ptr, size_t size)
 
 	return ret;
 }
+
+bool GSDumpRaw::Seek(u64 offset)
+{
+	if (FileSystem::FSeek64(m_fp, static_cast<s64>(offset), SEEK_SET) != 0)
+		return false;
+
+	m_read_offset = offset;
+	return true;
+}
+
+#ifdef USE_ZSTD
+
+/******************************************************************/
+
+GSDumpZstd::GSDumpZstd(FILE* file, FILE* repack_file)
+	: GSDumpFile(file, repack_file)
+{
+	const u32 num_threads = std::clamp<u32>(std::thread::hardware_concurrency(), 1u, MAX_DECOMPRESS_THREADS);
+	m_max_frames = num_threads * 2;
+	for (u32 i = 0; i < num_threads; i++)
+		m_workers.emplace_back(&GSDumpZstd::WorkerThread, this);
+}
+
+GSDumpZstd::~GSDumpZstd()
+{
+	EndStreaming();
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_shutdown = true;
+	}
+	m_work_cv.notify_all();
+	for (std::thread& thread : m_workers)
+		thread.join();
+}
+
+void GSDumpZstd::WorkerThread()
+{
+	ZSTD_DCtx* dctx = ZSTD_createDCtx();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;)
+	{
+		m_work_cv.wait(lock, [this]() { return !m_jobs.empty() || m_shutdown; });
+		if (m_shutdown)
+			break;
+
+		Frame* frame = m_jobs.front();
+		m_jobs.pop_front();
+		m_active_jobs++;
+		lock.unlock();
+
+		bool error = !dctx;
+		const u8* src = frame->compressed.data();
+		const size_t src_size = frame->compressed.size();
+		const unsigned long long size = dctx ? ZSTD_getFrameContentSize(src, src_size) : ZSTD_CONTENTSIZE_ERROR;
+		if (size == ZSTD_CONTENTSIZE_ERROR)
+		{
+			error = true;
+		}
+		else if (size != ZSTD_CONTENTSIZE_UNKNOWN)
+		{
+			frame->data.resize(size);
+			const size_t ret = ZSTD_decompressDCtx(dctx, frame->data.data(), frame->data.size(), src, src_size);
+			error = ZSTD_isError(ret) || ret != size;
+		}
+		else
+		{
+			// Frames from other compressors might not say how big they are
+			ZSTD_DCtx_reset(dctx, ZSTD_reset_session_only);
+			ZSTD_inBuffer in = {src, src_size, 0};
+			size_t ret;
+			do
+			{
+				const size_t pos = frame->data.size();
+				frame->data.resize(pos + ZSTD_DStreamOutSize());
+				ZSTD_outBuffer out = {frame->data.data() + pos, ZSTD_DStreamOutSize(), 0};
+				ret = ZSTD_decompressStream(dctx, &out, &in);
+				frame->data.resize(pos + out.pos);
+				if (ZSTD_isError(ret) || (in.pos == in.size && out.pos == 0 && ret != 0))
+				{
+					error = true;
+					break;
+				}
+			} while (ret != 0);
+		}
+
+		if (error)
+			fprintf(stderr, "GSDumpZstd: Failed to decompress frame\n");
+
+		frame->compressed = {};
+
+		lock.lock();
+		frame->error = error;
+		frame->done = true;
+		m_active_jobs--;
+		m_done_cv.notify_all();
+	}
+
+	lock.unlock();
+	ZSTD_freeDCtx(dctx);
+}
+
+bool GSDumpZstd::ReadFrame(std::vector<u8>* compressed)
+{
+	for (;;)
+	{
+		const size_t avail = m_inbuf.size() - m_inbuf_pos;
+		if (avail > 0)
+		{
+			const size_t frame_size = ZSTD_findFrameCompressedSize(m_inbuf.data() + m_inbuf_pos, avail);
+			if (!ZSTD_isError(frame_size))
+			{
+				compressed->assign(m_inbuf.begin() + m_inbuf_pos, m_inbuf.begin() + m_inbuf_pos + frame_size);
+				m_inbuf_pos += frame_size;
+				return true;
+			}
+		}
+
+		if (m_file_eof)
+		{
+			if (avail > 0)
+			{
+				fprintf(stderr, "GSDumpZstd: Truncated or corrupted frame at end of file\n");
+				m_error = true;
+			}
+			return false;
+		}
+
+		// Don't have the whole frame yet, read some more
+		m_inbuf.erase(m_inbuf.begin(), m_inbuf.begin() + m_inbuf_pos);
+		m_inbuf_pos = 0;
+
+		const size_t old_size = m_inbuf.size();
+		m_inbuf.resize(old_size + READ_SIZE);
+		const size_t read = fread(m_inbuf.data() + old_size, 1, READ_SIZE, m_fp);
+		m_inbuf.resize(old_size + read);
+		if (read == 0)
+		{
+			if (ferror(m_fp))
+			{
+				fprintf(stderr, "Read error: %s\n", strerror(errno));
+				m_error = true;
+				return false;
+			}
+
+			m_file_eof = true;
+		}
+	}
+}
+
+void GSDumpZstd::QueueFrames()
+{
+	while (m_frames.size() < m_max_frames && !m_error)
+	{
+		std::unique_ptr<Frame> frame = std::make_unique<Frame>();
+		frame->done = false;
+		frame->error = false;
+		if (!ReadFrame(&frame->compressed))
+			break;
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_jobs.push_back(frame.get());
+		m_frames.push_back(std::move(frame));
+		lock.unlock();
+		m_work_cv.notify_one();
+	}
+}
+
+bool GSDumpZstd::NextFrame()
+{
+	QueueFrames();
+	if (m_frames.empty())
+		return false;
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_done_cv.wait(lock, [this]() { return m_frames.front()->done; });
+	}
+
+	m_current = std::move(m_frames.front());
+	m_frames.pop_front();
+	m_current_pos = 0;
+	if (m_current->error)
+	{
+		m_error = true;
+		return false;
+	}
+
+	// Keep the workers busy while this one is consumed
+	QueueFrames();
+	return true;
+}
+
+void GSDumpZstd::ResetDecoder()
+{
+	{
+		// Frames which are being decompressed can't be freed until they're done
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_jobs.clear();
+		m_done_cv.wait(lock, [this]() { return m_active_jobs == 0; });
+	}
+
+	m_frames.clear();
+	m_current.reset();
+	m_current_pos = 0;
+	m_inbuf.clear();
+	m_inbuf_pos = 0;
+	m_file_eof = false;
+	m_error = false;
+	m_read_offset = 0;
+
+	std::rewind(m_fp);
+}
+
+bool GSDumpZstd::IsEof()
+{
+	return !m_error && m_file_eof && m_inbuf_pos == m_inbuf.size() && m_frames.empty() &&
+		   (!m_current || m_current_pos == m_current->data.size());
+}
+
+size_t GSDumpZstd::Read(void* ptr, size_t size)
+{
+	size_t off = 0;
+	u8* dst = static_cast<u8*>(ptr);
+	while (size > 0)
+	{
+		if (!m_current || m_current_pos == m_current->data.size())
+		{
+			if (!NextFrame())
+				break;
+
+			continue;
+		}
+
+		const size_t l = std::min(size, m_current->data.size() - m_current_pos);
+		memcpy(dst + off, m_current->data.data() + m_current_pos, l);
+		m_current_pos += l;
+		size -= l;
+		off += l;
+	}
+
+	if (off > 0)
+		Repack(ptr, off);
+
+	m_read_offset += off;
+	return off;
+}
+
+bool GSDumpZstd::Seek(u64 offset)
+{
+	// zstd can only be decoded forwards, so going back means starting over
+	if (offset < m_read_offset)
+		ResetDecoder();
+
+	while (m_read_offset < offset)
+	{
+		if (!m_current || m_current_pos == m_current->data.size())
+		{
+			if (!NextFrame())
+				return false;
+
+			continue;
+		}
+
+		const size_t l = static_cast<size_t>(std::min<u64>(offset - m_read_offset, m_current->data.size() - m_current_pos));
+		m_current_pos += l;
+		m_read_offset += l;
+	}
+
+	return true;
+}
+
+#endif
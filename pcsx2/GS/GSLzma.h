@@ -16,8 +16,15 @@
 #pragma once
 
 #include <lzma.h>
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #define GEN_REG_ENUM_CLASS_CONTENT(ClassName, EntryName, Value) \
@@ -311,19 +318,70 @@ public:
 	__fi const ByteArray& GetStateData() const { return m_state_data; }
 	__fi const GSDataArray& GetPackets() const { return m_dump_packets; }
 
+	/// Reads the header, state and registers, then every packet into memory.
 	bool ReadFile();
 
+	/// Reads the header, state and registers, then starts decoding packets on a worker thread
+	/// into a buffer of at most max_buffered_bytes, so huge dumps play in constant memory.
+	bool BeginStreaming(size_t max_buffered_bytes = DEFAULT_STREAM_BUFFER_SIZE);
+
+	/// Gets the next packet of a streamed dump, waiting for it to be decoded if needed. After the
+	/// last packet the stream starts over at the first one, with wrapped set. The packet's data
+	/// stays valid until the next call. Returns false if the dump can't be read.
+	bool GetNextStreamPacket(GSData* packet, bool* wrapped);
+
+	/// Restarts a streamed dump at the closest frame at or before frame that the seek index has
+	/// seen, returning that frame. Frames past the furthest one decoded so far can't be reached.
+	u32 SeekToFrame(u32 frame);
+
 protected:
 	GSDumpFile(FILE* file, FILE* repack_file);
 
 	virtual bool IsEof() = 0;
 	virtual size_t Read(void* ptr, size_t size) = 0;
+	/// Moves to an offset in the uncompressed dump.
+	virtual bool Seek(u64 offset) = 0;
 
 	void Repack(void* ptr, size_t size);
+	/// Stops the streaming thread, has to be called before a subclass is destroyed.
+	void EndStreaming();
 
 	FILE* m_fp = nullptr;
+	u64 m_read_offset = 0;
 
 private:
+	static constexpr size_t DEFAULT_STREAM_BUFFER_SIZE = 64 * _1mb;
+	// A seek point is recorded every this many frames
+	static constexpr u32 SEEK_INDEX_INTERVAL = 60;
+	// Packet buffers kept around for reuse
+	static constexpr size_t MAX_FREE_STREAM_BUFFERS = 256;
+
+	struct StreamPacket
+	{
+		GSData info;
+		ByteArray data;
+		bool wrapped;
+	};
+
+	struct SeekPoint
+	{
+		u32 frame;
+		u64 offset;
+	};
+
+	enum class StreamReadResult
+	{
+		OK,
+		End,
+		Error
+	};
+
+	bool ReadHeader();
+
+	void StreamThread();
+	StreamReadResult ReadStreamPacket(StreamPacket* packet);
+	void ReleaseStreamPacket(StreamPacket& packet);
+
 	FILE* m_repack_fp = nullptr;
 
 	std::string m_serial;
@@ -334,6 +392,24 @@ private:
 	std::vector<u8> m_packet_data;
 
 	GSDataArray m_dump_packets;
+
+	std::thread m_stream_thread;
+	std::mutex m_stream_mutex;
+	std::condition_variable m_stream_cv;
+	std::deque<StreamPacket> m_stream_queue;
+	std::vector<ByteArray> m_stream_free_buffers;
+	StreamPacket m_stream_current = {};
+	std::vector<SeekPoint> m_seek_index;
+	size_t m_stream_max_buffered = 0;
+	size_t m_stream_buffered = 0;
+	u64 m_packets_offset = 0;
+	SeekPoint m_stream_seek_point = {};
+	u32 m_stream_start_frame = 0;
+	u32 m_stream_generation = 0;
+	bool m_stream_seek_pending = false;
+	bool m_stream_consumed = false;
+	bool m_stream_error = false;
+	bool m_stream_shutdown = false;
 };
 
 class GSDumpLzma : public GSDumpFile
@@ -349,6 +425,7 @@ class GSDumpLzma : public GSDumpFile
 
 	void Decompress();
 	void Initialize();
+	bool ResetDecoder();
 
 public:
 	GSDumpLzma(FILE* file, FILE* repack_file);
@@ -356,14 +433,67 @@ public:
 
 	bool IsEof() final;
 	size_t Read(void* ptr, size_t size) final;
+	bool Seek(u64 offset) final;
 };
 
 class GSDumpRaw : public GSDumpFile
 {
 public:
 	GSDumpRaw(FILE* file, FILE* repack_file);
-	virtual ~GSDumpRaw() = default;
+	virtual ~GSDumpRaw();
+
+	bool IsEof() final;
+	size_t Read(void* ptr, size_t size) final;
+	bool Seek(u64 offset) final;
+};
+
+#ifdef USE_ZSTD
+class GSDumpZstd : public GSDumpFile
+{
+	// Dumps are written as a series of zstd frames, which are decompressed in parallel
+	static constexpr u32 MAX_DECOMPRESS_THREADS = 4;
+	static constexpr size_t READ_SIZE = 1024 * 1024;
+
+	struct Frame
+	{
+		std::vector<u8> compressed;
+		std::vector<u8> data;
+		bool done;
+		bool error;
+	};
+
+	bool ReadFrame(std::vector<u8>* compressed);
+	void QueueFrames();
+	bool NextFrame();
+	void ResetDecoder();
+	void WorkerThread();
+
+	// Compressed data read from the file but not yet split into frames
+	std::vector<u8> m_inbuf;
+	size_t m_inbuf_pos = 0;
+	bool m_file_eof = false;
+	bool m_error = false;
+
+	// Frames queued for decompression, in file order
+	std::deque<std::unique_ptr<Frame>> m_frames;
+	std::unique_ptr<Frame> m_current;
+	size_t m_current_pos = 0;
+	size_t m_max_frames = 0;
+
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_work_cv;
+	std::condition_variable m_done_cv;
+	std::deque<Frame*> m_jobs;
+	u32 m_active_jobs = 0;
+	bool m_shutdown = false;
+
+public:
+	GSDumpZstd(FILE* file, FILE* repack_file);
+	virtual ~GSDumpZstd();
 
 	bool IsEof() final;
 	size_t Read(void* ptr, size_t size) final;
+	bool Seek(u64 offset) final;
 };
+#endif
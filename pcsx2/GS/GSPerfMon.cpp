@@ -26,10 +26,18 @@ GSPerfMon::GSPerfMon()
 {
 	memset(m_counters, 0, sizeof(m_counters));
 	memset(m_stats, 0, sizeof(m_stats));
+	memset(m_frame_start, 0, sizeof(m_frame_start));
+	memset(m_last_frame, 0, sizeof(m_last_frame));
 }
 
 void GSPerfMon::EndFrame()
 {
+	for (size_t i = 0; i < std::size(m_counters); i++)
+	{
+		m_last_frame[i] = m_counters[i] - m_frame_start[i];
+		m_frame_start[i] = m_counters[i];
+	}
+
 	m_frame++;
 	m_count++;
 }
@@ -47,4 +55,5 @@ void GSPerfMon::Update()
 	}
 
 	memset(m_counters, 0, sizeof(m_counters));
+	memset(m_frame_start, 0, sizeof(m_frame_start));
 }
@@ -29,6 +29,10 @@ public:
 		Fillrate,
 		Quad,
 		SyncPoint,
+		JitCompiles,
+		JitCompileTime,
+		PaletteLookups,
+		PaletteHits,
 		CounterLast,
 
 		// Reused counters for HW.
@@ -39,6 +43,8 @@ public:
 protected:
 	double m_counters[CounterLast];
 	double m_stats[CounterLast];
+	double m_frame_start[CounterLast];
+	double m_last_frame[CounterLast];
 	u64 m_frame;
 	clock_t m_lastframe;
 	int m_count;
@@ -53,6 +59,8 @@ public:
 
 	void Put(counter_t c, double val = 0) { m_counters[c] += val; }
 	double Get(counter_t c) { return m_stats[c]; }
+	/// Counters of the frame most recently ended, rather than the average of the last period.
+	double GetLastFrame(counter_t c) { return m_last_frame[c]; }
 	void Update();
 
 	__fi void AddDisplayFramebufferSpriteBlit() { m_disp_fb_sprite_blits++; }
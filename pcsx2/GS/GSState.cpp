@@ -650,6 +650,33 @@ void GSState::DumpVertices(const std::string& filename)
 	file.close();
 }
 
+void GSState::DumpVertexCapture(const std::string& filename)
+{
+	std::ofstream file(filename, std::ios::binary);
+
+	if (!file.is_open())
+		return;
+
+	GSVertexTrace::Capture header;
+	memset(&header, 0, sizeof(header));
+
+	header.magic = GSVertexTrace::Capture::MAGIC;
+	header.primclass = m_vt.m_primclass;
+	header.iip = PRIM->IIP;
+	header.tme = PRIM->TME;
+	header.fst = PRIM->FST;
+	header.color = !(PRIM->TME && m_context->TEX0.TFX == TFX_DECAL && m_context->TEX0.TCC);
+	header.provoking_vertex_first = IsFirstProvokingVertex();
+	header.v_count = m_vertex.tail;
+	header.i_count = m_index.tail;
+	header.XYOFFSET = m_context->XYOFFSET;
+	header.TEX0 = m_context->TEX0;
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(m_vertex.buff), sizeof(GSVertex) * m_vertex.tail);
+	file.write(reinterpret_cast<const char*>(m_index.buff), sizeof(u32) * m_index.tail);
+}
+
 void GSState::GIFPackedRegHandlerNull(const GIFPackedReg* RESTRICT r)
 {
 }
@@ -715,7 +742,7 @@ void GSState::GIFPackedRegHandlerXYZF2(const GIFPackedReg* RESTRICT r)
 
 	m_v.m[1] = xy.upl32(zf);
 
-	VertexKick<prim, auto_flush, index_swap>(adc ? 1 : r->XYZF2.Skip());
+	VertexKick<prim, auto_flush, index_swap>(m_v, adc ? 1 : r->XYZF2.Skip());
 }
 
 template <u32 prim, u32 adc, bool auto_flush, bool index_swap>
@@ -727,7 +754,7 @@ void GSState::GIFPackedRegHandlerXYZ2(const GIFPackedReg* RESTRICT r)
 
 	m_v.m[1] = xyz.upl64(GSVector4i::loadl(&m_v.UV));
 
-	VertexKick<prim, auto_flush, index_swap>(adc ? 1 : r->XYZ2.Skip());
+	VertexKick<prim, auto_flush, index_swap>(m_v, adc ? 1 : r->XYZ2.Skip());
 }
 
 void GSState::GIFPackedRegHandlerFOG(const GIFPackedReg* RESTRICT r)
@@ -744,66 +771,105 @@ void GSState::GIFPackedRegHandlerNOP(const GIFPackedReg* RESTRICT r)
 {
 }
 
-template <u32 prim, bool auto_flush, bool index_swap>
-void GSState::GIFPackedRegHandlerSTQRGBAXYZF2(const GIFPackedReg* RESTRICT r, u32 size)
+/// Decodes an STQ, RGBA, XYZF2/XYZ2 register triple into the two halves of a vertex, once per 128-bit lane.
+/// q and zf are the upper halves of the STQ and XYZ registers moved down, uvf holds UV for XYZF2,
+/// or UV and FOG for XYZ2, which the tag doesn't change.
+template <bool xyzf, class V>
+static __forceinline void DecodePackedVertex(const V& st, V q, const V& rgba, const V& xy, const V& zf, const V& uvf, V& m0, V& m1)
 {
-	ASSERT(size > 0 && size % 3 == 0);
+	q = q.blend8(V(0x3f800000), q == V::zero()); // 1.0f, see GIFPackedRegHandlerSTQ
 
-	const GIFPackedReg* RESTRICT r_end = r + size;
+	m0 = st.upl64((rgba & V::x000000ff()).ps32().pu16().upl32(q));
 
-	while (r < r_end)
+	const V xy16 = xy.upl16(xy.template srl<4>());
+
+	if (xyzf)
 	{
-		GSVector4i st = GSVector4i::loadl(&r[0].U64[0]);
-		GSVector4i q = GSVector4i::loadl(&r[0].U64[1]);
-		GSVector4i rgba = (GSVector4i::load<false>(&r[1]) & GSVector4i::x000000ff()).ps32().pu16();
+		m1 = xy16.upl32(uvf).upl32(zf.srl32(4) & V::x00ffffff().upl32(V::x000000ff()));
+	}
+	else
+	{
+		m1 = xy16.upl32(zf).upl64(uvf);
+	}
+}
+
+/// Decodes count register triples into v, two vertices at a time with AVX2
+template <bool xyzf>
+static __forceinline void DecodePackedVertices(const GIFPackedReg* RESTRICT r, GSVertex* RESTRICT v, u32 count, const GSVector4i& uvf)
+{
+	u32 i = 0;
 
-		q = q.blend8(GSVector4i::cast(GSVector4::m_one), q == GSVector4i::zero()); // see GIFPackedRegHandlerSTQ
+#if _M_SSE >= 0x501
+	const GSVector8i uvf2 = GSVector8i::broadcast128(uvf);
 
-		m_v.m[0] = st.upl64(rgba.upl32(q)); // TODO: only store the last one
+	for (; i + 1 < count; i += 2, r += 6)
+	{
+		const GSVector8i stq = GSVector8i::cast(GSVector4i::load<false>(&r[0])).insert<1>(GSVector4i::load<false>(&r[3]));
+		const GSVector8i rgba = GSVector8i::cast(GSVector4i::load<false>(&r[1])).insert<1>(GSVector4i::load<false>(&r[4]));
+		const GSVector8i xyz = GSVector8i::cast(GSVector4i::load<false>(&r[2])).insert<1>(GSVector4i::load<false>(&r[5]));
+
+		GSVector8i m0, m1;
+		DecodePackedVertex<xyzf>(stq, stq.zwzw(), rgba, xyz, xyz.zwzw(), uvf2, m0, m1);
 
-		GSVector4i xy = GSVector4i::loadl(&r[2].U64[0]);
-		GSVector4i zf = GSVector4i::loadl(&r[2].U64[1]);
-		xy = xy.upl16(xy.srl<4>()).upl32(GSVector4i::load((int)m_v.UV));
-		zf = zf.srl32(4) & GSVector4i::x00ffffff().upl32(GSVector4i::x000000ff());
+		GSVector8i::sw128(m0, m1); // lanes held the same half of both vertices
 
-		m_v.m[1] = xy.upl32(zf); // TODO: only store the last one
+		GSVector8i::store<true>(&v[i + 0], m0);
+		GSVector8i::store<true>(&v[i + 1], m1);
+	}
+#endif
 
-		VertexKick<prim, auto_flush, index_swap>(r[2].XYZF2.Skip());
+	for (; i < count; i++, r += 3)
+	{
+		GSVector4i m0, m1;
+		DecodePackedVertex<xyzf>(
+			GSVector4i::loadl(&r[0].U64[0]), GSVector4i::loadl(&r[0].U64[1]), GSVector4i::load<false>(&r[1]),
+			GSVector4i::loadl(&r[2].U64[0]), GSVector4i::loadl(&r[2].U64[1]), uvf, m0, m1);
 
-		r += 3;
+		v[i].m[0] = m0;
+		v[i].m[1] = m1;
 	}
+}
 
-	m_q = r[-3].STQ.Q; // remember the last one, STQ outputs this to the temp Q each time
+template <u32 prim, bool auto_flush, bool index_swap>
+void GSState::GIFPackedRegHandlerSTQRGBAXYZF2(const GIFPackedReg* RESTRICT r, u32 size)
+{
+	VertexKickSTQRGBAXYZ<prim, auto_flush, index_swap, true>(r, size);
 }
 
 template <u32 prim, bool auto_flush, bool index_swap>
 void GSState::GIFPackedRegHandlerSTQRGBAXYZ2(const GIFPackedReg* RESTRICT r, u32 size)
+{
+	VertexKickSTQRGBAXYZ<prim, auto_flush, index_swap, false>(r, size);
+}
+
+template <u32 prim, bool auto_flush, bool index_swap, bool xyzf>
+void GSState::VertexKickSTQRGBAXYZ(const GIFPackedReg* RESTRICT r, u32 size)
 {
 	ASSERT(size > 0 && size % 3 == 0);
 
 	const GIFPackedReg* RESTRICT r_end = r + size;
 
-	while (r < r_end)
-	{
-		GSVector4i st = GSVector4i::loadl(&r[0].U64[0]);
-		GSVector4i q = GSVector4i::loadl(&r[0].U64[1]);
-		GSVector4i rgba = (GSVector4i::load<false>(&r[1]) & GSVector4i::x000000ff()).ps32().pu16();
-
-		q = q.blend8(GSVector4i::cast(GSVector4::m_one), q == GSVector4i::zero()); // see GIFPackedRegHandlerSTQ
-
-		m_v.m[0] = st.upl64(rgba.upl32(q)); // TODO: only store the last one
+	const GSVector4i uvf = xyzf ? GSVector4i::load((int)m_v.UV) : GSVector4i::loadl(&m_v.UV);
 
-		GSVector4i xy = GSVector4i::loadl(&r[2].U64[0]);
-		GSVector4i z = GSVector4i::loadl(&r[2].U64[1]);
-		GSVector4i xyz = xy.upl16(xy.srl<4>()).upl32(z);
+	// Decode a batch of vertices up front, then kick them one by one
+	alignas(32) GSVertex batch[32];
+	u32 count = 0;
 
-		m_v.m[1] = xyz.upl64(GSVector4i::loadl(&m_v.UV)); // TODO: only store the last one
+	while (r < r_end)
+	{
+		count = std::min<u32>(static_cast<u32>(r_end - r) / 3, std::size(batch));
 
-		VertexKick<prim, auto_flush, index_swap>(r[2].XYZ2.Skip());
+		DecodePackedVertices<xyzf>(r, batch, count, uvf);
 
-		r += 3;
+		for (u32 i = 0; i < count; i++, r += 3)
+		{
+			VertexKick<prim, auto_flush, index_swap>(batch[i], xyzf ? r[2].XYZF2.Skip() : r[2].XYZ2.Skip());
+		}
 	}
 
+	m_v.m[0] = batch[count - 1].m[0]; // the last vertex is the current vertex state
+	m_v.m[1] = batch[count - 1].m[1];
+
 	m_q = r[-3].STQ.Q; // remember the last one, STQ outputs this to the temp Q each time
 }
 
@@ -904,7 +970,7 @@ void GSState::GIFRegHandlerXYZF2(const GIFReg* RESTRICT r)
 
 	m_v.m[1] = xyz.upl64(uvf);
 
-	VertexKick<prim, auto_flush, index_swap>(adc);
+	VertexKick<prim, auto_flush, index_swap>(m_v, adc);
 }
 
 template <u32 prim, u32 adc, bool auto_flush, bool index_swap>
@@ -912,7 +978,7 @@ void GSState::GIFRegHandlerXYZ2(const GIFReg* RESTRICT r)
 {
 	m_v.m[1] = GSVector4i::load(&r->XYZ, &m_v.UV);
 
-	VertexKick<prim, auto_flush, index_swap>(adc);
+	VertexKick<prim, auto_flush, index_swap>(m_v, adc);
 }
 
 template <int i>
@@ -1513,7 +1579,7 @@ void GSState::FlushWrite()
 
 	const GSLocalMemory::writeImage wi = GSLocalMemory::m_psm[m_env.BITBLTBUF.DPSM].wi;
 
-	(m_mem.*wi)(m_tr.x, m_tr.y, &m_tr.buff[m_tr.start], len, m_env.BITBLTBUF, m_env.TRXPOS, m_env.TRXREG);
+	wi(m_mem, m_tr.x, m_tr.y, &m_tr.buff[m_tr.start], len, m_env.BITBLTBUF, m_env.TRXPOS, m_env.TRXREG);
 
 	m_tr.start += len;
 
@@ -1682,7 +1748,7 @@ void GSState::Write(const u8* mem, int len)
 
 		InvalidateVideoMem(blit, r);
 
-		(m_mem.*psm.wi)(m_tr.x, m_tr.y, mem, m_tr.total, blit, m_env.TRXPOS, m_env.TRXREG);
+		psm.wi(m_mem, m_tr.x, m_tr.y, mem, m_tr.total, blit, m_env.TRXPOS, m_env.TRXREG);
 
 		m_tr.start = m_tr.end = m_tr.total;
 
@@ -2573,7 +2639,7 @@ GSState::PRIM_OVERLAP GSState::PrimitiveOverlap()
 	return overlap;
 }
 
-__forceinline void GSState::HandleAutoFlush()
+__forceinline void GSState::HandleAutoFlush(const GSVertex& vertex)
 {
 	const u32 frame_mask = GSLocalMemory::m_psm[m_context->TEX0.PSM].fmsk;
 	const bool frame_hit = (m_context->FRAME.Block() == m_context->TEX0.TBP0) && !(m_context->TEST.ATE && m_context->TEST.ATST == 0 && m_context->TEST.AFAIL == 2) && ((m_context->FRAME.FBMSK & frame_mask) != frame_mask);
@@ -2611,13 +2677,13 @@ __forceinline void GSState::HandleAutoFlush()
 		// Prepare the currently processed vertex.
 		if (PRIM->FST)
 		{
-			tex_coord.x = m_v.U >> 4;
-			tex_coord.y = m_v.V >> 4;
+			tex_coord.x = vertex.U >> 4;
+			tex_coord.y = vertex.V >> 4;
 		}
 		else
 		{
-			tex_coord.x = (int)((1 << m_context->TEX0.TW) * (m_v.ST.S / m_v.RGBAQ.Q));
-			tex_coord.y = (int)((1 << m_context->TEX0.TH) * (m_v.ST.T / m_v.RGBAQ.Q));
+			tex_coord.x = (int)((1 << m_context->TEX0.TW) * (vertex.ST.S / vertex.RGBAQ.Q));
+			tex_coord.y = (int)((1 << m_context->TEX0.TH) * (vertex.ST.T / vertex.RGBAQ.Q));
 		}
 
 		GSVector4i tex_rect = tex_coord.xyxy();
@@ -2708,7 +2774,7 @@ __forceinline void GSState::HandleAutoFlush()
 }
 
 template <u32 prim, bool auto_flush, bool index_swap>
-__forceinline void GSState::VertexKick(u32 skip)
+__forceinline void GSState::VertexKick(const GSVertex& vertex, u32 skip)
 {
 	size_t n = 0;
 
@@ -2734,7 +2800,7 @@ __forceinline void GSState::VertexKick(u32 skip)
 		m_mem.m_clut.Invalidate(m_context->FRAME.Block());
 
 	if (auto_flush && m_index.tail >= n)
-		HandleAutoFlush();
+		HandleAutoFlush(vertex);
 
 	ASSERT(m_vertex.tail < m_vertex.maxcount + 3);
 
@@ -2743,10 +2809,10 @@ __forceinline void GSState::VertexKick(u32 skip)
 	size_t next = m_vertex.next;
 	size_t xy_tail = m_vertex.xy_tail;
 
-	// callers should write XYZUVF to m_v.m[1] in one piece to have this load store-forwarded, either by the cpu or the compiler when this function is inlined
+	// callers should write XYZUVF to vertex.m[1] in one piece to have this load store-forwarded, either by the cpu or the compiler when this function is inlined
 
-	GSVector4i v0(m_v.m[0]);
-	GSVector4i v1(m_v.m[1]);
+	GSVector4i v0(vertex.m[0]);
+	GSVector4i v1(vertex.m[1]);
 
 	GSVector4i* RESTRICT tailptr = (GSVector4i*)&m_vertex.buff[tail];
 
@@ -75,6 +75,7 @@ class GSState : public GSAlignedClass<32>
 
 	template<u32 prim, bool auto_flush, bool index_swap> void GIFPackedRegHandlerSTQRGBAXYZF2(const GIFPackedReg* RESTRICT r, u32 size);
 	template<u32 prim, bool auto_flush, bool index_swap> void GIFPackedRegHandlerSTQRGBAXYZ2(const GIFPackedReg* RESTRICT r, u32 size);
+	template<u32 prim, bool auto_flush, bool index_swap, bool xyzf> void VertexKickSTQRGBAXYZ(const GIFPackedReg* RESTRICT r, u32 size);
 	void GIFPackedRegHandlerNOP(const GIFPackedReg* RESTRICT r, u32 size);
 
 	template<int i> void ApplyTEX0(GIFRegTEX0& TEX0);
@@ -183,10 +184,10 @@ protected:
 	void UpdateVertexKick();
 
 	void GrowVertexBuffer();
-	void HandleAutoFlush();
+	void HandleAutoFlush(const GSVertex& v);
 	
 	template <u32 prim, bool auto_flush, bool index_swap>
-	void VertexKick(u32 skip);
+	void VertexKick(const GSVertex& v, u32 skip);
 
 	// following functions need m_vt to be initialized
 
@@ -304,6 +305,7 @@ public:
 
 	void SetFrameSkip(int skip);
 	void DumpVertices(const std::string& filename);
+	void DumpVertexCapture(const std::string& filename);
 
 	PRIM_OVERLAP PrimitiveOverlap();
 	GIFRegTEX0 GetTex0Layer(u32 lod);
@@ -17,6 +17,7 @@
 #include "GS.h"
 #include "GSExtra.h"
 #include "GSUtil.h"
+#include "MultiISA.h"
 #include <locale>
 #include <codecvt>
 
@@ -183,6 +184,38 @@ bool GSUtil::CheckSSE()
 	return status;
 }
 
+GSVectorISA GSGetBestISA()
+{
+	static const GSVectorISA isa = []() {
+		// Must match the flags the multi-ISA sources are built with in pcsx2/CMakeLists.txt
+		const bool avx2 = g_cpu.has(Xbyak::util::Cpu::tAVX2) && g_cpu.has(Xbyak::util::Cpu::tBMI1) &&
+			g_cpu.has(Xbyak::util::Cpu::tBMI2) && g_cpu.has(Xbyak::util::Cpu::tFMA);
+		// Xbyak only reports AVX-512 when the OS saves the zmm/k registers
+		if (avx2 && g_cpu.has(Xbyak::util::Cpu::tAVX512F) && g_cpu.has(Xbyak::util::Cpu::tAVX512BW) &&
+			g_cpu.has(Xbyak::util::Cpu::tAVX512VL) && g_cpu.has(Xbyak::util::Cpu::tAVX512_VBMI))
+			return GSVectorISA::AVX2_VBMI;
+		if (avx2)
+			return GSVectorISA::AVX2;
+		if (g_cpu.has(Xbyak::util::Cpu::tAVX))
+			return GSVectorISA::AVX;
+		return GSVectorISA::SSE4;
+	}();
+
+	return isa;
+}
+
+const char* GSGetISAName(GSVectorISA isa)
+{
+	switch (isa)
+	{
+		case GSVectorISA::AVX2_VBMI: return "AVX2 + AVX-512 VBMI";
+		case GSVectorISA::AVX2: return "AVX2";
+		case GSVectorISA::AVX:  return "AVX";
+		case GSVectorISA::SSE4: return "SSE4";
+	}
+	return "";
+}
+
 CRCHackLevel GSUtil::GetRecommendedCRCHackLevel(GSRendererType type)
 {
 	return type == GSRendererType::DX11 ? CRCHackLevel::Full : CRCHackLevel::Partial;
@@ -0,0 +1,77 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021 PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Support for compiling the vectorised GS kernels once per instruction set.
+//
+// Everything that is built with per-ISA compiler flags lives in a namespace named after the ISA,
+// so the SSE4, AVX, AVX2 and AVX-512 VBMI copies of the same function never collide at link time.
+// Normal builds only compile the namespace matching their own compiler flags.
+// Builds with MULTI_ISA_SHARED_COMPILATION (the SSE4.1 distro builds) compile the
+// multi-ISA sources once per ISA and pick a copy at runtime with MULTI_ISA_SELECT.
+//
+// The VBMI level is AVX2 plus AVX-512 F/BW/VL/VBMI. It only changes the GSBlock 8 and 4 bit kernels.
+//
+// Code inside these namespaces may only call shared header code that is __forceinline,
+// anything the linker is allowed to deduplicate could end up running the wrong ISA.
+
+#if _M_SSE >= 0x501 && defined(__AVX512VBMI__) && defined(__AVX512BW__) && defined(__AVX512VL__)
+	#define CURRENT_ISA isa_avx2_vbmi
+#elif _M_SSE >= 0x501
+	#define CURRENT_ISA isa_avx2
+#elif _M_SSE >= 0x500
+	#define CURRENT_ISA isa_avx
+#else
+	#define CURRENT_ISA isa_sse4
+#endif
+
+#define MULTI_ISA_UNSHARED_START namespace CURRENT_ISA {
+#define MULTI_ISA_UNSHARED_END }
+
+// Files that mix shared code with per-ISA kernels put the shared part under MULTI_ISA_COMPILE_ONCE,
+// which is only defined for one of the copies.
+#if !defined(MULTI_ISA_SHARED_COMPILATION) || _M_SSE < 0x500
+	#define MULTI_ISA_COMPILE_ONCE
+#endif
+
+/// Declares something in every ISA namespace, for the entry points the shared code calls into
+#define MULTI_ISA_DEF(...) \
+	namespace isa_sse4 { __VA_ARGS__ } \
+	namespace isa_avx { __VA_ARGS__ } \
+	namespace isa_avx2 { __VA_ARGS__ } \
+	namespace isa_avx2_vbmi { __VA_ARGS__ }
+
+enum class GSVectorISA
+{
+	SSE4,
+	AVX,
+	AVX2,
+	AVX2_VBMI,
+};
+
+/// Best ISA the running CPU supports, the result is cached after the first call
+GSVectorISA GSGetBestISA();
+const char* GSGetISAName(GSVectorISA isa);
+
+#ifdef MULTI_ISA_SHARED_COMPILATION
+	#define MULTI_ISA_SELECT(fn) \
+		(GSGetBestISA() == GSVectorISA::AVX2_VBMI ? isa_avx2_vbmi::fn : \
+		 GSGetBestISA() == GSVectorISA::AVX2      ? isa_avx2::fn      : \
+		 GSGetBestISA() == GSVectorISA::AVX       ? isa_avx::fn       : \
+		                                            isa_sse4::fn)
+#else
+	#define MULTI_ISA_SELECT(fn) (CURRENT_ISA::fn)
+#endif
@@ -15,3 +15,5 @@
 
 #include "PrecompiledHeader.h"
 #include "GSFunctionMap.h"
+
+GSCodeGeneratorStats g_codegen_stats;
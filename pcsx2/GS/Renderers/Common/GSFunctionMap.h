@@ -19,8 +19,21 @@
 #include "GS/GSExtra.h"
 #include "GS/Renderers/SW/GSScanlineEnvironment.h"
 #include "common/emitter/tools.h"
+#include "common/Timer.h"
 
 #include <xbyak/xbyak_util.h>
+#include <atomic>
+#include <mutex>
+
+/// Code generated while a draw was waiting for it, summed over every map and thread.
+/// Precompiled code isn't counted, it never holds up a draw.
+struct GSCodeGeneratorStats
+{
+	std::atomic<u32> compiles{0};
+	std::atomic<u64> ticks{0};
+};
+
+extern GSCodeGeneratorStats g_codegen_stats;
 
 template <class KEY, class VALUE>
 class GSFunctionMap
@@ -164,6 +177,11 @@ class GSCodeGeneratorFunctionMap : public GSFunctionMap<KEY, VALUE>
 	std::unordered_map<u64, VALUE> m_cgmap;
 	GSCodeBuffer m_cb;
 	size_t m_total_code_size;
+	// Guards m_cgmap, m_cb and m_total_code_size, code can also be generated ahead of time by Precompile
+	std::mutex m_lock;
+	// Precompile generates into its own buffer without holding m_lock, so draws never wait on it
+	GSCodeBuffer m_precompile_cb;
+	std::mutex m_precompile_lock;
 
 	enum { MAX_SIZE = 8192 };
 
@@ -184,78 +202,126 @@ public:
 
 	VALUE GetDefaultFunction(KEY key)
 	{
-		VALUE ret = NULL;
+		std::lock_guard<std::mutex> lock(m_lock);
 
 		auto i = m_cgmap.find(key);
 
 		if (i != m_cgmap.end())
+			return i->second;
+
+		const Common::Timer::Value start = Common::Timer::GetCurrentValue();
+
+		CG* cg = Assemble(m_cb, key);
+		m_cb.ReleaseBuffer(cg->getSize());
+		VALUE ret = Publish(key, cg);
+		delete cg;
+
+		g_codegen_stats.compiles.fetch_add(1, std::memory_order_relaxed);
+		g_codegen_stats.ticks.fetch_add(Common::Timer::GetCurrentValue() - start, std::memory_order_relaxed);
+
+		return ret;
+	}
+
+	/// Generates the code for key if it doesn't exist yet, safe to call from any thread.
+	/// m_lock is only held to look up and publish the function, not while generating it.
+	void Precompile(KEY key)
+	{
 		{
-			ret = i->second;
+			std::lock_guard<std::mutex> lock(m_lock);
+
+			if (m_cgmap.find(key) != m_cgmap.end())
+				return;
 		}
-		else
+
+		std::lock_guard<std::mutex> precompile_lock(m_precompile_lock);
+
+		CG* cg = Assemble(m_precompile_cb, key);
+
 		{
-			void* code_ptr = m_cb.GetBuffer(MAX_SIZE);
+			std::lock_guard<std::mutex> lock(m_lock);
 
-			CG* cg = new CG(m_param, key, code_ptr, MAX_SIZE);
-			ASSERT(cg->getSize() < MAX_SIZE);
+			// A draw may have needed the function in the meantime, then its code is the one in use
+			if (m_cgmap.find(key) == m_cgmap.end())
+			{
+				m_precompile_cb.ReleaseBuffer(cg->getSize());
+				Publish(key, cg);
+			}
+			else
+			{
+				m_precompile_cb.ReleaseBuffer(0);
+			}
+		}
+
+		delete cg;
+	}
+
+private:
+	// Generates the code for key into cb, the caller has to hold whichever lock guards cb
+	CG* Assemble(GSCodeBuffer& cb, KEY key)
+	{
+		void* code_ptr = cb.GetBuffer(MAX_SIZE);
+
+		CG* cg = new CG(m_param, key, code_ptr, MAX_SIZE);
+		ASSERT(cg->getSize() < MAX_SIZE);
 
 #if 0
-			fprintf(stderr, "%s Location:%p Size:%zu Key:%llx\n", m_name.c_str(), code_ptr, cg->getSize(), (u64)key);
-			GSScanlineSelector sel(key);
-			sel.Print();
+		fprintf(stderr, "%s Location:%p Size:%zu Key:%llx\n", m_name.c_str(), code_ptr, cg->getSize(), (u64)key);
+		GSScanlineSelector sel(key);
+		sel.Print();
 #endif
 
-			m_total_code_size += cg->getSize();
+		return cg;
+	}
 
-			m_cb.ReleaseBuffer(cg->getSize());
+	// Call with m_lock held, makes the code generated by cg the function for key
+	VALUE Publish(KEY key, CG* cg)
+	{
+		m_total_code_size += cg->getSize();
 
-			ret = (VALUE)cg->getCode();
+		VALUE ret = (VALUE)cg->getCode();
 
-			m_cgmap[key] = ret;
+		m_cgmap[key] = ret;
 
 #ifdef ENABLE_VTUNE
 
-			// vtune method registration
+		// vtune method registration
 
-			// if(iJIT_IsProfilingActive()) // always > 0
-			{
-				std::string name = format("%s<%016llx>()", m_name.c_str(), (u64)key);
+		// if(iJIT_IsProfilingActive()) // always > 0
+		{
+			std::string name = format("%s<%016llx>()", m_name.c_str(), (u64)key);
 
-				iJIT_Method_Load ml;
+			iJIT_Method_Load ml;
 
-				memset(&ml, 0, sizeof(ml));
+			memset(&ml, 0, sizeof(ml));
 
-				ml.method_id = iJIT_GetNewMethodID();
-				ml.method_name = (char*)name.c_str();
-				ml.method_load_address = (void*)cg->getCode();
-				ml.method_size = (unsigned int)cg->getSize();
+			ml.method_id = iJIT_GetNewMethodID();
+			ml.method_name = (char*)name.c_str();
+			ml.method_load_address = (void*)cg->getCode();
+			ml.method_size = (unsigned int)cg->getSize();
 
-				iJIT_NotifyEvent(iJVM_EVENT_TYPE_METHOD_LOAD_FINISHED, &ml);
+			iJIT_NotifyEvent(iJVM_EVENT_TYPE_METHOD_LOAD_FINISHED, &ml);
 /*
-				name = format("c:/temp1/%s_%016llx.bin", m_name.c_str(), (u64)key);
+			name = format("c:/temp1/%s_%016llx.bin", m_name.c_str(), (u64)key);
 
-				if(FILE* fp = fopen(name.c_str(), "wb"))
-				{
-					fputc(0x0F, fp); fputc(0x0B, fp);
-					fputc(0xBB, fp); fputc(0x6F, fp); fputc(0x00, fp); fputc(0x00, fp); fputc(0x00, fp);
-					fputc(0x64, fp); fputc(0x67, fp); fputc(0x90, fp);
+			if(FILE* fp = fopen(name.c_str(), "wb"))
+			{
+				fputc(0x0F, fp); fputc(0x0B, fp);
+				fputc(0xBB, fp); fputc(0x6F, fp); fputc(0x00, fp); fputc(0x00, fp); fputc(0x00, fp);
+				fputc(0x64, fp); fputc(0x67, fp); fputc(0x90, fp);
 
-					fwrite(cg->getCode(), cg->getSize(), 1, fp);
+				fwrite(cg->getCode(), cg->getSize(), 1, fp);
 
-					fputc(0xBB, fp); fputc(0xDE, fp); fputc(0x00, fp); fputc(0x00, fp); fputc(0x00, fp);
-					fputc(0x64, fp); fputc(0x67, fp); fputc(0x90, fp);
-					fputc(0x0F, fp); fputc(0x0B, fp);
+				fputc(0xBB, fp); fputc(0xDE, fp); fputc(0x00, fp); fputc(0x00, fp); fputc(0x00, fp);
+				fputc(0x64, fp); fputc(0x67, fp); fputc(0x90, fp);
+				fputc(0x0F, fp); fputc(0x0B, fp);
 
-					fclose(fp);
-				}
-*/
+				fclose(fp);
 			}
+*/
+		}
 
 #endif
 
-			delete cg;
-		}
-
 		return ret;
 	}
 };
@@ -495,10 +495,24 @@ void GSRenderer::VSync(u32 field, bool registers_written)
 			}
 			else
 			{
-				m_dump = std::unique_ptr<GSDumpBase>(new GSDumpXz(m_snapshot, GetDumpSerial(), m_crc,
-					DUMP_SCREENSHOT_WIDTH, DUMP_SCREENSHOT_HEIGHT,
-					screenshot_pixels.empty() ? nullptr : screenshot_pixels.data(),
-					fd, m_regs));
+#ifdef USE_ZSTD
+				// zstd compresses in the background as the dump is written, xz only compresses when it ends.
+				// It's opt-in, since older builds and other tools only read .gs.xz dumps.
+				if (GSConfig.GSDumpCompression == GSDumpCompressionMethod::Zstandard)
+				{
+					m_dump = std::unique_ptr<GSDumpBase>(new GSDumpZst(m_snapshot, GetDumpSerial(), m_crc,
+						DUMP_SCREENSHOT_WIDTH, DUMP_SCREENSHOT_HEIGHT,
+						screenshot_pixels.empty() ? nullptr : screenshot_pixels.data(),
+						fd, m_regs));
+				}
+				else
+#endif
+				{
+					m_dump = std::unique_ptr<GSDumpBase>(new GSDumpXz(m_snapshot, GetDumpSerial(), m_crc,
+						DUMP_SCREENSHOT_WIDTH, DUMP_SCREENSHOT_HEIGHT,
+						screenshot_pixels.empty() ? nullptr : screenshot_pixels.data(),
+						fd, m_regs));
+				}
 			}
 
 			delete[] fd.data;
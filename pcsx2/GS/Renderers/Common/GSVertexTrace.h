@@ -21,6 +21,7 @@
 #include "GS/Renderers/SW/GSVertexSW.h"
 #include "GS/Renderers/HW/GSVertexHW.h"
 #include "GSFunctionMap.h"
+#include "GS/MultiISA.h"
 
 class GSState;
 
@@ -39,17 +40,28 @@ public:
 	};
 	bool m_accurate_stq;
 
-protected:
-	const GSState* m_state;
+	/// Finds the range of the indexed vertices, see GSVertexTraceFMM.cpp
+	typedef void (*FindMinMaxPtr)(Vertex& vmin, Vertex& vmax, const GSDrawingContext* context, const void* vertex, const u32* index, int count);
+	typedef FindMinMaxPtr FindMinMaxTable[2][2][2][2][4]; // [color][fst][tme][iip][primclass]
 
-	static const GSVector4 s_minmax;
-
-	typedef void (GSVertexTrace::*FindMinMaxPtr)(const void* vertex, const u32* index, int count);
+	/// Header of the raw vertex buffers GSState::DumpVertexCapture writes, followed by
+	/// v_count GSVertex and i_count u32 indices.  tests/ctest/GS/vertex_trace_bench reads them back.
+	struct Capture
+	{
+		enum { MAGIC = 0x31565456 }; // "VTV1"
+
+		u32 magic;
+		u32 primclass, iip, tme, fst, color;
+		u32 provoking_vertex_first;
+		u32 v_count, i_count;
+		GIFRegXYOFFSET XYOFFSET;
+		GIFRegTEX0 TEX0;
+	};
 
-	FindMinMaxPtr m_fmm[2][2][2][2][4];
+protected:
+	const GSState* m_state;
 
-	template <GS_PRIM_CLASS primclass, u32 iip, u32 tme, u32 fst, u32 color, bool provoking_vertex_first>
-	void FindMinMax(const void* vertex, const u32* index, int count);
+	FindMinMaxTable m_fmm;
 
 public:
 	GS_PRIM_CLASS m_primclass;
@@ -83,3 +95,6 @@ public:
 
 	void CorrectDepthTrace(const void* vertex, int count);
 };
+
+/// Fills in the FindMinMax kernels for the given provoking vertex convention
+MULTI_ISA_DEF(void GSVertexTracePopulateFunctions(GSVertexTrace::FindMinMaxTable& fmm, bool provoking_vertex_first);)
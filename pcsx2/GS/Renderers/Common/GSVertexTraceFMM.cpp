@@ -0,0 +1,310 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022 PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "GSVertexTrace.h"
+#include <cfloat>
+
+// Vertex range kernels for GSVertexTrace.
+// This file is compiled once per ISA in multi-ISA builds, see MultiISA.h.
+//
+// With AVX2 the same per-lane code runs on two pairs of vertices at once, one pair in each
+// 128-bit lane, and the lanes are folded together at the end.
+
+MULTI_ISA_UNSHARED_START
+
+template <GS_PRIM_CLASS primclass, u32 iip, u32 tme, u32 fst, u32 color, bool flat_swapped>
+static void FindMinMax(GSVertexTrace::Vertex& vmin, GSVertexTrace::Vertex& vmax, const GSDrawingContext* context, const void* vertex, const u32* index, int count)
+{
+#if _M_SSE >= 0x501
+	typedef GSVector8 VectorF;
+	typedef GSVector8i VectorI;
+#else
+	typedef GSVector4 VectorF;
+	typedef GSVector4i VectorI;
+#endif
+
+	int n = 1;
+
+	switch (primclass)
+	{
+		case GS_POINT_CLASS:
+			n = 1;
+			break;
+		case GS_LINE_CLASS:
+		case GS_SPRITE_CLASS:
+			n = 2;
+			break;
+		case GS_TRIANGLE_CLASS:
+			n = 3;
+			break;
+	}
+
+	VectorF tmin = VectorF(FLT_MAX);
+	VectorF tmax = VectorF(-FLT_MAX);
+	VectorI cmin = VectorI::xffffffff();
+	VectorI cmax = VectorI::zero();
+
+	VectorI pmin = VectorI::xffffffff();
+	VectorI pmax = VectorI::zero();
+
+	const GSVertex* RESTRICT v = (GSVertex*)vertex;
+
+	// Process 2 vertices at a time for increased efficiency
+	// stq/xyzf are the two halves of each vertex: ST and RGBAQ, then XYZ, UV and FOG
+	auto processVertices = [&](const VectorI& stq0_, const VectorI& xyzf0, const VectorI& stq1_, const VectorI& xyzf1, bool finalVertex)
+	{
+		if (color)
+		{
+			// RGBA is the z element, the rest is min/maxed along with it and dropped at the end
+			const VectorI& c0 = stq0_;
+			const VectorI& c1 = stq1_;
+			if (iip || finalVertex)
+			{
+				cmin = cmin.min_u8(c0.min_u8(c1));
+				cmax = cmax.max_u8(c0.max_u8(c1));
+			}
+			else if (n == 2)
+			{
+				// For even n, we process v1 and v2 of the same prim
+				// (For odd n, we process one vertex from each of two prims)
+				cmin = cmin.min_u8(c1);
+				cmax = cmax.max_u8(c1);
+			}
+		}
+
+		if (tme)
+		{
+			if (!fst)
+			{
+				VectorF stq0 = VectorF::cast(stq0_);
+				VectorF stq1 = VectorF::cast(stq1_);
+
+				VectorF q;
+				// Sprites always have indices == vertices, so we don't have to look at the index table here
+				if (primclass == GS_SPRITE_CLASS)
+					q = stq1.wwww();
+				else
+					q = stq0.wwww(stq1);
+
+				// Note: If in the future this is changed in a way that causes parts of calculations to go unused,
+				//       make sure to remove the z (rgba) field as it's often denormal.
+				//       Then, use GSVector4::noopt() to prevent clang from optimizing out your "useless" shuffle
+				//       e.g. stq = (stq.xyww() / stq.wwww()).noopt().xyww(stq);
+				VectorF st = stq0.xyxy(stq1) / q;
+
+				stq0 = st.xyww(primclass == GS_SPRITE_CLASS ? stq1 : stq0);
+				stq1 = st.zwww(stq1);
+
+				tmin = tmin.min(stq0.min(stq1));
+				tmax = tmax.max(stq0.max(stq1));
+			}
+			else
+			{
+				VectorF st0 = VectorF(xyzf0.uph16()).xyxy();
+				VectorF st1 = VectorF(xyzf1.uph16()).xyxy();
+
+				tmin = tmin.min(st0.min(st1));
+				tmax = tmax.max(st0.max(st1));
+			}
+		}
+
+		VectorI xy0 = xyzf0.upl16();
+		VectorI z0 = xyzf0.yyyy();
+		VectorI xy1 = xyzf1.upl16();
+		VectorI z1 = xyzf1.yyyy();
+
+		VectorI p0 = xy0.template blend16<0xf0>(z0.uph32(primclass == GS_SPRITE_CLASS ? xyzf1 : xyzf0));
+		VectorI p1 = xy1.template blend16<0xf0>(z1.uph32(xyzf1));
+
+		pmin = pmin.min_u32(p0.min_u32(p1));
+		pmax = pmax.max_u32(p0.max_u32(p1));
+	};
+
+#if _M_SSE >= 0x501
+	// Two pairs per call, (v0, v1) in the low lane and (v2, v3) in the high lane
+	auto process = [&](const GSVertex& v0, const GSVertex& v1, const GSVertex& v2, const GSVertex& v3, bool finalVertex)
+	{
+		processVertices(
+			GSVector8i::load(&v0.m[0], &v2.m[0]), GSVector8i::load(&v0.m[1], &v2.m[1]),
+			GSVector8i::load(&v1.m[0], &v3.m[0]), GSVector8i::load(&v1.m[1], &v3.m[1]),
+			finalVertex);
+	};
+
+	// Leftovers run the same pair in both lanes
+	auto processPair = [&](const GSVertex& v0, const GSVertex& v1, bool finalVertex)
+	{
+		process(v0, v1, v0, v1, finalVertex);
+	};
+#else
+	auto processPair = [&](const GSVertex& v0, const GSVertex& v1, bool finalVertex)
+	{
+		processVertices(GSVector4i(v0.m[0]), GSVector4i(v0.m[1]), GSVector4i(v1.m[0]), GSVector4i(v1.m[1]), finalVertex);
+	};
+#endif
+
+	if (n == 2)
+	{
+		int i = 0;
+#if _M_SSE >= 0x501
+		for (; i < (count - 2); i += 4)
+		{
+			process(v[index[i + 0]], v[index[i + 1]], v[index[i + 2]], v[index[i + 3]], false);
+		}
+#endif
+		for (; i < count; i += 2)
+		{
+			processPair(v[index[i + 0]], v[index[i + 1]], false);
+		}
+	}
+	else if (iip || n == 1) // iip means final and non-final vertexes are treated the same
+	{
+		int i = 0;
+#if _M_SSE >= 0x501
+		for (; i < (count - 3); i += 4) // 4x loop unroll
+		{
+			process(v[index[i + 0]], v[index[i + 1]], v[index[i + 2]], v[index[i + 3]], true);
+		}
+#endif
+		for (; i < (count - 1); i += 2) // 2x loop unroll
+		{
+			processPair(v[index[i + 0]], v[index[i + 1]], true);
+		}
+		if (count & 1)
+		{
+			// Compiler optimizations go!
+			// (And if they don't, it's only one vertex out of many)
+			processPair(v[index[i]], v[index[i]], true);
+		}
+	}
+	else if (n == 3)
+	{
+		int i = 0;
+#if _M_SSE >= 0x501
+		for (; i < (count - 9); i += 12) // four triangles, two in each lane
+		{
+			process(v[index[i + 0]], v[index[i + 3]], v[index[i + 6]], v[index[i + 9]], flat_swapped);
+			process(v[index[i + 1]], v[index[i + 4]], v[index[i + 7]], v[index[i + 10]], false);
+			process(v[index[i + 2]], v[index[i + 5]], v[index[i + 8]], v[index[i + 11]], !flat_swapped);
+		}
+#endif
+		for (; i < (count - 3); i += 6)
+		{
+			processPair(v[index[i + 0]], v[index[i + 3]], flat_swapped);
+			processPair(v[index[i + 1]], v[index[i + 4]], false);
+			processPair(v[index[i + 2]], v[index[i + 5]], !flat_swapped);
+		}
+		if (count & 1)
+		{
+			processPair(v[index[i + 0]], v[index[i + 1]], flat_swapped);
+			// Compiler optimizations go!
+			// (And if they don't, it's only one vertex out of many)
+			processPair(v[index[i + 2]], v[index[i + 2]], !flat_swapped);
+		}
+	}
+	else
+	{
+		pxAssertRel(0, "Bad n value");
+	}
+
+#if _M_SSE >= 0x501
+	// Fold the two lanes together
+	const GSVector4 tmin4 = tmin.extract<0>().min(tmin.extract<1>());
+	const GSVector4 tmax4 = tmax.extract<0>().max(tmax.extract<1>());
+	const GSVector4i cmin4 = cmin.extract<0>().min_u8(cmin.extract<1>());
+	const GSVector4i cmax4 = cmax.extract<0>().max_u8(cmax.extract<1>());
+	const GSVector4i pmin4 = pmin.extract<0>().min_u32(pmin.extract<1>());
+	const GSVector4i pmax4 = pmax.extract<0>().max_u32(pmax.extract<1>());
+#else
+	const GSVector4 tmin4 = tmin;
+	const GSVector4 tmax4 = tmax;
+	const GSVector4i cmin4 = cmin;
+	const GSVector4i cmax4 = cmax;
+	const GSVector4i pmin4 = pmin;
+	const GSVector4i pmax4 = pmax;
+#endif
+
+	GSVector4 o(context->XYOFFSET);
+	GSVector4 s(1.0f / 16, 1.0f / 16, 2.0f, 1.0f);
+
+	vmin.p = (GSVector4(pmin4) - o) * s;
+	vmax.p = (GSVector4(pmax4) - o) * s;
+
+	// Fix signed int conversion
+	vmin.p = vmin.p.insert32<0, 2>(GSVector4::load((float)(u32)pmin4.extract32<2>()));
+	vmax.p = vmax.p.insert32<0, 2>(GSVector4::load((float)(u32)pmax4.extract32<2>()));
+
+	if (tme)
+	{
+		if (fst)
+		{
+			s = GSVector4(1.0f / 16, 1.0f).xxyy();
+		}
+		else
+		{
+			s = GSVector4(1 << context->TEX0.TW, 1 << context->TEX0.TH, 1, 1);
+		}
+
+		vmin.t = tmin4 * s;
+		vmax.t = tmax4 * s;
+	}
+	else
+	{
+		vmin.t = GSVector4::zero();
+		vmax.t = GSVector4::zero();
+	}
+
+	if (color)
+	{
+		vmin.c = cmin4.zzzz().u8to32();
+		vmax.c = cmax4.zzzz().u8to32();
+	}
+	else
+	{
+		vmin.c = GSVector4i::zero();
+		vmax.c = GSVector4i::zero();
+	}
+}
+
+void GSVertexTracePopulateFunctions(GSVertexTrace::FindMinMaxTable& fmm, bool provoking_vertex_first)
+{
+	#define InitUpdate3(P, IIP, TME, FST, COLOR) \
+	fmm[COLOR][FST][TME][IIP][P] = \
+		provoking_vertex_first ? &FindMinMax<P, IIP, TME, FST, COLOR, true> : \
+		                         &FindMinMax<P, IIP, TME, FST, COLOR, false>;
+
+	#define InitUpdate2(P, IIP, TME) \
+		InitUpdate3(P, IIP, TME, 0, 0) \
+		InitUpdate3(P, IIP, TME, 0, 1) \
+		InitUpdate3(P, IIP, TME, 1, 0) \
+		InitUpdate3(P, IIP, TME, 1, 1) \
+
+	#define InitUpdate(P) \
+		InitUpdate2(P, 0, 0) \
+		InitUpdate2(P, 0, 1) \
+		InitUpdate2(P, 1, 0) \
+		InitUpdate2(P, 1, 1) \
+
+	InitUpdate(GS_POINT_CLASS);
+	InitUpdate(GS_LINE_CLASS);
+	InitUpdate(GS_TRIANGLE_CLASS);
+	InitUpdate(GS_SPRITE_CLASS);
+
+	#undef InitUpdate
+	#undef InitUpdate2
+	#undef InitUpdate3
+}
+
+MULTI_ISA_UNSHARED_END
@@ -1209,6 +1209,8 @@ void GSRendererHW::Draw()
 		// Dump vertices
 		s = format("%05d_vertex.txt", s_n);
 		DumpVertices(m_dump_root + s);
+		s = format("%05d_vertex.bin", s_n);
+		DumpVertexCapture(m_dump_root + s);
 	}
 	if (IsBadFrame())
 	{
@@ -21,7 +21,7 @@
 class GSDeviceNull : public GSDevice
 {
 private:
-	GSTexture* CreateSurface(GSTexture::Type type, int w, int h, GSTexture::Format format);
+	GSTexture* CreateSurface(GSTexture::Type type, int w, int h, int levels, GSTexture::Format format) override;
 
 	void DoMerge(GSTexture* sTex[3], GSVector4* sRect, GSTexture* dTex, GSVector4* dRect, const GSRegPMODE& PMODE, const GSRegEXTBUF& EXTBUF, const GSVector4& c) {}
 	void DoInterlace(GSTexture* sTex, GSTexture* dTex, int shader, bool linear, float yoffset = 0) {}
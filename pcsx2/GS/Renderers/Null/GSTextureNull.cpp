@@ -16,23 +16,14 @@
 #include "PrecompiledHeader.h"
 #include "GSTextureNull.h"
 
-GSTextureNull::GSTextureNull()
+GSTextureNull::GSTextureNull(Type type, int w, int h, int levels, GSTexture::Format format)
 {
-	memset(&m_desc, 0, sizeof(m_desc));
-}
-
-GSTextureNull::GSTextureNull(Type type, int w, int h, GSTexture::Format format)
-{
-	m_desc.type = type;
-	m_desc.w = w;
-	m_desc.h = h;
-	m_desc.format = format;
-}
-
-void GSTextureNull::Swap(GSTexture* tex)
-{
-	GSTexture::Swap(tex);
-	std::swap(m_desc, static_cast<GSTextureNull*>(tex)->m_desc);
+	m_type = type;
+	m_format = format;
+	m_size.x = w;
+	m_size.y = h;
+	m_committed_size = m_size;
+	m_mipmap_levels = levels;
 }
 
 void* GSTextureNull::GetNativeHandle() const
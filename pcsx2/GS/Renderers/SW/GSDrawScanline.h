@@ -37,6 +37,9 @@ protected:
 	GSCodeGeneratorFunctionMap<GSSetupPrimCodeGenerator, u64, SetupPrimPtr> m_sp_map;
 	GSCodeGeneratorFunctionMap<GSDrawScanlineCodeGenerator, u64, DrawScanlinePtr> m_ds_map;
 
+	static GSScanlineSelector GetEdgeSelector(const GSScanlineSelector& global);
+	static GSScanlineSelector GetSetupPrimSelector(const GSScanlineSelector& global);
+
 	template <class T, bool masked>
 	void DrawRectT(const GSOffset& off, const GSVector4i& r, u32 c, u32 m);
 
@@ -63,6 +66,7 @@ public:
 
 	void BeginDraw(const GSRasterizerData* data);
 	void EndDraw(u64 frame, u64 ticks, int actual, int total, int prims);
+	void Precompile(u64 key);
 
 	void DrawRect(const GSVector4i& r, const GSVertexSW& v);
 
@@ -2735,7 +2735,7 @@ void GSDrawScanlineCodeGenerator2::WriteMask()
 }
 
 /// Inputs: t2=za, edx=fzm, _zm
-/// Destroys: xym0, xym1, xym7
+/// Destroys: rax, xym0, xym1, xym7
 void GSDrawScanlineCodeGenerator2::WriteZBuf()
 {
 	if (!m_sel.zwrite)
@@ -3211,6 +3211,23 @@ void GSDrawScanlineCodeGenerator2::WritePixel(const XYm& src_, const AddressReg&
 #endif
 		}
 	}
+#if USING_YMM
+	else if (hasAVX512 && hasBMI2 && (fast || psm == 0))
+	{
+		// Every pixel written is a whole dword, so store them under a mask instead of branching on fzm
+		// Pixel pairs are 16 bytes apart, [p01, p45, p23, p67] puts p01 and p23 at +0 and +16 of the
+		// first store and p45 and p67 at +8 and +24 of the second, 24 bytes further on
+
+		pext(eax, mask, ptr[_g_const + offsetof(GSScanlineConstantData, m_fzm_pixel_bits) + fz * sizeof(u32)]);
+		pdep(eax, eax, ptr[_g_const + offsetof(GSScanlineConstantData, m_fzm_pair_bits)]);
+		kmovw(k1, eax);
+		kshiftrw(k2, k1, 6);
+
+		vpermq(src_, src_, _MM_SHUFFLE(3, 1, 2, 0));
+		vmovdqu32(yword[base] | k1, src_);
+		vmovdqu32(yword[base + 12 * 2] | k2, src_);
+	}
+#endif
 	else
 	{
 		if (fast)
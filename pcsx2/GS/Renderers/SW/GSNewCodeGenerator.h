@@ -32,6 +32,9 @@ namespace SSEVersion
 struct CPUInfo
 {
 	bool hasFMA = false;
+	bool hasBMI2 = false;
+	/// AVX-512 F and VL, enough to use EVEX encoded dword instructions and mask registers on xmm/ymm
+	bool hasAVX512 = false;
 	SSEVersion::SSEVersion sseVersion = SSEVersion::SSE41;
 
 	CPUInfo() = default;
@@ -44,6 +47,8 @@ struct CPUInfo
 			version = SSEVersion::AVX2;
 
 		hasFMA = cpu.has(cpu.tFMA);
+		hasBMI2 = cpu.has(cpu.tBMI2);
+		hasAVX512 = cpu.has(cpu.tAVX512F) && cpu.has(cpu.tAVX512VL);
 		sseVersion = version;
 	}
 };
@@ -64,6 +69,7 @@ public:
 	using Xmm = Xbyak::Xmm;
 	using Ymm = Xbyak::Ymm;
 	using Zmm = Xbyak::Zmm;
+	using Opmask = Xbyak::Opmask;
 
 	class Error : public std::exception
 	{
@@ -157,7 +163,7 @@ public:
 	static T32 choose3264(T32 t32, T64 t64) { return t32; }
 #endif
 
-	const bool hasAVX, hasAVX2, hasFMA;
+	const bool hasAVX, hasAVX2, hasAVX512, hasFMA, hasBMI2;
 
 	const Xmm xmm0{0}, xmm1{1}, xmm2{2}, xmm3{3}, xmm4{4}, xmm5{5}, xmm6{6}, xmm7{7}, xmm8{8}, xmm9{9}, xmm10{10}, xmm11{11}, xmm12{12}, xmm13{13}, xmm14{14}, xmm15{15};
 	const Ymm ymm0{0}, ymm1{1}, ymm2{2}, ymm3{3}, ymm4{4}, ymm5{5}, ymm6{6}, ymm7{7}, ymm8{8}, ymm9{9}, ymm10{10}, ymm11{11}, ymm12{12}, ymm13{13}, ymm14{14}, ymm15{15};
@@ -165,6 +171,7 @@ public:
 	const Reg32      eax{0}, ecx{1}, edx{2}, ebx{3}, esp{4}, ebp{5}, esi{6}, edi{7}, r8d{8}, r9d{9}, r10d{10}, r11d{11}, r12d{12}, r13d{13}, r14d{14}, r15d{15};
 	const Reg16       ax{0},  cx{1},  dx{2},  bx{3},  sp{4},  bp{5},  si{6},  di{7};
 	const Reg8        al{0},  cl{1},  dl{2},  bl{3},  ah{4},  ch{5},  dh{6},  bh{7};
+	const Opmask      k1{1}, k2{2};
 
 	const RipType rip{};
 	const Xbyak::AddressFrame ptr{0}, byte{8}, word{16}, dword{32}, qword{64}, xword{128}, yword{256}, zword{512};
@@ -173,7 +180,9 @@ public:
 		: actual(*actual)
 		, hasAVX(cpu.sseVersion >= SSEVersion::AVX)
 		, hasAVX2(cpu.sseVersion >= SSEVersion::AVX2)
+		, hasAVX512(cpu.hasAVX512)
 		, hasFMA(cpu.hasFMA)
+		, hasBMI2(cpu.hasBMI2)
 	{
 	}
 
@@ -190,7 +199,9 @@ public:
 //   SSEONLY: available only on SSE (exception on AVX)
 //   AVX:     available only on AVX (exception on SSE)
 //   AVX2:    available only on AVX2 (exception on AVX/SSE)
+//   AVX512:  available only on AVX-512 F+VL (exception otherwise)
 //   FMA:     available only with FMA
+//   BMI2:    available only with BMI2
 // SFORWARD forwards an SSE-AVX pair where the AVX variant takes the same number of registers (e.g. pshufd dst, src + vpshufd dst, src)
 // AFORWARD forwards an SSE-AVX pair where the AVX variant takes an extra destination register (e.g. shufps dst, src + vshufps dst, src, src)
 
@@ -229,12 +240,24 @@ public:
 	else \
 		throw Error(Error::ERR_AVX_INSTR_IN_SSE);
 
+#define ACTUAL_FORWARD_AVX512(name, ...) \
+	if (hasAVX512) \
+		actual.name(__VA_ARGS__); \
+	else \
+		throw Error(Error::ERR_AVX_INSTR_IN_SSE);
+
 #define ACTUAL_FORWARD_FMA(name, ...) \
 	if (hasFMA) \
 		actual.name(__VA_ARGS__); \
 	else \
 		throw Error(Error::ERR_AVX_INSTR_IN_SSE);
 
+#define ACTUAL_FORWARD_BMI2(name, ...) \
+	if (hasBMI2) \
+		actual.name(__VA_ARGS__); \
+	else \
+		throw Error(Error::ERR_AVX_INSTR_IN_SSE);
+
 #define FORWARD1(category, name, type) \
 	void name(type a) \
 	{ \
@@ -458,6 +481,13 @@ public:
 	FORWARD(3, AVX2, vpsravd,        ARGS_XXO)
 	FORWARD(3, AVX2, vpsrlvd,        ARGS_XXO)
 
+	FORWARD(2, AVX512, kmovw,        const Opmask&, const Reg32&)
+	FORWARD(3, AVX512, kshiftrw,     const Opmask&, const Opmask&, u8)
+	FORWARD(2, AVX512, vmovdqu32,    const Address&, const Xmm&)
+
+	FORWARD(3, BMI2,   pdep,         const Reg32e&, const Reg32e&, const Operand&)
+	FORWARD(3, BMI2,   pext,         const Reg32e&, const Reg32e&, const Operand&)
+
 #undef REQUIRE64
 #undef ARGS_OI
 #undef ARGS_OO
@@ -479,7 +509,9 @@ public:
 #undef FORWARD3
 #undef FORWARD2
 #undef FORWARD1
+#undef ACTUAL_FORWARD_BMI2
 #undef ACTUAL_FORWARD_FMA
+#undef ACTUAL_FORWARD_AVX512
 #undef ACTUAL_FORWARD_AVX2
 #undef ACTUAL_FORWARD_AVX
 #undef ACTUAL_FORWARD_SSE
@@ -136,6 +136,13 @@ void GSRasterizer::Draw(GSRasterizerData* data)
 	if (data->vertex != NULL && data->vertex_count == 0 || data->index != NULL && data->index_count == 0)
 		return;
 
+	BeginDraw(data);
+	DrawPrims(data, data->scissor, NULL, 0);
+	EndDraw(data);
+}
+
+void GSRasterizer::BeginDraw(GSRasterizerData* data)
+{
 	m_pixels.actual = 0;
 	m_pixels.total = 0;
 	m_primcount = 0;
@@ -145,6 +152,11 @@ void GSRasterizer::Draw(GSRasterizerData* data)
 
 	m_ds->BeginDraw(data);
 
+	m_scanmsk_value = data->scanmsk_value;
+}
+
+void GSRasterizer::DrawPrims(GSRasterizerData* data, const GSVector4i& scissor, const u32* prims, int count)
+{
 	const GSVertexSW* vertex = data->vertex;
 	const GSVertexSW* vertex_end = data->vertex + data->vertex_count;
 
@@ -153,12 +165,72 @@ void GSRasterizer::Draw(GSRasterizerData* data)
 
 	u32 tmp_index[] = {0, 1, 2};
 
-	bool scissor_test = !data->bbox.eq(data->bbox.rintersect(data->scissor));
+	bool scissor_test = !data->bbox.eq(data->bbox.rintersect(scissor));
 
-	m_scissor = data->scissor;
-	m_fscissor_x = GSVector4(data->scissor).xzxz();
-	m_fscissor_y = GSVector4(data->scissor).ywyw();
-	m_scanmsk_value = data->scanmsk_value;
+	m_scissor = scissor;
+	m_fscissor_x = GSVector4(scissor).xzxz();
+	m_fscissor_y = GSVector4(scissor).ywyw();
+
+	if (prims != NULL)
+	{
+		const u32* prims_end = prims + count;
+
+		switch (data->primclass)
+		{
+			case GS_POINT_CLASS:
+
+				for (; prims < prims_end; prims++)
+				{
+					if (index != NULL)
+						DrawPoint<true>(vertex, 1, index + *prims, 1);
+					else
+						DrawPoint<true>(vertex + *prims, 1, NULL, 0);
+				}
+
+				break;
+
+			case GS_LINE_CLASS:
+
+				for (; prims < prims_end; prims++)
+				{
+					if (index != NULL)
+						DrawLine(vertex, index + *prims * 2);
+					else
+						DrawLine(vertex + *prims * 2, tmp_index);
+				}
+
+				break;
+
+			case GS_TRIANGLE_CLASS:
+
+				for (; prims < prims_end; prims++)
+				{
+					if (index != NULL)
+						DrawTriangle(vertex, index + *prims * 3);
+					else
+						DrawTriangle(vertex + *prims * 3, tmp_index);
+				}
+
+				break;
+
+			case GS_SPRITE_CLASS:
+
+				for (; prims < prims_end; prims++)
+				{
+					if (index != NULL)
+						DrawSprite(vertex, index + *prims * 2);
+					else
+						DrawSprite(vertex + *prims * 2, tmp_index);
+				}
+
+				break;
+
+			default:
+				__assume(0);
+		}
+
+		return;
+	}
 
 	switch (data->primclass)
 	{
@@ -241,7 +313,10 @@ void GSRasterizer::Draw(GSRasterizerData* data)
 		default:
 			__assume(0);
 	}
+}
 
+void GSRasterizer::EndDraw(GSRasterizerData* data)
+{
 #if _M_SSE >= 0x501
 	_mm256_zeroupper();
 #endif
@@ -1266,3 +1341,326 @@ int GSRasterizerList::GetPixels(bool reset)
 
 	return pixels;
 }
+
+void GSRasterizerList::Precompile(u64 key)
+{
+	for (size_t i = 0; i < m_r.size(); i++)
+	{
+		m_r[i]->Precompile(key);
+	}
+}
+
+//
+
+GSRasterizerBinned::GSRasterizerBinned(int threads, GSPerfMon* perfmon)
+	: m_perfmon(perfmon)
+	, m_filling(&m_batches[0])
+	, m_running(nullptr)
+{
+	for (Batch& batch : m_batches)
+	{
+		batch.draws.reserve(MAX_BATCH_DRAWS);
+		batch.ranges = std::make_unique<TileRange[]>(threads);
+	}
+
+	PerformanceMetrics::SetGSSWThreadCount(threads);
+}
+
+GSRasterizerBinned::~GSRasterizerBinned()
+{
+	PerformanceMetrics::SetGSSWThreadCount(0);
+}
+
+void GSRasterizerBinned::OnWorkerStartup(int i)
+{
+	Threading::SetNameOfCurrentThread(StringUtil::StdStringFromFormat("GS-SW-%d", i).c_str());
+	PerformanceMetrics::SetGSSWThreadTimer(i, Common::ThreadCPUTimer::GetForCallingThread());
+}
+
+void GSRasterizerBinned::OnWorkerShutdown(int i)
+{
+	PerformanceMetrics::SetGSSWThreadTimer(i, Common::ThreadCPUTimer());
+}
+
+void GSRasterizerBinned::Queue(const GSRingHeap::SharedPtr<GSRasterizerData>& data)
+{
+	GSVector4i r = data->bbox.rintersect(data->scissor);
+
+	ASSERT(r.top >= 0 && r.top < 2048 && r.bottom >= 0 && r.bottom < 2048);
+
+	if (r.rempty())
+		return;
+
+	int n;
+
+	switch (data->primclass)
+	{
+		case GS_POINT_CLASS: n = 1; break;
+		case GS_LINE_CLASS: n = 2; break;
+		case GS_TRIANGLE_CLASS: n = 3; break;
+		case GS_SPRITE_CLASS: n = 2; break;
+		default: __assume(0);
+	}
+
+	const int prims = (data->index != NULL ? data->index_count : data->vertex_count) / n;
+
+	if (prims == 0)
+		return;
+
+	Batch& batch = *m_filling;
+	const u32 draw = static_cast<u32>(batch.draws.size());
+	batch.draws.push_back(data);
+
+	// Right and bottom are inclusive here, an extra tile costs little and can never lose pixels
+	const int left = r.left >> TILE_WIDTH_SHIFT;
+	const int top = r.top >> TILE_HEIGHT_SHIFT;
+	const int right = std::min(r.right >> TILE_WIDTH_SHIFT, TILES_X - 1);
+	const int bottom = std::min(r.bottom >> TILE_HEIGHT_SHIFT, TILES_Y - 1);
+
+	if (left == right && top == bottom || prims >= (1 << 24))
+	{
+		// Nothing to sort if the whole draw is in one tile, and a bin header can't count that many primitives
+		for (int y = top; y <= bottom; y++)
+		{
+			for (int x = left; x <= right; x++)
+			{
+				AddToBin(batch, y * TILES_X + x, draw, ALL_PRIMS);
+			}
+		}
+	}
+	else
+	{
+		const GSVertexSW* RESTRICT vertex = data->vertex;
+		const u32* RESTRICT index = data->index;
+
+		for (int i = 0; i < prims; i++)
+		{
+			const u32 first = i * n;
+
+			GSVector4 pmin = vertex[index != NULL ? index[first] : first].p;
+			GSVector4 pmax = pmin;
+
+			for (int j = 1; j < n; j++)
+			{
+				const GSVector4& p = vertex[index != NULL ? index[first + j] : first + j].p;
+
+				pmin = pmin.min(p);
+				pmax = pmax.max(p);
+			}
+
+			// Rounded like the draw's bbox, so the primitive can't draw outside of it either
+			const GSVector4i b = GSVector4i(pmin.floor().xyxy(pmax.ceil()));
+
+			if (b.z < r.left || b.x >= r.right || b.w < r.top || b.y >= r.bottom)
+				continue;
+
+			const int prim_left = std::max(b.x, r.left) >> TILE_WIDTH_SHIFT;
+			const int prim_top = std::max(b.y, r.top) >> TILE_HEIGHT_SHIFT;
+			const int prim_right = std::min(b.z >> TILE_WIDTH_SHIFT, right);
+			const int prim_bottom = std::min(b.w >> TILE_HEIGHT_SHIFT, bottom);
+
+			for (int y = prim_top; y <= prim_bottom; y++)
+			{
+				for (int x = prim_left; x <= prim_right; x++)
+				{
+					AddToBin(batch, y * TILES_X + x, draw, i);
+				}
+			}
+		}
+	}
+
+	// Bigger batches bin better, but there's no point holding draws back from idle workers
+	if (batch.draws.size() >= MAX_BATCH_DRAWS || !IsRunning())
+		Dispatch();
+}
+
+void GSRasterizerBinned::AddToBin(Batch& batch, int tile, u32 draw, u32 prim)
+{
+	Bin& bin = batch.bins[tile];
+
+	if (bin.data.empty())
+	{
+		batch.tiles.push_back(static_cast<u16>(tile));
+	}
+	else if ((bin.data[bin.head] & 0xff) == draw)
+	{
+		// Another primitive of the draw this tile got last
+		bin.data[bin.head] += 1 << 8;
+		bin.data.push_back(prim);
+		return;
+	}
+
+	bin.head = bin.data.size();
+
+	if (prim == ALL_PRIMS)
+	{
+		bin.data.push_back(draw);
+	}
+	else
+	{
+		bin.data.push_back(draw | (1 << 8));
+		bin.data.push_back(prim);
+	}
+}
+
+void GSRasterizerBinned::Dispatch()
+{
+	Batch* batch = m_filling;
+	if (batch->draws.empty())
+		return;
+
+	// Only one batch is drawn at a time, which keeps every tile in queue order
+	WaitForRunning();
+
+	// Row order keeps a group's tiles next to each other
+	std::sort(batch->tiles.begin(), batch->tiles.end());
+
+	const int threads = static_cast<int>(m_workers.size());
+	const int count = static_cast<int>(batch->tiles.size());
+	for (int i = 0; i < threads; i++)
+	{
+		batch->ranges[i].next.store(count * i / threads, std::memory_order_relaxed);
+		batch->ranges[i].end = count * (i + 1) / threads;
+	}
+	batch->running.store(threads, std::memory_order_relaxed);
+
+	for (const std::unique_ptr<GSWorker>& worker : m_workers)
+		worker->Push(batch);
+
+	m_running = batch;
+	m_filling = (batch == &m_batches[0]) ? &m_batches[1] : &m_batches[0];
+}
+
+void GSRasterizerBinned::WaitForRunning()
+{
+	if (!m_running)
+		return;
+
+	for (const std::unique_ptr<GSWorker>& worker : m_workers)
+		worker->Wait();
+
+	for (u16 tile : m_running->tiles)
+		m_running->bins[tile].data.clear();
+	m_running->tiles.clear();
+	m_running->draws.clear();
+	m_running = nullptr;
+}
+
+bool GSRasterizerBinned::IsRunning() const
+{
+	for (const std::unique_ptr<GSWorker>& worker : m_workers)
+	{
+		if (!worker->IsEmpty())
+			return true;
+	}
+
+	return false;
+}
+
+void GSRasterizerBinned::DrawTiles(int i, Batch* batch)
+{
+	GSRasterizer& r = *m_r[i];
+	const int threads = static_cast<int>(m_workers.size());
+
+	for (int j = 0; j < threads; j++)
+	{
+		// Our own tiles first, then help out the others
+		TileRange& range = batch->ranges[(i + j) % threads];
+
+		for (int k = range.next.fetch_add(GROUP_TILES, std::memory_order_relaxed); k < range.end; k = range.next.fetch_add(GROUP_TILES, std::memory_order_relaxed))
+		{
+			DrawGroup(r, batch, &batch->tiles[k], std::min(GROUP_TILES, range.end - k));
+		}
+	}
+
+	// The last worker out releases the draws, so their pages are freed as soon as they would be with the list
+	if (batch->running.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		batch->draws.clear();
+}
+
+void GSRasterizerBinned::DrawGroup(GSRasterizer& r, Batch* batch, const u16* tiles, int count)
+{
+	const u32* pos[GROUP_TILES];
+	const u32* end[GROUP_TILES];
+	GSVector4i rect[GROUP_TILES];
+
+	for (int i = 0; i < count; i++)
+	{
+		const std::vector<u32>& bin = batch->bins[tiles[i]].data;
+		pos[i] = bin.data();
+		end[i] = bin.data() + bin.size();
+
+		const int x = (tiles[i] % TILES_X) << TILE_WIDTH_SHIFT;
+		const int y = (tiles[i] / TILES_X) << TILE_HEIGHT_SHIFT;
+		rect[i] = GSVector4i(x, y, x + (1 << TILE_WIDTH_SHIFT), y + (1 << TILE_HEIGHT_SHIFT));
+	}
+
+	while (true)
+	{
+		// Every bin lists its draws in queue order, so the lowest one left is next in all of them
+		u32 draw = MAX_BATCH_DRAWS;
+
+		for (int i = 0; i < count; i++)
+		{
+			if (pos[i] < end[i])
+				draw = std::min(draw, *pos[i] & 0xff);
+		}
+
+		if (draw == MAX_BATCH_DRAWS)
+			break;
+
+		GSRasterizerData* data = batch->draws[draw].get();
+
+		r.BeginDraw(data);
+
+		for (int i = 0; i < count; i++)
+		{
+			if (pos[i] < end[i] && (*pos[i] & 0xff) == draw)
+			{
+				const u32 prims = *pos[i] >> 8;
+
+				r.DrawPrims(data, data->scissor.rintersect(rect[i]), prims ? pos[i] + 1 : NULL, prims);
+
+				pos[i] += 1 + prims;
+			}
+		}
+
+		r.EndDraw(data);
+	}
+}
+
+void GSRasterizerBinned::Sync()
+{
+	if (!IsSynced())
+	{
+		Dispatch();
+		WaitForRunning();
+
+		m_perfmon->Put(GSPerfMon::SyncPoint, 1);
+	}
+}
+
+bool GSRasterizerBinned::IsSynced() const
+{
+	return m_filling->draws.empty() && !IsRunning();
+}
+
+int GSRasterizerBinned::GetPixels(bool reset)
+{
+	int pixels = 0;
+
+	for (size_t i = 0; i < m_r.size(); i++)
+	{
+		pixels += m_r[i]->GetPixels(reset);
+	}
+
+	return pixels;
+}
+
+void GSRasterizerBinned::Precompile(u64 key)
+{
+	for (size_t i = 0; i < m_r.size(); i++)
+	{
+		m_r[i]->Precompile(key);
+	}
+}
@@ -21,6 +21,7 @@
 #include "GS/GSPerfMon.h"
 #include "GS/GSThread_CXX11.h"
 #include "GS/GSRingHeap.h"
+#include <atomic>
 
 class alignas(32) GSRasterizerData : public GSAlignedClass<32>
 {
@@ -90,6 +91,8 @@ public:
 
 	virtual void BeginDraw(const GSRasterizerData* data) = 0;
 	virtual void EndDraw(u64 frame, u64 ticks, int actual, int total, int prims) = 0;
+	/// Generates the code for a selector ahead of the first draw that needs it, may be called from any thread
+	virtual void Precompile(u64 key) = 0;
 
 #ifdef ENABLE_JIT_RASTERIZER
 
@@ -123,6 +126,8 @@ public:
 	virtual bool IsSynced() const = 0;
 	virtual int GetPixels(bool reset = true) = 0;
 	virtual void PrintStats() = 0;
+	/// Generates the code for a scanline selector in every thread's drawer, may be called from any thread
+	virtual void Precompile(u64 key) = 0;
 };
 
 class alignas(32) GSRasterizer : public IRasterizer
@@ -174,6 +179,13 @@ public:
 
 	void Draw(GSRasterizerData* data);
 
+	/// Draw() in parts, for drawing pieces of a draw: BeginDraw(), any number of DrawPrims(), then EndDraw().
+	void BeginDraw(GSRasterizerData* data);
+	/// Draws the part inside scissor, which must be within the draw's own scissor, of the `count` primitives
+	/// numbered in `prims`, or of every primitive if `prims` is null.
+	void DrawPrims(GSRasterizerData* data, const GSVector4i& scissor, const u32* prims, int count);
+	void EndDraw(GSRasterizerData* data);
+
 	// IRasterizer
 
 	void Queue(const GSRingHeap::SharedPtr<GSRasterizerData>& data);
@@ -181,6 +193,7 @@ public:
 	bool IsSynced() const { return true; }
 	int GetPixels(bool reset);
 	void PrintStats() { m_ds->PrintStats(); }
+	void Precompile(u64 key) { m_ds->Precompile(key); }
 };
 
 class GSRasterizerList : public IRasterizer
@@ -235,4 +248,108 @@ public:
 	bool IsSynced() const;
 	int GetPixels(bool reset);
 	void PrintStats() {}
+	void Precompile(u64 key);
+};
+
+/// Sorts the primitives of the queued draws into screen tiles and hands them to the workers in
+/// batches. Each worker starts on its own share of the batch's tiles and takes groups of tiles from
+/// the others once it runs out. A tile is only ever drawn by one thread, in queue order, so the
+/// output doesn't depend on which thread drew what.
+class GSRasterizerBinned : public IRasterizer
+{
+protected:
+	static constexpr int TILE_WIDTH_SHIFT = 6;
+	static constexpr int TILE_HEIGHT_SHIFT = 5;
+	static constexpr int TILES_X = 2048 >> TILE_WIDTH_SHIFT;
+	static constexpr int TILES_Y = 2048 >> TILE_HEIGHT_SHIFT;
+
+	/// Draws collected before waiting for the workers, bins store the draw number in 8 bits.
+	static constexpr size_t MAX_BATCH_DRAWS = 256;
+	/// Tiles a worker takes at once. Each draw is only begun once per group, not once per tile.
+	static constexpr int GROUP_TILES = 4;
+	/// Bins all of a draw's primitives with a single entry.
+	static constexpr u32 ALL_PRIMS = 0xffffffff;
+
+	struct alignas(64) TileRange
+	{
+		std::atomic<int> next;
+		int end;
+	};
+
+	/// The primitives one tile has to draw, in queue order. Each draw touching the tile adds a
+	/// header, draw | (count << 8), followed by the numbers of its `count` primitives. A count of 0
+	/// means all of them.
+	struct Bin
+	{
+		std::vector<u32> data;
+		size_t head;
+	};
+
+	struct Batch
+	{
+		std::vector<GSRingHeap::SharedPtr<GSRasterizerData>> draws;
+		Bin bins[TILES_X * TILES_Y];
+		std::vector<u16> tiles;
+		std::unique_ptr<TileRange[]> ranges;
+		std::atomic<int> running{0};
+	};
+
+	using GSWorker = GSJobQueue<Batch*, 4>;
+
+	GSPerfMon* m_perfmon;
+	Batch m_batches[2];
+	Batch* m_filling;
+	Batch* m_running;
+	// Worker threads depend on the rasterizers, so don't change the order.
+	std::vector<std::unique_ptr<GSRasterizer>> m_r;
+	std::vector<std::unique_ptr<GSWorker>> m_workers;
+
+	GSRasterizerBinned(int threads, GSPerfMon* perfmon);
+
+	void OnWorkerStartup(int i);
+	void OnWorkerShutdown(int i);
+
+	void AddToBin(Batch& batch, int tile, u32 draw, u32 prim);
+	void Dispatch();
+	void WaitForRunning();
+	bool IsRunning() const;
+	void DrawTiles(int i, Batch* batch);
+	void DrawGroup(GSRasterizer& r, Batch* batch, const u16* tiles, int count);
+
+public:
+	virtual ~GSRasterizerBinned();
+
+	template <class DS>
+	static IRasterizer* Create(int threads, GSPerfMon* perfmon)
+	{
+		threads = std::max<int>(threads, 0);
+
+		if (threads == 0)
+		{
+			return new GSRasterizer(new DS(), 0, 1, perfmon);
+		}
+
+		GSRasterizerBinned* rl = new GSRasterizerBinned(threads, perfmon);
+
+		for (int i = 0; i < threads; i++)
+		{
+			// Tiles already split the work, so every rasterizer owns every scanline
+			rl->m_r.push_back(std::unique_ptr<GSRasterizer>(new GSRasterizer(new DS(), 0, 1, perfmon)));
+			rl->m_workers.push_back(std::unique_ptr<GSWorker>(new GSWorker(
+				[rl, i]() { rl->OnWorkerStartup(i); },
+				[rl, i](Batch*& batch) { rl->DrawTiles(i, batch); },
+				[rl, i]() { rl->OnWorkerShutdown(i); })));
+		}
+
+		return rl;
+	}
+
+	// IRasterizer
+
+	void Queue(const GSRingHeap::SharedPtr<GSRasterizerData>& data);
+	void Sync();
+	bool IsSynced() const;
+	int GetPixels(bool reset);
+	void PrintStats() {}
+	void Precompile(u64 key);
 };
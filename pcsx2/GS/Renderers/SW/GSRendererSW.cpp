@@ -16,6 +16,16 @@
 #include "PrecompiledHeader.h"
 #include "GSRendererSW.h"
 #include "GS/GSGL.h"
+#include "common/FileSystem.h"
+#include "common/Path.h"
+#include "common/PersistentThread.h"
+#include "common/StringUtil.h"
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 #define LOG 0
 
@@ -26,8 +36,25 @@ CONSTINIT const GSVector4 GSRendererSW::m_pos_scale = GSVector4::cxpr(1.0f / 16,
 CONSTINIT const GSVector8 GSRendererSW::m_pos_scale2 = GSVector8::cxpr(1.0f / 16, 1.0f / 16, 1.0f, 128.0f, 1.0f / 16, 1.0f / 16, 1.0f, 128.0f);
 #endif
 
+static constexpr u32 JIT_KEYS_MAGIC = 0x4A575350; // PSWJ
+static constexpr u32 JIT_KEYS_VERSION = 1;
+// More than any game should reach, keeps a corrupt file from precompiling forever
+static constexpr size_t MAX_JIT_KEYS = 4096;
+
+struct JitKeysHeader
+{
+	u32 magic;
+	u32 version;
+	u32 count;
+};
+
+static std::string GetJitKeysPath(u32 crc)
+{
+	return Path::CombineStdString(EmuFolders::Cache, StringUtil::StdStringFromFormat("%08X.swjit", crc));
+}
+
 GSRendererSW::GSRendererSW(int threads)
-	: GSRenderer(), m_fzb(NULL)
+	: GSRenderer(), m_fzb(NULL), m_jit_keys_crc(0), m_jit_keys_dirty(false), m_precompile_cancel(false)
 {
 	m_nativeres = true; // ignore ini, sw is always native
 
@@ -35,7 +62,10 @@ GSRendererSW::GSRendererSW(int threads)
 
 	memset(m_texture, 0, sizeof(m_texture));
 
-	m_rl = GSRasterizerList::Create<GSDrawScanline>(threads, &g_perfmon);
+	if (GSConfig.SWTileBinning)
+		m_rl = GSRasterizerBinned::Create<GSDrawScanline>(threads, &g_perfmon);
+	else
+		m_rl = GSRasterizerList::Create<GSDrawScanline>(threads, &g_perfmon);
 
 	m_output = (u8*)_aligned_malloc(1024 * 1024 * sizeof(u32), 32);
 
@@ -62,6 +92,9 @@ GSRendererSW::GSRendererSW(int threads)
 
 GSRendererSW::~GSRendererSW()
 {
+	StopPrecompile();
+	SaveJitKeys();
+
 	// Need to destroy worker queue first to stop any pending thread work
 	delete m_rl;
 	delete m_tc;
@@ -83,6 +116,101 @@ void GSRendererSW::Reset()
 	GSRenderer::Reset();
 }
 
+void GSRendererSW::SetGameCRC(u32 crc, int options)
+{
+	GSRenderer::SetGameCRC(crc, options);
+
+	// Reopening the GS sets the same CRC again
+	if (crc == m_jit_keys_crc)
+		return;
+
+	StopPrecompile();
+	SaveJitKeys();
+	LoadJitKeys(crc);
+}
+
+void GSRendererSW::LoadJitKeys(u32 crc)
+{
+	m_jit_keys.clear();
+	m_jit_keys_crc = crc;
+	m_jit_keys_dirty = false;
+
+	if (crc == 0)
+		return;
+
+	std::optional<std::vector<u8>> data = FileSystem::ReadBinaryFile(GetJitKeysPath(crc).c_str());
+	if (!data.has_value() || data->size() < sizeof(JitKeysHeader))
+		return;
+
+	JitKeysHeader header;
+	std::memcpy(&header, data->data(), sizeof(header));
+	if (header.magic != JIT_KEYS_MAGIC || header.version != JIT_KEYS_VERSION || header.count > MAX_JIT_KEYS ||
+		data->size() != sizeof(header) + header.count * sizeof(u64))
+	{
+		Console.Warning("(GSRendererSW) Ignoring invalid JIT key cache for %08X", crc);
+		return;
+	}
+
+	std::vector<u64> keys(header.count);
+	std::memcpy(keys.data(), data->data() + sizeof(header), header.count * sizeof(u64));
+	m_jit_keys.insert(keys.begin(), keys.end());
+
+	DevCon.WriteLn("(GSRendererSW) Precompiling %zu scanline functions for %08X", keys.size(), crc);
+
+	m_precompile_cancel.store(false, std::memory_order_relaxed);
+	m_precompile_thread = std::thread([this, keys = std::move(keys)]() {
+		Threading::SetNameOfCurrentThread("GS-SW-JIT");
+
+		// Draws compile whatever they need themselves, this only has to beat them to it with spare time.
+		// It's only niced rather than idle, so a busy system can't starve it indefinitely.
+#ifdef _WIN32
+		SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+#elif defined(__linux__)
+		// Nice values are per thread on Linux
+		setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+#endif
+
+		for (u64 key : keys)
+		{
+			if (m_precompile_cancel.load(std::memory_order_relaxed))
+				break;
+
+			m_rl->Precompile(key);
+		}
+	});
+}
+
+void GSRendererSW::SaveJitKeys()
+{
+	if (!m_jit_keys_dirty || m_jit_keys_crc == 0)
+		return;
+
+	m_jit_keys_dirty = false;
+
+	const JitKeysHeader header = {JIT_KEYS_MAGIC, JIT_KEYS_VERSION, static_cast<u32>(m_jit_keys.size())};
+	std::vector<u8> data(sizeof(header) + m_jit_keys.size() * sizeof(u64));
+	std::memcpy(data.data(), &header, sizeof(header));
+
+	u8* ptr = data.data() + sizeof(header);
+	for (u64 key : m_jit_keys)
+	{
+		std::memcpy(ptr, &key, sizeof(key));
+		ptr += sizeof(key);
+	}
+
+	if (!FileSystem::WriteBinaryFile(GetJitKeysPath(m_jit_keys_crc).c_str(), data.data(), data.size()))
+		Console.Warning("(GSRendererSW) Failed to save JIT key cache for %08X", m_jit_keys_crc);
+}
+
+void GSRendererSW::StopPrecompile()
+{
+	if (!m_precompile_thread.joinable())
+		return;
+
+	m_precompile_cancel.store(true, std::memory_order_relaxed);
+	m_precompile_thread.join();
+}
+
 void GSRendererSW::VSync(u32 field, bool registers_written)
 {
 	Sync(0); // IncAge might delete a cached texture in use
@@ -120,6 +248,9 @@ void GSRendererSW::VSync(u32 field, bool registers_written)
 	//
 	*/
 
+	g_perfmon.Put(GSPerfMon::JitCompiles, g_codegen_stats.compiles.exchange(0, std::memory_order_relaxed));
+	g_perfmon.Put(GSPerfMon::JitCompileTime, Common::Timer::ConvertValueToMilliseconds(g_codegen_stats.ticks.exchange(0, std::memory_order_relaxed)));
+
 	GSRenderer::VSync(field, registers_written);
 
 	m_tc->IncAge();
@@ -146,7 +277,7 @@ GSTexture* GSRendererSW::GetOutput(int i, int& y_offset)
 
 		const GSLocalMemory::psm_t& psm = GSLocalMemory::m_psm[DISPFB.PSM];
 
-		(m_mem.*psm.rtx)(m_mem.GetOffset(DISPFB.Block(), DISPFB.FBW, DISPFB.PSM), r.ralign<Align_Outside>(psm.bs), m_output, pitch, m_env.TEXA);
+		psm.rtx(m_mem, m_mem.GetOffset(DISPFB.Block(), DISPFB.FBW, DISPFB.PSM), r.ralign<Align_Outside>(psm.bs), m_output, pitch, m_env.TEXA);
 
 		m_texture[i]->Update(r, m_output, pitch);
 
@@ -332,6 +463,8 @@ void GSRendererSW::Draw()
 			// Dump vertices
 			s = format("%05d_vertex.txt", s_n);
 			DumpVertices(m_dump_root + s);
+			s = format("%05d_vertex.bin", s_n);
+			DumpVertexCapture(m_dump_root + s);
 		}
 	}
 
@@ -379,6 +512,9 @@ void GSRendererSW::Draw()
 		return;
 	}
 
+	if (m_jit_keys_crc != 0 && m_jit_keys.size() < MAX_JIT_KEYS && m_jit_keys.insert(sd->global.sel.key).second)
+		m_jit_keys_dirty = true;
+
 	if (0) if (LOG)
 	{
 		int n = GSUtil::GetVertexCount(PRIM->PRIM);
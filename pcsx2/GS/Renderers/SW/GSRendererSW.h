@@ -18,6 +18,8 @@
 #include "GSTextureCacheSW.h"
 #include "GSDrawScanline.h"
 #include "GS/GSRingHeap.h"
+#include <thread>
+#include <unordered_set>
 
 class GSRendererSW : public GSRenderer
 {
@@ -79,7 +81,19 @@ protected:
 	std::atomic<u32> m_fzb_pages[512]; // u16 frame/zbuf pages interleaved
 	std::atomic<u16> m_tex_pages[512];
 
+	// Scanline selectors drawn with by the current game, saved so they can be precompiled on its next boot
+	std::unordered_set<u64> m_jit_keys;
+	u32 m_jit_keys_crc;
+	bool m_jit_keys_dirty;
+	std::thread m_precompile_thread;
+	std::atomic_bool m_precompile_cancel;
+
+	void LoadJitKeys(u32 crc);
+	void SaveJitKeys();
+	void StopPrecompile();
+
 	void Reset() override;
+	void SetGameCRC(u32 crc, int options) override;
 	void VSync(u32 field, bool registers_written) override;
 	GSTexture* GetOutput(int i, int& y_offset) override;
 	GSTexture* GetFeedbackOutput() override;
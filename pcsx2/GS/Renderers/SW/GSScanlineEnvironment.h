@@ -239,6 +239,11 @@ struct GSScanlineConstantData : public GSAlignedClass<32>
 	alignas(16) float m_shift_128b[5][4];
 	alignas(16) float m_log2_coef_128b[4][4];
 
+	/// pext selectors taking one bit per pixel out of the ymm fzm mask, [0] for the frame, [1] for z
+	u32 m_fzm_pixel_bits[2];
+	/// pdep selector spreading the 8 pixel bits to the dword lanes of the masked stores
+	u32 m_fzm_pair_bits;
+
 	GSScanlineConstantData() {}
 
 	// GCC will be clever enough to stick some AVX instruction here
@@ -316,6 +321,10 @@ struct GSScanlineConstantData : public GSAlignedClass<32>
 				m_log2_coef_256b[n][i + 4] = log2_coef[n];
 			}
 		}
+
+		m_fzm_pixel_bits[0] = 0x00550055;
+		m_fzm_pixel_bits[1] = 0x55005500;
+		m_fzm_pair_bits = 0x3333;
 	}
 };
 
@@ -249,7 +249,7 @@ bool GSTextureCacheSW::Texture::Update(const GSVector4i& rect)
 				{
 					m_valid[row] |= col;
 
-					(mem.*rtxbP)(block, &dst[bn.blkX() << shift], pitch, m_TEXA);
+					rtxbP(mem, block, &dst[bn.blkX() << shift], pitch, m_TEXA);
 
 					blocks++;
 				}
@@ -271,7 +271,7 @@ bool GSTextureCacheSW::Texture::Update(const GSVector4i& rect)
 				{
 					m_valid[row] |= col;
 
-					(mem.*rtxbP)(block, &dst[bn.blkX() << shift], pitch, m_TEXA);
+					rtxbP(mem, block, &dst[bn.blkX() << shift], pitch, m_TEXA);
 
 					blocks++;
 				}
@@ -123,6 +123,10 @@ const char* dialog_message(int ID, bool* updateText)
 				"If you have 4 threads on your CPU pick 2 or 3.\n"
 				"You can calculate how to get the best performance (amount of CPU threads - 2)\n"
 				"Note: 7+ threads will not give much more performance and could perhaps even lower it.");
+		case IDC_SWTHREADS_BINNING:
+			return cvtString("Sorts primitives into screen tiles and lets idle rendering threads take tiles from busy ones,\n"
+				"instead of giving each thread every other band of scanlines.\n"
+				"Scales better with many threads in scenes made of lots of small triangles.");
 		case IDC_MIPMAP_SW:
 			return cvtString("Enables mipmapping, which some games require to render correctly.");
 		case IDC_SHADEBOOST:
@@ -305,6 +305,7 @@ RendererTab::RendererTab(wxWindow* parent)
 	m_ui.addCheckBox(sw_checks_box, "Auto Flush",              "autoflush_sw", IDC_AUTO_FLUSH_SW, sw_prereq);
 	m_ui.addCheckBox(sw_checks_box, "Edge Antialiasing (Del)", "aa1",          IDC_AA1,           sw_prereq);
 	m_ui.addCheckBox(sw_checks_box, "Mipmapping",              "mipmap",       IDC_MIPMAP_SW,     sw_prereq);
+	m_ui.addCheckBox(sw_checks_box, "Tile Binning",            "extrathreads_binning", IDC_SWTHREADS_BINNING, sw_prereq);
 
 	software_box->Add(sw_checks_box, wxSizerFlags().Centre());
 	software_box->AddSpacer(space);
@@ -559,6 +560,7 @@ DebugTab::DebugTab(wxWindow* parent)
 
 		m_ui.addSpinAndLabel(dump_grid, "Start of Dump:",  "saven", 0, pow(10, 9),    0);
 		m_ui.addSpinAndLabel(dump_grid, "Length of Dump:", "savel", 1, pow(10, 5), 5000);
+		m_ui.addComboBoxAndLabel(dump_grid, "GS Dump Compression:", "GSDumpCompression", &theApp.m_gs_dump_compression);
 
 		debug_box->AddSpacer(space);
 		debug_box->Add(dump_grid);
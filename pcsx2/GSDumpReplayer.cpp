@@ -41,6 +41,8 @@ static u32 s_current_packet = 0;
 static u32 s_dump_frame_number = 0;
 static bool s_dump_running = false;
 static bool s_needs_state_loaded = false;
+static s32 s_loop_count = 0;
+static s32 s_loops_remaining = 0;
 static u64 s_frame_ticks = 0;
 static u64 s_next_frame_time = 0;
 
@@ -68,17 +70,18 @@ bool GSDumpReplayer::IsReplayingDump()
 bool GSDumpReplayer::Initialize(const char* filename)
 {
 	Common::Timer timer;
-	Console.WriteLn("(GSDumpReplayer) Reading file...");
+	Console.WriteLn("(GSDumpReplayer) Opening file...");
 
+	// Packets are decoded as they're played, so huge dumps start straight away and don't have to fit in memory
 	s_dump_file = GSDumpFile::OpenGSDump(filename);
-	if (!s_dump_file || !s_dump_file->ReadFile())
+	if (!s_dump_file || !s_dump_file->BeginStreaming())
 	{
 		Host::ReportFormattedErrorAsync("GSDumpReplayer", "Failed to open or read '%s'.", filename);
 		s_dump_file.reset();
 		return false;
 	}
 
-	Console.WriteLn("(GSDumpReplayer) Read file in %.2f ms.", timer.GetTimeMilliseconds());
+	Console.WriteLn("(GSDumpReplayer) Opened file in %.2f ms.", timer.GetTimeMilliseconds());
 
 	// We replace all CPUs.
 	Cpu = &GSDumpReplayerCpu;
@@ -105,6 +108,12 @@ void GSDumpReplayer::Shutdown()
 	s_dump_file.reset();
 }
 
+void GSDumpReplayer::SetLoopCount(s32 loops)
+{
+	s_loop_count = loops;
+	s_loops_remaining = loops;
+}
+
 std::string GSDumpReplayer::GetDumpSerial()
 {
 	std::string ret;
@@ -144,6 +153,8 @@ void GSDumpReplayerCpuReset()
 	s_needs_state_loaded = true;
 	s_current_packet = 0;
 	s_dump_frame_number = 0;
+	s_loops_remaining = s_loop_count;
+	s_dump_file->SeekToFrame(0);
 }
 
 static void GSDumpReplayerLoadInitialState()
@@ -210,10 +221,30 @@ void GSDumpReplayerCpuStep()
 		s_needs_state_loaded = false;
 	}
 
-	const GSDumpFile::GSData& packet = s_dump_file->GetPackets()[s_current_packet];
-	s_current_packet = (s_current_packet + 1) % static_cast<u32>(s_dump_file->GetPackets().size());
-	if (s_current_packet == 0)
+	GSDumpFile::GSData packet;
+	bool wrapped;
+	if (!s_dump_file->GetNextStreamPacket(&packet, &wrapped))
+	{
+		Host::ReportFormattedErrorAsync("GSDumpReplayer", "Failed to read packet %u of the dump.", s_current_packet);
+		VMManager::SetPaused(true);
+		GSDumpReplayerCpuCheckExecutionState();
+		return;
+	}
+
+	if (wrapped)
+	{
+		// Everything before this packet has been sent, the VM shutdown waits for the GS to finish it
+		if (s_loops_remaining > 0 && --s_loops_remaining == 0)
+		{
+			VMManager::SetState(VMState::Stopping);
+			GSDumpReplayerCpuCheckExecutionState();
+			return;
+		}
+
+		s_current_packet = 0;
 		s_dump_frame_number = 0;
+	}
+	s_current_packet++;
 
 	switch (packet.id)
 	{
@@ -335,7 +366,7 @@ void GSDumpReplayer::RenderUI()
 	DRAW_LINE(font, text.c_str(), IM_COL32(255, 255, 255, 255));
 
 	text.Clear();
-	text.Write("Packet Number: %u/%u", s_current_packet, static_cast<u32>(s_dump_file->GetPackets().size()));
+	text.Write("Packet Number: %u", s_current_packet);
 	DRAW_LINE(font, text.c_str(), IM_COL32(255, 255, 255, 255));
 
 #undef DRAW_LINE
@@ -8,6 +8,9 @@ bool Initialize(const char* filename);
 void Reset();
 void Shutdown();
 
+/// Stops the VM after the dump has been played this many times, zero plays it until stopped.
+void SetLoopCount(s32 loops);
+
 std::string GetDumpSerial();
 u32 GetDumpCRC();
 
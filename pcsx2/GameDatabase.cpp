@@ -20,6 +20,7 @@
 #include "Patch.h"
 
 #include "common/FileSystem.h"
+#include "common/MappedFile.h"
 #include "common/Path.h"
 #include "common/StringUtil.h"
 #include "common/Timer.h"
@@ -29,6 +30,8 @@
 #include "ryml.hpp"
 #include "fmt/core.h"
 #include "fmt/ranges.h"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <mutex>
 #include <optional>
@@ -44,13 +47,246 @@ namespace GameDatabase
 {
 	static void parseAndInsert(const std::string_view& serial, const c4::yml::NodeRef& node);
 	static void initDatabase();
+
+	static u64 getSchemaHash();
+	static bool loadCompiledDatabase(std::time_t yaml_timestamp);
+	static void compileDatabase(std::time_t yaml_timestamp);
+	static const GameDatabaseSchema::GameEntry* findCompiledGame(const std::string& serial);
 } // namespace GameDatabase
 
 static constexpr char GAMEDB_YAML_FILE_NAME[] = "GameIndex.yaml";
+static constexpr char GAMEDB_COMPILED_FILE_NAME[] = "gamedb.cache";
+
+static constexpr u32 GAMEDB_COMPILED_SIGNATURE = 0x42444750; // PGDB
+static constexpr u32 GAMEDB_COMPILED_VERSION = 1;
+
+// Parsing the YAML takes a while, so it's compiled into a file in the cache folder which is mapped
+// on later runs.  The file is a header, an index sorted by serial, and a blob holding the serials
+// and the serialized entries.  Entries are only deserialized when they're looked up.
+struct CompiledHeader
+{
+	u32 signature;
+	u32 version;
+	// Enum values are stored as numbers, so the file is only good for the build that wrote it
+	u64 schema_hash;
+	s64 source_timestamp;
+	u32 num_games;
+	u32 blob_size;
+	u64 index_offset;
+	u64 blob_offset;
+};
 
+struct CompiledIndexEntry
+{
+	u32 serial_offset;
+	u32 serial_length;
+	u32 entry_offset;
+	u32 entry_size;
+};
+
+// Games from the YAML when it was parsed this run, otherwise the ones looked up so far
 static std::unordered_map<std::string, GameDatabaseSchema::GameEntry> s_game_db;
+static std::mutex s_game_db_mutex;
 static std::once_flag s_load_once_flag;
 
+static Common::MappedFile s_compiled_file;
+static const CompiledIndexEntry* s_compiled_index = nullptr;
+static const u8* s_compiled_blob = nullptr;
+static u32 s_compiled_num_games = 0;
+static u32 s_compiled_blob_size = 0;
+
+namespace
+{
+	class BlobWriter
+	{
+	public:
+		std::vector<u8>& data() { return m_data; }
+
+		void writeU32(u32 value) { write(&value, sizeof(value)); }
+		void writeS32(s32 value) { write(&value, sizeof(value)); }
+
+		void writeString(const std::string& str)
+		{
+			writeU32(static_cast<u32>(str.size()));
+			write(str.data(), str.size());
+		}
+
+	private:
+		void write(const void* src, size_t size)
+		{
+			const u8* bytes = static_cast<const u8*>(src);
+			m_data.insert(m_data.end(), bytes, bytes + size);
+		}
+
+		std::vector<u8> m_data;
+	};
+
+	class BlobReader
+	{
+	public:
+		BlobReader(const u8* data, size_t size)
+			: m_data(data)
+			, m_size(size)
+		{
+		}
+
+		bool readU32(u32* value) { return read(value, sizeof(*value)); }
+		bool readS32(s32* value) { return read(value, sizeof(*value)); }
+
+		bool readString(std::string* str)
+		{
+			u32 length;
+			if (!readU32(&length) || length > m_size - m_pos)
+				return false;
+
+			str->assign(reinterpret_cast<const char*>(m_data + m_pos), length);
+			m_pos += length;
+			return true;
+		}
+
+		// Keeps a corrupted count from making us allocate the world
+		bool readCount(u32* count, size_t min_item_size)
+		{
+			return readU32(count) && static_cast<u64>(*count) * min_item_size <= m_size - m_pos;
+		}
+
+	private:
+		bool read(void* dst, size_t size)
+		{
+			if (size > m_size - m_pos)
+				return false;
+
+			std::memcpy(dst, m_data + m_pos, size);
+			m_pos += size;
+			return true;
+		}
+
+		const u8* m_data;
+		size_t m_size;
+		size_t m_pos = 0;
+	};
+} // namespace
+
+static void serializeEntry(const GameDatabaseSchema::GameEntry& entry, BlobWriter& writer)
+{
+	writer.writeString(entry.name);
+	writer.writeString(entry.region);
+	writer.writeS32(static_cast<s32>(entry.compat));
+	writer.writeS32(static_cast<s32>(entry.eeRoundMode));
+	writer.writeS32(static_cast<s32>(entry.vuRoundMode));
+	writer.writeS32(static_cast<s32>(entry.eeClampMode));
+	writer.writeS32(static_cast<s32>(entry.vuClampMode));
+
+	writer.writeU32(static_cast<u32>(entry.gameFixes.size()));
+	for (const GamefixId id : entry.gameFixes)
+		writer.writeS32(static_cast<s32>(id));
+
+	writer.writeU32(static_cast<u32>(entry.speedHacks.size()));
+	for (const auto& [id, value] : entry.speedHacks)
+	{
+		writer.writeS32(static_cast<s32>(id));
+		writer.writeS32(value);
+	}
+
+	writer.writeU32(static_cast<u32>(entry.gsHWFixes.size()));
+	for (const auto& [id, value] : entry.gsHWFixes)
+	{
+		writer.writeU32(static_cast<u32>(id));
+		writer.writeS32(value);
+	}
+
+	writer.writeU32(static_cast<u32>(entry.memcardFilters.size()));
+	for (const std::string& filter : entry.memcardFilters)
+		writer.writeString(filter);
+
+	writer.writeU32(static_cast<u32>(entry.patches.size()));
+	for (const auto& [crc, patch] : entry.patches)
+	{
+		writer.writeString(crc);
+		writer.writeU32(static_cast<u32>(patch.size()));
+		for (const std::string& line : patch)
+			writer.writeString(line);
+	}
+}
+
+static bool deserializeEntry(BlobReader& reader, GameDatabaseSchema::GameEntry* entry)
+{
+	s32 compat, eeRoundMode, vuRoundMode, eeClampMode, vuClampMode;
+	if (!reader.readString(&entry->name) || !reader.readString(&entry->region) || !reader.readS32(&compat) ||
+		!reader.readS32(&eeRoundMode) || !reader.readS32(&vuRoundMode) || !reader.readS32(&eeClampMode) ||
+		!reader.readS32(&vuClampMode))
+	{
+		return false;
+	}
+
+	entry->compat = static_cast<GameDatabaseSchema::Compatibility>(compat);
+	entry->eeRoundMode = static_cast<GameDatabaseSchema::RoundMode>(eeRoundMode);
+	entry->vuRoundMode = static_cast<GameDatabaseSchema::RoundMode>(vuRoundMode);
+	entry->eeClampMode = static_cast<GameDatabaseSchema::ClampMode>(eeClampMode);
+	entry->vuClampMode = static_cast<GameDatabaseSchema::ClampMode>(vuClampMode);
+
+	u32 count;
+	if (!reader.readCount(&count, sizeof(s32)))
+		return false;
+	for (u32 i = 0; i < count; i++)
+	{
+		s32 id;
+		if (!reader.readS32(&id) || id < 0 || id >= GamefixId_COUNT)
+			return false;
+		entry->gameFixes.push_back(static_cast<GamefixId>(id));
+	}
+
+	if (!reader.readCount(&count, sizeof(s32) * 2))
+		return false;
+	for (u32 i = 0; i < count; i++)
+	{
+		s32 id, value;
+		if (!reader.readS32(&id) || !reader.readS32(&value) || id < 0 || id >= SpeedhackId_COUNT)
+			return false;
+		entry->speedHacks.emplace_back(static_cast<SpeedhackId>(id), value);
+	}
+
+	if (!reader.readCount(&count, sizeof(u32) + sizeof(s32)))
+		return false;
+	for (u32 i = 0; i < count; i++)
+	{
+		u32 id;
+		s32 value;
+		if (!reader.readU32(&id) || !reader.readS32(&value) || id >= static_cast<u32>(GameDatabaseSchema::GSHWFixId::Count))
+			return false;
+		entry->gsHWFixes.emplace_back(static_cast<GameDatabaseSchema::GSHWFixId>(id), value);
+	}
+
+	if (!reader.readCount(&count, sizeof(u32)))
+		return false;
+	entry->memcardFilters.resize(count);
+	for (std::string& filter : entry->memcardFilters)
+	{
+		if (!reader.readString(&filter))
+			return false;
+	}
+
+	if (!reader.readCount(&count, sizeof(u32) * 2))
+		return false;
+	for (u32 i = 0; i < count; i++)
+	{
+		std::string crc;
+		u32 lines;
+		if (!reader.readString(&crc) || !reader.readCount(&lines, sizeof(u32)))
+			return false;
+
+		GameDatabaseSchema::Patch& patch = entry->patches[std::move(crc)];
+		patch.resize(lines);
+		for (std::string& line : patch)
+		{
+			if (!reader.readString(&line))
+				return false;
+		}
+	}
+
+	return true;
+}
+
 std::string GameDatabaseSchema::GameEntry::memcardFiltersAsString() const
 {
 	return fmt::to_string(fmt::join(memcardFilters, "/"));
@@ -502,13 +738,169 @@ void GameDatabase::initDatabase()
 	ryml::reset_callbacks();
 }
 
+u64 GameDatabase::getSchemaHash()
+{
+	// FNV-1a over the names of everything which is stored by value
+	u64 hash = 0xCBF29CE484222325ULL;
+	auto add = [&hash](const char* name) {
+		for (; *name; name++)
+		{
+			hash ^= static_cast<u8>(*name);
+			hash *= 0x100000001B3ULL;
+		}
+		// Separate the names, so moving a character from one to the next changes the hash
+		hash ^= 0xFF;
+		hash *= 0x100000001B3ULL;
+	};
+
+	for (GamefixId id = GamefixId_FIRST; id < pxEnumEnd; id++)
+		add(EnumToString(id));
+	for (SpeedhackId id = SpeedhackId_FIRST; id < pxEnumEnd; id++)
+		add(EnumToString(id));
+	for (const char* name : s_gs_hw_fix_names)
+		add(name);
+
+	return hash;
+}
+
+bool GameDatabase::loadCompiledDatabase(std::time_t yaml_timestamp)
+{
+	const std::string path(Path::CombineStdString(EmuFolders::Cache, GAMEDB_COMPILED_FILE_NAME));
+	if (!FileSystem::FileExists(path.c_str()) || !s_compiled_file.Open(path.c_str()))
+		return false;
+
+	const u8* data = s_compiled_file.GetData();
+	const size_t size = s_compiled_file.GetSize();
+	CompiledHeader header;
+	if (size < sizeof(header))
+	{
+		s_compiled_file.Close();
+		return false;
+	}
+
+	std::memcpy(&header, data, sizeof(header));
+	if (header.signature != GAMEDB_COMPILED_SIGNATURE || header.version != GAMEDB_COMPILED_VERSION ||
+		header.schema_hash != getSchemaHash() || header.source_timestamp != static_cast<s64>(yaml_timestamp))
+	{
+		DevCon.WriteLn("[GameDB] Compiled GameDB is out of date");
+		s_compiled_file.Close();
+		return false;
+	}
+
+	const u64 index_size = static_cast<u64>(header.num_games) * sizeof(CompiledIndexEntry);
+	if ((header.index_offset % alignof(CompiledIndexEntry)) != 0 || header.index_offset < sizeof(header) ||
+		header.index_offset > size || index_size > size - header.index_offset ||
+		header.blob_offset < sizeof(header) || header.blob_offset > size || header.blob_size > size - header.blob_offset)
+	{
+		Console.Warning("[GameDB] Compiled GameDB is corrupted");
+		s_compiled_file.Close();
+		return false;
+	}
+
+	s_compiled_index = reinterpret_cast<const CompiledIndexEntry*>(data + header.index_offset);
+	s_compiled_blob = data + header.blob_offset;
+	s_compiled_num_games = header.num_games;
+	s_compiled_blob_size = header.blob_size;
+	return true;
+}
+
+void GameDatabase::compileDatabase(std::time_t yaml_timestamp)
+{
+	std::vector<const std::pair<const std::string, GameDatabaseSchema::GameEntry>*> games;
+	games.reserve(s_game_db.size());
+	for (const auto& it : s_game_db)
+		games.push_back(&it);
+	std::sort(games.begin(), games.end(), [](const auto* lhs, const auto* rhs) { return lhs->first < rhs->first; });
+
+	std::vector<CompiledIndexEntry> index;
+	index.reserve(games.size());
+	BlobWriter blob;
+	for (const auto* game : games)
+	{
+		CompiledIndexEntry ie;
+		ie.serial_offset = static_cast<u32>(blob.data().size());
+		ie.serial_length = static_cast<u32>(game->first.size());
+		blob.data().insert(blob.data().end(), game->first.begin(), game->first.end());
+		ie.entry_offset = static_cast<u32>(blob.data().size());
+		serializeEntry(game->second, blob);
+		ie.entry_size = static_cast<u32>(blob.data().size()) - ie.entry_offset;
+		index.push_back(ie);
+	}
+
+	CompiledHeader header = {};
+	header.signature = GAMEDB_COMPILED_SIGNATURE;
+	header.version = GAMEDB_COMPILED_VERSION;
+	header.schema_hash = getSchemaHash();
+	header.source_timestamp = static_cast<s64>(yaml_timestamp);
+	header.num_games = static_cast<u32>(index.size());
+	header.blob_size = static_cast<u32>(blob.data().size());
+	header.index_offset = sizeof(header);
+	header.blob_offset = header.index_offset + index.size() * sizeof(CompiledIndexEntry);
+
+	std::vector<u8> data(static_cast<size_t>(header.blob_offset + header.blob_size));
+	std::memcpy(data.data(), &header, sizeof(header));
+	std::memcpy(data.data() + header.index_offset, index.data(), index.size() * sizeof(CompiledIndexEntry));
+	std::memcpy(data.data() + header.blob_offset, blob.data().data(), blob.data().size());
+
+	// Another instance could be reading the old one, so replace it rather than writing over it
+	const std::string path(Path::CombineStdString(EmuFolders::Cache, GAMEDB_COMPILED_FILE_NAME));
+	const std::string temp_path(path + ".tmp");
+	if (!FileSystem::WriteBinaryFile(temp_path.c_str(), data.data(), data.size()) ||
+		!FileSystem::RenamePath(temp_path.c_str(), path.c_str()))
+	{
+		Console.Warning("[GameDB] Failed to write compiled GameDB to '%s'", path.c_str());
+		FileSystem::DeleteFilePath(temp_path.c_str());
+		return;
+	}
+
+	DevCon.WriteLn("[GameDB] Wrote compiled GameDB (%zu bytes)", data.size());
+}
+
+const GameDatabaseSchema::GameEntry* GameDatabase::findCompiledGame(const std::string& serial)
+{
+	const CompiledIndexEntry* end = s_compiled_index + s_compiled_num_games;
+	const auto getSerial = [](const CompiledIndexEntry& ie) {
+		if (static_cast<u64>(ie.serial_offset) + ie.serial_length > s_compiled_blob_size)
+			return std::string_view();
+		return std::string_view(reinterpret_cast<const char*>(s_compiled_blob + ie.serial_offset), ie.serial_length);
+	};
+
+	const CompiledIndexEntry* it = std::lower_bound(s_compiled_index, end, serial,
+		[&getSerial](const CompiledIndexEntry& ie, const std::string& value) { return getSerial(ie) < value; });
+	if (it == end || getSerial(*it) != serial)
+		return nullptr;
+
+	if (static_cast<u64>(it->entry_offset) + it->entry_size > s_compiled_blob_size)
+		return nullptr;
+
+	GameDatabaseSchema::GameEntry entry;
+	BlobReader reader(s_compiled_blob + it->entry_offset, it->entry_size);
+	if (!deserializeEntry(reader, &entry))
+	{
+		Console.Error(fmt::format("[GameDB] Compiled entry for '{}' is corrupted", serial));
+		return nullptr;
+	}
+
+	return &s_game_db.emplace(serial, std::move(entry)).first->second;
+}
+
 void GameDatabase::ensureLoaded()
 {
 	std::call_once(s_load_once_flag, []() {
 		Common::Timer timer;
+		const std::optional<std::time_t> yaml_timestamp(Host::GetResourceFileTimestamp(GAMEDB_YAML_FILE_NAME));
+		if (yaml_timestamp.has_value() && loadCompiledDatabase(yaml_timestamp.value()))
+		{
+			Console.WriteLn("[GameDB] %u games on record (mapped in %.2fms)", s_compiled_num_games, timer.GetTimeMilliseconds());
+			return;
+		}
+
 		Console.WriteLn(fmt::format("[GameDB] Has not been initialized yet, initializing..."));
 		initDatabase();
 		Console.WriteLn("[GameDB] %zu games on record (loaded in %.2fms)", s_game_db.size(), timer.GetTimeMilliseconds());
+
+		if (yaml_timestamp.has_value() && !s_game_db.empty())
+			compileDatabase(yaml_timestamp.value());
 	});
 }
 
@@ -518,6 +910,9 @@ const GameDatabaseSchema::GameEntry* GameDatabase::findGame(const std::string_vi
 
 	std::string serialLower = StringUtil::toLower(serial);
 	Console.WriteLn(fmt::format("[GameDB] Searching for '{}' in GameDB", serialLower));
+
+	// The game list looks games up from several threads
+	std::unique_lock lock(s_game_db_mutex);
 	const auto gameEntry = s_game_db.find(serialLower);
 	if (gameEntry != s_game_db.end())
 	{
@@ -525,6 +920,15 @@ const GameDatabaseSchema::GameEntry* GameDatabase::findGame(const std::string_vi
 		return &gameEntry->second;
 	}
 
+	if (s_compiled_file.IsOpen())
+	{
+		if (const GameDatabaseSchema::GameEntry* compiledEntry = findCompiledGame(serialLower))
+		{
+			Console.WriteLn(fmt::format("[GameDB] Found '{}' in GameDB", serialLower));
+			return compiledEntry;
+		}
+	}
+
 	Console.Error(fmt::format("[GameDB] Could not find '{}' in GameDB", serialLower));
 	return nullptr;
 }
@@ -17,6 +17,12 @@
 #include "AsyncFileReader.h"
 #include "common/FileSystem.h"
 
+#ifdef USE_IO_URING
+// Requests larger than this are split so the kernel can work on the pieces in parallel
+static constexpr u32 URING_READ_SPLIT = 64 * 1024;
+static constexpr uint URING_QUEUE_DEPTH = 32;
+#endif
+
 FlatFileReader::FlatFileReader(bool shareWrite)
 	: shareWrite(shareWrite)
 {
@@ -34,13 +40,27 @@ bool FlatFileReader::Open(std::string fileName)
 {
 	m_filename = std::move(fileName);
 
+	m_fd = FileSystem::OpenFDFile(m_filename.c_str(), O_RDONLY, 0);
+	if (m_fd == -1)
+		return false;
+
+#ifdef USE_IO_URING
+	// Older kernels (or seccomp profiles) don't allow io_uring, libaio still works there
+	if (m_uring.Open(m_fd, URING_QUEUE_DEPTH))
+		return true;
+
+	DevCon.WriteLn("FlatFileReader: io_uring unavailable, using libaio");
+#endif
+
 	int err = io_setup(64, &m_aio_context);
 	if (err)
+	{
+		close(m_fd);
+		m_fd = -1;
 		return false;
+	}
 
-	m_fd = FileSystem::OpenFDFile(m_filename.c_str(), O_RDONLY, 0);
-
-	return (m_fd != -1);
+	return true;
 }
 
 int FlatFileReader::ReadSync(void* pBuffer, uint sector, uint count)
@@ -56,6 +76,27 @@ void FlatFileReader::BeginRead(void* pBuffer, uint sector, uint count)
 
 	u32 bytesToRead = count * m_blocksize;
 
+#ifdef USE_IO_URING
+	if (m_uring.IsOpen())
+	{
+		u8* dst = static_cast<u8*>(pBuffer);
+		while (bytesToRead > 0)
+		{
+			const u32 size = std::min(bytesToRead, URING_READ_SPLIT);
+			if (!m_uring.QueueRead(dst, size, offset))
+				break;
+
+			dst += size;
+			offset += size;
+			bytesToRead -= size;
+		}
+
+		// A short queue shows up as a short read in FinishRead
+		m_uring.Submit();
+		return;
+	}
+#endif
+
 	struct iocb iocb;
 	struct iocb* iocbs = &iocb;
 
@@ -65,6 +106,11 @@ void FlatFileReader::BeginRead(void* pBuffer, uint sector, uint count)
 
 int FlatFileReader::FinishRead(void)
 {
+#ifdef USE_IO_URING
+	if (m_uring.IsOpen())
+		return m_uring.WaitAll();
+#endif
+
 	int min_nr = 1;
 	int max_nr = 1;
 	struct io_event events[max_nr];
@@ -78,6 +124,15 @@ int FlatFileReader::FinishRead(void)
 
 void FlatFileReader::CancelRead(void)
 {
+#ifdef USE_IO_URING
+	// The reads target the caller's buffer, so they have to finish before it can be reused
+	if (m_uring.IsOpen())
+	{
+		m_uring.WaitAll();
+		return;
+	}
+#endif
+
 	// Will be done when m_aio_context context is destroyed
 	// Note: io_cancel exists but need the iocb structure as parameter
 	// int io_cancel(aio_context_t ctx_id, struct iocb *iocb,
@@ -86,11 +141,15 @@ void FlatFileReader::CancelRead(void)
 
 void FlatFileReader::Close(void)
 {
+#ifdef USE_IO_URING
+	m_uring.Close();
+#endif
 
 	if (m_fd != -1)
 		close(m_fd);
 
-	io_destroy(m_aio_context);
+	if (m_aio_context)
+		io_destroy(m_aio_context);
 
 	m_fd = -1;
 	m_aio_context = 0;
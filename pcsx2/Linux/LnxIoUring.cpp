@@ -0,0 +1,150 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "LnxIoUring.h"
+
+#ifdef USE_IO_URING
+
+#include <liburing.h>
+
+IoUringQueue::IoUringQueue()
+	: m_ring(nullptr)
+	, m_fd(-1)
+	, m_fixedFile(false)
+	, m_fixedBuffer(nullptr)
+	, m_fixedBufferSize(0)
+	, m_pending(0)
+{
+}
+
+IoUringQueue::~IoUringQueue()
+{
+	Close();
+}
+
+bool IoUringQueue::Open(int fd, uint entries)
+{
+	Close();
+
+	m_ring = new io_uring;
+	if (io_uring_queue_init(entries, m_ring, 0) < 0)
+	{
+		delete m_ring;
+		m_ring = nullptr;
+		return false;
+	}
+
+	// Registering the file saves a file table lookup on every read
+	m_fixedFile = (io_uring_register_files(m_ring, &fd, 1) == 0);
+	m_fd = m_fixedFile ? 0 : fd;
+	return true;
+}
+
+void IoUringQueue::Close()
+{
+	if (!m_ring)
+		return;
+
+	// The reads target the caller's buffers, they can't be abandoned
+	WaitAll();
+
+	io_uring_queue_exit(m_ring);
+	delete m_ring;
+	m_ring = nullptr;
+	m_fd = -1;
+	m_fixedFile = false;
+	m_fixedBuffer = nullptr;
+	m_fixedBufferSize = 0;
+}
+
+void IoUringQueue::RegisterBuffer(void* buffer, size_t size)
+{
+	if (!m_ring || m_fixedBuffer)
+		return;
+
+	iovec iov = {buffer, size};
+	// Can fail if RLIMIT_MEMLOCK is too low, plain reads still work
+	if (io_uring_register_buffers(m_ring, &iov, 1) == 0)
+	{
+		m_fixedBuffer = static_cast<u8*>(buffer);
+		m_fixedBufferSize = size;
+	}
+}
+
+bool IoUringQueue::QueueRead(void* dst, u32 size, u64 offset)
+{
+	io_uring_sqe* sqe = io_uring_get_sqe(m_ring);
+	if (!sqe)
+	{
+		if (!Submit() || !(sqe = io_uring_get_sqe(m_ring)))
+			return false;
+	}
+
+	u8* target = static_cast<u8*>(dst);
+	if (m_fixedBuffer && target >= m_fixedBuffer && target + size <= m_fixedBuffer + m_fixedBufferSize)
+		io_uring_prep_read_fixed(sqe, m_fd, dst, size, offset, 0);
+	else
+		io_uring_prep_read(sqe, m_fd, dst, size, offset);
+
+	if (m_fixedFile)
+		io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+
+	m_pending++;
+	return true;
+}
+
+bool IoUringQueue::Submit()
+{
+	return io_uring_submit(m_ring) >= 0;
+}
+
+int IoUringQueue::WaitAll()
+{
+	int total = 0;
+	bool failed = false;
+
+	if (m_pending > 0 && !Submit())
+	{
+		m_pending = 0;
+		return -1;
+	}
+
+	while (m_pending > 0)
+	{
+		io_uring_cqe* cqe;
+		int ret = io_uring_wait_cqe(m_ring, &cqe);
+		if (ret == -EINTR)
+			continue;
+		if (ret < 0)
+		{
+			// Nothing more is coming back, don't wait for it forever
+			m_pending = 0;
+			return -1;
+		}
+
+		if (cqe->res < 0)
+			failed = true;
+		else
+			total += cqe->res;
+
+		io_uring_cqe_seen(m_ring, cqe);
+		m_pending--;
+	}
+
+	return failed ? -1 : total;
+}
+
+#endif
@@ -0,0 +1,58 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifdef USE_IO_URING
+
+struct io_uring;
+
+// Keeps several reads of one file in flight through io_uring.
+// Used by the Linux file readers, which fall back to their old path if Open() fails.
+// Uncompressed images normally go through MappedFileReader instead, FlatFileReader (and so
+// this) is used for them when CdvdMapImages is off, when CdvdShareWrite is on, when the
+// image can't be mapped, and for the extra parts of multi-part images.
+class IoUringQueue
+{
+	DeclareNoncopyableObject(IoUringQueue);
+
+	io_uring* m_ring;
+	int m_fd;
+	bool m_fixedFile;
+	u8* m_fixedBuffer;
+	size_t m_fixedBufferSize;
+	uint m_pending;
+
+public:
+	IoUringQueue();
+	~IoUringQueue();
+
+	// Returns false if io_uring isn't available on this kernel
+	bool Open(int fd, uint entries);
+	void Close();
+	bool IsOpen() const { return m_ring != nullptr; }
+
+	// Pins a buffer reads will usually target, so the kernel doesn't have to map it on every read
+	void RegisterBuffer(void* buffer, size_t size);
+
+	// Queues a read, submitting what's already queued if the submission queue is full
+	bool QueueRead(void* dst, u32 size, u64 offset);
+	// Starts everything queued
+	bool Submit();
+	// Waits for every submitted read, returns the number of bytes read or -1 on error
+	int WaitAll();
+};
+
+#endif
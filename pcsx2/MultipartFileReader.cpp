@@ -242,3 +242,9 @@ void MultipartFileReader::SetBlockSize(uint bytes)
 	}
 }
 
+void MultipartFileReader::RegisterReadBuffer(void* buffer, size_t size)
+{
+	for(uint i=0;i<m_numparts;i++)
+		m_parts[i].reader->RegisterReadBuffer(buffer, size);
+}
+
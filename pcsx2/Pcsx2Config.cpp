@@ -310,6 +310,7 @@ Pcsx2Config::GSOptions::GSOptions()
 	GPUPaletteConversion = false;
 	ConservativeFramebuffer = true;
 	AutoFlushSW = true;
+	SWTileBinning = false;
 	PreloadFrameWithGSData = false;
 	WrapGSMem = false;
 	Mipmap = true;
@@ -382,6 +383,7 @@ bool Pcsx2Config::GSOptions::OptionsAreEqual(const GSOptions& right) const
 		OpEqu(CRCHack) &&
 		OpEqu(TextureFiltering) &&
 		OpEqu(TexturePreloading) &&
+		OpEqu(GSDumpCompression) &&
 		OpEqu(Dithering) &&
 		OpEqu(MaxAnisotropy) &&
 		OpEqu(SWExtraThreads) &&
@@ -512,6 +514,7 @@ void Pcsx2Config::GSOptions::ReloadIniSettings()
 	GSSettingBoolEx(GPUPaletteConversion, "paltex");
 	GSSettingBoolEx(ConservativeFramebuffer, "conservative_framebuffer");
 	GSSettingBoolEx(AutoFlushSW, "autoflush_sw");
+	GSSettingBoolEx(SWTileBinning, "extrathreads_binning");
 	GSSettingBoolEx(PreloadFrameWithGSData, "preload_frame_with_gs_data");
 	GSSettingBoolEx(WrapGSMem, "wrap_gs_mem");
 	GSSettingBoolEx(Mipmap, "mipmap");
@@ -553,6 +556,7 @@ void Pcsx2Config::GSOptions::ReloadIniSettings()
 	GSSettingIntEnumEx(CRCHack, "crc_hack_level");
 	GSSettingIntEnumEx(TextureFiltering, "filter");
 	GSSettingIntEnumEx(TexturePreloading, "texture_preloading");
+	GSSettingIntEnumEx(GSDumpCompression, "GSDumpCompression");
 	GSSettingIntEx(Dithering, "dithering_ps2");
 	GSSettingIntEx(MaxAnisotropy, "MaxAnisotropy");
 	GSSettingIntEx(SWExtraThreads, "extrathreads");
@@ -1005,6 +1009,7 @@ Pcsx2Config::Pcsx2Config()
 	McdFolderAutoManage = true;
 	EnablePatches = true;
 	BackupSavestate = true;
+	CdvdMapImages = true;
 
 #ifdef __WXMSW__
 	McdCompressNTFS = true;
@@ -1021,6 +1026,9 @@ Pcsx2Config::Pcsx2Config()
 	}
 
 	GzipIsoIndexTemplate = "$(f).pindex.tmp";
+	CdvdDecompressThreads = 0;
+	CdvdChdCacheSize = 64;
+	CdvdChdPrefetchHunks = 0;
 }
 
 void Pcsx2Config::LoadSave(SettingsWrapper& wrap)
@@ -1030,6 +1038,8 @@ void Pcsx2Config::LoadSave(SettingsWrapper& wrap)
 	SettingsWrapBitBool(CdvdVerboseReads);
 	SettingsWrapBitBool(CdvdDumpBlocks);
 	SettingsWrapBitBool(CdvdShareWrite);
+	SettingsWrapBitBool(CdvdMapImages);
+	SettingsWrapBitBool(CdvdBootPrefetch);
 	SettingsWrapBitBool(EnablePatches);
 	SettingsWrapBitBool(EnableCheats);
 	SettingsWrapBitBool(EnablePINE);
@@ -1063,6 +1073,9 @@ void Pcsx2Config::LoadSave(SettingsWrapper& wrap)
 	Trace.LoadSave(wrap);
 
 	SettingsWrapEntry(GzipIsoIndexTemplate);
+	SettingsWrapEntry(CdvdDecompressThreads);
+	SettingsWrapEntry(CdvdChdCacheSize);
+	SettingsWrapEntry(CdvdChdPrefetchHunks);
 
 	// For now, this in the derived config for backwards ini compatibility.
 #ifdef PCSX2_CORE
@@ -1138,7 +1151,10 @@ bool Pcsx2Config::operator==(const Pcsx2Config& right) const
 		OpEqu(Framerate) &&
 		OpEqu(Trace) &&
 		OpEqu(BaseFilenames) &&
-		OpEqu(GzipIsoIndexTemplate);
+		OpEqu(GzipIsoIndexTemplate) &&
+		OpEqu(CdvdDecompressThreads) &&
+		OpEqu(CdvdChdCacheSize) &&
+		OpEqu(CdvdChdPrefetchHunks);
 	for (u32 i = 0; i < sizeof(Mcd) / sizeof(Mcd[0]); i++)
 	{
 		equal &= OpEqu(Mcd[i].Enabled);
@@ -1169,10 +1185,15 @@ void Pcsx2Config::CopyConfig(const Pcsx2Config& cfg)
 	}
 
 	GzipIsoIndexTemplate = cfg.GzipIsoIndexTemplate;
+	CdvdDecompressThreads = cfg.CdvdDecompressThreads;
+	CdvdChdCacheSize = cfg.CdvdChdCacheSize;
+	CdvdChdPrefetchHunks = cfg.CdvdChdPrefetchHunks;
 
 	CdvdVerboseReads = cfg.CdvdVerboseReads;
 	CdvdDumpBlocks = cfg.CdvdDumpBlocks;
 	CdvdShareWrite = cfg.CdvdShareWrite;
+	CdvdMapImages = cfg.CdvdMapImages;
+	CdvdBootPrefetch = cfg.CdvdBootPrefetch;
 	EnablePatches = cfg.EnablePatches;
 	EnableCheats = cfg.EnableCheats;
 	EnablePINE = cfg.EnablePINE;
@@ -15,6 +15,8 @@
 
 #include "PrecompiledHeader.h"
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <vector>
 
@@ -71,6 +73,14 @@ static float s_accumulated_gpu_time = 0.0f;
 static float s_gpu_usage = 0.0f;
 static u32 s_presents_since_last_update = 0;
 
+// CDVD readahead, counted by the ISO reader threads
+static std::array<std::atomic<u32>, static_cast<size_t>(PerformanceMetrics::CDVDAccessPattern::Count)> s_cdvd_patterns_since_last_update = {};
+static std::atomic<u32> s_cdvd_reads_since_last_update{0};
+static std::atomic<u32> s_cdvd_prefetched_since_last_update{0};
+static u32 s_cdvd_reads = 0;
+static float s_cdvd_prefetch_hit_rate = 0.0f;
+static PerformanceMetrics::CDVDAccessPattern s_cdvd_access_pattern = PerformanceMetrics::CDVDAccessPattern::Unknown;
+
 void PerformanceMetrics::Clear()
 {
 	Reset();
@@ -91,6 +101,10 @@ void PerformanceMetrics::Clear()
 	s_average_gpu_time = 0.0f;
 	s_gpu_usage = 0.0f;
 
+	s_cdvd_reads = 0;
+	s_cdvd_prefetch_hit_rate = 0.0f;
+	s_cdvd_access_pattern = CDVDAccessPattern::Unknown;
+
 	s_frame_number = 0;
 }
 
@@ -105,6 +119,11 @@ void PerformanceMetrics::Reset()
 	s_accumulated_gpu_time = 0.0f;
 	s_presents_since_last_update = 0;
 
+	for (std::atomic<u32>& count : s_cdvd_patterns_since_last_update)
+		count.store(0, std::memory_order_relaxed);
+	s_cdvd_reads_since_last_update.store(0, std::memory_order_relaxed);
+	s_cdvd_prefetched_since_last_update.store(0, std::memory_order_relaxed);
+
 	s_last_update_time.Reset();
 	s_last_frame_time.Reset();
 
@@ -159,6 +178,21 @@ void PerformanceMetrics::Update(bool gs_register_write, bool fb_blit)
 	s_gs_privileged_register_writes_since_last_update = 0;
 	s_gs_framebuffer_blits_since_last_update = 0;
 
+	s_cdvd_reads = s_cdvd_reads_since_last_update.exchange(0, std::memory_order_relaxed);
+	const u32 cdvd_prefetched = s_cdvd_prefetched_since_last_update.exchange(0, std::memory_order_relaxed);
+	s_cdvd_prefetch_hit_rate = s_cdvd_reads ? (static_cast<float>(cdvd_prefetched) * 100.0f / static_cast<float>(s_cdvd_reads)) : 0.0f;
+	u32 cdvd_most_common = 0;
+	s_cdvd_access_pattern = CDVDAccessPattern::Unknown;
+	for (size_t i = 0; i < s_cdvd_patterns_since_last_update.size(); i++)
+	{
+		const u32 count = s_cdvd_patterns_since_last_update[i].exchange(0, std::memory_order_relaxed);
+		if (count > cdvd_most_common)
+		{
+			cdvd_most_common = count;
+			s_cdvd_access_pattern = static_cast<CDVDAccessPattern>(i);
+		}
+	}
+
 	s_cpu_thread_timer.GetUsageInMillisecondsAndReset(ticks_diff, &s_cpu_thread_time, &s_cpu_thread_usage);
 	s_cpu_thread_time /= static_cast<double>(s_frames_since_last_update);
 
@@ -223,6 +257,18 @@ void PerformanceMetrics::SetVerticalFrequency(float rate)
 	s_vertical_frequency = rate;
 }
 
+void PerformanceMetrics::OnCDVDReadahead(CDVDAccessPattern pattern)
+{
+	s_cdvd_patterns_since_last_update[static_cast<size_t>(pattern)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void PerformanceMetrics::OnCDVDRead(bool prefetched)
+{
+	s_cdvd_reads_since_last_update.fetch_add(1, std::memory_order_relaxed);
+	if (prefetched)
+		s_cdvd_prefetched_since_last_update.fetch_add(1, std::memory_order_relaxed);
+}
+
 u64 PerformanceMetrics::GetFrameNumber()
 {
 	return s_frame_number;
@@ -317,3 +363,34 @@ float PerformanceMetrics::GetGPUAverageTime()
 {
 	return s_average_gpu_time;
 }
+
+u32 PerformanceMetrics::GetCDVDReadCount()
+{
+	return s_cdvd_reads;
+}
+
+float PerformanceMetrics::GetCDVDPrefetchHitRate()
+{
+	return s_cdvd_prefetch_hit_rate;
+}
+
+PerformanceMetrics::CDVDAccessPattern PerformanceMetrics::GetCDVDAccessPattern()
+{
+	return s_cdvd_access_pattern;
+}
+
+const char* PerformanceMetrics::GetCDVDAccessPatternName(CDVDAccessPattern pattern)
+{
+	switch (pattern)
+	{
+		case CDVDAccessPattern::Sequential:
+			return "Sequential";
+		case CDVDAccessPattern::Strided:
+			return "Strided";
+		case CDVDAccessPattern::Random:
+			return "Random";
+		case CDVDAccessPattern::Unknown:
+		default:
+			return "Unknown";
+	}
+}
@@ -25,6 +25,15 @@ namespace PerformanceMetrics
 		DISPFBBlit
 	};
 
+	enum class CDVDAccessPattern
+	{
+		Unknown,
+		Sequential,
+		Strided,
+		Random,
+		Count
+	};
+
 	void Clear();
 	void Reset();
 	void Update(bool gs_register_write, bool fb_blit);
@@ -40,6 +49,11 @@ namespace PerformanceMetrics
 	/// Sets the vertical frequency, used in speed calculations.
 	void SetVerticalFrequency(float rate);
 
+	/// Records the access pattern the ISO readahead picked for a request. Can be called from any thread.
+	void OnCDVDReadahead(CDVDAccessPattern pattern);
+	/// Records a disc read, and whether it was served entirely from readahead. Can be called from any thread.
+	void OnCDVDRead(bool prefetched);
+
 	u64 GetFrameNumber();
 
 	InternalFPSMethod GetInternalFPSMethod();
@@ -64,4 +78,11 @@ namespace PerformanceMetrics
 
 	float GetGPUUsage();
 	float GetGPUAverageTime();
+
+	/// Disc reads in the last update interval, the other CDVD stats are meaningless when this is zero.
+	u32 GetCDVDReadCount();
+	float GetCDVDPrefetchHitRate();
+	/// Most common readahead decision in the last update interval.
+	CDVDAccessPattern GetCDVDAccessPattern();
+	const char* GetCDVDAccessPatternName(CDVDAccessPattern pattern);
 } // namespace PerformanceMetrics
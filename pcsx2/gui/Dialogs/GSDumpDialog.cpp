@@ -212,10 +212,12 @@ void Dialogs::GSDumpDialog::GetDumpsList()
 			dumps.push_back(filename.substr(0, filename.length() - 3));
 		else if (filename.EndsWith(".gs.xz"))
 			dumps.push_back(filename.substr(0, filename.length() - 6));
+		else if (filename.EndsWith(".gs.zst"))
+			dumps.push_back(filename.substr(0, filename.length() - 7));
 		cont = snaps.GetNext(&filename);
 	}
 	std::sort(dumps.begin(), dumps.end(), [](const wxString& a, const wxString& b) { return a.CmpNoCase(b) < 0; });
-	dumps.erase(std::unique(dumps.begin(), dumps.end()), dumps.end()); // In case there was both .gs and .gs.xz
+	dumps.erase(std::unique(dumps.begin(), dumps.end()), dumps.end()); // In case there was more than one of .gs, .gs.xz and .gs.zst
 	for (size_t i = 0; i < dumps.size(); i++)
 		m_dump_list->InsertItem(i, dumps[i]);
 }
@@ -239,6 +241,8 @@ void Dialogs::GSDumpDialog::SelectedDump(wxListEvent& evt)
 	wxString filename = g_Conf->Folders.Snapshots.ToAscii() + ("/" + evt.GetText()) + ".gs";
 	if (!wxFileExists(filename))
 		filename.append(".xz");
+	if (!wxFileExists(filename))
+		filename = filename.BeforeLast('.') + ".zst";
 	if (wxFileExists(filename_preview))
 	{
 		auto img = wxImage(filename_preview);
@@ -0,0 +1,396 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Generates a synthetic ISO, compresses it to every format we can write, and times the image
+// readers on sequential, strided and random access.  Every sector read is checked against the
+// generator, so with --quick this doubles as a test of the readers.
+
+#include "PrecompiledHeader.h"
+#include "AsyncFileReader.h"
+#include "CDVD/ChdFileReader.h"
+#include "CDVD/CsoFileReader.h"
+#include "CDVD/CsoWriter.h"
+#include "CDVD/GzippedFileReader.h"
+
+#include "common/FileSystem.h"
+#include "common/Path.h"
+#include "common/StringUtil.h"
+#include "common/Timer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#ifdef __POSIX__
+#include <zlib.h>
+#else
+#include <zlib/zlib.h>
+#endif
+
+static constexpr u32 SECTOR_SIZE = 2048;
+
+struct BenchOptions
+{
+	u32 sizeMb = 256;
+	u32 sectorsPerRead = 16;
+	u32 decompressThreads = 0;
+	u32 chdCacheMb = 0;
+	bool chd = false;
+	bool keep = false;
+	std::string dir = ".";
+};
+
+enum class Pattern
+{
+	Sequential,
+	Strided,
+	Random,
+};
+
+static const char* PatternName(Pattern pattern)
+{
+	switch (pattern)
+	{
+		case Pattern::Sequential: return "sequential";
+		case Pattern::Strided:    return "strided";
+		case Pattern::Random:     return "random";
+	}
+	return "";
+}
+
+// Roughly game-like data: one sector in five doesn't compress at all, the rest compress well.
+// Sector 16 is a primary volume descriptor so the gzip reader can guess the size up front.
+static void FillSector(u8* dst, u32 lsn, u32 blocks)
+{
+	u32* words = reinterpret_cast<u32*>(dst);
+	if (lsn % 5 == 0)
+	{
+		u32 x = lsn * 2654435761u + 1;
+		for (u32 i = 0; i < SECTOR_SIZE / 4; i++)
+		{
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+			words[i] = x;
+		}
+	}
+	else
+	{
+		for (u32 i = 0; i < SECTOR_SIZE / 4; i++)
+			words[i] = ((lsn + i / 16) * 0x01010101u) & 0x0F0F0F0Fu;
+	}
+	words[0] = lsn;
+
+	if (lsn == 16)
+	{
+		dst[0] = 1;
+		std::memcpy(dst + 1, "CD001", 5);
+		std::memcpy(dst + 80, &blocks, sizeof(blocks));
+	}
+}
+
+static bool WriteIso(const std::string& path, u32 blocks)
+{
+	auto fp = FileSystem::OpenManagedCFile(path.c_str(), "wb");
+	if (!fp)
+		return false;
+
+	std::vector<u8> buffer(SECTOR_SIZE * 512);
+	for (u32 lsn = 0; lsn < blocks; lsn += 512)
+	{
+		const u32 count = std::min(512u, blocks - lsn);
+		for (u32 i = 0; i < count; i++)
+			FillSector(&buffer[i * SECTOR_SIZE], lsn + i, blocks);
+		if (std::fwrite(buffer.data(), SECTOR_SIZE, count, fp.get()) != count)
+			return false;
+	}
+	return true;
+}
+
+static bool WriteGzip(const std::string& isoPath, const std::string& path)
+{
+	auto src = FileSystem::OpenManagedCFile(isoPath.c_str(), "rb");
+	gzFile dst = gzopen(path.c_str(), "wb6");
+	if (!src || !dst)
+	{
+		if (dst)
+			gzclose(dst);
+		return false;
+	}
+
+	std::vector<u8> buffer(1024 * 1024);
+	size_t read;
+	bool ok = true;
+	while (ok && (read = std::fread(buffer.data(), 1, buffer.size(), src.get())) > 0)
+		ok = gzwrite(dst, buffer.data(), static_cast<unsigned>(read)) == static_cast<int>(read);
+	return gzclose(dst) == Z_OK && ok;
+}
+
+// libchdr can't write CHDs, so this needs chdman from MAME on the path
+static bool WriteChd(const std::string& isoPath, const std::string& path)
+{
+	const std::string command = StringUtil::StdStringFromFormat("chdman createdvd -f -i \"%s\" -o \"%s\"", isoPath.c_str(), path.c_str());
+	return std::system(command.c_str()) == 0 && FileSystem::FileExists(path.c_str());
+}
+
+struct ReaderType
+{
+	const char* name;
+	std::string path;
+	std::function<std::unique_ptr<AsyncFileReader>()> create;
+};
+
+struct Result
+{
+	double mbPerSec;
+	double p50Us;
+	double p99Us;
+	u32 mismatches;
+};
+
+static bool RunPattern(const ReaderType& type, Pattern pattern, u32 blocks, u32 reads, const BenchOptions& options, Result* result)
+{
+	std::unique_ptr<AsyncFileReader> reader = type.create();
+	if (!reader->Open(type.path))
+	{
+		std::fprintf(stderr, "%s: failed to open %s\n", type.name, type.path.c_str());
+		return false;
+	}
+	if (reader->GetBlockCount() != blocks)
+	{
+		std::fprintf(stderr, "%s: %u blocks, expected %u\n", type.name, reader->GetBlockCount(), blocks);
+		return false;
+	}
+
+	const u32 count = options.sectorsPerRead;
+	std::vector<u8> buffer(count * SECTOR_SIZE);
+	std::vector<u8> expected(SECTOR_SIZE);
+	std::vector<double> latencies;
+	latencies.reserve(reads);
+	std::mt19937 rng(12345);
+	u32 lsn = 0;
+	u32 mismatches = 0;
+
+	Common::Timer total;
+	for (u32 i = 0; i < reads; i++)
+	{
+		Common::Timer timer;
+		reader->BeginRead(buffer.data(), lsn, count);
+		const int res = reader->FinishRead();
+		latencies.push_back(timer.GetTimeNanoseconds() / 1000.0);
+
+		for (u32 j = 0; j < count; j++)
+		{
+			FillSector(expected.data(), lsn + j, blocks);
+			if (res <= 0 || std::memcmp(&buffer[j * SECTOR_SIZE], expected.data(), SECTOR_SIZE) != 0)
+			{
+				if (mismatches++ == 0)
+					std::fprintf(stderr, "%s: %s read of sector %u returned the wrong data\n", type.name, PatternName(pattern), lsn + j);
+			}
+		}
+
+		switch (pattern)
+		{
+			case Pattern::Sequential:
+				lsn += count;
+				break;
+			// Like streaming two files at once, which defeats simple readahead
+			case Pattern::Strided:
+				lsn += count * 8;
+				break;
+			case Pattern::Random:
+				lsn = rng() % (blocks - count + 1);
+				break;
+		}
+		if (lsn + count > blocks)
+			lsn = (lsn + count) % (blocks - count + 1);
+	}
+	const double seconds = total.GetTimeSeconds();
+	reader->Close();
+
+	std::sort(latencies.begin(), latencies.end());
+	result->mbPerSec = (static_cast<double>(reads) * count * SECTOR_SIZE / (1024.0 * 1024.0)) / seconds;
+	result->p50Us = latencies[latencies.size() / 2];
+	result->p99Us = latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)];
+	result->mismatches = mismatches;
+	return true;
+}
+
+static void Usage()
+{
+	std::fprintf(stderr,
+		"Usage: cdvd_reader_bench [options]\n"
+		"  --quick          small image, for checking the readers rather than timing them\n"
+		"  --size MB        size of the generated image (default 256)\n"
+		"  --sectors N      sectors per read (default 16)\n"
+		"  --threads N      decompression threads for compressed readers (default 0)\n"
+		"  --chd            also test CHD, made with chdman\n"
+		"  --chd-cache MB   CHD hunk cache size (default 0)\n"
+		"  --dir PATH       where to put the images (default .)\n"
+		"  --keep           don't delete the images afterwards\n"
+		"  --verbose        show reader log output\n");
+}
+
+int main(int argc, char** argv)
+{
+	BenchOptions options;
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if (std::strcmp(arg, "--quick") == 0)
+			options.sizeMb = 16;
+		else if (std::strcmp(arg, "--size") == 0 && hasValue)
+			options.sizeMb = std::max(1, std::atoi(argv[++i]));
+		else if (std::strcmp(arg, "--sectors") == 0 && hasValue)
+			options.sectorsPerRead = std::clamp(std::atoi(argv[++i]), 1, 256);
+		else if (std::strcmp(arg, "--threads") == 0 && hasValue)
+			options.decompressThreads = std::max(0, std::atoi(argv[++i]));
+		else if (std::strcmp(arg, "--chd") == 0)
+			options.chd = true;
+		else if (std::strcmp(arg, "--chd-cache") == 0 && hasValue)
+			options.chdCacheMb = std::max(0, std::atoi(argv[++i]));
+		else if (std::strcmp(arg, "--dir") == 0 && hasValue)
+			options.dir = argv[++i];
+		else if (std::strcmp(arg, "--keep") == 0)
+			options.keep = true;
+		else if (std::strcmp(arg, "--verbose") == 0)
+		{
+			Console_SetActiveHandler(ConsoleWriter_Stdout);
+			DevConWriterEnabled = true;
+		}
+		else
+		{
+			Usage();
+			return 1;
+		}
+	}
+
+	const u32 blocks = static_cast<u32>((static_cast<u64>(options.sizeMb) * 1024 * 1024) / SECTOR_SIZE);
+	const u32 reads = blocks / options.sectorsPerRead;
+	const std::string isoPath = Path::CombineStdString(options.dir, "cdvd_bench.iso");
+
+	std::printf("Generating %u MB image\n", options.sizeMb);
+	if (!WriteIso(isoPath, blocks))
+	{
+		std::fprintf(stderr, "Failed to write %s\n", isoPath.c_str());
+		return 1;
+	}
+
+	std::vector<std::string> files = {isoPath};
+	std::vector<ReaderType> types;
+	types.push_back({"flat", isoPath, []() {
+		auto reader = std::make_unique<FlatFileReader>();
+		reader->SetBlockSize(SECTOR_SIZE);
+		return reader;
+	}});
+	types.push_back({"mapped", isoPath, []() {
+		auto reader = std::make_unique<MappedFileReader>();
+		reader->SetBlockSize(SECTOR_SIZE);
+		return reader;
+	}});
+
+	const u32 threads = options.decompressThreads;
+	for (CsoWriter::Format format : {CsoWriter::Format::CSO, CsoWriter::Format::ZSO})
+	{
+		if (!CsoWriter::IsFormatSupported(format))
+			continue;
+
+		const bool zso = format == CsoWriter::Format::ZSO;
+		const std::string path = Path::CombineStdString(options.dir, zso ? "cdvd_bench.zso" : "cdvd_bench.cso");
+		std::printf("Compressing %s\n", zso ? "ZSO" : "CSO");
+		if (!CsoWriter::Convert(isoPath, path, format))
+		{
+			std::fprintf(stderr, "Failed to write %s\n", path.c_str());
+			return 1;
+		}
+		files.push_back(path);
+		types.push_back({zso ? "zso" : "cso", path, [threads]() {
+			auto reader = std::make_unique<CsoFileReader>();
+			reader->SetDecompressThreads(threads);
+			return reader;
+		}});
+	}
+
+	const std::string gzPath = Path::CombineStdString(options.dir, "cdvd_bench.iso.gz");
+	std::printf("Compressing GZ\n");
+	if (!WriteGzip(isoPath, gzPath))
+	{
+		std::fprintf(stderr, "Failed to write %s\n", gzPath.c_str());
+		return 1;
+	}
+	files.push_back(gzPath);
+	files.push_back(gzPath + ".pindex.tmp");
+	types.push_back({"gz", gzPath, [threads]() {
+		auto reader = std::make_unique<GzippedFileReader>();
+		reader->SetDecompressThreads(threads);
+		return reader;
+	}});
+
+	if (options.chd)
+	{
+		const std::string path = Path::CombineStdString(options.dir, "cdvd_bench.chd");
+		std::printf("Compressing CHD\n");
+		if (WriteChd(isoPath, path))
+		{
+			files.push_back(path);
+			const u32 cacheMb = options.chdCacheMb;
+			types.push_back({"chd", path, [threads, cacheMb]() {
+				auto reader = std::make_unique<ChdFileReader>();
+				reader->SetDecompressThreads(threads);
+				reader->SetHunkCache(cacheMb, 0);
+				return reader;
+			}});
+		}
+		else
+		{
+			std::fprintf(stderr, "Couldn't make a CHD, is chdman installed?\n");
+		}
+	}
+
+	std::printf("\n%u sectors per read, %u decompression threads\n", options.sectorsPerRead, threads);
+	std::printf("%-8s %-12s %10s %10s %10s\n", "reader", "pattern", "MB/s", "p50 us", "p99 us");
+
+	bool failed = false;
+	for (const ReaderType& type : types)
+	{
+		for (Pattern pattern : {Pattern::Sequential, Pattern::Strided, Pattern::Random})
+		{
+			Result result;
+			if (!RunPattern(type, pattern, blocks, reads, options, &result))
+			{
+				failed = true;
+				break;
+			}
+
+			std::printf("%-8s %-12s %10.1f %10.1f %10.1f%s\n", type.name, PatternName(pattern),
+				result.mbPerSec, result.p50Us, result.p99Us, result.mismatches ? "  WRONG DATA" : "");
+			failed |= result.mismatches != 0;
+		}
+	}
+
+	if (!options.keep)
+	{
+		for (const std::string& file : files)
+			FileSystem::DeleteFilePath(file.c_str());
+	}
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,51 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// This file defines functions that are linked to by the image readers but not needed by the benchmark, in order to make linkers happy
+
+#include "PrecompiledHeader.h"
+#include "Config.h"
+#include "PerformanceMetrics.h"
+
+// The gzip reader takes its index location from here, keep the index next to the image
+Pcsx2Config EmuConfig;
+
+Pcsx2Config::Pcsx2Config()
+{
+	GzipIsoIndexTemplate = "$(f).pindex.tmp";
+}
+
+Pcsx2Config::SpeedhackOptions::SpeedhackOptions() {}
+Pcsx2Config::RecompilerOptions::RecompilerOptions() {}
+Pcsx2Config::CpuOptions::CpuOptions() {}
+Pcsx2Config::GSOptions::GSOptions() {}
+Pcsx2Config::SPU2Options::SPU2Options() {}
+Pcsx2Config::DEV9Options::DEV9Options() {}
+Pcsx2Config::GamefixOptions::GamefixOptions() {}
+Pcsx2Config::DebugOptions::DebugOptions() {}
+Pcsx2Config::FilenameOptions::FilenameOptions() {}
+
+namespace EmuFolders
+{
+	wxDirName DataRoot;
+}
+
+void PerformanceMetrics::OnCDVDReadahead(CDVDAccessPattern pattern)
+{
+}
+
+void PerformanceMetrics::OnCDVDRead(bool prefetched)
+{
+}
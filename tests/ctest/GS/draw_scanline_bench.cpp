@@ -0,0 +1,472 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022 PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Times the draw scanline JIT with and without its AVX-512 code (frame and z buffer writes
+// stored under a mask instead of branching per pixel) on synthetic triangle draws, one scene
+// per kind of test or blend feeding those writes.  Both versions draw every scene from the
+// same starting memory and must leave the same frame and z buffer behind.  With --quick only
+// that check runs, so this doubles as a test.  On a CPU without AVX-512 there is nothing to
+// compare and it exits successfully.
+
+#include "PrecompiledHeader.h"
+#include "GS/GS.h"
+#include "GS/Renderers/SW/GSRasterizer.h"
+#include "GS/Renderers/SW/GSScanlineEnvironment.h"
+#include "GS/Renderers/SW/GSDrawScanlineCodeGenerator.all.h"
+#include "GS/Renderers/SW/GSSetupPrimCodeGenerator.all.h"
+#include "PerformanceMetrics.h"
+
+#include "common/Timer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// GSRasterizer.cpp and the code generators need these, the bench doesn't use the rest of the GS
+
+GSApp::GSApp() {}
+int GSApp::GetConfigI(const char* entry) { return 0; }
+GSApp theApp;
+
+void PerformanceMetrics::SetGSSWThreadCount(u32 count) {}
+void PerformanceMetrics::SetGSSWThreadTimer(u32 index, Common::ThreadCPUTimer timer) {}
+
+void* vmalloc(size_t size, bool code)
+{
+	return std::malloc(size);
+}
+
+void vmfree(void* ptr, size_t size)
+{
+	std::free(ptr);
+}
+
+std::unique_ptr<GSScanlineConstantData> g_const(new GSScanlineConstantData());
+
+static constexpr int SCREEN_WIDTH = 512;
+static constexpr int SCREEN_HEIGHT = 448;
+static constexpr int TEXTURE_SIZE = 256;
+
+// The frame and z buffer don't use the real swizzle.  Like in a PSMCT32 column, each group of 8
+// pixels is stored as pairs 4 dwords apart, the rows are 4 KB apart and the z buffer starts
+// half way into local memory.  The tables are in 16 bit units, like GSPixelOffset4.
+static constexpr u32 ROW_PITCH = SCREEN_WIDTH * 2 * 2;
+static constexpr u32 ZBUF_START = HALF_VM_SIZE / 2;
+
+alignas(64) static u8 s_vm[VM_SIZE];
+alignas(32) static u32 s_texture[TEXTURE_SIZE * TEXTURE_SIZE];
+static GSVector2i s_fzbr[2048];
+static GSVector2i s_fzbc[512];
+
+class alignas(32) BenchData : public GSRasterizerData
+{
+public:
+	GSScanlineGlobalData global;
+	std::vector<GSVertexSW> vertices;
+	std::vector<u32> indices;
+};
+
+/// Like GSDrawScanline, but it builds the code straight into its own buffers, with or without AVX-512
+template <bool avx512>
+class JitDrawScanline : public IDrawScanline
+{
+	static constexpr size_t CODE_SIZE = 64 * 1024;
+
+	GSScanlineGlobalData m_global;
+	GSScanlineLocalData m_local;
+	std::vector<std::unique_ptr<Xbyak::CodeGenerator>> m_code;
+	std::unordered_map<u64, std::pair<SetupPrimPtr, DrawScanlinePtr>> m_map;
+
+	CPUInfo GetCPUInfo() const
+	{
+		CPUInfo cpu{Xbyak::util::Cpu()};
+		cpu.hasAVX512 = avx512;
+		return cpu;
+	}
+
+public:
+	JitDrawScanline()
+	{
+		m_local.gd = &m_global;
+	}
+
+	void BeginDraw(const GSRasterizerData* data) override
+	{
+		std::memcpy(&m_global, &static_cast<const BenchData*>(data)->global, sizeof(m_global));
+
+		auto it = m_map.find(m_global.sel.key);
+		if (it == m_map.end())
+		{
+			Precompile(m_global.sel.key);
+			it = m_map.find(m_global.sel.key);
+		}
+
+		m_sp = it->second.first;
+		m_ds = it->second.second;
+	}
+
+	void EndDraw(u64 frame, u64 ticks, int actual, int total, int prims) override {}
+
+	void Precompile(u64 key) override
+	{
+		if (m_map.find(key) != m_map.end())
+			return;
+
+		std::unique_ptr<Xbyak::CodeGenerator> sp = std::make_unique<Xbyak::CodeGenerator>(CODE_SIZE);
+		GSSetupPrimCodeGenerator2(sp.get(), GetCPUInfo(), &m_local, key).Generate();
+
+		std::unique_ptr<Xbyak::CodeGenerator> ds = std::make_unique<Xbyak::CodeGenerator>(CODE_SIZE);
+		GSDrawScanlineCodeGenerator2(ds.get(), GetCPUInfo(), &m_local, key).Generate();
+
+		m_map.emplace(key, std::make_pair(sp->getCode<SetupPrimPtr>(), ds->getCode<DrawScanlinePtr>()));
+		m_code.push_back(std::move(sp));
+		m_code.push_back(std::move(ds));
+	}
+
+	void PrintStats() override {}
+};
+
+struct Scene
+{
+	const char* name;
+	std::vector<GSRingHeap::SharedPtr<GSRasterizerData>> draws;
+};
+
+/// The parts of GSRendererSW::GetScanlineGlobalData the scenes need
+struct SceneSetup
+{
+	u32 zpsm = 0;
+	u32 ztst = ZTST_ALWAYS;
+	u32 atst = ATST_ALWAYS;
+	u32 afail = AFAIL_KEEP;
+	u32 aref = 0;
+	u32 fm = 0;
+	bool abe = false;
+	bool tme = false;
+};
+
+static void SetupGlobalData(GSScanlineGlobalData& gd, const SceneSetup& setup)
+{
+	std::memset(&gd, 0, sizeof(gd));
+
+	gd.vm = s_vm;
+	gd.fzbr = s_fzbr;
+	gd.fzbc = s_fzbc;
+
+	gd.sel.key = 0;
+	gd.sel.prim = GS_TRIANGLE_CLASS;
+	gd.sel.fpsm = 0;
+	gd.sel.iip = 1;
+	gd.sel.tfx = TFX_NONE;
+	gd.sel.ababcd = 0xff;
+	gd.sel.colclamp = 1;
+
+	gd.sel.atst = setup.atst;
+	gd.sel.afail = setup.afail;
+	gd.aref = GSVector4i(static_cast<int>(setup.aref));
+
+	gd.sel.fwrite = 1;
+	gd.sel.ftest = setup.atst != ATST_ALWAYS;
+
+	if (setup.tme)
+	{
+		gd.sel.tfx = TFX_MODULATE;
+		gd.sel.tcc = 1;
+		gd.sel.fst = 1;
+		gd.sel.wms = CLAMP_REPEAT;
+		gd.sel.wmt = CLAMP_REPEAT;
+		gd.sel.tw = 8 - 3;
+
+		gd.tex[0] = s_texture;
+
+		gd.t.min.U16[0] = gd.t.minmax.U16[0] = TEXTURE_SIZE - 1;
+		gd.t.min.U16[4] = gd.t.minmax.U16[1] = TEXTURE_SIZE - 1;
+		gd.t.mask.U32[0] = 0xffffffff;
+		gd.t.mask.U32[2] = 0xffffffff;
+		gd.t.min = gd.t.min.xxxxlh();
+		gd.t.max = gd.t.max.xxxxlh();
+		gd.t.mask = gd.t.mask.xxzz();
+		gd.t.invmask = ~gd.t.mask;
+	}
+
+	if (setup.abe)
+	{
+		// Cs * As + Cd * (1 - As), the usual transparency
+		gd.sel.abe = 1;
+		gd.sel.aba = 0;
+		gd.sel.abb = 1;
+		gd.sel.abc = 0;
+		gd.sel.abd = 1;
+	}
+
+	gd.sel.rfb = gd.sel.aba == 1 || gd.sel.abb == 1 || gd.sel.abc == 1 || gd.sel.abd == 1
+		|| gd.sel.atst != ATST_ALWAYS && gd.sel.afail == AFAIL_RGB_ONLY
+		|| setup.fm != 0;
+
+	gd.sel.zpsm = setup.zpsm;
+	gd.sel.ztst = setup.ztst;
+	gd.sel.zwrite = 1;
+	gd.sel.ztest = setup.ztst > ZTST_ALWAYS;
+
+#if _M_SSE >= 0x501
+	gd.fm = setup.fm;
+	gd.zm = setup.zpsm == 1 ? 0xff000000 : 0;
+#else
+	gd.fm = GSVector4i(static_cast<int>(setup.fm));
+	gd.zm = setup.zpsm == 1 ? GSVector4i::xff000000() : GSVector4i::zero();
+#endif
+}
+
+/// Random triangles with random depth and colors, converted like GSRendererSW::ConvertVertexBuffer
+static void AddTriangles(GSRingHeap& heap, std::mt19937& rng, Scene& scene, const SceneSetup& setup, int draws, int prims)
+{
+	const u32 z_max = setup.zpsm == 1 ? 0x00ffffff : 0x7fffffff;
+	std::uniform_real_distribution<float> px(0.0f, SCREEN_WIDTH - 1);
+	std::uniform_real_distribution<float> py(0.0f, SCREEN_HEIGHT - 1);
+	std::uniform_real_distribution<float> size(16.0f, 96.0f);
+	std::uniform_int_distribution<u32> z(0, z_max);
+	std::uniform_int_distribution<int> c(0, 255);
+	std::uniform_real_distribution<float> t(0.0f, TEXTURE_SIZE * 2);
+
+	for (int i = 0; i < draws; i++)
+	{
+		GSRingHeap::SharedPtr<GSRasterizerData> data = heap.make_shared<BenchData>().cast<GSRasterizerData>();
+		BenchData& d = static_cast<BenchData&>(*data);
+
+		for (int j = 0; j < prims; j++)
+		{
+			const float x = px(rng);
+			const float y = py(rng);
+			const float s = size(rng);
+			const GSVector4 p[3] = {
+				GSVector4(x, y),
+				GSVector4(x + s, y + size(rng) * 0.5f),
+				GSVector4(x + size(rng) * 0.25f, y + s),
+			};
+
+			for (const GSVector4& xy : p)
+			{
+				const GSVector4 cxy = xy.min(GSVector4(SCREEN_WIDTH - 1, SCREEN_HEIGHT - 1));
+
+				GSVertexSW v;
+				v.p = GSVector4(cxy.x, cxy.y, static_cast<float>(z(rng)), 0.0f);
+				v._pad = GSVector4::zero();
+				v.t = setup.tme ? GSVector4(t(rng), t(rng)) * GSVector4(0x10000) : GSVector4::zero();
+				v.c = GSVector4(GSVector4i(c(rng), c(rng), c(rng), c(rng)) << 7);
+
+				d.indices.push_back(static_cast<u32>(d.vertices.size()));
+				d.vertices.push_back(v);
+			}
+		}
+
+		GSVector4 pmin = d.vertices[0].p;
+		GSVector4 pmax = pmin;
+		for (const GSVertexSW& v : d.vertices)
+		{
+			pmin = pmin.min(v.p);
+			pmax = pmax.max(v.p);
+		}
+
+		SetupGlobalData(d.global, setup);
+		d.primclass = GS_TRIANGLE_CLASS;
+		d.scissor = GSVector4i(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+		d.bbox = GSVector4i(pmin.floor().xyxy(pmax.ceil()));
+		d.vertex = d.vertices.data();
+		d.vertex_count = static_cast<int>(d.vertices.size());
+		d.index = d.indices.data();
+		d.index_count = static_cast<int>(d.indices.size());
+
+		scene.draws.push_back(std::move(data));
+	}
+}
+
+static void RunScene(IRasterizer* rl, const Scene& scene)
+{
+	for (const GSRingHeap::SharedPtr<GSRasterizerData>& data : scene.draws)
+		rl->Queue(data);
+
+	rl->Sync();
+}
+
+/// Runs the passes from the starting memory and returns the time per pass
+static double TimePasses(IRasterizer* rl, const Scene& scene, const std::vector<u8>& start, int passes)
+{
+	std::memcpy(s_vm, start.data(), sizeof(s_vm));
+
+	Common::Timer timer;
+	for (int i = 0; i < passes; i++)
+		RunScene(rl, scene);
+
+	return timer.GetTimeSeconds() / passes;
+}
+
+static void Usage()
+{
+	std::fprintf(stderr, "Usage: draw_scanline_bench [--quick] [--time seconds]\n");
+}
+
+int main(int argc, char** argv)
+{
+	double seconds = 0.5;
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		if (std::strcmp(arg, "--quick") == 0)
+			seconds = 0;
+		else if (std::strcmp(arg, "--time") == 0 && i + 1 < argc)
+			seconds = std::max(0.0, std::atof(argv[++i]));
+		else
+		{
+			Usage();
+			return 1;
+		}
+	}
+
+	if (!CPUInfo(Xbyak::util::Cpu()).hasAVX512)
+	{
+		std::printf("AVX-512 is not available, skipping\n");
+		return 0;
+	}
+
+	g_const->Init();
+
+	for (int y = 0; y < static_cast<int>(std::size(s_fzbr)); y++)
+	{
+		const int row = (y % SCREEN_HEIGHT) * ROW_PITCH;
+		s_fzbr[y] = GSVector2i(row, ZBUF_START + row);
+	}
+
+	for (int x = 0; x < static_cast<int>(std::size(s_fzbc)); x++)
+	{
+		const int col = ((x * 4) % SCREEN_WIDTH) / 8 * 32 + (x & 1) * 4;
+		s_fzbc[x] = GSVector2i(col, col);
+	}
+
+	std::mt19937 rng(1);
+
+	for (u32& texel : s_texture)
+		texel = static_cast<u32>(rng());
+
+	std::vector<u8> start(sizeof(s_vm));
+	for (u8& b : start)
+		b = static_cast<u8>(rng());
+
+	struct SceneDesc
+	{
+		const char* name;
+		SceneSetup setup;
+	};
+
+	std::vector<SceneDesc> descs(8);
+	descs[0].name = "Z write only";
+	descs[0].setup.ztst = ZTST_ALWAYS;
+	descs[1].name = "Z test >=, z32";
+	descs[1].setup.ztst = ZTST_GEQUAL;
+	descs[2].name = "Z test >, z24";
+	descs[2].setup.ztst = ZTST_GREATER;
+	descs[2].setup.zpsm = 1;
+	descs[3].name = "Alpha test >=, keep";
+	descs[3].setup.ztst = ZTST_GEQUAL;
+	descs[3].setup.atst = ATST_GEQUAL;
+	descs[3].setup.aref = 0x40;
+	descs[4].name = "Alpha test ==, fb only";
+	descs[4].setup.ztst = ZTST_GEQUAL;
+	descs[4].setup.atst = ATST_NOTEQUAL;
+	descs[4].setup.afail = AFAIL_FB_ONLY;
+	descs[4].setup.aref = 0x80;
+	descs[5].name = "Alpha test <=, rgb only";
+	descs[5].setup.ztst = ZTST_GEQUAL;
+	descs[5].setup.atst = ATST_LEQUAL;
+	descs[5].setup.afail = AFAIL_RGB_ONLY;
+	descs[5].setup.aref = 0xc0;
+	descs[6].name = "Blend, masked frame";
+	descs[6].setup.ztst = ZTST_GEQUAL;
+	descs[6].setup.abe = true;
+	descs[6].setup.fm = 0xff00ff00;
+	descs[7].name = "Textured, alpha test, blend";
+	descs[7].setup.ztst = ZTST_GEQUAL;
+	descs[7].setup.atst = ATST_GEQUAL;
+	descs[7].setup.aref = 0x40;
+	descs[7].setup.abe = true;
+	descs[7].setup.tme = true;
+
+	GSRingHeap heap;
+	std::vector<Scene> scenes(descs.size());
+	for (size_t i = 0; i < descs.size(); i++)
+	{
+		scenes[i].name = descs[i].name;
+		AddTriangles(heap, rng, scenes[i], descs[i].setup, 8, 64);
+	}
+
+	IRasterizer* off = GSRasterizerList::Create<JitDrawScanline<false>>(0, &g_perfmon);
+	IRasterizer* on = GSRasterizerList::Create<JitDrawScanline<true>>(0, &g_perfmon);
+
+	int result = 0;
+	std::vector<u8> expected(sizeof(s_vm));
+
+	std::printf("%-30s  %12s  %12s  %8s\n", "Scene", "Off ms", "AVX-512 ms", "Speedup");
+	for (const Scene& scene : scenes)
+	{
+		// The second pass gets the same z as the first, which the z tests have to get right
+		std::memcpy(s_vm, start.data(), sizeof(s_vm));
+		RunScene(off, scene);
+		RunScene(off, scene);
+		std::memcpy(expected.data(), s_vm, sizeof(s_vm));
+
+		std::memcpy(s_vm, start.data(), sizeof(s_vm));
+		RunScene(on, scene);
+		RunScene(on, scene);
+		if (std::memcmp(expected.data(), s_vm, sizeof(s_vm)) != 0)
+		{
+			std::fprintf(stderr, "%s: AVX-512 output differs\n", scene.name);
+			result = 1;
+		}
+
+		if (seconds == 0)
+			continue;
+
+		// Same number of passes for both, the buffers change from pass to pass.  The two take
+		// turns, so clock changes hit both, and the best round of each counts.
+		static constexpr int ROUNDS = 5;
+
+		Common::Timer timer;
+		int passes = 0;
+		do
+		{
+			RunScene(off, scene);
+			passes++;
+		} while (timer.GetTimeSeconds() < seconds / (ROUNDS * 2));
+
+		double t_off = TimePasses(off, scene, start, passes);
+		double t_on = TimePasses(on, scene, start, passes);
+		for (int round = 1; round < ROUNDS; round++)
+		{
+			t_off = std::min(t_off, TimePasses(off, scene, start, passes));
+			t_on = std::min(t_on, TimePasses(on, scene, start, passes));
+		}
+
+		std::printf("%-30s  %12.3f  %12.3f  %7.2fx\n", scene.name, t_off * 1e3, t_on * 1e3, t_off / t_on);
+	}
+
+	delete on;
+	delete off;
+
+	return result;
+}
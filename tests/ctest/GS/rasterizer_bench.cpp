@@ -0,0 +1,328 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022 PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Times GSRasterizerList against GSRasterizerBinned on synthetic scenes.
+// The scanline functions stand in for the JIT: they do a little work per pixel which depends on
+// the order the draws are done in, so every mode is also checked against a single threaded
+// GSRasterizer.  With --quick only the check runs, so this doubles as a test.
+
+#include "PrecompiledHeader.h"
+#include "GS/GS.h"
+#include "GS/Renderers/SW/GSRasterizer.h"
+#include "GS/Renderers/SW/GSScanlineEnvironment.h"
+#include "PerformanceMetrics.h"
+
+#include "common/Timer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// GSRasterizer.cpp needs these, the bench doesn't use the rest of the GS
+
+GSApp::GSApp() {}
+int GSApp::GetConfigI(const char* entry) { return 0; }
+GSApp theApp;
+
+void PerformanceMetrics::SetGSSWThreadCount(u32 count) {}
+void PerformanceMetrics::SetGSSWThreadTimer(u32 index, Common::ThreadCPUTimer timer) {}
+
+void* vmalloc(size_t size, bool code)
+{
+	return std::malloc(size);
+}
+
+void vmfree(void* ptr, size_t size)
+{
+	std::free(ptr);
+}
+
+static constexpr int FB_WIDTH = 1024;
+static constexpr int SCREEN_WIDTH = 640;
+static constexpr int SCREEN_HEIGHT = 448;
+
+static u32 s_fb[FB_WIDTH * 512];
+
+class alignas(32) BenchData : public GSRasterizerData
+{
+public:
+	GSScanlineGlobalData global;
+	u64 sel;
+	u32 color;
+	std::vector<GSVertexSW> vertices;
+	std::vector<u32> indices;
+};
+
+class BenchDrawScanline : public IDrawScanline
+{
+	static thread_local u32 s_color;
+
+	// Like GSDrawScanline, which copies its constants and looks the function up in a map
+	GSScanlineGlobalData m_global;
+	std::unordered_map<u64, DrawScanlinePtr> m_map;
+
+	static void SetupPrimBench(const GSVertexSW* vertex, const u32* index, const GSVertexSW& dscan)
+	{
+	}
+
+	static void __fastcall DrawScanlineBench(int pixels, int left, int top, const GSVertexSW& scan)
+	{
+		u32* RESTRICT fb = &s_fb[top * FB_WIDTH + left];
+
+		for (int i = 0; i < pixels; i++)
+			fb[i] = fb[i] * 33 + s_color;
+	}
+
+public:
+	void BeginDraw(const GSRasterizerData* data) override
+	{
+		const BenchData* bd = static_cast<const BenchData*>(data);
+		std::memcpy(&m_global, &bd->global, sizeof(m_global));
+
+		auto it = m_map.find(bd->sel);
+		if (it == m_map.end())
+			it = m_map.emplace(bd->sel, &DrawScanlineBench).first;
+
+		m_sp = &SetupPrimBench;
+		m_ds = it->second;
+		s_color = bd->color;
+	}
+
+	void EndDraw(u64 frame, u64 ticks, int actual, int total, int prims) override {}
+	void Precompile(u64 key) override {}
+	void PrintStats() override {}
+};
+
+thread_local u32 BenchDrawScanline::s_color;
+
+struct Scene
+{
+	const char* name;
+	std::vector<GSRingHeap::SharedPtr<GSRasterizerData>> draws;
+};
+
+static GSVertexSW MakeVertex(float x, float y)
+{
+	GSVertexSW v;
+	v.p = GSVector4(x, y, 0.0f, 0.0f);
+	v._pad = GSVector4::zero();
+	v.t = GSVector4::zero();
+	v.c = GSVector4::zero();
+	return v;
+}
+
+static void FinishDraw(BenchData& d, GS_PRIM_CLASS primclass, u32 color)
+{
+	GSVector4 pmin = d.vertices[0].p;
+	GSVector4 pmax = pmin;
+	for (const GSVertexSW& v : d.vertices)
+	{
+		pmin = pmin.min(v.p);
+		pmax = pmax.max(v.p);
+	}
+
+	std::memset(&d.global, 0, sizeof(d.global));
+	d.sel = color & 15;
+	d.color = color;
+	d.primclass = primclass;
+	d.scissor = GSVector4i(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+	d.bbox = GSVector4i(pmin.floor().xyxy(pmax.ceil()));
+	d.vertex = d.vertices.data();
+	d.vertex_count = static_cast<int>(d.vertices.size());
+	d.index = d.indices.data();
+	d.index_count = static_cast<int>(d.indices.size());
+}
+
+static void AddSprites(GSRingHeap& heap, std::mt19937& rng, Scene& scene, int draws, int prims, int min_size, int max_size, int spread)
+{
+	std::uniform_int_distribution<int> size(min_size, max_size);
+
+	for (int i = 0; i < draws; i++)
+	{
+		GSRingHeap::SharedPtr<GSRasterizerData> data = heap.make_shared<BenchData>().cast<GSRasterizerData>();
+		BenchData& d = static_cast<BenchData&>(*data);
+
+		// Each draw's sprites stay near each other, like a line of text
+		const int cx = std::uniform_int_distribution<int>(0, SCREEN_WIDTH - 1)(rng);
+		const int cy = std::uniform_int_distribution<int>(0, SCREEN_HEIGHT - 1)(rng);
+		std::uniform_int_distribution<int> offset(-spread, spread);
+
+		for (int j = 0; j < prims; j++)
+		{
+			const int w = size(rng);
+			const int h = size(rng);
+			const int x = std::clamp(cx + offset(rng), 0, SCREEN_WIDTH - w);
+			const int y = std::clamp(cy + offset(rng), 0, SCREEN_HEIGHT - h);
+
+			d.indices.push_back(static_cast<u32>(d.vertices.size()));
+			d.indices.push_back(static_cast<u32>(d.vertices.size() + 1));
+			d.vertices.push_back(MakeVertex(static_cast<float>(x), static_cast<float>(y)));
+			d.vertices.push_back(MakeVertex(static_cast<float>(x + w), static_cast<float>(y + h)));
+		}
+
+		FinishDraw(d, GS_SPRITE_CLASS, static_cast<u32>(rng()));
+		scene.draws.push_back(std::move(data));
+	}
+}
+
+static void AddTriangles(GSRingHeap& heap, std::mt19937& rng, Scene& scene, int draws, int prims, float min_size, float max_size, int spread)
+{
+	std::uniform_real_distribution<float> size(min_size, max_size);
+
+	for (int i = 0; i < draws; i++)
+	{
+		GSRingHeap::SharedPtr<GSRasterizerData> data = heap.make_shared<BenchData>().cast<GSRasterizerData>();
+		BenchData& d = static_cast<BenchData&>(*data);
+
+		// A mesh covers part of the screen, its triangles are small and close together
+		const float cx = std::uniform_real_distribution<float>(0.0f, SCREEN_WIDTH)(rng);
+		const float cy = std::uniform_real_distribution<float>(0.0f, SCREEN_HEIGHT)(rng);
+		std::uniform_real_distribution<float> offset(-spread, spread);
+
+		for (int j = 0; j < prims; j++)
+		{
+			const float x = cx + offset(rng);
+			const float y = cy + offset(rng);
+			const float s = size(rng);
+
+			const GSVector4 p[3] = {
+				GSVector4(x, y, 0.0f, 0.0f),
+				GSVector4(x + s, y + size(rng) * 0.5f, 0.0f, 0.0f),
+				GSVector4(x + size(rng) * 0.25f, y + s, 0.0f, 0.0f),
+			};
+
+			for (const GSVector4& v : p)
+			{
+				const GSVector4 c = v.max(GSVector4::zero()).min(GSVector4(SCREEN_WIDTH - 1, SCREEN_HEIGHT - 1, 0, 0));
+				d.indices.push_back(static_cast<u32>(d.vertices.size()));
+				d.vertices.push_back(MakeVertex(c.x, c.y));
+			}
+		}
+
+		FinishDraw(d, GS_TRIANGLE_CLASS, static_cast<u32>(rng()));
+		scene.draws.push_back(std::move(data));
+	}
+}
+
+static void RunScene(IRasterizer* rl, const Scene& scene)
+{
+	for (const GSRingHeap::SharedPtr<GSRasterizerData>& data : scene.draws)
+		rl->Queue(data);
+
+	rl->Sync();
+}
+
+static double TimeScene(IRasterizer* rl, const Scene& scene, double seconds)
+{
+	Common::Timer timer;
+	int passes = 0;
+	do
+	{
+		RunScene(rl, scene);
+		passes++;
+	} while (timer.GetTimeSeconds() < seconds);
+
+	return timer.GetTimeSeconds() / passes;
+}
+
+static void Usage()
+{
+	std::fprintf(stderr, "Usage: rasterizer_bench [--quick] [--time seconds] [--threads n]\n");
+}
+
+int main(int argc, char** argv)
+{
+	double seconds = 0.5;
+	int threads = std::clamp(static_cast<int>(std::thread::hardware_concurrency()) - 1, 2, 8);
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		if (std::strcmp(arg, "--quick") == 0)
+			seconds = 0;
+		else if (std::strcmp(arg, "--time") == 0 && i + 1 < argc)
+			seconds = std::max(0.0, std::atof(argv[++i]));
+		else if (std::strcmp(arg, "--threads") == 0 && i + 1 < argc)
+			threads = std::max(1, std::atoi(argv[++i]));
+		else
+		{
+			Usage();
+			return 1;
+		}
+	}
+
+	GSRingHeap heap;
+	std::mt19937 rng(1);
+	std::vector<Scene> scenes(6);
+
+	scenes[0].name = "HUD, 2000 single sprites";
+	AddSprites(heap, rng, scenes[0], 2000, 1, 8, 32, 0);
+	scenes[1].name = "Text, 200 x 20 sprites";
+	AddSprites(heap, rng, scenes[1], 200, 20, 8, 16, 64);
+	scenes[2].name = "Meshes, 40 x 400 triangles";
+	AddTriangles(heap, rng, scenes[2], 40, 400, 4.0f, 24.0f, 100);
+	scenes[3].name = "Meshes, 400 x 40 triangles";
+	AddTriangles(heap, rng, scenes[3], 400, 40, 4.0f, 24.0f, 40);
+	scenes[4].name = "Big triangles, 100 x 2";
+	AddTriangles(heap, rng, scenes[4], 100, 2, 100.0f, 300.0f, 100);
+	scenes[5].name = "Full screen, 16 sprites";
+	AddSprites(heap, rng, scenes[5], 16, 1, SCREEN_WIDTH, SCREEN_WIDTH, 0);
+
+	IRasterizer* reference = GSRasterizerList::Create<BenchDrawScanline>(0, &g_perfmon);
+	IRasterizer* list = GSRasterizerList::Create<BenchDrawScanline>(threads, &g_perfmon);
+	IRasterizer* binned = GSRasterizerBinned::Create<BenchDrawScanline>(threads, &g_perfmon);
+
+	int result = 0;
+	std::vector<u32> expected(std::size(s_fb));
+
+	std::printf("%d threads\n", threads);
+	std::printf("%-30s  %12s  %12s  %12s  %8s\n", "Scene", "1 thread ms", "List ms", "Binned ms", "Speedup");
+	for (const Scene& scene : scenes)
+	{
+		std::memset(s_fb, 0, sizeof(s_fb));
+		RunScene(reference, scene);
+		std::memcpy(expected.data(), s_fb, sizeof(s_fb));
+
+		for (IRasterizer* rl : {list, binned})
+		{
+			std::memset(s_fb, 0, sizeof(s_fb));
+			RunScene(rl, scene);
+			if (std::memcmp(expected.data(), s_fb, sizeof(s_fb)) != 0)
+			{
+				std::fprintf(stderr, "%s: %s output differs from one thread\n", scene.name, rl == list ? "list" : "binned");
+				result = 1;
+			}
+		}
+
+		if (seconds == 0)
+			continue;
+
+		const double t_reference = TimeScene(reference, scene, seconds);
+		const double t_list = TimeScene(list, scene, seconds);
+		const double t_binned = TimeScene(binned, scene, seconds);
+		std::printf("%-30s  %12.3f  %12.3f  %12.3f  %7.2fx\n", scene.name,
+			t_reference * 1e3, t_list * 1e3, t_binned * 1e3, t_list / t_binned);
+	}
+
+	delete binned;
+	delete list;
+	delete reference;
+
+	return result;
+}
@@ -0,0 +1,223 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Times the GSBlock swizzle kernels over a buffer the size of GS local memory, one linear tile
+// per block, and reports GB/s of GS memory read or written for each PSM and kernel.
+// The plain read/write kernels are round tripped first, so with --quick this doubles as a test.
+
+#include "PrecompiledHeader.h"
+#include "GSBlock.h"
+#include "GSClut.h"
+
+#include "common/Timer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace CURRENT_ISA;
+
+struct BenchOptions
+{
+	u32 blocks = MAX_BLOCKS;
+	double seconds = 0.25;
+};
+
+struct Buffers
+{
+	u8* mem;
+	u8* lin;
+	const u32* clut32;
+	GIFRegTEXA texa;
+};
+
+struct Kernel
+{
+	const char* psm;
+	const char* name;
+	u32 tileSize; ///< Bytes of linear data per block
+	void (*pass)(const Buffers& buf, u32 blocks);
+};
+
+// The loop lives in each entry so the kernel gets inlined into it, like it is in GSLocalMemory
+#define READ(psm, name, size, call) {psm, name, size, [](const Buffers& buf, u32 blocks) { \
+	for (u32 b = 0; b < blocks; b++) \
+	{ \
+		const u8* src = buf.mem + b * BLOCK_SIZE; \
+		u8* dst = buf.lin + b * (size); \
+		call; \
+	} \
+}}
+
+#define WRITE(psm, name, size, call) {psm, name, size, [](const Buffers& buf, u32 blocks) { \
+	for (u32 b = 0; b < blocks; b++) \
+	{ \
+		u8* dst = buf.mem + b * BLOCK_SIZE; \
+		const u8* src = buf.lin + b * (size); \
+		call; \
+	} \
+}}
+
+static const Kernel s_kernels[] = {
+	READ("PSMCT32", "ReadBlock32", 256, GSBlock::ReadBlock32(src, dst, 32)),
+	READ("PSMCT16", "ReadBlock16", 256, GSBlock::ReadBlock16(src, dst, 32)),
+	READ("PSMT8", "ReadBlock8", 256, GSBlock::ReadBlock8(src, dst, 16)),
+	READ("PSMT4", "ReadBlock4", 256, GSBlock::ReadBlock4(src, dst, 16)),
+	READ("PSMT4", "ReadBlock4P", 512, GSBlock::ReadBlock4P(src, dst, 32)),
+	READ("PSMT8H", "ReadBlock8HP", 64, GSBlock::ReadBlock8HP(src, dst, 8)),
+	READ("PSMT4HL", "ReadBlock4HLP", 64, GSBlock::ReadBlock4HLP(src, dst, 8)),
+	READ("PSMT4HH", "ReadBlock4HHP", 64, GSBlock::ReadBlock4HHP(src, dst, 8)),
+	READ("PSMCT16", "ReadAndExpandBlock16", 512, GSBlock::ReadAndExpandBlock16<false>(src, dst, 64, buf.texa)),
+	READ("PSMT8", "ReadAndExpandBlock8_32", 1024, GSBlock::ReadAndExpandBlock8_32(src, dst, 64, buf.clut32)),
+	READ("PSMT4", "ReadAndExpandBlock4_32", 2048, GSBlock::ReadAndExpandBlock4_32(src, dst, 128, buf.clut32)),
+	READ("PSMT8H", "ReadAndExpandBlock8H_32", 256, GSBlock::ReadAndExpandBlock8H_32(src, dst, 32, buf.clut32)),
+	READ("PSMT4HL", "ReadAndExpandBlock4HL_32", 256, GSBlock::ReadAndExpandBlock4HL_32(src, dst, 32, buf.clut32)),
+	READ("PSMT4HH", "ReadAndExpandBlock4HH_32", 256, GSBlock::ReadAndExpandBlock4HH_32(src, dst, 32, buf.clut32)),
+	WRITE("PSMCT32", "WriteBlock32", 256, (GSBlock::WriteBlock32<32, 0xffffffff>(dst, src, 32))),
+	WRITE("PSMCT16", "WriteBlock16", 256, GSBlock::WriteBlock16<32>(dst, src, 32)),
+	WRITE("PSMT8", "WriteBlock8", 256, GSBlock::WriteBlock8<32>(dst, src, 16)),
+	WRITE("PSMT4", "WriteBlock4", 256, GSBlock::WriteBlock4<32>(dst, src, 16)),
+	WRITE("PSMT8H", "UnpackAndWriteBlock8H", 64, GSBlock::UnpackAndWriteBlock8H(src, 8, dst)),
+	WRITE("PSMT4HL", "UnpackAndWriteBlock4HL", 32, GSBlock::UnpackAndWriteBlock4HL(src, 4, dst)),
+	WRITE("PSMT4HH", "UnpackAndWriteBlock4HH", 32, GSBlock::UnpackAndWriteBlock4HH(src, 4, dst)),
+};
+
+#undef READ
+#undef WRITE
+
+// Writing a linear tile and reading it back has to give the same tile for every format
+static bool CheckRoundTrip(const Buffers& buf, u32 blocks)
+{
+	static const char* pairs[][2] = {
+		{"WriteBlock32", "ReadBlock32"},
+		{"WriteBlock16", "ReadBlock16"},
+		{"WriteBlock8", "ReadBlock8"},
+		{"WriteBlock4", "ReadBlock4"},
+	};
+
+	std::vector<u8> expected(static_cast<size_t>(blocks) * BLOCK_SIZE);
+	std::mt19937 rng(blocks);
+	for (u8& v : expected)
+		v = static_cast<u8>(rng());
+
+	bool ok = true;
+	for (const auto& pair : pairs)
+	{
+		const Kernel* write = nullptr;
+		const Kernel* read = nullptr;
+		for (const Kernel& kernel : s_kernels)
+		{
+			if (std::strcmp(kernel.name, pair[0]) == 0)
+				write = &kernel;
+			else if (std::strcmp(kernel.name, pair[1]) == 0)
+				read = &kernel;
+		}
+
+		std::memcpy(buf.lin, expected.data(), expected.size());
+		write->pass(buf, blocks);
+		std::memset(buf.lin, 0, expected.size());
+		read->pass(buf, blocks);
+
+		if (std::memcmp(buf.lin, expected.data(), expected.size()) != 0)
+		{
+			std::fprintf(stderr, "%s -> %s: data doesn't match\n", pair[0], pair[1]);
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+static void Usage()
+{
+	std::fprintf(stderr,
+		"Usage: swizzle_bench [options]\n"
+		"  --quick          small buffer and one pass, for checking the kernels rather than timing them\n"
+		"  --blocks N       GS memory blocks to cover (default 16384, all 4MB)\n"
+		"  --time S         seconds to spend on each kernel (default 0.25)\n");
+}
+
+int main(int argc, char** argv)
+{
+	BenchOptions options;
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if (std::strcmp(arg, "--quick") == 0)
+		{
+			options.blocks = 64;
+			options.seconds = 0;
+		}
+		else if (std::strcmp(arg, "--blocks") == 0 && hasValue)
+			options.blocks = std::max(1, std::atoi(argv[++i]));
+		else if (std::strcmp(arg, "--time") == 0 && hasValue)
+			options.seconds = std::max(0.0, std::atof(argv[++i]));
+		else
+		{
+			Usage();
+			return 1;
+		}
+	}
+
+	u32 maxTile = 0;
+	for (const Kernel& kernel : s_kernels)
+		maxTile = std::max(maxTile, kernel.tileSize);
+
+	const size_t memSize = static_cast<size_t>(options.blocks) * BLOCK_SIZE;
+	const size_t linSize = static_cast<size_t>(options.blocks) * maxTile;
+	u8* mem = static_cast<u8*>(_aligned_malloc(memSize, 64));
+	u8* lin = static_cast<u8*>(_aligned_malloc(linSize, 64));
+	alignas(64) static u32 clut32[256];
+
+	std::mt19937 rng(0);
+	for (size_t i = 0; i < memSize; i++)
+		mem[i] = static_cast<u8>(rng());
+	for (size_t i = 0; i < linSize; i++)
+		lin[i] = static_cast<u8>(rng());
+	for (u32& c : clut32)
+		c = rng();
+
+	Buffers buf = {mem, lin, clut32, {}};
+	buf.texa.TA0 = 0x40;
+	buf.texa.TA1 = 0x80;
+
+	int result = CheckRoundTrip(buf, options.blocks) ? 0 : 1;
+
+	std::printf("%-8s  %-26s  %10s\n", "PSM", "Kernel", "GB/s");
+	for (const Kernel& kernel : s_kernels)
+	{
+		// Warm up the caches and page in the tiles before timing
+		kernel.pass(buf, options.blocks);
+
+		u64 passes = 0;
+		Common::Timer timer;
+		do
+		{
+			kernel.pass(buf, options.blocks);
+			passes++;
+		} while (timer.GetTimeSeconds() < options.seconds);
+		const double seconds = timer.GetTimeSeconds();
+
+		const double bytes = static_cast<double>(passes) * memSize;
+		std::printf("%-8s  %-26s  %10.2f\n", kernel.psm, kernel.name, bytes / seconds / 1e9);
+	}
+
+	_aligned_free(lin);
+	_aligned_free(mem);
+	return result;
+}
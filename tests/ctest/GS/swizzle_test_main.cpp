@@ -19,6 +19,19 @@
 #include <gtest/gtest.h>
 #include <string.h>
 
+using namespace CURRENT_ISA;
+
+/// The CLUT kernels built for the ISA of this test
+static const GSClutFunctions& clutKernels()
+{
+	static const GSClutFunctions fn = [] {
+		GSClutFunctions ret;
+		GSClutPopulateFunctions(ret);
+		return ret;
+	}();
+	return fn;
+}
+
 static void swizzle(const u8* table, u8* dst, const u8* src, int bpp, bool deswizzle)
 {
 	int pxbytes = bpp / 8;
@@ -174,7 +187,7 @@ struct TestData
 			output.block[i] = i;
 			output.clut32[i] = i | (i << 16);
 		}
-		GSClut::ExpandCLUT64_T32_I8(output.clut32, output.clut64);
+		clutKernels().ExpandCLUT64_T32_I8(output.clut32, output.clut64);
 		return output;
 	}
 
@@ -189,7 +202,7 @@ struct TestData
 			output.block[i] = rand();
 			output.clut32[i] = rand();
 		}
-		GSClut::ExpandCLUT64_T32_I8(output.clut32, output.clut64);
+		clutKernels().ExpandCLUT64_T32_I8(output.clut32, output.clut64);
 		return output;
 	}
 
@@ -510,3 +523,55 @@ TEST(WriteTest, Write4HL)
 		assertEqual(expected, data, "Write4HL", 8, 8, 32);
 	});
 }
+
+TEST(ClutTest, ExpandCLUT64)
+{
+	runTest([](TestData data)
+	{
+		for (int i = 0; i < 256; i++)
+			EXPECT_EQ(data.clut64[i], (static_cast<u64>(data.clut32[i >> 4]) << 32) | data.clut32[i & 15]) << "Unexpected ExpandCLUT64 entry " << i;
+	});
+}
+
+TEST(ClutTest, Expand16)
+{
+	runTest([](TestData data)
+	{
+		GIFRegTEXA texa = {0};
+		texa.TA0 = 1;
+		texa.TA1 = 2;
+		TestData expected = expand16(data, texa);
+		clutKernels().Expand16(reinterpret_cast<const u16*>(data.block), reinterpret_cast<u32*>(data.output), 128, texa);
+		assertEqual(expected, data, "Expand16", 8, 16, 32);
+	});
+}
+
+TEST(ClutTest, Expand16AEM)
+{
+	runTest([](TestData data)
+	{
+		u8 idx = data.block[0] >> 1;
+		data.block[idx * 2 + 0] = 0;
+		data.block[idx * 2 + 1] = 0;
+		GIFRegTEXA texa = {0};
+		texa.TA0 = 1;
+		texa.TA1 = 2;
+		texa.AEM = 1;
+		TestData expected = expand16(data, texa);
+		clutKernels().Expand16(reinterpret_cast<const u16*>(data.block), reinterpret_cast<u32*>(data.output), 128, texa);
+		assertEqual(expected, data, "Expand16AEM", 8, 16, 32);
+	});
+}
+
+TEST(ClutTest, WriteReadT32I4)
+{
+	runTest([](TestData data)
+	{
+		// The 16 colors are the top two rows of the block
+		alignas(64) u16 clut[512] = {};
+		TestData expected = swizzle(&columnTable32[0][0], data, 32, true);
+		clutKernels().WriteCLUT_T32_I4_CSM1(reinterpret_cast<const u32*>(data.block), clut);
+		clutKernels().ReadCLUT_T32_I4(clut, reinterpret_cast<u32*>(data.output));
+		assertEqual(expected, data, "WriteReadCLUT_T32_I4", 2, 8, 32);
+	});
+}
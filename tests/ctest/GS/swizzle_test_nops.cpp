@@ -19,9 +19,13 @@
 #include "GSBlock.h"
 #include "GSClut.h"
 #include "GSLocalMemory.h"
+#include "GSPerfMon.h"
 
 GSLocalMemory::psm_t GSLocalMemory::m_psm[64];
 
+GSPerfMon::GSPerfMon() {}
+GSPerfMon g_perfmon;
+
 void* vmalloc(size_t size, bool code)
 {
 	abort();
@@ -0,0 +1,412 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Times the GSVertexTrace FindMinMax kernels, either over synthetic draws or over the
+// NNNNN_vertex.bin captures a GS dump writes next to its vertex text files.
+// Every kernel is first checked against a scalar version for all the leftover cases of the
+// unrolled loops, so with --quick this doubles as a test.
+
+#include "PrecompiledHeader.h"
+#include "GS/Renderers/Common/GSVertexTrace.h"
+
+#include "common/Timer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace CURRENT_ISA;
+
+struct Draw
+{
+	std::string name;
+	GSVertexTrace::Capture header;
+	std::vector<GSVertex> vertices;
+	std::vector<u32> indices;
+};
+
+static GSVertexTrace::FindMinMaxTable s_fmm[2]; // [provoking_vertex_first]
+
+static int GetVerticesPerPrim(u32 primclass)
+{
+	switch (primclass)
+	{
+		case GS_POINT_CLASS:
+			return 1;
+		case GS_LINE_CLASS:
+		case GS_SPRITE_CLASS:
+			return 2;
+		default:
+			return 3;
+	}
+}
+
+static void RunKernel(const Draw& draw, GSVertexTrace::Vertex& vmin, GSVertexTrace::Vertex& vmax)
+{
+	const GSVertexTrace::Capture& h = draw.header;
+
+	GSDrawingContext context;
+	context.XYOFFSET = h.XYOFFSET;
+	context.TEX0 = h.TEX0;
+
+	s_fmm[h.provoking_vertex_first][h.color][h.fst][h.tme][h.iip][h.primclass](
+		vmin, vmax, &context, draw.vertices.data(), draw.indices.data(), static_cast<int>(draw.indices.size()));
+}
+
+// One vertex at a time, following the rules of the vector code including its quirks
+static void RunReference(const Draw& draw, GSVertexTrace::Vertex& vmin, GSVertexTrace::Vertex& vmax)
+{
+	const GSVertexTrace::Capture& h = draw.header;
+	const int n = GetVerticesPerPrim(h.primclass);
+	const int count = static_cast<int>(draw.indices.size());
+	const bool sprite = h.primclass == GS_SPRITE_CLASS;
+
+	u32 pmin[4] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff};
+	u32 pmax[4] = {};
+	float tmin[4] = {FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX};
+	float tmax[4] = {-FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX};
+	u8 cmin[4] = {0xff, 0xff, 0xff, 0xff};
+	u8 cmax[4] = {};
+
+	for (int i = 0; i < count; i++)
+	{
+		const GSVertex& v = draw.vertices[draw.indices[i]];
+		const int prim = i / n;
+		const int k = i % n;
+
+		// Sprites take fog and q from their second vertex
+		const GSVertex& last = sprite ? draw.vertices[draw.indices[i - k + 1]] : v;
+
+		const u32 p[4] = {v.XYZ.X, v.XYZ.Y, v.XYZ.Z, last.FOG};
+		for (int j = 0; j < 4; j++)
+		{
+			pmin[j] = std::min(pmin[j], p[j]);
+			pmax[j] = std::max(pmax[j], p[j]);
+		}
+
+		if (h.tme)
+		{
+			float t[4];
+			if (h.fst)
+			{
+				t[0] = t[2] = static_cast<float>(v.U);
+				t[1] = t[3] = static_cast<float>(v.V);
+			}
+			else
+			{
+				const float q = last.RGBAQ.Q;
+				t[0] = v.ST.S / q;
+				t[1] = v.ST.T / q;
+				t[2] = t[3] = q;
+			}
+			for (int j = 0; j < 4; j++)
+			{
+				tmin[j] = std::min(tmin[j], t[j]);
+				tmax[j] = std::max(tmax[j], t[j]);
+			}
+		}
+
+		bool used = true;
+		if (!h.iip && n == 2)
+		{
+			used = k == 1;
+		}
+		else if (!h.iip && n == 3)
+		{
+			const int provoking = h.provoking_vertex_first ? 0 : 2;
+			const bool odd_last = (count / 3) & 1 && prim == count / 3 - 1;
+			// The last triangle of an odd count also picks up v1 when v0 is the provoking vertex
+			used = k == provoking || (odd_last && h.provoking_vertex_first && k == 1);
+		}
+
+		if (h.color && used)
+		{
+			const u8 c[4] = {v.RGBAQ.R, v.RGBAQ.G, v.RGBAQ.B, v.RGBAQ.A};
+			for (int j = 0; j < 4; j++)
+			{
+				cmin[j] = std::min(cmin[j], c[j]);
+				cmax[j] = std::max(cmax[j], c[j]);
+			}
+		}
+	}
+
+	// Same scaling as the kernels
+	const GSVector4i pmin4 = GSVector4i::load<false>(pmin);
+	const GSVector4i pmax4 = GSVector4i::load<false>(pmax);
+
+	GSVector4 o(GSVector4i(h.XYOFFSET));
+	GSVector4 s(1.0f / 16, 1.0f / 16, 2.0f, 1.0f);
+
+	vmin.p = (GSVector4(pmin4) - o) * s;
+	vmax.p = (GSVector4(pmax4) - o) * s;
+	vmin.p = vmin.p.insert32<0, 2>(GSVector4::load((float)pmin[2]));
+	vmax.p = vmax.p.insert32<0, 2>(GSVector4::load((float)pmax[2]));
+
+	if (h.tme)
+	{
+		s = h.fst ? GSVector4(1.0f / 16, 1.0f).xxyy() : GSVector4(1 << h.TEX0.TW, 1 << h.TEX0.TH, 1, 1);
+		vmin.t = GSVector4::load<false>(tmin) * s;
+		vmax.t = GSVector4::load<false>(tmax) * s;
+	}
+	else
+	{
+		vmin.t = GSVector4::zero();
+		vmax.t = GSVector4::zero();
+	}
+
+	vmin.c = h.color ? GSVector4i(cmin[0], cmin[1], cmin[2], cmin[3]) : GSVector4i::zero();
+	vmax.c = h.color ? GSVector4i(cmax[0], cmax[1], cmax[2], cmax[3]) : GSVector4i::zero();
+}
+
+static bool Matches(const GSVertexTrace::Vertex& a, const GSVertexTrace::Vertex& b)
+{
+	return (a.c == b.c).alltrue() &&
+		   (GSVector4i::cast(a.p) == GSVector4i::cast(b.p)).alltrue() &&
+		   (GSVector4i::cast(a.t) == GSVector4i::cast(b.t)).alltrue();
+}
+
+static Draw MakeDraw(std::mt19937& rng, u32 primclass, u32 iip, u32 tme, u32 fst, u32 color, u32 provoking_vertex_first, int prims)
+{
+	Draw draw;
+	memset(&draw.header, 0, sizeof(draw.header));
+	draw.header.magic = GSVertexTrace::Capture::MAGIC;
+	draw.header.primclass = primclass;
+	draw.header.iip = iip;
+	draw.header.tme = tme;
+	draw.header.fst = fst;
+	draw.header.color = color;
+	draw.header.provoking_vertex_first = provoking_vertex_first;
+	draw.header.XYOFFSET.OFX = 0x8000 - (320 << 4);
+	draw.header.XYOFFSET.OFY = 0x8000 - (224 << 4);
+	draw.header.TEX0.TW = 8;
+	draw.header.TEX0.TH = 8;
+
+	std::uniform_real_distribution<float> st(0.0f, 1.0f);
+	std::uniform_real_distribution<float> q(0.125f, 2.0f);
+
+	const int count = prims * GetVerticesPerPrim(primclass);
+	// Sprites are never indexed, the rest share vertices like strips and fans do
+	const int v_count = (primclass == GS_SPRITE_CLASS) ? count : std::max(1, count / 2);
+
+	draw.vertices.resize(v_count);
+	for (GSVertex& v : draw.vertices)
+	{
+		v.ST.S = st(rng);
+		v.ST.T = st(rng);
+		v.RGBAQ.U32[0] = rng();
+		v.RGBAQ.Q = q(rng);
+		v.XYZ.X = static_cast<u16>(rng());
+		v.XYZ.Y = static_cast<u16>(rng());
+		v.XYZ.Z = rng();
+		v.UV = rng() & 0x3fff3fff;
+		v.FOG = rng();
+	}
+
+	draw.indices.resize(count);
+	for (int i = 0; i < count; i++)
+		draw.indices[i] = (primclass == GS_SPRITE_CLASS) ? i : rng() % v_count;
+
+	draw.header.v_count = v_count;
+	draw.header.i_count = count;
+	return draw;
+}
+
+// All 128 kernels, with every leftover count of the 4 and 2 vertex loops
+static bool CheckKernels()
+{
+	std::mt19937 rng(0);
+	int mismatches = 0;
+
+	for (u32 pvf = 0; pvf < 2; pvf++)
+	for (u32 primclass = 0; primclass < 4; primclass++)
+	for (u32 iip = 0; iip < 2; iip++)
+	for (u32 tme = 0; tme < 2; tme++)
+	for (u32 fst = 0; fst < 2; fst++)
+	for (u32 color = 0; color < 2; color++)
+	for (int prims = 1; prims <= 13; prims++)
+	{
+		const Draw draw = MakeDraw(rng, primclass, iip, tme, fst, color, pvf, prims);
+
+		GSVertexTrace::Vertex kmin, kmax, rmin, rmax;
+		RunKernel(draw, kmin, kmax);
+		RunReference(draw, rmin, rmax);
+
+		if (!Matches(kmin, rmin) || !Matches(kmax, rmax))
+		{
+			if (mismatches++ < 10)
+			{
+				std::fprintf(stderr, "Mismatch: class %u iip %u tme %u fst %u color %u pvf %u, %d prims\n",
+					primclass, iip, tme, fst, color, pvf, prims);
+			}
+		}
+	}
+
+	if (mismatches > 0)
+		std::fprintf(stderr, "%d mismatches\n", mismatches);
+	return mismatches == 0;
+}
+
+static bool LoadCapture(const char* filename, Draw& draw)
+{
+	FILE* fp = std::fopen(filename, "rb");
+	if (!fp)
+	{
+		std::fprintf(stderr, "Failed to open %s\n", filename);
+		return false;
+	}
+
+	draw.name = filename;
+	bool ok = std::fread(&draw.header, sizeof(draw.header), 1, fp) == 1 &&
+			  draw.header.magic == GSVertexTrace::Capture::MAGIC && draw.header.primclass < 4;
+	if (ok)
+	{
+		draw.vertices.resize(draw.header.v_count);
+		draw.indices.resize(draw.header.i_count);
+		ok = std::fread(draw.vertices.data(), sizeof(GSVertex), draw.vertices.size(), fp) == draw.vertices.size() &&
+			 std::fread(draw.indices.data(), sizeof(u32), draw.indices.size(), fp) == draw.indices.size();
+		for (u32 i : draw.indices)
+			ok = ok && i < draw.header.v_count;
+	}
+	std::fclose(fp);
+
+	if (!ok)
+		std::fprintf(stderr, "%s is not a vertex capture\n", filename);
+	return ok;
+}
+
+// Runs every draw in the set once per pass, returns the seconds a pass takes
+static double TimeDraws(const std::vector<Draw>& draws, double seconds)
+{
+	GSVertexTrace::Vertex vmin, vmax;
+	for (const Draw& draw : draws)
+		RunKernel(draw, vmin, vmax);
+
+	u64 passes = 0;
+	Common::Timer timer;
+	do
+	{
+		for (const Draw& draw : draws)
+			RunKernel(draw, vmin, vmax);
+		passes++;
+	} while (timer.GetTimeSeconds() < seconds);
+
+	return timer.GetTimeSeconds() / passes;
+}
+
+static void Usage()
+{
+	std::fprintf(stderr,
+		"Usage: vertex_trace_bench [options] [NNNNN_vertex.bin ...]\n"
+		"  --quick          check the kernels and run each timing once\n"
+		"  --time S         seconds to spend on each timing (default 0.25)\n"
+		"Captures come from the GS dump (dump = 1 in the GS settings), all given captures are\n"
+		"timed together as one scene.  Without captures a few synthetic draw types are timed.\n");
+}
+
+int main(int argc, char** argv)
+{
+	double seconds = 0.25;
+	std::vector<const char*> files;
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		if (std::strcmp(arg, "--quick") == 0)
+			seconds = 0;
+		else if (std::strcmp(arg, "--time") == 0 && i + 1 < argc)
+			seconds = std::max(0.0, std::atof(argv[++i]));
+		else if (arg[0] == '-')
+		{
+			Usage();
+			return 1;
+		}
+		else
+			files.push_back(arg);
+	}
+
+	GSVertexTracePopulateFunctions(s_fmm[0], false);
+	GSVertexTracePopulateFunctions(s_fmm[1], true);
+
+	int result = CheckKernels() ? 0 : 1;
+
+	if (!files.empty())
+	{
+		std::vector<Draw> draws(files.size());
+		u64 indices = 0;
+		int mismatches = 0;
+		for (size_t i = 0; i < files.size(); i++)
+		{
+			if (!LoadCapture(files[i], draws[i]))
+				return 1;
+			indices += draws[i].indices.size();
+
+			GSVertexTrace::Vertex kmin, kmax, rmin, rmax;
+			RunKernel(draws[i], kmin, kmax);
+			RunReference(draws[i], rmin, rmax);
+			if (!Matches(kmin, rmin) || !Matches(kmax, rmax))
+			{
+				std::fprintf(stderr, "%s: kernel and reference disagree\n", draws[i].name.c_str());
+				mismatches++;
+			}
+		}
+		result |= mismatches > 0;
+
+		const double pass = TimeDraws(draws, seconds);
+		std::printf("%zu draws, %llu vertices: %.3f us per scene, %.1f ns per draw, %.1f M vertices/s\n",
+			draws.size(), static_cast<unsigned long long>(indices), pass * 1e6, pass * 1e9 / draws.size(),
+			indices / pass / 1e6);
+		return result;
+	}
+
+	struct Synthetic
+	{
+		const char* name;
+		u32 primclass, iip, tme, fst, color;
+	};
+	static const Synthetic types[] = {
+		{"Gouraud textured triangles", GS_TRIANGLE_CLASS, 1, 1, 0, 1},
+		{"Flat textured triangles", GS_TRIANGLE_CLASS, 0, 1, 0, 1},
+		{"Untextured triangles", GS_TRIANGLE_CLASS, 1, 0, 0, 1},
+		{"Sprites (UV)", GS_SPRITE_CLASS, 0, 1, 1, 1},
+		{"Sprites (STQ)", GS_SPRITE_CLASS, 0, 1, 0, 1},
+		{"Lines", GS_LINE_CLASS, 1, 0, 0, 1},
+		{"Points", GS_POINT_CLASS, 0, 0, 0, 1},
+	};
+	static const int sizes[] = {2, 16, 1000};
+
+	std::mt19937 rng(1);
+	std::printf("%-28s  %6s  %12s  %14s\n", "Draw", "Prims", "ns/draw", "M vertices/s");
+	for (const Synthetic& type : types)
+	{
+		for (int prims : sizes)
+		{
+			// Enough draws of the size to not just be timing one cached index buffer
+			std::vector<Draw> draws;
+			const int count = std::max(1, 4096 / prims);
+			for (int i = 0; i < count; i++)
+				draws.push_back(MakeDraw(rng, type.primclass, type.iip, type.tme, type.fst, type.color, 0, prims));
+
+			const double pass = TimeDraws(draws, seconds);
+			const double vertices = static_cast<double>(count) * prims * GetVerticesPerPrim(type.primclass);
+			std::printf("%-28s  %6d  %12.1f  %14.1f\n", type.name, prims, pass * 1e9 / count, vertices / pass / 1e6);
+		}
+	}
+
+	return result;
+}